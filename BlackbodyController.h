@@ -3,8 +3,12 @@
 
 #pragma once
 #include <QObject>
-#include <QSerialPort>
-#include <QModbusRtuSerialMaster>
+#include <QModbusDataUnit>
+#include <QElapsedTimer>
+#include "modbuslinkstats.h"
+#include "modbustransactionscheduler.h"
+
+class ModbusBus;
 
 class BlackbodyController : public QObject
 {
@@ -13,16 +17,33 @@ public:
     explicit BlackbodyController(QObject *parent = nullptr);
     ~BlackbodyController();
 
+    // 挂接到 portName 对应的 RS-485 总线（与其他设备共用同一 COM 口时共享一个主站）
     bool connectDevice(const QString &portName);
-    bool isConnected() const;
-    void setMasterControl(bool enable);
+    // 以下接口为虚函数，便于仿真设备（见 calibrationsimulator.h）替换实机通信
+    virtual bool isConnected() const;
+    virtual void setMasterControl(bool enable);
     bool connectDevice();
     void disconnectDevice();
-    void setTargetTemperature(float temperature);
-    void readCurrentTemperature();
-    void setDeviceState(bool start);
+    virtual void setTargetTemperature(float temperature);
+    virtual void readCurrentTemperature();
+    virtual void setDeviceState(bool start);
+
+    virtual float getCurrentTemperature() const;
+
+    // 从站地址，默认 0x02；需在 connectDevice 之前设置
+    void setSlaveAddress(quint8 address) { m_slaveAddress = address; }
+    quint8 slaveAddress() const { return m_slaveAddress; }
+
+    // 周期读取当前温度（周期由本设备的轮询档位决定，与共线的其他设备互不影响）
+    void setPollingEnabled(bool enabled);
+    void setPollProfile(ModbusTransactionScheduler::PollProfile profile);
+    // 所在总线的调度器，未连接时为 nullptr
+    ModbusTransactionScheduler *scheduler() const;
 
-    float getCurrentTemperature() const;
+    // 通信诊断：本从站的往返时间/错误统计，以及缓存温度距上次成功读取的时间（毫秒，-1 表示从未读到）
+    ModbusLinkStats linkStats() const;
+    qint64 temperatureAgeMs() const;
+    QString busDescription() const;
 
 signals:
     void connectionStatusChanged(bool connected);
@@ -32,11 +53,17 @@ signals:
     void masterControlChanged(bool acquired);
 
 private:
-    QModbusRtuSerialMaster *m_modbusDevice = nullptr;
+    ModbusBus *m_bus = nullptr;
+    int m_pollId = -1;
+    bool m_pollingEnabled = false;
+    ModbusTransactionScheduler::PollProfile m_pollProfile = ModbusTransactionScheduler::IdlePoll;
     quint8 m_slaveAddress; // 确保初始化为0x02
     quint16 calculateCRC(const QByteArray &data);
+    void updateTemperature(const QModbusDataUnit &unit);
+    QString busErrorString() const;
 
     float m_currentTemperature = 0.0f; // 新增成员变量用于存储当前温度
+    QElapsedTimer m_temperatureAge;
 
     QString m_portName; // 保存当前端口名
     bool m_connected = false; // 连接状态
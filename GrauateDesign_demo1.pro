@@ -26,34 +26,72 @@ INCLUDEPATH += $$UI_DIR            # 告诉编译器从此目录查找 UI 头文
 
 SOURCES += \
     blackbodycontroller.cpp \
+    calibrationclock.cpp \
     calibrationmanager.cpp \
+    calibrationplan.cpp \
+    calibrationsimulator.cpp \
     customtitlebar.cpp \
     database.cpp \
     dataexcelprocessor.cpp \
     dualtemperaturechart.cpp \
+    exceltime.cpp \
     humiditycontroller.cpp \
+    irdatahub.cpp \
+    jobqueue.cpp \
+    jobqueuewidget.cpp \
     loginwindow.cpp \
     main.cpp \
     mainwindow.cpp \
+    modbusbusmanager.cpp \
+    modbusdiagnosticswidget.cpp \
+    modbuslinkstats.cpp \
+    modbustransactionscheduler.cpp \
     modelingpointdialog.cpp \
+    planengine.cpp \
     pythonprocessor.cpp \
+    rigorchestrator.cpp \
+    rigoverviewwidget.cpp \
     serialportthread.cpp \
-    servomotorcontroller.cpp
+    setpointshaper.cpp \
+    servomotorcontroller.cpp \
+    txtblocklog.cpp \
+    txtdirectoryindex.cpp \
+    txtlogscanner.cpp \
+    txtminuteindex.cpp
 
 HEADERS += \
     blackbodycontroller.h \
+    calibrationclock.h \
     calibrationmanager.h \
+    calibrationplan.h \
+    calibrationsimulator.h \
     customtitlebar.h \
     database.h \
     dataexcelprocessor.h \
     dualtemperaturechart.h \
+    exceltime.h \
     humiditycontroller.h \
+    irdatahub.h \
+    jobqueue.h \
+    jobqueuewidget.h \
     loginwindow.h \
     mainwindow.h \
+    modbusbusmanager.h \
+    modbusdiagnosticswidget.h \
+    modbuslinkstats.h \
+    modbustransactionscheduler.h \
     modelingpointdialog.h \
+    planengine.h \
     pythonprocessor.h \
+    rigorchestrator.h \
+    rigoverviewwidget.h \
     serialportthread.h \
-    servomotorcontroller.h
+    setpointshaper.h \
+    servomotorcontroller.h \
+    txtblocklog.h \
+    txtdirectoryindex.h \
+    txtlogscanner.h \
+    txtminuteindex.h
 
 FORMS += \
     loginwindow.ui \
@@ -67,3 +105,7 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 RESOURCES += \
     fonts.qrc \
     pictures.qrc
+
+DISTFILES += \
+    plans/default_plan.json \
+    plans/prerampchamber_plan.json
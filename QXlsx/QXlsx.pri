@@ -91,6 +91,8 @@ $${QXLSX_HEADERPATH}xlsxrelationships_p.h \
 $${QXLSX_HEADERPATH}xlsxrichstring.h \
 $${QXLSX_HEADERPATH}xlsxrichstring_p.h \
 $${QXLSX_HEADERPATH}xlsxsharedstrings_p.h \
+$${QXLSX_HEADERPATH}xlsxsheetreader.h \
+$${QXLSX_HEADERPATH}xlsxsheetreader_p.h \
 $${QXLSX_HEADERPATH}xlsxsimpleooxmlfile_p.h \
 $${QXLSX_HEADERPATH}xlsxstyles_p.h \
 $${QXLSX_HEADERPATH}xlsxtheme_p.h \
@@ -128,6 +130,7 @@ $${QXLSX_SOURCEPATH}xlsxnumformatparser.cpp \
 $${QXLSX_SOURCEPATH}xlsxrelationships.cpp \
 $${QXLSX_SOURCEPATH}xlsxrichstring.cpp \
 $${QXLSX_SOURCEPATH}xlsxsharedstrings.cpp \
+$${QXLSX_SOURCEPATH}xlsxsheetreader.cpp \
 $${QXLSX_SOURCEPATH}xlsxsimpleooxmlfile.cpp \
 $${QXLSX_SOURCEPATH}xlsxstyles.cpp \
 $${QXLSX_SOURCEPATH}xlsxtheme.cpp \
@@ -40,6 +40,14 @@ public:
     QVariant read(const CellReference &cell) const;
     QVariant read(int row, int col) const;
 
+    QVector<QVariant> readRange(const CellRange &range) const;
+    bool writeRange(int row,
+                    int col,
+                    const QVector<QVariant> &values,
+                    int columnCount,
+                    const Format &format = Format());
+    bool permuteRows(int firstRow, const QVector<int> &sourceRows);
+
     int insertImage(int row, int col, const QImage &image);
     bool getImage(int imageIndex, QImage &img);
     bool getImage(int row, int col, QImage &img);
@@ -0,0 +1,49 @@
+// xlsxsheetreader.h
+
+#ifndef QXLSX_XLSXSHEETREADER_H
+#define QXLSX_XLSXSHEETREADER_H
+
+#include "xlsxglobal.h"
+
+#include <QIODevice>
+#include <QList>
+#include <QStringList>
+#include <QVariant>
+
+QT_BEGIN_NAMESPACE_XLSX
+
+class SheetReaderPrivate;
+
+class QXLSX_EXPORT SheetReader
+{
+    Q_DECLARE_PRIVATE(SheetReader)
+public:
+    explicit SheetReader(const QString &xlsxName);
+    explicit SheetReader(QIODevice *device);
+    ~SheetReader();
+
+    bool isLoaded() const;
+    QStringList sheetNames() const;
+
+    bool selectSheet(const QString &name);
+    bool selectSheet(int index);
+
+    void setColumns(const QList<int> &columns);
+    QList<int> columns() const;
+
+    bool readNextRow();
+    int row() const;
+    int lastColumn() const;
+    QVariant read(int column) const;
+
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(SheetReader)
+    SheetReaderPrivate *const d_ptr;
+};
+
+QT_END_NAMESPACE_XLSX
+
+#endif // QXLSX_XLSXSHEETREADER_H
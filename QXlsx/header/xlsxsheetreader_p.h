@@ -0,0 +1,58 @@
+// xlsxsheetreader_p.h
+
+#ifndef XLSXSHEETREADER_P_H
+#define XLSXSHEETREADER_P_H
+
+#include "xlsxglobal.h"
+#include "xlsxsheetreader.h"
+#include "xlsxworkbook.h"
+#include "xlsxzipreader_p.h"
+
+#include <QVector>
+#include <QXmlStreamReader>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE_XLSX
+
+class SheetReaderPrivate
+{
+    Q_DECLARE_PUBLIC(SheetReader)
+public:
+    SheetReaderPrivate(SheetReader *p);
+
+    bool loadPackage();
+    bool openSheet(int index);
+    void closeSheet();
+
+    int valueIndex(int column);
+    void readRow();
+    QVariant readCell(const QXmlStreamAttributes &attributes);
+    QString readInlineString();
+    bool isDateTimeXf(int xf) const;
+    void setError(const QString &message);
+
+    SheetReader *q_ptr;
+    std::unique_ptr<ZipReader> zipReader;
+    std::shared_ptr<Workbook> workbook;
+    QString workbookDir;
+    bool isLoad;
+
+    // State of the selected sheet. The reader owns the inflated sheet part
+    // and is advanced one <row> at a time.
+    QXmlStreamReader reader;
+    bool inSheetData;
+    int currentRow;
+    int currentLastColumn;
+
+    QList<int> columns;          // selected columns, empty means all
+    QVector<int> columnIndex;    // column -> index into values, -1 if not selected
+    QVector<QVariant> values;    // decoded cells of the current row
+
+    mutable QVector<qint8> xfDateTime; // 0 unknown, 1 no, 2 date/time format
+    QString errorString;
+};
+
+QT_END_NAMESPACE_XLSX
+
+#endif // XLSXSHEETREADER_P_H
@@ -78,6 +78,7 @@ private:
     friend class WorksheetPrivate;
     friend class Document;
     friend class DocumentPrivate;
+    friend class SheetReaderPrivate;
 
     Workbook(Workbook::CreateFlag flag);
 
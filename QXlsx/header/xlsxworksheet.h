@@ -58,6 +58,15 @@ public:
     QVariant read(const CellReference &row_column) const;
     QVariant read(int row, int column) const;
 
+    // Block access: row-major buffers, rows moved without copying cells
+    QVector<QVariant> readRange(const CellRange &range) const;
+    bool writeRange(int row,
+                    int column,
+                    const QVector<QVariant> &values,
+                    int columnCount,
+                    const Format &format = Format());
+    bool permuteRows(int firstRow, const QVector<int> &sourceRows);
+
     bool writeString(const CellReference &row_column,
                      const QString &value,
                      const Format &format = Format());
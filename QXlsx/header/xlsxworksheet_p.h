@@ -132,54 +132,98 @@ struct XlsxColumnInfo {
     bool collapsed;
 };
 
+/*
+ * Cell storage of a worksheet.
+ *
+ * Rows are grouped into blocks of BlockRows rows. Each row keeps its cells in one
+ * array of 16-byte slots sorted by column, so a row that is filled from its first
+ * to its last column is indexed directly and other rows use a binary search.
+ *
+ * Numbers, booleans, blanks and plain shared strings are stored in the slot itself,
+ * together with the xf index of the cell format. Only cells that need more than
+ * that (formulas, rich text, inline strings, errors, ...) keep a Cell object; those
+ * are held by the row and referenced from an Object slot.
+ */
 class CellTable
 {
 public:
-    static QList<int> sorteIntList(QList<int> &&keys)
-    {
-        std::sort(keys.begin(), keys.end());
-        return keys;
-    }
+    enum { BlockRows = 16 };
+
+    struct Slot {
+        enum Kind : quint8 { Blank, Number, SharedString, Boolean, Object };
+        enum : quint8 { TypeMask = 0x0f, FileStyle = 0x80 };
+
+        Slot()
+            : number(0)
+            , xf(-1)
+            , column(0)
+            , kind(Blank)
+            , type(Cell::NumberType)
+        {
+        }
 
-    inline QList<int> sortedRows() const
-    {
-        QList<int> keys = cells.keys();
-        std::sort(keys.begin(), keys.end());
-        return keys;
-    }
+        Cell::CellType cellType() const { return Cell::CellType(type & TypeMask); }
+
+        union {
+            double number;
+            qint32 index; // shared string index, or index into Row::objects
+            bool boolean;
+        };
+        qint32 xf; // xf index of the cell format, -1 for an empty format
+        quint16 column;
+        quint8 kind;
+        quint8 type; // Cell::CellType; FileStyle when the xf index came from the "s" attribute
+    };
+
+    struct Row {
+        QVector<Slot> slots;                    // sorted by column
+        QVector<std::shared_ptr<Cell>> objects; // cells of the Object slots
+
+        bool isEmpty() const { return slots.isEmpty(); }
+        int indexOf(int column) const;
+        int lowerBound(int column) const;
+        const Slot *find(int column) const
+        {
+            const int i = indexOf(column);
+            return i < 0 ? nullptr : slots.constData() + i;
+        }
+    };
 
-    void setValue(int row, int column, const std::shared_ptr<Cell> &cell)
-    {
-        cells[row].insert(column, cell);
-        firstRow    = qMin(firstRow, row);
-        firstColumn = qMin(firstColumn, column);
-        lastRow     = qMin(lastRow, row);
-        lastColumn  = qMin(lastColumn, column);
-    }
+    QList<int> sortedRows() const;
 
-    std::shared_ptr<Cell> cellAt(int row, int column) const
-    {
-        return cells.value(row).value(column);
-    }
+    // Returns the cells of \a row, or nullptr if the row is empty.
+    const Row *row(int row) const;
+    Row takeRow(int row);
+    void setRow(int row, const Row &cells);
 
-    bool contains(int row, int column) const
+    const Slot *slot(int row, int column) const
     {
-        auto it = cells.find(row);
-        if (it != cells.end()) {
-            return it->contains(column);
-        }
-        return false;
+        const Row *cells = this->row(row);
+        return cells ? cells->find(column) : nullptr;
     }
+    void setSlot(int row, int column, const Slot &slot);
+    void setObject(int row, int column, const std::shared_ptr<Cell> &cell);
 
-    bool isEmpty() const { return cells.isEmpty(); }
+    bool contains(int row, int column) const { return slot(row, column) != nullptr; }
+
+    bool isEmpty() const { return blocks.isEmpty(); }
 
-    // It's faster with a single QHash, but in Qt5 it's capacity limits
-    // how much cells we can hold
-    QHash<int, QHash<int, std::shared_ptr<Cell>>> cells;
     int firstRow    = -1;
     int firstColumn = -1;
     int lastRow     = -1;
     int lastColumn  = -1;
+
+private:
+    struct Block {
+        Row rows[BlockRows];
+        int usedRows = 0;
+    };
+
+    static int blockOf(int row) { return (row - 1) / BlockRows; }
+    Slot &slotForWrite(int row, int column, Row **cells);
+    void extendBounds(int row, int firstCol, int lastCol);
+
+    QHash<int, Block> blocks;
 };
 
 class WorksheetPrivate : public AbstractSheetPrivate
@@ -193,6 +237,28 @@ public:
 public:
     int checkDimensions(int row, int col, bool ignore_row = false, bool ignore_col = false);
     Format cellFormat(int row, int col) const;
+    QVariant cellValue(int row, int col, const Cell *cell) const;
+    void detachSharedFormulas(int row, CellTable::Row &cells) const;
+
+    std::shared_ptr<Cell> cellAt(int row, int col) const;
+    void setCell(int row, int col, const std::shared_ptr<Cell> &cell);
+    bool setCompactCell(int row,
+                        int col,
+                        Cell::CellType type,
+                        const QVariant &value,
+                        const Format &format,
+                        int sharedIndex = -1);
+    bool compactSlot(Cell::CellType type,
+                     const QVariant &value,
+                     const Format &format,
+                     qint32 styleNumber,
+                     int sharedIndex,
+                     CellTable::Slot *slot) const;
+    QVariant slotRawValue(const CellTable::Slot &slot) const;
+    QVariant slotValue(int row, const CellTable::Row &cells, const CellTable::Slot &slot) const;
+    std::shared_ptr<Cell> slotCell(const CellTable::Row &cells, const CellTable::Slot &slot) const;
+    Format xfFormat(int xf) const;
+    bool isDateTimeXf(int xf) const;
     QString generateDimensionString() const;
     void calculateSpans() const;
     void splitColsInfo(int colFirst, int colLast);
@@ -203,6 +269,8 @@ public:
                          int row,
                          int col,
                          std::shared_ptr<Cell> cell) const;
+    void saveXmlSlotData(QXmlStreamWriter &writer, int row, const CellTable::Slot &slot) const;
+    void saveXmlCellStyle(QXmlStreamWriter &writer, int row, int col, int xf) const;
     void saveXmlMergeCells(QXmlStreamWriter &writer) const;
     void saveXmlHyperlinks(QXmlStreamWriter &writer) const;
     void saveXmlDrawings(QXmlStreamWriter &writer) const;
@@ -228,6 +296,7 @@ public:
 
 public:
     CellTable cellTable;
+    mutable QVector<qint8> xfDateTime; // per xf index: 0 unknown, 1 no, 2 date/time format
 
     QHash<int, QHash<int, QString>> comments;
     QHash<int, QHash<int, std::shared_ptr<XlsxHyperlinkData>>> urlTable;
@@ -291,4 +360,5 @@ private:
 };
 
 QT_END_NAMESPACE_XLSX
+
 #endif // XLSXWORKSHEET_P_H
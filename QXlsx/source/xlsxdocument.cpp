@@ -746,6 +746,43 @@ QVariant Document::read(int row, int col) const
     return QVariant();
 }
 
+/*!
+        Returns the contents of \a range of the current worksheet in row-major
+        order, see Worksheet::readRange().
+ */
+QVector<QVariant> Document::readRange(const CellRange &range) const
+{
+    if (Worksheet *sheet = currentWorksheet())
+        return sheet->readRange(range);
+    return QVector<QVariant>();
+}
+
+/*!
+        Writes the row-major \a values, \a columnCount values per row, to the
+        current worksheet starting at (\a row, \a col), see Worksheet::writeRange().
+ */
+bool Document::writeRange(int row,
+                          int col,
+                          const QVector<QVariant> &values,
+                          int columnCount,
+                          const Format &format)
+{
+    if (Worksheet *sheet = currentWorksheet())
+        return sheet->writeRange(row, col, values, columnCount, format);
+    return false;
+}
+
+/*!
+        Reorders rows of the current worksheet starting at \a firstRow,
+        see Worksheet::permuteRows().
+ */
+bool Document::permuteRows(int firstRow, const QVector<int> &sourceRows)
+{
+    if (Worksheet *sheet = currentWorksheet())
+        return sheet->permuteRows(firstRow, sourceRows);
+    return false;
+}
+
 /*!
  * Insert an \a image to current active worksheet at the position \a row, \a column
  * Returns true if success.
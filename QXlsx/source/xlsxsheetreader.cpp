@@ -0,0 +1,533 @@
+// xlsxsheetreader.cpp
+
+#include "xlsxsheetreader.h"
+
+#include "xlsxformat.h"
+#include "xlsxrelationships_p.h"
+#include "xlsxsharedstrings_p.h"
+#include "xlsxsheetreader_p.h"
+#include "xlsxstyles_p.h"
+#include "xlsxutility_p.h"
+#include "xlsxworkbook.h"
+
+#include <QDateTime>
+
+QT_BEGIN_NAMESPACE_XLSX
+
+namespace {
+// Largest column of the xlsx format (XFD)
+const int MaxColumn = 16384;
+
+// Column part of a cell reference such as "AB12", 0 when there is none
+int referenceColumn(const QXmlStreamAttributes &attributes)
+{
+    const auto ref = attributes.value(QLatin1String("r"));
+    int column     = 0;
+    for (int i = 0; i < ref.size(); ++i) {
+        const ushort c = ref.at(i).unicode();
+        if (c < 'A' || c > 'Z')
+            break;
+        column = column * 26 + (c - 'A' + 1);
+    }
+    return column;
+}
+} // namespace
+
+SheetReaderPrivate::SheetReaderPrivate(SheetReader *p)
+    : q_ptr(p)
+    , isLoad(false)
+    , inSheetData(false)
+    , currentRow(0)
+    , currentLastColumn(0)
+{
+}
+
+/*!
+ * \internal
+ * Loads the workbook part, the styles and the shared strings, the same
+ * way DocumentPrivate::loadPackage() does. Sheet parts are not touched.
+ */
+bool SheetReaderPrivate::loadPackage()
+{
+    const QStringList filePaths = zipReader->filePaths();
+    if (!filePaths.contains(QLatin1String("_rels/.rels"))) {
+        setError(QStringLiteral("not an xlsx package"));
+        return false;
+    }
+
+    Relationships rootRels;
+    rootRels.loadFromXmlData(zipReader->fileData(QStringLiteral("_rels/.rels")));
+    const QList<XlsxRelationship> rels_xl =
+        rootRels.documentRelationships(QStringLiteral("/officeDocument"));
+    if (rels_xl.isEmpty()) {
+        setError(QStringLiteral("workbook part not found"));
+        return false;
+    }
+
+    const QString xlworkbook_Path = rels_xl[0].target;
+    workbookDir                   = splitPath(xlworkbook_Path).first();
+
+    workbook = std::shared_ptr<Workbook>(new Workbook(Workbook::F_LoadFromExists));
+    workbook->relationships()->loadFromXmlData(
+        zipReader->fileData(getRelFilePath(xlworkbook_Path)));
+    workbook->setFilePath(xlworkbook_Path);
+    if (!workbook->loadFromXmlData(zipReader->fileData(xlworkbook_Path))) {
+        setError(QStringLiteral("failed to load the workbook part"));
+        return false;
+    }
+
+    auto partPath = [this](const QString &name) {
+        return workbookDir == QLatin1String(".") ? name : workbookDir + QLatin1String("/") + name;
+    };
+
+    // The workbook was created with F_LoadFromExists, so its styles and
+    // shared strings can be loaded in place.
+    const QList<XlsxRelationship> rels_styles =
+        workbook->relationships()->documentRelationships(QStringLiteral("/styles"));
+    if (!rels_styles.isEmpty())
+        workbook->styles()->loadFromXmlData(zipReader->fileData(partPath(rels_styles[0].target)));
+
+    const QList<XlsxRelationship> rels_sharedStrings =
+        workbook->relationships()->documentRelationships(QStringLiteral("/sharedStrings"));
+    if (!rels_sharedStrings.isEmpty())
+        workbook->sharedStrings()->loadFromXmlData(
+            zipReader->fileData(partPath(rels_sharedStrings[0].target)));
+
+    return true;
+}
+
+/*!
+ * \internal
+ * Inflates the part of sheet \a index and positions the reader on its
+ * <sheetData> element. Returns false if the sheet is not a worksheet or
+ * its part is missing or malformed.
+ */
+bool SheetReaderPrivate::openSheet(int index)
+{
+    closeSheet();
+
+    AbstractSheet *sheet = workbook->sheet(index);
+    if (!sheet || sheet->sheetType() != AbstractSheet::ST_WorkSheet) {
+        setError(QStringLiteral("not a worksheet"));
+        return false;
+    }
+
+    const QByteArray data = zipReader->fileData(sheet->filePath());
+    if (data.isEmpty()) {
+        setError(QStringLiteral("worksheet part not found: ") + sheet->filePath());
+        return false;
+    }
+    reader.addData(data);
+
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QXmlStreamReader::StartElement &&
+            reader.name() == QLatin1String("sheetData")) {
+            inSheetData = true;
+            return true;
+        }
+    }
+
+    const bool ok = !reader.hasError();
+    if (!ok)
+        setError(reader.errorString());
+    // A sheet without <sheetData> simply has no rows
+    reader.clear();
+    return ok;
+}
+
+void SheetReaderPrivate::closeSheet()
+{
+    reader.clear();
+    inSheetData       = false;
+    currentRow        = 0;
+    currentLastColumn = 0;
+    values.fill(QVariant());
+    errorString.clear();
+}
+
+/*!
+ * \internal
+ * Returns the index into values for \a column, or -1 if the column is not
+ * selected and its cells should be skipped.
+ */
+int SheetReaderPrivate::valueIndex(int column)
+{
+    if (column < 1 || column > MaxColumn)
+        return -1;
+
+    if (!columns.isEmpty())
+        return column < columnIndex.size() ? columnIndex[column] : -1;
+
+    if (column > values.size())
+        values.resize(column);
+    return column - 1;
+}
+
+/*!
+ * \internal
+ * Decodes the cells of the current <row> element and leaves the reader on
+ * its end element. Cells of columns that are not selected are skipped
+ * without being decoded.
+ */
+void SheetReaderPrivate::readRow()
+{
+    values.fill(QVariant());
+    currentLastColumn = 0;
+
+    int column = 0;
+    while (reader.readNextStartElement()) {
+        if (reader.name() != QLatin1String("c")) {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        const QXmlStreamAttributes attributes = reader.attributes();
+        const int ref                         = referenceColumn(attributes);
+        column                                = ref > 0 ? ref : column + 1;
+
+        const int index = valueIndex(column);
+        if (index < 0) {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        const QVariant value = readCell(attributes);
+        if (!value.isNull()) {
+            values[index]     = value;
+            currentLastColumn = qMax(currentLastColumn, column);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * Decodes the <c> element the reader is on, with the \a attributes of that
+ * element. Returns a null QVariant for cells without a value.
+ */
+QVariant SheetReaderPrivate::readCell(const QXmlStreamAttributes &attributes)
+{
+    const int xf =
+        attributes.hasAttribute(QLatin1String("s")) ? attributes.value(QLatin1String("s")).toInt() : -1;
+    const auto type = attributes.value(QLatin1String("t"));
+
+    QString text;
+    bool hasValue = false;
+    while (reader.readNextStartElement()) {
+        if (reader.name() == QLatin1String("v")) {
+            text     = reader.readElementText();
+            hasValue = true;
+        } else if (reader.name() == QLatin1String("is")) {
+            text     = readInlineString();
+            hasValue = true;
+        } else {
+            // <f> is not needed, only its cached value
+            reader.skipCurrentElement();
+        }
+    }
+    if (!hasValue)
+        return QVariant();
+
+    if (type == QLatin1String("s"))
+        return workbook->sharedStrings()->getSharedString(text.toInt()).toPlainString();
+    if (type == QLatin1String("b"))
+        return text.toInt() ? true : false;
+    if (type == QLatin1String("inlineStr") || type == QLatin1String("str") ||
+        type == QLatin1String("e"))
+        return text;
+    if (type == QLatin1String("d"))
+        return QDateTime::fromString(text, Qt::ISODate);
+
+    // Number or no type: same rule as Cell::isDateTime()
+    const double number = text.toDouble();
+    if (isDateTimeXf(xf) && number >= 0)
+        return datetimeFromNumber(number, workbook->isDate1904());
+    if (type == QLatin1String("n"))
+        return number;
+    return text;
+}
+
+/*!
+ * \internal
+ * Returns the plain text of the <is> element the reader is on, including
+ * the text of rich text runs.
+ */
+QString SheetReaderPrivate::readInlineString()
+{
+    QString text;
+    while (reader.readNextStartElement()) {
+        if (reader.name() == QLatin1String("t")) {
+            text += reader.readElementText();
+        } else if (reader.name() == QLatin1String("r")) {
+            while (reader.readNextStartElement()) {
+                if (reader.name() == QLatin1String("t"))
+                    text += reader.readElementText();
+                else
+                    reader.skipCurrentElement();
+            }
+        } else {
+            reader.skipCurrentElement();
+        }
+    }
+    return text;
+}
+
+bool SheetReaderPrivate::isDateTimeXf(int xf) const
+{
+    if (xf < 0)
+        return false;
+
+    if (xf >= xfDateTime.size())
+        xfDateTime.resize(xf + 1);
+    if (xfDateTime[xf] == 0) {
+        const Format format = workbook->styles()->xfFormat(xf);
+        xfDateTime[xf]      = (format.isValid() && format.isDateTimeFormat()) ? 2 : 1;
+    }
+    return xfDateTime[xf] == 2;
+}
+
+void SheetReaderPrivate::setError(const QString &message)
+{
+    errorString = message;
+}
+
+/*!
+  \class SheetReader
+  \inmodule QtXlsx
+  \brief Forward-only reader for the cell values of one worksheet.
+
+  Unlike Document, SheetReader does not build the cell table of a sheet.
+  The sheet part is decoded one row at a time with readNextRow(), and only
+  the cells of the columns given to setColumns() are decoded; the others
+  are skipped. Memory use does not grow with the number of cells read.
+
+  \code
+  SheetReader reader("data.xlsx");
+  reader.selectSheet(0);
+  reader.setColumns({1, 3});
+  while (reader.readNextRow())
+      qDebug() << reader.row() << reader.read(1) << reader.read(3);
+  \endcode
+
+  The workbook, its styles and its shared strings are loaded when the
+  reader is constructed.
+*/
+
+/*!
+ * Opens the xlsx file \a xlsxName. Use isLoaded() to check whether it
+ * could be read.
+ */
+SheetReader::SheetReader(const QString &xlsxName)
+    : d_ptr(new SheetReaderPrivate(this))
+{
+    Q_D(SheetReader);
+    d->zipReader.reset(new ZipReader(xlsxName));
+    d->isLoad = d->loadPackage();
+}
+
+/*!
+ * \overload
+ * Opens the xlsx package on \a device. The device must stay open while
+ * the reader is used.
+ */
+SheetReader::SheetReader(QIODevice *device)
+    : d_ptr(new SheetReaderPrivate(this))
+{
+    Q_D(SheetReader);
+    if (device && device->isReadable()) {
+        d->zipReader.reset(new ZipReader(device));
+        d->isLoad = d->loadPackage();
+    } else {
+        d->setError(QStringLiteral("device is not readable"));
+    }
+}
+
+SheetReader::~SheetReader()
+{
+    delete d_ptr;
+}
+
+/*!
+ * Returns true if the workbook was loaded.
+ */
+bool SheetReader::isLoaded() const
+{
+    Q_D(const SheetReader);
+    return d->isLoad;
+}
+
+/*!
+ * Returns the names of all sheets of the workbook, in workbook order.
+ */
+QStringList SheetReader::sheetNames() const
+{
+    Q_D(const SheetReader);
+    QStringList names;
+    if (!d->isLoad)
+        return names;
+    for (int i = 0; i < d->workbook->sheetCount(); ++i)
+        names.append(d->workbook->sheet(i)->sheetName());
+    return names;
+}
+
+/*!
+ * Starts reading the worksheet named \a name from its first row.
+ * Returns false if there is no such worksheet.
+ */
+bool SheetReader::selectSheet(const QString &name)
+{
+    return selectSheet(sheetNames().indexOf(name));
+}
+
+/*!
+ * \overload
+ * Starts reading the worksheet at \a index from its first row.
+ */
+bool SheetReader::selectSheet(int index)
+{
+    Q_D(SheetReader);
+    if (!d->isLoad || index < 0 || index >= d->workbook->sheetCount()) {
+        d->closeSheet();
+        d->setError(QStringLiteral("no such sheet"));
+        return false;
+    }
+    return d->openSheet(index);
+}
+
+/*!
+ * Restricts decoding to \a columns (1-based). An empty list, the default,
+ * decodes every column. Takes effect from the next readNextRow().
+ */
+void SheetReader::setColumns(const QList<int> &columns)
+{
+    Q_D(SheetReader);
+    d->columns.clear();
+    d->columnIndex.clear();
+    d->values.clear();
+
+    for (int column : columns) {
+        if (column < 1 || column > MaxColumn || d->columns.contains(column))
+            continue;
+        if (column >= d->columnIndex.size())
+            d->columnIndex.resize(column + 1);
+        d->columns.append(column);
+    }
+
+    d->columnIndex.fill(-1);
+    for (int i = 0; i < d->columns.size(); ++i)
+        d->columnIndex[d->columns[i]] = i;
+    d->values.resize(d->columns.size());
+}
+
+/*!
+ * Returns the selected columns, empty if every column is decoded.
+ */
+QList<int> SheetReader::columns() const
+{
+    Q_D(const SheetReader);
+    return d->columns;
+}
+
+/*!
+ * Advances to the next <row> of the selected sheet and decodes its
+ * selected cells. Rows are returned in file order, which is ascending row
+ * order; rows that are missing from the file are not returned.
+ *
+ * Returns false at the end of the sheet or on a parse error, see
+ * hasError().
+ */
+bool SheetReader::readNextRow()
+{
+    Q_D(SheetReader);
+    if (!d->inSheetData)
+        return false;
+
+    QXmlStreamReader &reader = d->reader;
+    while (!reader.atEnd()) {
+        const QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::StartElement && reader.name() == QLatin1String("row")) {
+            const QXmlStreamAttributes attributes = reader.attributes();
+            if (attributes.hasAttribute(QLatin1String("r")))
+                d->currentRow = attributes.value(QLatin1String("r")).toInt();
+            else
+                ++d->currentRow;
+
+            d->readRow();
+            if (!reader.hasError())
+                return true;
+            break;
+        }
+        if (token == QXmlStreamReader::EndElement && reader.name() == QLatin1String("sheetData"))
+            break;
+    }
+
+    if (reader.hasError())
+        d->setError(reader.errorString());
+    d->inSheetData = false;
+    d->values.fill(QVariant());
+    reader.clear(); // release the inflated sheet part
+    return false;
+}
+
+/*!
+ * Returns the 1-based number of the current row.
+ */
+int SheetReader::row() const
+{
+    Q_D(const SheetReader);
+    return d->currentRow;
+}
+
+/*!
+ * Returns the largest selected column of the current row that has a value,
+ * or 0 if it has none.
+ */
+int SheetReader::lastColumn() const
+{
+    Q_D(const SheetReader);
+    return d->currentLastColumn;
+}
+
+/*!
+ * Returns the value of \a column in the current row, decoded as
+ * Worksheet::read() does: shared and inline strings as QString, numbers
+ * as double, untyped numbers as their text, and numbers with a date/time
+ * format as QDateTime, QDate or QTime. Formula cells return their cached
+ * value rather than the formula.
+ *
+ * Returns a null QVariant for empty cells and columns that are not
+ * selected.
+ */
+QVariant SheetReader::read(int column) const
+{
+    Q_D(const SheetReader);
+    int index = -1;
+    if (d->columns.isEmpty())
+        index = column - 1;
+    else if (column > 0 && column < d->columnIndex.size())
+        index = d->columnIndex[column];
+
+    if (index < 0 || index >= d->values.size())
+        return QVariant();
+    return d->values[index];
+}
+
+/*!
+ * Returns true if loading the package, opening a sheet or reading a row
+ * failed.
+ */
+bool SheetReader::hasError() const
+{
+    Q_D(const SheetReader);
+    return !d->errorString.isEmpty();
+}
+
+/*!
+ * Returns a description of the last error.
+ */
+QString SheetReader::errorString() const
+{
+    Q_D(const SheetReader);
+    return d->errorString;
+}
+
+QT_END_NAMESPACE_XLSX
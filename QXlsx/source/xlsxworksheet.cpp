@@ -22,6 +22,7 @@
 #include "xlsxworkbook.h"
 #include "xlsxworksheet_p.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QBuffer>
@@ -30,6 +31,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QLocale>
 #include <QMap>
 #include <QMapIterator>
 #include <QPoint>
@@ -68,6 +70,166 @@ WorksheetPrivate::~WorksheetPrivate()
 {
 }
 
+static_assert(sizeof(CellTable::Slot) == 16, "CellTable::Slot should stay compact");
+
+int CellTable::Row::indexOf(int column) const
+{
+    if (slots.isEmpty())
+        return -1;
+
+    // Dense rows: the slot of a column is at its offset from the first column
+    const Slot *data = slots.constData();
+    const int offset = column - data[0].column;
+    if (offset < 0)
+        return -1;
+    if (offset < slots.size() && data[offset].column == column)
+        return offset;
+
+    const int i = lowerBound(column);
+    return (i < slots.size() && data[i].column == column) ? i : -1;
+}
+
+int CellTable::Row::lowerBound(int column) const
+{
+    auto it = std::lower_bound(slots.constBegin(),
+                               slots.constEnd(),
+                               column,
+                               [](const Slot &slot, int col) { return slot.column < col; });
+    return int(it - slots.constBegin());
+}
+
+QList<int> CellTable::sortedRows() const
+{
+    QList<int> keys = blocks.keys();
+    std::sort(keys.begin(), keys.end());
+
+    QList<int> rows;
+    for (int key : keys) {
+        const Block &block = *blocks.constFind(key);
+        for (int i = 0; i < BlockRows; ++i) {
+            if (!block.rows[i].isEmpty())
+                rows.append(key * BlockRows + i + 1);
+        }
+    }
+    return rows;
+}
+
+const CellTable::Row *CellTable::row(int row) const
+{
+    if (row < 1)
+        return nullptr;
+
+    auto it = blocks.constFind(blockOf(row));
+    if (it == blocks.constEnd())
+        return nullptr;
+
+    const Row &cells = it->rows[(row - 1) % BlockRows];
+    return cells.isEmpty() ? nullptr : &cells;
+}
+
+CellTable::Row CellTable::takeRow(int row)
+{
+    Row cells;
+    if (row < 1)
+        return cells;
+
+    auto it = blocks.find(blockOf(row));
+    if (it == blocks.end())
+        return cells;
+
+    Row &stored = it->rows[(row - 1) % BlockRows];
+    if (stored.isEmpty())
+        return cells;
+
+    std::swap(cells, stored);
+    if (--it->usedRows == 0)
+        blocks.erase(it);
+    return cells;
+}
+
+void CellTable::setRow(int row, const Row &cells)
+{
+    takeRow(row);
+    if (row < 1 || cells.isEmpty())
+        return;
+
+    Block &block                      = blocks[blockOf(row)];
+    block.rows[(row - 1) % BlockRows] = cells;
+    ++block.usedRows;
+    extendBounds(row, cells.slots.constFirst().column, cells.slots.constLast().column);
+}
+
+CellTable::Slot &CellTable::slotForWrite(int row, int column, Row **cells)
+{
+    Block &block = blocks[blockOf(row)];
+    Row &stored  = block.rows[(row - 1) % BlockRows];
+    if (stored.isEmpty())
+        ++block.usedRows;
+    extendBounds(row, column, column);
+    *cells = &stored;
+
+    // Cells are usually written left to right
+    int i = stored.slots.size();
+    if (i > 0 && stored.slots.constLast().column >= column) {
+        i = stored.lowerBound(column);
+        if (stored.slots.at(i).column == column) {
+            Slot &slot = stored.slots[i];
+            if (slot.kind == Slot::Object)
+                stored.objects[slot.index].reset();
+            return slot;
+        }
+    }
+
+    Slot slot;
+    slot.column = quint16(column);
+    stored.slots.insert(i, slot);
+    return stored.slots[i];
+}
+
+void CellTable::setSlot(int row, int column, const Slot &slot)
+{
+    Q_ASSERT(slot.kind != Slot::Object);
+    if (row < 1 || column < 1 || column > 0xffff)
+        return;
+
+    Row *cells;
+    Slot &stored  = slotForWrite(row, column, &cells);
+    stored        = slot;
+    stored.column = quint16(column);
+}
+
+void CellTable::setObject(int row, int column, const std::shared_ptr<Cell> &cell)
+{
+    if (row < 1 || column < 1 || column > 0xffff)
+        return;
+
+    Row *cells;
+    Slot &stored = slotForWrite(row, column, &cells);
+
+    // Reuse an index released by an overwritten object cell
+    int index = cells->objects.indexOf(std::shared_ptr<Cell>());
+    if (index < 0) {
+        index = cells->objects.size();
+        cells->objects.append(cell);
+    } else {
+        cells->objects[index] = cell;
+    }
+
+    stored        = Slot();
+    stored.column = quint16(column);
+    stored.kind   = Slot::Object;
+    stored.type   = quint8(cell->cellType());
+    stored.index  = index;
+}
+
+void CellTable::extendBounds(int row, int firstCol, int lastCol)
+{
+    firstRow    = firstRow < 0 ? row : qMin(firstRow, row);
+    lastRow     = qMax(lastRow, row);
+    firstColumn = firstColumn < 0 ? firstCol : qMin(firstColumn, firstCol);
+    lastColumn  = qMax(lastColumn, lastCol);
+}
+
 /*
   Calculate the "spans" attribute of the <row> tag. This is an
   XLSX optimisation and isn't strictly required. However, it
@@ -192,18 +354,25 @@ Worksheet *Worksheet::copy(const QString &distName, int distId) const
 
     sheet_d->dimension = d->dimension;
 
-    for (auto it = d->cellTable.cells.begin(); it != d->cellTable.cells.end(); ++it) {
-        int row = it.key();
-        for (auto it2 = it.value().begin(); it2 != it.value().end(); ++it2) {
-            int col = it2.key();
+    const auto rows = d->cellTable.sortedRows();
+    for (int row : rows) {
+        const CellTable::Row *cells = d->cellTable.row(row);
+        for (const CellTable::Slot &slot : cells->slots) {
+            if (slot.kind != CellTable::Slot::Object) {
+                if (slot.kind == CellTable::Slot::SharedString)
+                    d->workbook->sharedStrings()->incRefByStringIndex(slot.index);
+
+                sheet_d->cellTable.setSlot(row, slot.column, slot);
+                continue;
+            }
 
-            auto cell           = std::make_shared<Cell>(it2.value().get());
+            auto cell           = std::make_shared<Cell>(cells->objects.at(slot.index).get());
             cell->d_ptr->parent = sheet;
 
             if (cell->cellType() == Cell::SharedStringType)
                 d->workbook->sharedStrings()->addSharedString(cell->d_ptr->richString);
 
-            sheet_d->cellTable.setValue(row, col, cell);
+            sheet_d->cellTable.setObject(row, slot.column, cell);
         }
     }
 
@@ -516,10 +685,156 @@ QVariant Worksheet::read(int row, int column) const
 {
     Q_D(const Worksheet);
 
-    auto cell = cellAt(row, column);
-    if (!cell)
+    const CellTable::Row *cells = d->cellTable.row(row);
+    const CellTable::Slot *slot = cells ? cells->find(column) : nullptr;
+    if (!slot)
         return QVariant();
 
+    return d->slotValue(row, *cells, *slot);
+}
+
+/*!
+        Returns the contents of all cells in \a range as one row-major buffer of
+        range.rowCount() * range.columnCount() values; the value of cell
+        (row, column) is at index (row - firstRow) * columnCount + (column - firstColumn).
+        Each value is the same as read() would return; empty cells give a null QVariant.
+
+        Each row of the cell table is looked up once, instead of once per cell.
+ */
+QVector<QVariant> Worksheet::readRange(const CellRange &range) const
+{
+    Q_D(const Worksheet);
+
+    if (!range.isValid() || range.firstRow() < 1 || range.firstColumn() < 1)
+        return QVector<QVariant>();
+
+    const int firstColumn = range.firstColumn();
+    const int lastColumn  = range.lastColumn();
+    const int columnCount = range.columnCount();
+    QVector<QVariant> values(range.rowCount() * columnCount);
+
+    for (int row = range.firstRow(); row <= range.lastRow(); ++row) {
+        const CellTable::Row *cells = d->cellTable.row(row);
+        if (!cells)
+            continue;
+
+        // the slots of a row are sorted by column
+        QVariant *out = values.data() + (row - range.firstRow()) * columnCount;
+        for (int i = cells->lowerBound(firstColumn); i < cells->slots.size(); ++i) {
+            const CellTable::Slot &slot = cells->slots.at(i);
+            if (slot.column > lastColumn)
+                break;
+            out[slot.column - firstColumn] = d->slotValue(row, *cells, slot);
+        }
+    }
+
+    return values;
+}
+
+/*!
+        Writes the row-major \a values, \a columnCount values per row, starting at
+        cell (\a row, \a column). Every value is written as by write(), so null
+        values become blank cells.
+
+        Returns true if all values were written.
+ */
+bool Worksheet::writeRange(int row,
+                           int column,
+                           const QVector<QVariant> &values,
+                           int columnCount,
+                           const Format &format)
+{
+    if (columnCount <= 0 || values.size() % columnCount != 0)
+        return false;
+
+    bool ret = true;
+    for (int i = 0; i < values.size(); ++i) {
+        if (!write(row + i / columnCount, column + i % columnCount, values.at(i), format))
+            ret = false;
+    }
+    return ret;
+}
+
+/*!
+        Reorders the rows starting at \a firstRow: row (firstRow + i) receives the
+        former contents of row \a sourceRows[i]. \a sourceRows must be a permutation
+        of firstRow ... firstRow + sourceRows.size() - 1.
+
+        Whole rows of cells, comments and hyperlinks are moved; cells are not copied
+        or re-encoded, so values, formats and cached formula results are kept. Shared
+        formulas in the moved rows are converted to normal formulas first. Formula
+        references are not adjusted, as with reading and writing the cells back.
+
+        Returns false, without changing anything, if \a sourceRows is not a valid
+        permutation.
+ */
+bool Worksheet::permuteRows(int firstRow, const QVector<int> &sourceRows)
+{
+    Q_D(Worksheet);
+
+    const int count = sourceRows.size();
+    if (firstRow < 1 || firstRow + count - 1 > XLSX_ROW_MAX)
+        return false;
+
+    QVector<bool> used(count, false);
+    for (int source : sourceRows) {
+        const int index = source - firstRow;
+        if (index < 0 || index >= count || used[index])
+            return false;
+        used[index] = true;
+    }
+
+    QVector<CellTable::Row> rowCells(count);
+    QVector<QHash<int, QString>> rowComments(count);
+    QVector<QHash<int, std::shared_ptr<XlsxHyperlinkData>>> rowLinks(count);
+    for (int i = 0; i < count; ++i) {
+        const int row = firstRow + i;
+        rowCells[i]   = d->cellTable.takeRow(row);
+        d->detachSharedFormulas(row, rowCells[i]);
+        rowComments[i] = d->comments.take(row);
+        rowLinks[i]    = d->urlTable.take(row);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const int row   = firstRow + i;
+        const int index = sourceRows[i] - firstRow;
+        d->cellTable.setRow(row, rowCells[index]);
+        if (!rowComments[index].isEmpty())
+            d->comments.insert(row, rowComments[index]);
+        if (!rowLinks[index].isEmpty())
+            d->urlTable.insert(row, rowLinks[index]);
+    }
+
+    return true;
+}
+
+/*!
+ * Returns the cell at the given \a row_column. If there
+ * is no cell at the specified position, the function returns 0.
+ */
+std::shared_ptr<Cell> Worksheet::cellAt(const CellReference &row_column) const
+{
+    if (!row_column.isValid())
+        return {};
+
+    return cellAt(row_column.row(), row_column.column());
+}
+
+/*!
+ * Returns the cell at the given \a row and \a column. If there
+ * is no cell at the specified position, the function returns 0.
+ *
+ * Cells without formula or rich text are stored in a compact form, and a new
+ * Cell object is created for them on each call.
+ */
+std::shared_ptr<Cell> Worksheet::cellAt(int row, int col) const
+{
+    Q_D(const Worksheet);
+    return d->cellAt(row, col);
+}
+
+QVariant WorksheetPrivate::cellValue(int row, int col, const Cell *cell) const
+{
     if (cell->hasFormula()) {
         if (cell->formula().formulaType() == CellFormula::NormalType) {
             return QVariant(QLatin1String("=") + cell->formula().formulaText());
@@ -528,11 +843,11 @@ QVariant Worksheet::read(int row, int column) const
                 return QVariant(QLatin1String("=") + cell->formula().formulaText());
             } else {
                 int si                         = cell->formula().sharedIndex();
-                const CellFormula &rootFormula = d->sharedFormulaMap[si];
+                const CellFormula &rootFormula = sharedFormulaMap[si];
                 CellReference rootCellRef      = rootFormula.reference().topLeft();
                 QString rootFormulaText        = rootFormula.formulaText();
                 QString newFormulaText =
-                    convertSharedFormula(rootFormulaText, rootCellRef, CellReference(row, column));
+                    convertSharedFormula(rootFormulaText, rootCellRef, CellReference(row, col));
                 return QVariant(QLatin1String("=") + newFormulaText);
             }
         }
@@ -547,35 +862,245 @@ QVariant Worksheet::read(int row, int column) const
 }
 
 /*!
- * Returns the cell at the given \a row_column. If there
- * is no cell at the specified position, the function returns 0.
+ * \internal
+ * Replaces every shared-formula cell of \a cells (the cells of \a row) by a copy
+ * holding the equivalent normal formula, so the row can be moved without breaking
+ * the shared formula's anchor and range.
  */
-std::shared_ptr<Cell> Worksheet::cellAt(const CellReference &row_column) const
+void WorksheetPrivate::detachSharedFormulas(int row, CellTable::Row &cells) const
 {
-    if (!row_column.isValid())
+    for (const CellTable::Slot &slot : cells.slots) {
+        if (slot.kind != CellTable::Slot::Object)
+            continue;
+
+        const std::shared_ptr<Cell> &cell = cells.objects.at(slot.index);
+        if (!cell->hasFormula() || cell->formula().formulaType() != CellFormula::SharedType)
+            continue;
+
+        QString text = cellValue(row, slot.column, cell.get()).toString().mid(1);
+        auto copy    = std::make_shared<Cell>(cell.get());
+        copy->d_ptr->formula      = CellFormula(text);
+        cells.objects[slot.index] = copy;
+    }
+}
+
+Format WorksheetPrivate::cellFormat(int row, int col) const
+{
+    const CellTable::Row *cells = cellTable.row(row);
+    const CellTable::Slot *slot = cells ? cells->find(col) : nullptr;
+    if (!slot)
         return {};
 
-    return cellAt(row_column.row(), row_column.column());
+    if (slot->kind == CellTable::Slot::Object)
+        return cells->objects.at(slot->index)->format();
+    return xfFormat(slot->xf);
 }
 
 /*!
- * Returns the cell at the given \a row and \a column. If there
- * is no cell at the specified position, the function returns 0.
+ * \internal
+ * Returns the cell at (\a row, \a col), or nullptr. Cells stored as compact slots
+ * are returned as a new Cell object; changes to it must be stored back with setCell().
  */
-std::shared_ptr<Cell> Worksheet::cellAt(int row, int col) const
+std::shared_ptr<Cell> WorksheetPrivate::cellAt(int row, int col) const
 {
-    Q_D(const Worksheet);
-    return d->cellTable.cellAt(row, col);
+    const CellTable::Row *cells = cellTable.row(row);
+    const CellTable::Slot *slot = cells ? cells->find(col) : nullptr;
+    return slot ? slotCell(*cells, *slot) : std::shared_ptr<Cell>();
 }
 
-Format WorksheetPrivate::cellFormat(int row, int col) const
+/*!
+ * \internal
+ * Stores \a cell at (\a row, \a col), as a compact slot when it has no formula or
+ * rich text and its value fits in one.
+ */
+void WorksheetPrivate::setCell(int row, int col, const std::shared_ptr<Cell> &cell)
 {
-    auto cell = cellTable.cellAt(row, col);
-    if (cell) {
-        return cell->format();
+    const CellPrivate *cd = cell->d_ptr;
+    CellTable::Slot slot;
+    if (cd->parent == q_func() && !cd->formula.isValid() && !cd->richString.isRichString() &&
+        compactSlot(cd->cellType, cd->value, cd->format, cd->styleNumber, -1, &slot)) {
+        cellTable.setSlot(row, col, slot);
+    } else {
+        cellTable.setObject(row, col, cell);
     }
+}
+
+/*!
+ * \internal
+ * Stores a cell without formula or rich text at (\a row, \a col) as a compact slot.
+ * \a sharedIndex is the shared string index of a SharedStringType cell, if known.
+ * Returns false, without storing anything, if the cell needs a Cell object.
+ */
+bool WorksheetPrivate::setCompactCell(int row,
+                                      int col,
+                                      Cell::CellType type,
+                                      const QVariant &value,
+                                      const Format &format,
+                                      int sharedIndex)
+{
+    CellTable::Slot slot;
+    if (!compactSlot(type, value, format, -1, sharedIndex, &slot))
+        return false;
+
+    cellTable.setSlot(row, col, slot);
+    return true;
+}
+
+/*!
+ * \internal
+ * Encodes a cell of \a type holding \a value as a compact slot. The format must be
+ * empty or registered in the workbook styles; \a styleNumber is the "s" attribute
+ * of a loaded cell, or -1.
+ */
+bool WorksheetPrivate::compactSlot(Cell::CellType type,
+                                   const QVariant &value,
+                                   const Format &format,
+                                   qint32 styleNumber,
+                                   int sharedIndex,
+                                   CellTable::Slot *slot) const
+{
+    qint32 xf = -1;
+    if (!format.isEmpty()) {
+        xf = styleNumber >= 0 ? styleNumber : format.xfIndex();
+        if (xf < 0 || workbook->styles()->xfFormat(xf) != format)
+            return false;
+    } else if (styleNumber >= 0) {
+        return false;
+    }
+
+    CellTable::Slot s;
+    s.xf   = xf;
+    s.type = quint8(type | (styleNumber >= 0 ? CellTable::Slot::FileStyle : 0));
+
+    switch (type) {
+    case Cell::NumberType:
+    case Cell::DateType:
+        if (!value.isValid())
+            break;
+        if (value.userType() != QMetaType::Double)
+            return false;
+        s.kind   = CellTable::Slot::Number;
+        s.number = value.toDouble();
+        break;
+    case Cell::CustomType: {
+        // Untyped cells hold the number text as loaded; keep only texts that convert back exactly
+        if (!value.isValid())
+            break;
+        if (value.userType() != QMetaType::QString)
+            return false;
+        const QString text = value.toString();
+        bool ok            = false;
+        const double d     = text.toDouble(&ok);
+        if (!ok || QString::number(d, 'g', QLocale::FloatingPointShortest) != text)
+            return false;
+        s.kind   = CellTable::Slot::Number;
+        s.number = d;
+        break;
+    }
+    case Cell::BooleanType:
+        if (value.userType() != QMetaType::Bool)
+            return false;
+        s.kind    = CellTable::Slot::Boolean;
+        s.boolean = value.toBool();
+        break;
+    case Cell::SharedStringType:
+        if (value.userType() != QMetaType::QString)
+            return false;
+        if (sharedIndex < 0)
+            sharedIndex = sharedStrings()->getSharedStringIndex(value.toString());
+        if (sharedIndex < 0)
+            return false;
+        s.kind  = CellTable::Slot::SharedString;
+        s.index = sharedIndex;
+        break;
+    default:
+        return false;
+    }
+
+    *slot = s;
+    return true;
+}
+
+/*!
+ * \internal
+ * Returns the value a Cell object would hold for \a slot (Cell::value()).
+ */
+QVariant WorksheetPrivate::slotRawValue(const CellTable::Slot &slot) const
+{
+    switch (slot.kind) {
+    case CellTable::Slot::Number:
+        if (slot.cellType() == Cell::CustomType)
+            return QString::number(slot.number, 'g', QLocale::FloatingPointShortest);
+        return slot.number;
+    case CellTable::Slot::Boolean:
+        return slot.boolean;
+    case CellTable::Slot::SharedString:
+        return sharedStrings()->getSharedString(slot.index).toPlainString();
+    default:
+        return QVariant();
+    }
+}
+
+/*!
+ * \internal
+ * Returns the contents of the cell in \a slot of \a row, as Worksheet::read() does,
+ * without creating a Cell object for compact slots.
+ */
+QVariant WorksheetPrivate::slotValue(int row,
+                                     const CellTable::Row &cells,
+                                     const CellTable::Slot &slot) const
+{
+    if (slot.kind == CellTable::Slot::Object)
+        return cellValue(row, slot.column, cells.objects.at(slot.index).get());
+
+    // Same rule as Cell::isDateTime()
+    const Cell::CellType type = slot.cellType();
+    if ((type == Cell::NumberType || type == Cell::DateType || type == Cell::CustomType) &&
+        isDateTimeXf(slot.xf)) {
+        const double value = slot.kind == CellTable::Slot::Number ? slot.number : 0.0;
+        if (value >= 0)
+            return datetimeFromNumber(value, workbook->isDate1904());
+    }
+
+    return slotRawValue(slot);
+}
+
+/*!
+ * \internal
+ * Returns the Cell object of \a slot, creating one for compact slots.
+ */
+std::shared_ptr<Cell> WorksheetPrivate::slotCell(const CellTable::Row &cells,
+                                                 const CellTable::Slot &slot) const
+{
+    if (slot.kind == CellTable::Slot::Object)
+        return cells.objects.at(slot.index);
 
-    return {};
+    const qint32 styleNumber = (slot.type & CellTable::Slot::FileStyle) ? slot.xf : -1;
+    return std::make_shared<Cell>(slotRawValue(slot),
+                                  slot.cellType(),
+                                  xfFormat(slot.xf),
+                                  const_cast<Worksheet *>(q_func()),
+                                  styleNumber);
+}
+
+Format WorksheetPrivate::xfFormat(int xf) const
+{
+    return xf < 0 ? Format() : workbook->styles()->xfFormat(xf);
+}
+
+bool WorksheetPrivate::isDateTimeXf(int xf) const
+{
+    if (xf < 0)
+        return false;
+
+    // xf indexes are never reused, so the answer can be cached
+    if (xf >= xfDateTime.size())
+        xfDateTime.resize(xf + 1);
+    if (xfDateTime[xf] == 0) {
+        const Format format = workbook->styles()->xfFormat(xf);
+        xfDateTime[xf]      = (format.isValid() && format.isDateTimeFormat()) ? 2 : 1;
+    }
+    return xfDateTime[xf] == 2;
 }
 
 /*!
@@ -610,14 +1135,19 @@ bool Worksheet::writeString(int row, int column, const RichString &value, const
     //        error = -2;
     //    }
 
-    d->sharedStrings()->addSharedString(value);
+    const int sharedIndex = d->sharedStrings()->addSharedString(value);
     Format fmt = format.isValid() ? format : d->cellFormat(row, column);
     if (value.fragmentCount() == 1 && value.fragmentFormat(0).isValid())
         fmt.mergeFormat(value.fragmentFormat(0));
     d->workbook->styles()->addXfFormat(fmt);
+    if (!value.isRichString() &&
+        d->setCompactCell(
+            row, column, Cell::SharedStringType, value.toPlainString(), fmt, sharedIndex))
+        return true;
+
     auto cell = std::make_shared<Cell>(value.toPlainString(), Cell::SharedStringType, fmt, this);
     cell->d_ptr->richString = value;
-    d->cellTable.setValue(row, column, cell);
+    d->setCell(row, column, cell);
     return true;
 }
 
@@ -690,7 +1220,7 @@ bool Worksheet::writeInlineString(int row, int column, const QString &value, con
     Format fmt = format.isValid() ? format : d->cellFormat(row, column);
     d->workbook->styles()->addXfFormat(fmt);
     auto cell = std::make_shared<Cell>(value, Cell::InlineStringType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    d->setCell(row, column, cell);
 
     return true;
 }
@@ -720,8 +1250,8 @@ bool Worksheet::writeNumeric(int row, int column, double value, const Format &fo
 
     Format fmt = format.isValid() ? format : d->cellFormat(row, column);
     d->workbook->styles()->addXfFormat(fmt);
-    auto cell = std::make_shared<Cell>(value, Cell::NumberType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    if (!d->setCompactCell(row, column, Cell::NumberType, value, fmt))
+        d->setCell(row, column, std::make_shared<Cell>(value, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -774,7 +1304,7 @@ bool Worksheet::writeFormula(int row,
 
     auto data            = std::make_shared<Cell>(result, Cell::NumberType, fmt, this);
     data->d_ptr->formula = formula;
-    d->cellTable.setValue(row, column, data);
+    d->setCell(row, column, data);
 
     CellRange range = formula.reference();
     if (formula.formulaType() == CellFormula::SharedType) {
@@ -785,10 +1315,11 @@ bool Worksheet::writeFormula(int row,
                 if (!(r == row && c == column)) {
                     if (auto cell = cellAt(r, c)) {
                         cell->d_ptr->formula = sf;
+                        d->setCell(r, c, cell);
                     } else {
                         auto newCell = std::make_shared<Cell>(result, Cell::NumberType, fmt, this);
                         newCell->d_ptr->formula = sf;
-                        d->cellTable.setValue(row, column, newCell);
+                        d->setCell(row, column, newCell);
                     }
                 }
             }
@@ -825,8 +1356,8 @@ bool Worksheet::writeBlank(int row, int column, const Format &format)
     d->workbook->styles()->addXfFormat(fmt);
 
     // Note: NumberType with an invalid QVariant value means blank.
-    auto cell = std::make_shared<Cell>(QVariant{}, Cell::NumberType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    if (!d->setCompactCell(row, column, Cell::NumberType, QVariant{}, fmt))
+        d->setCell(row, column, std::make_shared<Cell>(QVariant{}, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -855,8 +1386,8 @@ bool Worksheet::writeBool(int row, int column, bool value, const Format &format)
 
     Format fmt = format.isValid() ? format : d->cellFormat(row, column);
     d->workbook->styles()->addXfFormat(fmt);
-    auto cell = std::make_shared<Cell>(value, Cell::BooleanType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    if (!d->setCompactCell(row, column, Cell::BooleanType, value, fmt))
+        d->setCell(row, column, std::make_shared<Cell>(value, Cell::BooleanType, fmt, this));
 
     return true;
 }
@@ -892,8 +1423,8 @@ bool Worksheet::writeDateTime(int row, int column, const QDateTime &dt, const Fo
 
     double value = datetimeToNumber(dt, d->workbook->isDate1904());
 
-    auto cell = std::make_shared<Cell>(value, Cell::NumberType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    if (!d->setCompactCell(row, column, Cell::NumberType, value, fmt))
+        d->setCell(row, column, std::make_shared<Cell>(value, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -923,8 +1454,8 @@ bool Worksheet::writeDate(int row, int column, const QDate &dt, const Format &fo
 
     double value = datetimeToNumber(QDateTime(dt, QTime(0, 0, 0)), d->workbook->isDate1904());
 
-    auto cell = std::make_shared<Cell>(value, Cell::NumberType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    if (!d->setCompactCell(row, column, Cell::NumberType, value, fmt))
+        d->setCell(row, column, std::make_shared<Cell>(value, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -957,8 +1488,9 @@ bool Worksheet::writeTime(int row, int column, const QTime &t, const Format &for
         fmt.setNumberFormat(QStringLiteral("hh:mm:ss"));
     d->workbook->styles()->addXfFormat(fmt);
 
-    auto cell = std::make_shared<Cell>(timeToNumber(t), Cell::NumberType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    const double value = timeToNumber(t);
+    if (!d->setCompactCell(row, column, Cell::NumberType, value, fmt))
+        d->setCell(row, column, std::make_shared<Cell>(value, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -1034,7 +1566,7 @@ bool Worksheet::writeHyperlink(int row,
     // Write the hyperlink string as normal string.
     d->sharedStrings()->addSharedString(displayString);
     auto cell = std::make_shared<Cell>(displayString, Cell::SharedStringType, fmt, this);
-    d->cellTable.setValue(row, column, cell);
+    d->setCell(row, column, cell);
 
     // Store the hyperlink data in a separate table
     d->urlTable[row][column] = std::make_shared<XlsxHyperlinkData>(
@@ -1224,8 +1756,10 @@ bool Worksheet::mergeCells(const CellRange &range, const Format &format)
             if (row == range.firstRow() && col == range.firstColumn()) {
                 auto cell = cellAt(row, col);
                 if (cell) {
-                    if (format.isValid())
+                    if (format.isValid()) {
                         cell->d_ptr->format = format;
+                        d->setCell(row, col, cell);
+                    }
                 } else {
                     writeBlank(row, col, format);
                 }
@@ -1486,9 +2020,9 @@ void WorksheetPrivate::saveXmlSheetData(QXmlStreamWriter &writer) const
     calculateSpans();
 
     for (int row_num = dimension.firstRow(); row_num <= dimension.lastRow(); row_num++) {
-        auto ctIt = cellTable.cells.constFind(row_num);
-        auto riIt = rowsInfo.constFind(row_num);
-        if (ctIt == cellTable.cells.constEnd() && riIt == rowsInfo.constEnd() &&
+        const CellTable::Row *cells = cellTable.row(row_num);
+        auto riIt                   = rowsInfo.constFind(row_num);
+        if (!cells && riIt == rowsInfo.constEnd() &&
             !comments.contains(row_num)) {
             // Only process rows with cell data / comments / formatting
             continue;
@@ -1533,13 +2067,15 @@ void WorksheetPrivate::saveXmlSheetData(QXmlStreamWriter &writer) const
         }
 
         // Write cell data if row contains filled cells
-        if (ctIt != cellTable.cells.constEnd()) {
-            for (int col_num = dimension.firstColumn(); col_num <= dimension.lastColumn();
-                 col_num++) {
-                auto cellIt = ctIt->find(col_num);
-                if (cellIt != ctIt->end()) {
-                    saveXmlCellData(writer, row_num, col_num, *cellIt);
-                }
+        if (cells) {
+            for (int i = cells->lowerBound(dimension.firstColumn()); i < cells->slots.size(); ++i) {
+                const CellTable::Slot &slot = cells->slots.at(i);
+                if (slot.column > dimension.lastColumn())
+                    break;
+                if (slot.kind == CellTable::Slot::Object)
+                    saveXmlCellData(writer, row_num, slot.column, cells->objects.at(slot.index));
+                else
+                    saveXmlSlotData(writer, row_num, slot);
             }
         }
         writer.writeEndElement(); // row
@@ -1559,21 +2095,7 @@ void WorksheetPrivate::saveXmlCellData(QXmlStreamWriter &writer,
     writer.writeStartElement(QStringLiteral("c"));
     writer.writeAttribute(QStringLiteral("r"), cell_pos);
 
-    // Style used by the cell, row or col
-    if (!cell->format().isEmpty()) {
-        writer.writeAttribute(QStringLiteral("s"), QString::number(cell->format().xfIndex()));
-    } else {
-        auto rIt = rowsInfo.constFind(row);
-        if (rIt != rowsInfo.constEnd() && !(*rIt)->format.isEmpty()) {
-            writer.writeAttribute(QStringLiteral("s"), QString::number((*rIt)->format.xfIndex()));
-        } else {
-            auto cIt = colsInfoHelper.constFind(col);
-            if (cIt != colsInfoHelper.constEnd() && !(*cIt)->format.isEmpty()) {
-                writer.writeAttribute(QStringLiteral("s"),
-                                      QString::number((*cIt)->format.xfIndex()));
-            }
-        }
-    }
+    saveXmlCellStyle(writer, row, col, cell->format().isEmpty() ? -1 : cell->format().xfIndex());
 
     if (cell->cellType() == Cell::SharedStringType) // 's'
     {
@@ -1679,6 +2201,66 @@ void WorksheetPrivate::saveXmlCellData(QXmlStreamWriter &writer,
     writer.writeEndElement(); // c
 }
 
+/*
+ * Style used by the cell (xf index \a xf, -1 if none), row or col
+ */
+void WorksheetPrivate::saveXmlCellStyle(QXmlStreamWriter &writer, int row, int col, int xf) const
+{
+    if (xf >= 0) {
+        writer.writeAttribute(QStringLiteral("s"), QString::number(xf));
+    } else {
+        auto rIt = rowsInfo.constFind(row);
+        if (rIt != rowsInfo.constEnd() && !(*rIt)->format.isEmpty()) {
+            writer.writeAttribute(QStringLiteral("s"), QString::number((*rIt)->format.xfIndex()));
+        } else {
+            auto cIt = colsInfoHelper.constFind(col);
+            if (cIt != colsInfoHelper.constEnd() && !(*cIt)->format.isEmpty()) {
+                writer.writeAttribute(QStringLiteral("s"),
+                                      QString::number((*cIt)->format.xfIndex()));
+            }
+        }
+    }
+}
+
+/*
+ * Same output as saveXmlCellData() for the Cell object of a compact slot
+ */
+void WorksheetPrivate::saveXmlSlotData(QXmlStreamWriter &writer,
+                                       int row,
+                                       const CellTable::Slot &slot) const
+{
+    writer.writeStartElement(QStringLiteral("c"));
+    writer.writeAttribute(QStringLiteral("r"), CellReference(row, slot.column).toString());
+    saveXmlCellStyle(writer, row, slot.column, slot.xf);
+
+    switch (slot.cellType()) {
+    case Cell::SharedStringType:
+        writer.writeAttribute(QStringLiteral("t"), QStringLiteral("s"));
+        writer.writeTextElement(QStringLiteral("v"), QString::number(slot.index));
+        break;
+    case Cell::NumberType:
+        writer.writeAttribute(QStringLiteral("t"), QStringLiteral("n"));
+        if (slot.kind == CellTable::Slot::Number)
+            writer.writeTextElement(QStringLiteral("v"), QString::number(slot.number, 'g', 15));
+        break;
+    case Cell::BooleanType:
+        writer.writeAttribute(QStringLiteral("t"), QStringLiteral("b"));
+        writer.writeTextElement(QStringLiteral("v"),
+                                slot.boolean ? QStringLiteral("1") : QStringLiteral("0"));
+        break;
+    case Cell::DateType:
+        writer.writeAttribute(QStringLiteral("t"), QStringLiteral("n"));
+        writer.writeTextElement(QStringLiteral("v"), slotRawValue(slot).toString());
+        break;
+    default: // Cell::CustomType
+        if (slot.kind == CellTable::Slot::Number)
+            writer.writeTextElement(QStringLiteral("v"), QString::number(slot.number, 'g', 15));
+        break;
+    }
+
+    writer.writeEndElement(); // c
+}
+
 void WorksheetPrivate::saveXmlMergeCells(QXmlStreamWriter &writer) const
 {
     if (merges.isEmpty())
@@ -2364,15 +2946,16 @@ void WorksheetPrivate::loadXmlSheetData(QXmlStreamReader &reader)
                     cellType = Cell::DateType;
                 }
 
-                // create a heap of new cell
-                auto cell = std::make_shared<Cell>(QVariant{}, cellType, format, q, styleIndex);
+                QVariant value;
+                CellFormula formula;
+                RichString richString;
+                int sharedIndex = -1;
 
                 while (!reader.atEnd() && !(reader.name() == QLatin1String("c") &&
                                             reader.tokenType() == QXmlStreamReader::EndElement)) {
                     if (reader.readNextStartElement()) {
                         if (reader.name() == QLatin1String("f")) // formula
                         {
-                            CellFormula &formula = cell->d_func()->formula;
                             formula.loadFromXml(reader);
                             if (formula.formulaType() == CellFormula::SharedType &&
                                 !formula.formulaText().isEmpty()) {
@@ -2381,32 +2964,33 @@ void WorksheetPrivate::loadXmlSheetData(QXmlStreamReader &reader)
                             }
                         } else if (reader.name() == QLatin1String("v")) // Value
                         {
-                            QString value = reader.readElementText();
+                            QString text = reader.readElementText();
                             if (cellType == Cell::SharedStringType) {
-                                int sst_idx = value.toInt();
+                                int sst_idx = text.toInt();
                                 sharedStrings()->incRefByStringIndex(sst_idx);
                                 RichString rs          = sharedStrings()->getSharedString(sst_idx);
                                 QString strPlainString = rs.toPlainString();
-                                cell->d_func()->value  = strPlainString;
+                                value                  = strPlainString;
+                                sharedIndex            = sst_idx;
                                 if (rs.isRichString())
-                                    cell->d_func()->richString = rs;
+                                    richString = rs;
                             } else if (cellType == Cell::NumberType) {
-                                cell->d_func()->value = value.toDouble();
+                                value = text.toDouble();
                             } else if (cellType == Cell::BooleanType) {
-                                cell->d_func()->value = value.toInt() ? true : false;
+                                value = text.toInt() ? true : false;
                             } else if (cellType == Cell::DateType) {
                                 // [dev54] DateType
 
-                                double dValue    = value.toDouble(); // days from 1900(or 1904)
+                                double dValue    = text.toDouble(); // days from 1900(or 1904)
                                 bool bIsDate1904 = q->workbook()->isDate1904();
 
                                 QVariant vDatetimeValue = datetimeFromNumber(dValue, bIsDate1904);
                                 Q_UNUSED(vDatetimeValue);
-                                // cell->d_func()->value = vDatetimeValue;
-                                cell->d_func()->value = dValue; // dev67
+                                // value = vDatetimeValue;
+                                value = dValue; // dev67
                             } else {
                                 // ELSE type
-                                cell->d_func()->value = value;
+                                value = text;
                             }
 
                         } else if (reader.name() == QLatin1String("is")) {
@@ -2416,7 +3000,7 @@ void WorksheetPrivate::loadXmlSheetData(QXmlStreamReader &reader)
                                 if (reader.readNextStartElement()) {
                                     //: Todo, add rich text read support
                                     if (reader.name() == QLatin1String("t")) {
-                                        cell->d_func()->value = reader.readElementText();
+                                        value = reader.readElementText();
                                     }
                                 }
                             }
@@ -2431,7 +3015,18 @@ void WorksheetPrivate::loadXmlSheetData(QXmlStreamReader &reader)
                     }
                 }
 
-                cellTable.setValue(pos.row(), pos.column(), cell);
+                // Plain values are kept as compact slots, without a Cell object
+                CellTable::Slot slot;
+                if (!formula.isValid() && !richString.isRichString() &&
+                    compactSlot(cellType, value, format, styleIndex, sharedIndex, &slot)) {
+                    cellTable.setSlot(pos.row(), pos.column(), slot);
+                } else {
+                    // create a heap of new cell
+                    auto cell = std::make_shared<Cell>(value, cellType, format, q, styleIndex);
+                    cell->d_func()->formula    = formula;
+                    cell->d_func()->richString = richString;
+                    cellTable.setObject(pos.row(), pos.column(), cell);
+                }
             }
         }
     }
@@ -2849,12 +3444,14 @@ QVector<CellLocation> Worksheet::getFullCells(int *maxRow, int *maxCol) const
 
     const auto sortedRows = d->cellTable.sortedRows();
     for (const auto row : sortedRows) {
-        const auto &columns      = d->cellTable.cells[row];
-        const auto columnsSorted = CellTable::sorteIntList(columns.keys());
-        for (const auto &col : columnsSorted) {
-            // It's faster to iterate but cellTable is unordered which might not
-            // be what callers want?
-            auto cell = std::make_shared<Cell>(columns.value(col).get());
+        const CellTable::Row *cells = d->cellTable.row(row);
+        for (const CellTable::Slot &slot : cells->slots) {
+            // The slots of a row are sorted by column
+            std::shared_ptr<Cell> cell;
+            if (slot.kind == CellTable::Slot::Object)
+                cell = std::make_shared<Cell>(cells->objects.at(slot.index).get());
+            else
+                cell = d->slotCell(*cells, slot);
 
             CellLocation cl;
 
@@ -2863,9 +3460,9 @@ QVector<CellLocation> Worksheet::getFullCells(int *maxRow, int *maxCol) const
                 (*maxRow) = row;
             }
 
-            cl.col = col;
-            if (col > (*maxCol)) {
-                (*maxCol) = col;
+            cl.col = slot.column;
+            if (slot.column > (*maxCol)) {
+                (*maxCol) = slot.column;
             }
 
             cl.cell = cell;
@@ -1,85 +1,72 @@
 #include "BlackbodyController.h"
-#include <QModbusRtuSerialMaster>
 #include <QVariant>
 #include <QDebug>
+#include "modbusbusmanager.h"
+#include "modbustransactionscheduler.h"
 
 BlackbodyController::BlackbodyController(QObject *parent) : QObject(parent), m_slaveAddress(0x02), m_connected(false)
 {
-    m_modbusDevice = new QModbusRtuSerialMaster(this);
-
-    // 连接状态信号
-    connect(m_modbusDevice, &QModbusClient::stateChanged, this, [this](QModbusDevice::State state) {
-        bool connected = (state == QModbusDevice::ConnectedState);
-        m_connected = connected;
-        emit connectionStatusChanged(connected);
-    });
-
-    // 错误处理
-    connect(m_modbusDevice, &QModbusDevice::errorOccurred, this, [this](QModbusDevice::Error error) {
-        if (error == QModbusDevice::ConnectionError && m_connected) {
-            m_connected = false;
-            emit connectionStatusChanged(false);
-        }
-    });
 }
 
 BlackbodyController::~BlackbodyController()
 {
-    if (m_modbusDevice && m_modbusDevice->state() == QModbusDevice::ConnectedState) {
-        m_modbusDevice->disconnectDevice();
+    if (m_bus) {
+        m_bus->scheduler()->removePoll(m_pollId);
+        ModbusBusManager::instance()->release(m_bus);
+        m_bus = nullptr;
     }
-    delete m_modbusDevice;
 }
 
 bool BlackbodyController::connectDevice(const QString &portName)
 {
-    if (m_connected) {
+    // 以是否持有总线为准：总线掉线后 m_connected 为 false，但引用和轮询仍在，重连前必须先释放
+    if (m_bus) {
         disconnectDevice();
     }
 
     m_portName = portName;
 
-    // 配置端口参数
-    m_modbusDevice->setConnectionParameter(
-        QModbusDevice::SerialPortNameParameter,
-        m_portName
-        );
-    m_modbusDevice->setConnectionParameter(
-        QModbusDevice::SerialBaudRateParameter,
-        QVariant(9600)
-        );
-    m_modbusDevice->setConnectionParameter(
-        QModbusDevice::SerialDataBitsParameter,
-        QVariant(8)  // 固定数据位
-        );
-    m_modbusDevice->setConnectionParameter(
-        QModbusDevice::SerialParityParameter,
-        QVariant(QSerialPort::NoParity)  // 固定无校验
-        );
-    m_modbusDevice->setConnectionParameter(
-        QModbusDevice::SerialStopBitsParameter,
-        QVariant(QSerialPort::OneStop)  // 固定停止位
-        );
-
-    if (m_modbusDevice->connectDevice()) {
-        m_connected = true;
-        emit connectionStatusChanged(true); // 关键：成功连接时发出信号
-        return true;
-    } else {
+    QString error;
+    m_bus = ModbusBusManager::instance()->acquire(portName, &error);
+    if (!m_bus) {
+        qDebug() << "黑体炉连接失败:" << portName << error;
         m_connected = false;
         emit connectionStatusChanged(false);
         return false;
     }
+
+    // 总线断开时同步连接状态
+    connect(m_bus, &ModbusBus::connectionStatusChanged, this, [this](bool connected) {
+        if (m_connected == connected) return;
+        m_connected = connected;
+        emit connectionStatusChanged(connected);
+    });
+
+    // 所有读写经由总线调度器：写优先、限制在途请求、周期轮询
+    m_pollId = m_bus->scheduler()->addPoll(m_slaveAddress, 0x000C, 2, [this](bool ok, const QModbusDataUnit &unit) {
+        if (ok) updateTemperature(unit);
+    });
+    m_bus->scheduler()->setPollEnabled(m_pollId, m_pollingEnabled);
+    m_bus->scheduler()->setPollProfile(m_pollId, m_pollProfile);
+
+    m_connected = true;
+    emit connectionStatusChanged(true); // 关键：成功连接时发出信号
+    return true;
 }
 
 void BlackbodyController::disconnectDevice()
 {
-    if (m_modbusDevice->state() == QModbusDevice::ConnectedState) {
-        m_modbusDevice->disconnectDevice();
-        m_connected = false;
-        emit connectionStatusChanged(false);
-        qDebug() << "已断开端口连接:" << m_portName;
-    }
+    if (!m_bus) return;
+
+    m_bus->scheduler()->removePoll(m_pollId);
+    m_pollId = -1;
+    disconnect(m_bus, nullptr, this, nullptr);
+    ModbusBusManager::instance()->release(m_bus);
+    m_bus = nullptr;
+
+    m_connected = false;
+    emit connectionStatusChanged(false);
+    qDebug() << "已断开端口连接:" << m_portName;
 }
 
 bool BlackbodyController::isConnected() const
@@ -87,29 +74,74 @@ bool BlackbodyController::isConnected() const
     return m_connected;
 }
 
+ModbusTransactionScheduler *BlackbodyController::scheduler() const
+{
+    return m_bus ? m_bus->scheduler() : nullptr;
+}
+
+ModbusLinkStats BlackbodyController::linkStats() const
+{
+    return m_bus ? m_bus->scheduler()->stats(m_slaveAddress) : ModbusLinkStats();
+}
+
+qint64 BlackbodyController::temperatureAgeMs() const
+{
+    return m_temperatureAge.isValid() ? m_temperatureAge.elapsed() : -1;
+}
+
+QString BlackbodyController::busDescription() const
+{
+    return QString("%1 / 0x%2").arg(m_bus ? m_bus->portName() : QString("未连接"))
+        .arg(m_slaveAddress, 2, 16, QChar('0'));
+}
+
+QString BlackbodyController::busErrorString() const
+{
+    return m_bus ? m_bus->errorString() : tr("总线已断开");
+}
+
 void BlackbodyController::readCurrentTemperature()
 {
-    if (auto *reply = m_modbusDevice->sendReadRequest(
-            QModbusDataUnit(QModbusDataUnit::HoldingRegisters, 0x000C, 2), m_slaveAddress))
-    {
-        connect(reply, &QModbusReply::finished, this, [this, reply]() {
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                if (unit.valueCount() == 2) {
-                    quint32 tempData = (unit.value(0) << 16) | unit.value(1);
-                    float temperature;
-                    memcpy(&temperature, &tempData, sizeof(float));
-                    m_currentTemperature = temperature;
-                    emit currentTemperatureUpdated(temperature);
-                }
-            }
-            reply->deleteLater();
-        });
+    if (!m_bus) return;
+    m_bus->scheduler()->read(m_slaveAddress, 0x000C, 2, [this](bool ok, const QModbusDataUnit &unit) {
+        if (ok) {
+            updateTemperature(unit);
+        } else {
+            qDebug() << "黑体炉温度读取失败:" << busErrorString();
+        }
+    }, ModbusTransactionScheduler::ReadPriority, this);
+}
+
+void BlackbodyController::updateTemperature(const QModbusDataUnit &unit)
+{
+    if (unit.valueCount() == 2) {
+        quint32 tempData = (unit.value(0) << 16) | unit.value(1);
+        float temperature;
+        memcpy(&temperature, &tempData, sizeof(float));
+        m_currentTemperature = temperature;
+        m_temperatureAge.start();
+        emit currentTemperatureUpdated(temperature);
     }
 }
 
+void BlackbodyController::setPollingEnabled(bool enabled)
+{
+    m_pollingEnabled = enabled;
+    if (m_bus) m_bus->scheduler()->setPollEnabled(m_pollId, enabled);
+}
+
+void BlackbodyController::setPollProfile(ModbusTransactionScheduler::PollProfile profile)
+{
+    m_pollProfile = profile;
+    if (m_bus) m_bus->scheduler()->setPollProfile(m_pollId, profile);
+}
+
 void BlackbodyController::setTargetTemperature(float temperature)
 {
+    if (!m_bus) {
+        emit errorOccurred(tr("黑体炉未连接"));
+        return;
+    }
     quint32 tempData;
     memcpy(&tempData, &temperature, sizeof(quint32));
 
@@ -117,34 +149,32 @@ void BlackbodyController::setTargetTemperature(float temperature)
     writeUnit.setValue(0, tempData >> 16);
     writeUnit.setValue(1, tempData & 0xFFFF);
 
-    if (auto *reply = m_modbusDevice->sendWriteRequest(writeUnit, m_slaveAddress)) {
-        connect(reply, &QModbusReply::finished, this, [this, reply]() {
-            if (reply->error() == QModbusDevice::NoError) {
-                emit targetTemperatureSet(true); // 发射成功信号
-            } else {
-                emit errorOccurred(tr("设置失败: %1").arg(reply->errorString()));
-                emit targetTemperatureSet(false); // 发射失败信号
-            }
-            reply->deleteLater();
-        });
-    }
+    m_bus->scheduler()->write(m_slaveAddress, writeUnit, [this](bool ok) {
+        if (ok) {
+            emit targetTemperatureSet(true); // 发射成功信号
+        } else {
+            emit errorOccurred(tr("设置失败: %1").arg(busErrorString()));
+            emit targetTemperatureSet(false); // 发射失败信号
+        }
+    }, this);
 }
 
 void BlackbodyController::setDeviceState(bool start)
 {
+    if (!m_bus) {
+        emit errorOccurred(tr("黑体炉未连接"));
+        return;
+    }
     QModbusDataUnit writeUnit(QModbusDataUnit::HoldingRegisters, 0x0001, 1);
     writeUnit.setValue(0, start ? 0x01 : 0x00);
 
-    if (auto *reply = m_modbusDevice->sendWriteRequest(writeUnit, m_slaveAddress)) {
-        connect(reply, &QModbusReply::finished, [this, reply, start]() {
-            if (reply->error() == QModbusDevice::NoError) {
-                qDebug() << "Device state set to:" << (start ? "ON" : "OFF");
-            } else {
-                emit errorOccurred(tr("控制命令失败: %1").arg(reply->errorString()));
-            }
-            reply->deleteLater();
-        });
-    }
+    m_bus->scheduler()->write(m_slaveAddress, writeUnit, [this, start](bool ok) {
+        if (ok) {
+            qDebug() << "Device state set to:" << (start ? "ON" : "OFF");
+        } else {
+            emit errorOccurred(tr("控制命令失败: %1").arg(busErrorString()));
+        }
+    }, this);
 }
 
 quint16 BlackbodyController::calculateCRC(const QByteArray &data) {
@@ -164,20 +194,21 @@ quint16 BlackbodyController::calculateCRC(const QByteArray &data) {
 }
 
 void BlackbodyController::setMasterControl(bool enable) {
+    if (!m_bus) {
+        emit errorOccurred(tr("黑体炉未连接"));
+        return;
+    }
     QModbusDataUnit writeUnit(QModbusDataUnit::HoldingRegisters, 0x0000, 1);
     writeUnit.setValue(0, enable ? 0x0001 : 0x0000);
 
-    if (auto *reply = m_modbusDevice->sendWriteRequest(writeUnit, m_slaveAddress)) {
-        connect(reply, &QModbusReply::finished, this, [this, reply, enable]() {
-            if (reply->error() == QModbusDevice::NoError) {
-                emit masterControlChanged(enable); // 发射控制权状态
-                qDebug() << "黑体炉上位机控制" << (enable ? "已获取" : "已释放");
-            } else {
-                emit errorOccurred(tr("黑体炉控制权操作失败: %1").arg(reply->errorString()));
-            }
-            reply->deleteLater();
-        });
-    }
+    m_bus->scheduler()->write(m_slaveAddress, writeUnit, [this, enable](bool ok) {
+        if (ok) {
+            emit masterControlChanged(enable); // 发射控制权状态
+            qDebug() << "黑体炉上位机控制" << (enable ? "已获取" : "已释放");
+        } else {
+            emit errorOccurred(tr("黑体炉控制权操作失败: %1").arg(busErrorString()));
+        }
+    }, this);
 }
 
 float BlackbodyController::getCurrentTemperature() const
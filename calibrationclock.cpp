@@ -0,0 +1,179 @@
+#include "calibrationclock.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <limits>
+
+// ===================== CalibrationClock =====================
+void CalibrationClock::singleShot(int msec, QObject *context, std::function<void()> func)
+{
+    // 定时器挂在 context 下，context 析构时一并销毁，回调不会再触发
+    CalibrationTimer *timer = createTimer(context);
+    timer->setSingleShot(true);
+    connect(timer, &CalibrationTimer::timeout, context, [timer, func]() {
+        timer->deleteLater();
+        if (func) func();
+    });
+    timer->start(msec);
+}
+
+CalibrationClock *CalibrationClock::systemClock()
+{
+    static SystemClock clock;
+    return &clock;
+}
+
+// ===================== SystemTimer =====================
+SystemTimer::SystemTimer(QObject *parent)
+    : CalibrationTimer(parent)
+{
+    connect(&m_timer, &QTimer::timeout, this, &CalibrationTimer::timeout);
+}
+
+// ===================== SimulatedTimer =====================
+SimulatedTimer::SimulatedTimer(SimulatedClock *clock, QObject *parent)
+    : CalibrationTimer(parent), m_clock(clock)
+{
+    if (m_clock) m_clock->registerTimer(this);
+}
+
+SimulatedTimer::~SimulatedTimer()
+{
+    if (m_clock) m_clock->unregisterTimer(this);
+}
+
+void SimulatedTimer::start(int msec)
+{
+    m_interval = qMax(0, msec);
+    start();
+}
+
+void SimulatedTimer::start()
+{
+    if (!m_clock) return;
+    // 与 QTimer 相同：重复调用 start 会重新计时
+    m_active = true;
+    m_dueMs = m_clock->elapsedMs() + m_interval;
+    m_sequence = m_clock->m_nextSequence++;
+}
+
+void SimulatedTimer::stop()
+{
+    m_active = false;
+}
+
+void SimulatedTimer::setInterval(int msec)
+{
+    m_interval = qMax(0, msec);
+    if (m_active) start();
+}
+
+// ===================== SimulatedClock =====================
+SimulatedClock::SimulatedClock(const QDateTime &epoch, QObject *parent)
+    : CalibrationClock(parent), m_epoch(epoch)
+{
+}
+
+SimulatedClock::~SimulatedClock()
+{
+    for (SimulatedTimer *timer : qAsConst(m_timers)) {
+        timer->m_clock = nullptr;
+        timer->m_active = false;
+    }
+}
+
+CalibrationTimer *SimulatedClock::createTimer(QObject *parent)
+{
+    return new SimulatedTimer(this, parent);
+}
+
+int SimulatedClock::activeTimerCount() const
+{
+    int count = 0;
+    for (const SimulatedTimer *timer : m_timers) {
+        if (timer->m_active) ++count;
+    }
+    return count;
+}
+
+void SimulatedClock::registerTimer(SimulatedTimer *timer)
+{
+    m_timers.append(timer);
+}
+
+void SimulatedClock::unregisterTimer(SimulatedTimer *timer)
+{
+    m_timers.removeOne(timer);
+}
+
+SimulatedTimer *SimulatedClock::nextDueTimer() const
+{
+    SimulatedTimer *next = nullptr;
+    for (SimulatedTimer *timer : m_timers) {
+        if (!timer->m_active) continue;
+        if (!next || timer->m_dueMs < next->m_dueMs
+            || (timer->m_dueMs == next->m_dueMs && timer->m_sequence < next->m_sequence)) {
+            next = timer;
+        }
+    }
+    return next;
+}
+
+void SimulatedClock::fire(SimulatedTimer *timer)
+{
+    m_elapsedMs = qMax(m_elapsedMs, timer->m_dueMs);
+
+    if (timer->m_singleShot) {
+        timer->m_active = false;
+    } else {
+        // 间隔为 0 的重复定时器在实机上会空转，这里至少推进 1ms 防止死循环
+        timer->m_dueMs = m_elapsedMs + qMax(1, timer->m_interval);
+        timer->m_sequence = m_nextSequence++;
+    }
+
+    ++m_firedEvents;
+    emit timer->timeout();
+}
+
+bool SimulatedClock::advanceToNextEvent()
+{
+    SimulatedTimer *timer = nextDueTimer();
+    if (!timer) return false;
+    fire(timer);
+    return true;
+}
+
+void SimulatedClock::advanceTo(qint64 untilMs)
+{
+    while (true) {
+        SimulatedTimer *timer = nextDueTimer();
+        if (!timer || timer->m_dueMs > untilMs) break;
+        fire(timer);
+    }
+    m_elapsedMs = qMax(m_elapsedMs, untilMs);
+}
+
+bool SimulatedClock::runUntil(const std::function<bool()> &stopCondition, qint64 maxMs)
+{
+    const qint64 limit = (maxMs > 0) ? m_elapsedMs + maxMs : std::numeric_limits<qint64>::max();
+
+    while (!stopCondition || !stopCondition()) {
+        // 处理排队信号与 deleteLater，保证与实机事件循环下的顺序一致
+        if (QCoreApplication::instance()) {
+            QCoreApplication::sendPostedEvents();
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        }
+
+        SimulatedTimer *timer = nextDueTimer();
+        if (!timer) {
+            qWarning() << "虚拟时钟：没有待触发的事件，仿真提前结束";
+            return false;
+        }
+        if (timer->m_dueMs > limit) {
+            m_elapsedMs = limit;
+            qWarning() << "虚拟时钟：超过最长仿真时长" << maxMs << "ms";
+            return false;
+        }
+        fire(timer);
+    }
+    return true;
+}
@@ -0,0 +1,144 @@
+#ifndef CALIBRATIONCLOCK_H
+#define CALIBRATIONCLOCK_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+class SimulatedClock;
+
+// 定时器抽象：接口与 QTimer 保持一致，CalibrationManager 只通过它计时
+class CalibrationTimer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CalibrationTimer(QObject *parent = nullptr) : QObject(parent) {}
+
+    virtual void start(int msec) = 0;
+    virtual void start() = 0;
+    virtual void stop() = 0;
+    virtual bool isActive() const = 0;
+    virtual void setInterval(int msec) = 0;
+    virtual int interval() const = 0;
+    virtual void setSingleShot(bool singleShot) = 0;
+    virtual bool isSingleShot() const = 0;
+
+signals:
+    void timeout();
+};
+
+// 时钟服务：提供“当前时间”和定时器。实机使用系统时钟，仿真使用虚拟时钟
+class CalibrationClock : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CalibrationClock(QObject *parent = nullptr) : QObject(parent) {}
+
+    virtual QDateTime now() const = 0;
+    virtual CalibrationTimer *createTimer(QObject *parent = nullptr) = 0;
+
+    // 等价于 QTimer::singleShot：context 销毁时回调自动取消
+    void singleShot(int msec, QObject *context, std::function<void()> func);
+
+    // 进程内共享的系统时钟
+    static CalibrationClock *systemClock();
+};
+
+// ===================== 系统时钟（QTimer 实现） =====================
+class SystemTimer : public CalibrationTimer
+{
+    Q_OBJECT
+public:
+    explicit SystemTimer(QObject *parent = nullptr);
+
+    void start(int msec) override { m_timer.start(msec); }
+    void start() override { m_timer.start(); }
+    void stop() override { m_timer.stop(); }
+    bool isActive() const override { return m_timer.isActive(); }
+    void setInterval(int msec) override { m_timer.setInterval(msec); }
+    int interval() const override { return m_timer.interval(); }
+    void setSingleShot(bool singleShot) override { m_timer.setSingleShot(singleShot); }
+    bool isSingleShot() const override { return m_timer.isSingleShot(); }
+
+private:
+    QTimer m_timer;
+};
+
+class SystemClock : public CalibrationClock
+{
+    Q_OBJECT
+public:
+    explicit SystemClock(QObject *parent = nullptr) : CalibrationClock(parent) {}
+
+    QDateTime now() const override { return QDateTime::currentDateTime(); }
+    CalibrationTimer *createTimer(QObject *parent = nullptr) override { return new SystemTimer(parent); }
+};
+
+// ===================== 虚拟时钟（离散事件仿真） =====================
+class SimulatedTimer : public CalibrationTimer
+{
+    Q_OBJECT
+public:
+    SimulatedTimer(SimulatedClock *clock, QObject *parent = nullptr);
+    ~SimulatedTimer();
+
+    void start(int msec) override;
+    void start() override;
+    void stop() override;
+    bool isActive() const override { return m_active; }
+    void setInterval(int msec) override;
+    int interval() const override { return m_interval; }
+    void setSingleShot(bool singleShot) override { m_singleShot = singleShot; }
+    bool isSingleShot() const override { return m_singleShot; }
+
+private:
+    friend class SimulatedClock;
+
+    SimulatedClock *m_clock;
+    int m_interval = 0;
+    bool m_singleShot = false;
+    bool m_active = false;
+    qint64 m_dueMs = 0;   // 到期的虚拟时间
+    quint64 m_sequence = 0; // 同一时刻到期时按启动顺序触发
+};
+
+class SimulatedClock : public CalibrationClock
+{
+    Q_OBJECT
+public:
+    explicit SimulatedClock(const QDateTime &epoch = QDateTime::currentDateTime(), QObject *parent = nullptr);
+    ~SimulatedClock();
+
+    QDateTime now() const override { return m_epoch.addMSecs(m_elapsedMs); }
+    CalibrationTimer *createTimer(QObject *parent = nullptr) override;
+
+    qint64 elapsedMs() const { return m_elapsedMs; }
+    int activeTimerCount() const;
+
+    // 跳到下一个到期的定时器并触发它；没有待触发事件时返回 false
+    bool advanceToNextEvent();
+    // 推进到 untilMs（虚拟毫秒），期间按顺序触发所有到期定时器
+    void advanceTo(qint64 untilMs);
+    // 连续推进，直到 stopCondition 为真、事件耗尽或超过 maxMs
+    bool runUntil(const std::function<bool()> &stopCondition, qint64 maxMs);
+
+    quint64 firedEventCount() const { return m_firedEvents; }
+
+private:
+    friend class SimulatedTimer;
+
+    void registerTimer(SimulatedTimer *timer);
+    void unregisterTimer(SimulatedTimer *timer);
+    SimulatedTimer *nextDueTimer() const;
+    void fire(SimulatedTimer *timer);
+
+    QDateTime m_epoch;
+    qint64 m_elapsedMs = 0;
+    quint64 m_nextSequence = 0;
+    quint64 m_firedEvents = 0;
+    QVector<SimulatedTimer *> m_timers;
+};
+
+#endif // CALIBRATIONCLOCK_H
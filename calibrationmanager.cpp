@@ -2,27 +2,111 @@
 #include <QMessageBox>
 #include <xlsxdocument.h>
 #include <QDebug>
+#include <QDir>
+#include "modbustransactionscheduler.h"
 #include <numeric>
 #include <algorithm>
 
-CalibrationManager::CalibrationManager(BlackbodyController *blackbodyController, HumidityController *humidityController, QObject *parent)
-    : QObject(parent), m_blackbodyController(blackbodyController), m_humidityController(humidityController)
+namespace {
+
+// 报告附加“通信诊断”工作表：各从站的往返时间和错误统计，便于事后判断稳定判断偏慢的原因
+void writeLinkStatsSheet(QXlsx::Document &report, const QVector<QPair<QString, ModbusLinkStats>> &devices)
+{
+    report.addSheet("通信诊断");
+    const QStringList headers = {"设备", "请求数", "成功数", "平均RTT(ms)", "P95(ms)", "最大RTT(ms)",
+                                 "超时", "帧错误", "异常应答", "重试", "RTT分布", "最近错误"};
+    for (int col = 0; col < headers.size(); ++col) report.write(1, col + 1, headers[col]);
+
+    int row = 2;
+    for (const auto &device : devices) {
+        const ModbusLinkStats &stats = device.second;
+        report.write(row, 1, device.first);
+        report.write(row, 2, double(stats.requests));
+        report.write(row, 3, double(stats.successes));
+        report.write(row, 4, stats.meanRttMs());
+        report.write(row, 5, stats.percentileMs(0.95));
+        report.write(row, 6, stats.rttMaxMs);
+        report.write(row, 7, double(stats.timeouts));
+        report.write(row, 8, double(stats.frameErrors));
+        report.write(row, 9, double(stats.exceptions));
+        report.write(row, 10, double(stats.retries));
+        report.write(row, 11, stats.histogramText());
+        report.write(row, 12, stats.lastError);
+        ++row;
+    }
+    report.selectSheet(report.sheetNames().first());
+}
+
+// 报告附加“整定时间”工作表：每次黑体炉设定值变化的预测与实际整定时间
+void writeSettleSheet(QXlsx::Document &report, const QVector<SetpointShaper::SettleReport> &settles)
+{
+    report.addSheet("整定时间");
+    const QStringList headers = {"温度点序号", "起始温度(℃)", "目标温度(℃)", "是否整形",
+                                 "预测整定(s)", "不整形预测(s)", "实际整定(s)"};
+    for (int col = 0; col < headers.size(); ++col) report.write(1, col + 1, headers[col]);
+
+    int row = 2;
+    for (const auto &s : settles) {
+        report.write(row, 1, s.pointIndex + 1);
+        report.write(row, 2, s.from);
+        report.write(row, 3, s.target);
+        report.write(row, 4, s.shaped ? "是" : "否");
+        if (s.predictedSec >= 0) report.write(row, 5, s.predictedSec);
+        if (s.unshapedSec >= 0) report.write(row, 6, s.unshapedSec);
+        if (s.achievedSec >= 0) report.write(row, 7, s.achievedSec);
+        else report.write(row, 7, "未整定");
+        ++row;
+    }
+    report.selectSheet(report.sheetNames().first());
+}
+
+} // namespace
+
+CalibrationManager::CalibrationManager(BlackbodyController *blackbodyController, HumidityController *humidityController,
+                                       QObject *parent, CalibrationClock *clock)
+    : QObject(parent), m_blackbodyController(blackbodyController), m_humidityController(humidityController),
+    m_clock(clock ? clock : CalibrationClock::systemClock())
 {
-    m_sensorStabilizeTimer.setSingleShot(true);
-    m_waitNextMinuteTimer.setSingleShot(true);
-    m_samplingTimer.setInterval(1000);
-    m_countdownTimer.setInterval(1000);
+    m_stabilityTimer = m_clock->createTimer(this);
+    m_sensorStabilizeTimer = m_clock->createTimer(this);
+    m_countdownTimer = m_clock->createTimer(this);
+    m_waitNextMinuteTimer = m_clock->createTimer(this);
+    m_samplingTimer = m_clock->createTimer(this);
+    m_servoTimeoutTimer = m_clock->createTimer(this);
+
+    m_sensorStabilizeTimer->setSingleShot(true);
+    m_waitNextMinuteTimer->setSingleShot(true);
+    m_samplingTimer->setInterval(1000);
+    m_countdownTimer->setInterval(1000);
 
     // 【新增】初始化超时定时器
-    m_servoTimeoutTimer.setSingleShot(true);
+    m_servoTimeoutTimer->setSingleShot(true);
+
+    // 流水线模式：最后一个测温仪驻留期间提前切换恒温箱
+    m_preRampTimer = m_clock->createTimer(this);
+    m_preRampTimer->setSingleShot(true);
+    connect(m_preRampTimer, &CalibrationTimer::timeout, this, &CalibrationManager::onPreRampTimeout);
 
-    connect(&m_countdownTimer, &QTimer::timeout, this, &CalibrationManager::onCountdownTimerTimeout);
-    connect(&m_waitNextMinuteTimer, &QTimer::timeout, this, &CalibrationManager::onWaitNextMinuteTimeout);
-    connect(&m_sensorStabilizeTimer, &QTimer::timeout, this, &CalibrationManager::onSensorStabilizeTimeout);
-    connect(&m_samplingTimer, &QTimer::timeout, this, &CalibrationManager::onSamplingTimerTimeout);
+    m_shaper = new SetpointShaper(m_blackbodyController, m_clock, this);
+    connect(m_shaper, &SetpointShaper::settleReported, this, &CalibrationManager::onSettleReported);
+
+    connect(m_countdownTimer, &CalibrationTimer::timeout, this, &CalibrationManager::onCountdownTimerTimeout);
+    connect(m_waitNextMinuteTimer, &CalibrationTimer::timeout, this, &CalibrationManager::onWaitNextMinuteTimeout);
+    connect(m_sensorStabilizeTimer, &CalibrationTimer::timeout, this, &CalibrationManager::onSensorStabilizeTimeout);
+    connect(m_samplingTimer, &CalibrationTimer::timeout, this, &CalibrationManager::onSamplingTimerTimeout);
 
     // 【新增】连接超时信号
-    connect(&m_servoTimeoutTimer, &QTimer::timeout, this, &CalibrationManager::onServoTimeout);
+    connect(m_servoTimeoutTimer, &CalibrationTimer::timeout, this, &CalibrationManager::onServoTimeout);
+
+    m_planEngine = new PlanEngine(m_clock, this);
+    connect(m_planEngine, &PlanEngine::nodeReady, this, &CalibrationManager::onPlanNodeReady);
+    connect(m_planEngine, &PlanEngine::planFinished, this, &CalibrationManager::onPlanFinished);
+    connect(m_planEngine, &PlanEngine::nodeFinished, this, [this](int node, qint64 actualMs) {
+        const PlanNode &n = m_planEngine->node(node);
+        float target = m_allTempPoints.value(m_currentTempPointIndex).temp;
+        float previous = (m_currentTempPointIndex > 0) ? m_allTempPoints[m_currentTempPointIndex - 1].temp : target;
+        emit planStageFinished(n.id, actualMs, CalibrationPlan::expectedNodeSec(n, target - previous));
+    });
 }
 
 CalibrationManager::~CalibrationManager() {}
@@ -32,6 +116,64 @@ void CalibrationManager::setServoController(ServoMotorController *servo) {
     connect(m_servo, &ServoMotorController::positionReached, this, &CalibrationManager::onServoInPosition);
 }
 
+void CalibrationManager::setReportDirectory(const QString &dir) {
+    m_reportDirectory = dir;
+}
+
+void CalibrationManager::setPlan(const CalibrationPlan &plan) {
+    clearPlan();
+    m_plan = plan;
+    m_usePlan = !plan.isEmpty();
+}
+
+// 动作参数只在对应节点执行时写入，换计划或回到内置流程时恢复默认值，避免沿用上一个计划的设置
+void CalibrationManager::clearPlan() {
+    m_plan = CalibrationPlan();
+    m_usePlan = false;
+    m_stabilityCriteria = StabilityCriteria();
+    m_dwellSeconds = 5 * 60;
+    m_servoTimeoutMs = 0;
+}
+
+double CalibrationManager::estimateDurationSec(const QVector<float> &bbPoints, QStringList *criticalPath) const {
+    const CalibrationPlan plan = m_usePlan ? m_plan : CalibrationPlan::defaultPlan();
+    QVector<PlanNode> nodes;
+    if (!plan.expand(m_taskQueue.size(), &nodes, nullptr)) return 0.0;
+    fillServoEstimates(&nodes);
+
+    double total = 0.0;
+    float previous = m_blackbodyController->getCurrentTemperature();
+    for (int i = 0; i < bbPoints.size(); ++i) {
+        PlanEstimate est = CalibrationPlan::estimate(nodes, bbPoints[i] - previous);
+        if (i == 0 && criticalPath) *criticalPath = est.criticalPath;
+        total += est.totalSec;
+        previous = bbPoints[i];
+    }
+    return total;
+}
+
+double CalibrationManager::slotAngle(int taskIndex) const {
+    return (m_taskQueue[taskIndex].position - 1) * DEGREES_PER_SLOT;
+}
+
+void CalibrationManager::fillServoEstimates(QVector<PlanNode> *nodes) const {
+    if (!m_servo) return;
+    // 按实际会下发的转动累计位置：第一个测温仪从零点出发，其余从上一个槽位出发，
+    // 累计超出 max_turns 时转台会反向绕行，转角可能远大于最短转角
+    double position = 0.0;
+    for (PlanNode &node : *nodes) {
+        if (node.action != "measureSensor") continue;
+        if (node.sensorIndex < 0 || node.sensorIndex >= m_taskQueue.size()) continue;
+        if (node.sensorIndex == 0) position = 0.0;
+        double rotation = m_servo->plannedMoveAngleFrom(position, slotAngle(node.sensorIndex));
+        position += rotation;
+        if (node.params.contains("servoSec")) continue;
+        // 另加约半个查询周期的到位确认
+        double moveSec = m_servo->predictedMoveMs(rotation) / 1000.0 + 0.1;
+        node.params.insert("servoSec", moveSec);
+    }
+}
+
 void CalibrationManager::setMeasurementQueue(const QVector<SensorTask>& queue) {
     m_taskQueue = queue;
     std::sort(m_taskQueue.begin(), m_taskQueue.end(), [](const SensorTask& a, const SensorTask& b){
@@ -55,6 +197,8 @@ void CalibrationManager::startCalibration(const QVector<float> &modelingPoints,
     m_paused = false;
     m_canceling = false;
     m_calibrationData.clear();
+    m_settleReports.clear();
+    m_shaper->abort(); // 上一轮正常结束时阶跃仍保留，不清掉会让本轮同号同温度点的设定值被跳过
     m_allTempPoints.clear();
     m_environmentType = envType;
 
@@ -67,11 +211,38 @@ void CalibrationManager::startCalibration(const QVector<float> &modelingPoints,
 
     m_humidityTempPoints = humidityPoints;
 
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    if (m_usePlan) {
+        QString planError;
+        if (!m_planEngine->load(m_plan, m_taskQueue.size(), &planError)) {
+            m_currentState = Idle;
+            emit errorOccurred(QString("标校流程加载失败：%1").arg(planError));
+            return;
+        }
+        QVector<PlanNode> nodes = m_planEngine->nodes();
+        fillServoEstimates(&nodes);
+        for (int i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].action == "measureSensor") m_planEngine->setNodeParam(i, "servoSec", nodes[i].params.value("servoSec"));
+        }
+    }
+
+    QVector<float> bbPoints;
+    for (const auto &p : m_allTempPoints) bbPoints.append(p.temp);
+    QStringList criticalPath;
+    double expectedSec = estimateDurationSec(bbPoints, &criticalPath);
+    emit planEstimateUpdated(expectedSec, criticalPath);
+
+    QString timestamp = m_clock->now().toString("yyyyMMdd_HHmmss");
     m_currentReportFileName = QString("measurement_record_%1.xlsx").arg(timestamp);
-    setCurrentOperation(QString("初始化完成 (%1)，总计 %2 个温度点").arg(m_environmentType).arg(m_allTempPoints.size()));
+    if (!m_reportDirectory.isEmpty()) {
+        m_currentReportFileName = QDir(m_reportDirectory).filePath(m_currentReportFileName);
+    }
+    setCurrentOperation(QString("初始化完成 (%1)，总计 %2 个温度点，流程：%3，预计耗时 %4 小时")
+                            .arg(m_environmentType).arg(m_allTempPoints.size())
+                            .arg(m_usePlan ? m_plan.name : QString("内置"))
+                            .arg(expectedSec / 3600.0, 0, 'f', 1));
 
     emit stateChanged(Running);
+    updatePollProfile();
 
     // =========================================================
     // 【关键修复】使用 resetZeroPoint() 替代 moveToZero()
@@ -100,10 +271,17 @@ void CalibrationManager::calibrateNextPoint(int index) {
     QString type = m_allTempPoints[index].type;
     float humTemp = (index < m_humidityTempPoints.size()) ? m_humidityTempPoints[index] : 25.0f;
 
+    if (m_usePlan) {
+        setCurrentOperation(QString("开始第 %1 个点 (%2)：黑体炉 %3℃，恒温箱 %4℃，按流程 %5 执行")
+                                .arg(index + 1).arg(type).arg(bbTemp).arg(humTemp).arg(m_plan.name));
+        m_planEngine->start();
+        return;
+    }
+
     setCurrentOperation(QString("设置第 %1 个点 (%2)：黑体炉 %3℃，恒温箱 %4℃")
                             .arg(index + 1).arg(type).arg(bbTemp).arg(humTemp));
 
-    m_blackbodyController->setTargetTemperature(bbTemp);
+    setBlackbodyTarget(bbTemp, index);
     m_blackbodyController->setDeviceState(true);
     m_humidityController->setTargetTemperature(humTemp);
     m_humidityController->setDeviceState(true);
@@ -118,13 +296,14 @@ void CalibrationManager::checkStability(int index) {
     float targetTemp = m_allTempPoints[index].temp;
     m_stabilitySamples.clear();
     m_sampleCount = 0;
-    int windowSize = 150;
-    int interval = 2;
+    const StabilityCriteria criteria = m_stabilityCriteria;
+    int windowSize = criteria.windowSamples;
+    int interval = criteria.intervalSec;
 
     setCurrentOperation(QString("等待环境稳定 (目标: %1℃)...").arg(targetTemp));
-    m_pausedStage = StabilityCheck;
+    setStage(StabilityCheck);
 
-    auto checkFunc = [this, targetTemp, windowSize]() {
+    auto checkFunc = [this, targetTemp, windowSize, criteria]() {
         if (m_currentState != Running) return;
         float currentBB = m_blackbodyController->getCurrentTemperature();
         m_stabilitySamples.append(currentBB);
@@ -135,8 +314,16 @@ void CalibrationManager::checkStability(int index) {
             auto minmax = std::minmax_element(m_stabilitySamples.begin(), m_stabilitySamples.end());
             float fluctuation = *minmax.second - *minmax.first;
             float deviation = qAbs(currentBB - targetTemp);
-            if (deviation < 1.0 && fluctuation < 0.1) {
-                m_stabilityTimer.stop();
+            if (deviation < criteria.maxDeviation && fluctuation < criteria.maxFluctuation) {
+                m_stabilityTimer->stop();
+                if (m_usePlan) {
+                    setCurrentOperation(QString("环境已稳定 (波动%1℃)").arg(fluctuation, 0, 'f', 3));
+                    setStage(None);
+                    int node = m_stableNode;
+                    m_stableNode = -1;
+                    m_planEngine->completeNode(node);
+                    return;
+                }
                 setCurrentOperation(QString("环境已稳定 (波动%1℃)，打开标定窗口...").arg(fluctuation, 0, 'f', 3));
                 m_humidityController->toggleCalibrationWindow(true);
                 startMeasurement(m_currentTempPointIndex);
@@ -145,25 +332,26 @@ void CalibrationManager::checkStability(int index) {
             }
         }
     };
-    m_stabilityTimer.disconnect();
-    connect(&m_stabilityTimer, &QTimer::timeout, this, checkFunc);
-    m_stabilityTimer.start(interval * 1000);
+    m_stabilityTimer->disconnect();
+    connect(m_stabilityTimer, &CalibrationTimer::timeout, this, checkFunc);
+    m_stabilityTimer->start(interval * 1000);
 }
 
 void CalibrationManager::startMeasurement(int index) {
     if (m_canceling || m_paused) return;
-    QDateTime nextMinute = QDateTime::currentDateTime().addSecs(60);
+    QDateTime now = m_clock->now();
+    QDateTime nextMinute = now.addSecs(60);
     nextMinute.setTime(QTime(nextMinute.time().hour(), nextMinute.time().minute(), 0));
-    int waitToNextMinute = QDateTime::currentDateTime().secsTo(nextMinute);
+    int waitToNextMinute = now.secsTo(nextMinute);
     if (waitToNextMinute > 0) {
         setCurrentOperation(QString("等待到下一分钟开始测量（%1秒后）").arg(waitToNextMinute));
-        m_pausedStage = WaitingForNextMinute;
+        setStage(WaitingForNextMinute);
         m_currentWaitIndex = index;
-        m_currentWaitStartTime = QDateTime::currentDateTime();
+        m_currentWaitStartTime = now;
         m_totalWaitSeconds = waitToNextMinute;
         m_currentCountdownStage = QString("等待到下一分钟开始第%1个温度点测量").arg(index + 1);
-        m_countdownTimer.start();
-        m_waitNextMinuteTimer.start(waitToNextMinute * 1000);
+        m_countdownTimer->start();
+        m_waitNextMinuteTimer->start(waitToNextMinute * 1000);
     } else {
         startBatchSequence(index);
     }
@@ -171,16 +359,23 @@ void CalibrationManager::startMeasurement(int index) {
 
 void CalibrationManager::onWaitNextMinuteTimeout() {
     if (m_paused || m_canceling || m_currentState != Running) return;
-    m_pausedStage = None;
-    m_countdownTimer.stop();
+    setStage(None);
+    m_countdownTimer->stop();
     startBatchSequence(m_currentTempPointIndex);
 }
 
 void CalibrationManager::startBatchSequence(int index) {
     m_currentBatchData.blackbodyTarget = m_allTempPoints[index].temp;
     m_currentBatchData.blackbodyReal = 0.0f;
-    m_currentBatchData.measureTime = QDateTime::currentDateTime();
+    m_currentBatchData.measureTime = m_clock->now();
     m_currentBatchData.pointType = m_allTempPoints[index].type;
+    if (m_usePlan) {
+        setCurrentOperation(QString("%1点(%2℃)准备就绪").arg(m_currentBatchData.pointType).arg(m_currentBatchData.blackbodyTarget));
+        int node = m_alignNode;
+        m_alignNode = -1;
+        m_planEngine->completeNode(node);
+        return;
+    }
     setCurrentOperation(QString("%1点(%2℃)准备就绪，开始执行多通道测量序列...").arg(m_currentBatchData.pointType).arg(m_currentBatchData.blackbodyTarget));
     startSensorSequence();
 }
@@ -195,17 +390,20 @@ void CalibrationManager::startSensorSequence() {
 void CalibrationManager::processCurrentTask() {
     if (m_canceling) return;
     if (m_currentTaskIndex >= m_taskQueue.size()) {
-        finishSequence();
+        if (!m_usePlan) finishSequence();
         return;
     }
     SensorTask task = m_taskQueue[m_currentTaskIndex];
-    double targetAngle = (task.position - 1) * DEGREES_PER_SLOT;
-    setCurrentOperation(QString("电机移动至位置 %1 (COM: %2)...").arg(task.position).arg(task.comPort));
-    m_pausedStage = ServoMoving;
+    double targetAngle = slotAngle(m_currentTaskIndex);
+    double delta = m_servo->plannedMoveAngle(targetAngle);
+    setCurrentOperation(QString("电机移动至位置 %1 (COM: %2)，预计 %3 秒...")
+                            .arg(task.position).arg(task.comPort).arg(m_servo->predictedMoveMs(delta) / 1000.0, 0, 'f', 1));
+    setStage(ServoMoving);
 
-    // 【新增】启动超时保护 (20秒)
+    // 【新增】启动超时保护：按速度曲线预测时间推算（计划显式配置 servoTimeoutSec 时以配置为准）
     // 防止电机实际动了但未收到信号导致死锁
-    m_servoTimeoutTimer.start(20000);
+    m_activeServoTimeoutMs = (m_servoTimeoutMs > 0) ? m_servoTimeoutMs : m_servo->moveTimeoutMs(delta);
+    m_servoTimeoutTimer->start(m_activeServoTimeoutMs);
 
     m_servo->moveToAbsolute(targetAngle);
 }
@@ -224,18 +422,25 @@ void CalibrationManager::onServoInPosition() {
     if (m_pausedStage != ServoMoving) return;
 
     // 【新增】正常到位，停止超时计时
-    m_servoTimeoutTimer.stop();
+    m_servoTimeoutTimer->stop();
 
     SensorTask task = m_taskQueue[m_currentTaskIndex];
-    int waitSeconds = 5 * 60;
-    m_pausedStage = SensorStabilizing;
-    m_waitStartTime = QDateTime::currentDateTime();
+    int waitSeconds = m_dwellSeconds;
+    setStage(SensorStabilizing);
+    m_waitStartTime = m_clock->now();
     m_waitTotalSeconds = waitSeconds;
-    m_waitDescription = QString("位置 %1 (%2) 测量中 - 等待5分钟").arg(task.position).arg(task.comPort);
-    m_sensorStabilizeTimer.start(waitSeconds * 1000);
-    m_countdownTimer.start(1000);
+    m_waitDescription = QString("位置 %1 (%2) 测量中 - 等待%3分钟").arg(task.position).arg(task.comPort).arg(waitSeconds / 60.0, 0, 'g', 3);
+    m_sensorStabilizeTimer->start(waitSeconds * 1000);
+    m_countdownTimer->start(1000);
     m_bbRealtimeSamples.clear();
-    m_samplingTimer.start();
+    m_samplingTimer->start();
+
+    // 流水线模式：最后一个测温仪驻留结束前 leadTime 秒开始切换恒温箱
+    if (!m_usePlan && m_pipelineLeadSeconds > 0 && m_currentTaskIndex == m_taskQueue.size() - 1) {
+        int delaySeconds = qMax(0, waitSeconds - m_pipelineLeadSeconds);
+        m_preRampDue = m_waitStartTime.addSecs(delaySeconds);
+        m_preRampTimer->start(delaySeconds * 1000);
+    }
     emit irMeasurementStarted(task.comPort);
 }
 
@@ -250,8 +455,8 @@ void CalibrationManager::onServoTimeout() {
 }
 
 void CalibrationManager::onSensorStabilizeTimeout() {
-    m_countdownTimer.stop();
-    m_samplingTimer.stop();
+    m_countdownTimer->stop();
+    m_samplingTimer->stop();
     SensorTask task = m_taskQueue[m_currentTaskIndex];
     float bbAvg = 0.0f;
     if (!m_bbRealtimeSamples.isEmpty()) {
@@ -276,7 +481,7 @@ void CalibrationManager::onIrAverageReceived(const QString& comPort, const Calib
     CalibrationRecord record;
     record.physicalPosition = currentTask.position;
     record.comPort = comPort;
-    record.measureTime = QDateTime::currentDateTime();
+    record.measureTime = m_clock->now();
     record.blackbodyTarget = m_currentBatchData.blackbodyTarget;
     record.blackbodyReal = m_currentBatchData.blackbodyReal;
     record.pointType = m_currentBatchData.pointType;
@@ -287,6 +492,14 @@ void CalibrationManager::onIrAverageReceived(const QString& comPort, const Calib
 
     setCurrentOperation(QString("位置 %1 数据已保存 (%2)").arg(currentTask.position).arg(record.pointType));
 
+    if (m_usePlan) {
+        setStage(None);
+        int node = m_measureNode;
+        m_measureNode = -1;
+        m_planEngine->completeNode(node);
+        return;
+    }
+
     m_currentTaskIndex++;
     processCurrentTask();
 }
@@ -298,11 +511,16 @@ void CalibrationManager::finishSequence() {
 
     m_humidityController->toggleCalibrationWindow(false);
     m_servo->moveToZero();
-    m_pausedStage = None;
-    m_samplingTimer.stop();
-    m_servoTimeoutTimer.stop(); // 确保停止
+    setStage(None);
+    m_samplingTimer->stop();
+    m_servoTimeoutTimer->stop(); // 确保停止
+
+    // 流水线模式：本温度点已测完，黑体炉不再是基准，立即切到下一温度点，不必等 5 秒
+    if (m_pipelineLeadSeconds > 0) {
+        preRampNextPoint("blackbody", true, nullptr);
+    }
 
-    QTimer::singleShot(5000, this, [this](){
+    m_clock->singleShot(5000, this, [this](){
         int nextIndex = m_currentTempPointIndex + 1;
         int progress = nextIndex * 100 / m_allTempPoints.size();
         emit calibrationProgress(progress);
@@ -310,6 +528,161 @@ void CalibrationManager::finishSequence() {
     });
 }
 
+// ===================== 声明式流程动作 =====================
+void CalibrationManager::onPlanNodeReady(int node) {
+    if (m_canceling || m_currentState != Running) return;
+
+    const PlanNode &n = m_planEngine->node(node);
+    const QVariantMap &p = n.params;
+    const int index = m_currentTempPointIndex;
+    float bbTemp = m_allTempPoints[index].temp;
+    float humTemp = (index < m_humidityTempPoints.size()) ? m_humidityTempPoints[index] : 25.0f;
+
+    if (n.action == "setpoint") {
+        QStringList devices = p.value("devices", QStringList{"blackbody", "chamber"}).toStringList();
+        if (devices.contains("blackbody")) {
+            setBlackbodyTarget(bbTemp, index);
+            m_blackbodyController->setDeviceState(true);
+        }
+        if (devices.contains("chamber")) {
+            m_humidityController->setTargetTemperature(humTemp);
+            m_humidityController->setDeviceState(true);
+        }
+        setCurrentOperation(QString("[%1] 设定值已下发：黑体炉 %2℃，恒温箱 %3℃").arg(n.id).arg(bbTemp).arg(humTemp));
+        m_planEngine->completeNode(node);
+    } else if (n.action == "servoZero") {
+        m_servo->moveToZero();
+        m_planEngine->completeNode(node);
+    } else if (n.action == "waitStable") {
+        m_stabilityCriteria.windowSamples = qMax(1, p.value("windowSamples", 150).toInt());
+        m_stabilityCriteria.intervalSec = qMax(1, p.value("intervalSec", 2).toInt());
+        m_stabilityCriteria.maxDeviation = p.value("maxDeviation", 1.0).toFloat();
+        m_stabilityCriteria.maxFluctuation = p.value("maxFluctuation", 0.1).toFloat();
+        m_stableNode = node;
+        checkStability(index);
+    } else if (n.action == "openWindow" || n.action == "closeWindow") {
+        m_humidityController->toggleCalibrationWindow(n.action == "openWindow");
+        m_planEngine->completeNode(node);
+    } else if (n.action == "alignMinute") {
+        m_alignNode = node;
+        startMeasurement(index);
+    } else if (n.action == "measureSensor") {
+        m_dwellSeconds = qMax(1, p.value("dwellSec", 300).toInt());
+        m_servoTimeoutMs = qMax(0, p.value("servoTimeoutSec", 0).toInt()) * 1000;
+        m_measureNode = node;
+        m_currentTaskIndex = n.sensorIndex;
+        processCurrentTask();
+    } else if (n.action == "saveReport") {
+        generateCalibrationReport(false);
+        m_planEngine->completeNode(node);
+    } else if (n.action == "delay") {
+        int ms = qRound(p.value("sec", 0).toDouble() * 1000.0);
+        m_clock->singleShot(ms, this, [this, node]() {
+            if (m_currentState == Running) m_planEngine->completeNode(node);
+            else if (m_currentState == Paused) m_deferredPlanNodes.append(node); // 恢复后再完成
+        });
+    } else if (n.action == "presetNext") {
+        presetNextPoint(node);
+        m_planEngine->completeNode(node);
+    } else {
+        emit errorOccurred(QString("流程阶段 %1 的动作 %2 无法执行").arg(n.id, n.action));
+    }
+}
+
+void CalibrationManager::presetNextPoint(int node) {
+    const PlanNode &n = m_planEngine->node(node);
+    QString device = n.params.value("device", "chamber").toString();
+
+    bool measurementDone = true;
+    for (int i = 0; i < m_planEngine->nodes().size(); ++i) {
+        if (m_planEngine->node(i).action == "measureSensor" && m_planEngine->status(i) != PlanEngine::Done) {
+            measurementDone = false;
+            break;
+        }
+    }
+
+    QString reason;
+    if (!preRampNextPoint(device, measurementDone, &reason)) {
+        qDebug() << "流程阶段" << n.id << "跳过预设：" << reason;
+    }
+}
+
+// 提前把不在测量中的设备切到下一温度点，缩短点间等待。
+// 黑体炉是测温仪的测量基准，本温度点测完之前绝不改动；恒温箱设定值不变（如箱外固定25℃）
+// 或跨度超过 m_preRampMaxChamberStep 时也不预设，避免标定窗口打开时箱内温度剧烈变化
+bool CalibrationManager::preRampNextPoint(const QString &device, bool measurementDone, QString *reason) {
+    int next = m_currentTempPointIndex + 1;
+    if (next >= m_allTempPoints.size()) {
+        if (reason) *reason = "已是最后一个温度点";
+        return false;
+    }
+
+    if (device == "blackbody") {
+        if (!measurementDone) {
+            if (reason) *reason = "黑体炉仍在作为测量基准";
+            return false;
+        }
+        setBlackbodyTarget(m_allTempPoints[next].temp, next);
+        setCurrentOperation(QString("黑体炉预设下一温度点 %1℃").arg(m_allTempPoints[next].temp));
+        return true;
+    }
+
+    int current = m_currentTempPointIndex;
+    float curHum = (current < m_humidityTempPoints.size()) ? m_humidityTempPoints[current] : 25.0f;
+    float nextHum = (next < m_humidityTempPoints.size()) ? m_humidityTempPoints[next] : 25.0f;
+    if (qAbs(nextHum - curHum) < 0.05f) {
+        if (reason) *reason = "恒温箱设定值不变";
+        return false;
+    }
+    if (!measurementDone && m_preRampMaxChamberStep > 0.0f && qAbs(nextHum - curHum) > m_preRampMaxChamberStep) {
+        if (reason) *reason = QString("恒温箱跨度 %1℃ 超过允许的 %2℃").arg(qAbs(nextHum - curHum)).arg(m_preRampMaxChamberStep);
+        return false;
+    }
+    m_humidityController->setTargetTemperature(nextHum);
+    setCurrentOperation(QString("恒温箱预设下一温度点 %1℃").arg(nextHum));
+    return true;
+}
+
+void CalibrationManager::setBlackbodyTarget(float temperature, int pointIndex) {
+    m_shaper->moveTo(temperature, pointIndex);
+    if (m_shaper->isShaping()) {
+        setCurrentOperation(QString("黑体炉设定值整形：先过冲再回到 %1℃").arg(temperature));
+    }
+}
+
+void CalibrationManager::onSettleReported(const SetpointShaper::SettleReport &report) {
+    m_settleReports.append(report);
+    auto sec = [](double v) { return v < 0 ? QString("-") : QString::number(v, 'f', 0); };
+    setCurrentOperation(QString("黑体炉 %1→%2℃ 整定时间：预测 %3 s（不整形 %4 s），实际 %5 s")
+                            .arg(report.from, 0, 'f', 2).arg(report.target)
+                            .arg(sec(report.predictedSec), sec(report.unshapedSec), sec(report.achievedSec)));
+}
+
+void CalibrationManager::setPipelineLeadTime(int seconds) {
+    m_pipelineLeadSeconds = qMax(0, seconds);
+}
+
+void CalibrationManager::setPreRampMaxChamberStep(float degrees) {
+    m_preRampMaxChamberStep = degrees;
+}
+
+void CalibrationManager::onPreRampTimeout() {
+    if (m_currentState != Running || m_canceling) return;
+    QString reason;
+    if (!preRampNextPoint("chamber", false, &reason)) {
+        qDebug() << "流水线预升温跳过：" << reason;
+    }
+}
+
+void CalibrationManager::onPlanFinished(qint64 totalMs) {
+    if (m_currentState != Running) return;
+    setCurrentOperation(QString("第 %1 个温度点流程完成，用时 %2 分钟")
+                            .arg(m_currentTempPointIndex + 1).arg(totalMs / 60000.0, 0, 'f', 1));
+    int nextIndex = m_currentTempPointIndex + 1;
+    emit calibrationProgress(nextIndex * 100 / m_allTempPoints.size());
+    calibrateNextPoint(nextIndex);
+}
+
 void CalibrationManager::generateCalibrationReport(bool isFinal)
 {
     if (m_calibrationData.isEmpty()) return;
@@ -357,13 +730,32 @@ void CalibrationManager::generateCalibrationReport(bool isFinal)
         row++;
     }
 
+    // 通信统计随最终报告一起保存，并写入运行日志
+    QVector<QPair<QString, ModbusLinkStats>> linkStats;
+    if (isFinal) {
+        linkStats.append({"黑体炉", m_blackbodyController->linkStats()});
+        linkStats.append({"恒温箱", m_humidityController->linkStats()});
+        if (linkStats[0].second.requests > 0 || linkStats[1].second.requests > 0) {
+            writeLinkStatsSheet(report, linkStats);
+        }
+        if (!m_settleReports.isEmpty()) {
+            writeSettleSheet(report, m_settleReports);
+        }
+    }
+
     if (report.saveAs(m_currentReportFileName)) {
         setCurrentOperation(QString("测量记录保存成功：%1").arg(m_currentReportFileName));
+        for (const auto &device : linkStats) {
+            if (device.second.requests > 0) {
+                setCurrentOperation(QString("通信统计（%1）：%2").arg(device.first, device.second.summary()));
+            }
+        }
         if (isFinal) {
             m_currentState = Finished;
             emit stateChanged(Finished);
+            updatePollProfile();
             emit calibrationFinished(m_calibrationData);
-            QTimer::singleShot(2000, this, [this]() {
+            m_clock->singleShot(2000, this, [this]() {
                 m_currentState = Idle;
                 emit stateChanged(Idle);
             });
@@ -378,18 +770,24 @@ void CalibrationManager::generateCalibrationReport(bool isFinal)
 void CalibrationManager::cancelCalibration() {
     m_currentState = Canceling;
     m_canceling = true;
-    m_stabilityTimer.stop();
-    m_sensorStabilizeTimer.stop();
-    m_countdownTimer.stop();
-    m_samplingTimer.stop();
-    m_servoTimeoutTimer.stop(); // 停止超时计时
+    updatePollProfile();
+    m_stabilityTimer->stop();
+    m_sensorStabilizeTimer->stop();
+    m_countdownTimer->stop();
+    m_samplingTimer->stop();
+    m_servoTimeoutTimer->stop(); // 停止超时计时
+    m_waitNextMinuteTimer->stop();
+    m_preRampTimer->stop();
+    m_shaper->abort();
+    m_planEngine->cancel();
+    m_deferredPlanNodes.clear();
 
     if(m_servo) m_servo->stop();
     m_humidityController->toggleCalibrationWindow(false);
     m_blackbodyController->setDeviceState(false);
     m_humidityController->setDeviceState(false);
 
-    QTimer::singleShot(1000, this, [this]() {
+    m_clock->singleShot(1000, this, [this]() {
         m_currentState = Idle;
         m_canceling = false;
         emit stateChanged(Idle);
@@ -401,11 +799,16 @@ void CalibrationManager::pauseCalibration() {
     if (m_currentState == Running) {
         m_currentState = Paused;
         m_paused = true;
-        m_stabilityTimer.stop();
-        m_sensorStabilizeTimer.stop();
-        m_countdownTimer.stop();
-        m_samplingTimer.stop();
-        m_servoTimeoutTimer.stop();
+        m_stabilityTimer->stop();
+        m_sensorStabilizeTimer->stop();
+        m_countdownTimer->stop();
+        m_samplingTimer->stop();
+        m_servoTimeoutTimer->stop();
+        m_planEngine->pause();
+        m_shaper->finishShaping(); // 暂停期间不保留过冲设定值
+        updatePollProfile();
+        m_preRampPending = m_preRampTimer->isActive();
+        m_preRampTimer->stop();
         emit stateChanged(Paused);
     }
 }
@@ -415,19 +818,28 @@ void CalibrationManager::resumeCalibration() {
         m_currentState = Running;
         m_paused = false;
         emit stateChanged(Running);
+        updatePollProfile();
+        m_planEngine->resume();
+        const QVector<int> deferred = m_deferredPlanNodes;
+        m_deferredPlanNodes.clear();
+        for (int node : deferred) m_planEngine->completeNode(node);
 
-        if (m_pausedStage == StabilityCheck) m_stabilityTimer.start();
+        if (m_pausedStage == StabilityCheck) m_stabilityTimer->start();
         else if (m_pausedStage == SensorStabilizing) {
-            qint64 elapsed = m_waitStartTime.secsTo(QDateTime::currentDateTime());
+            qint64 elapsed = m_waitStartTime.secsTo(m_clock->now());
             int remaining = m_waitTotalSeconds - elapsed;
-            if (remaining > 0) m_sensorStabilizeTimer.start(remaining * 1000);
+            if (remaining > 0) m_sensorStabilizeTimer->start(remaining * 1000);
             else onSensorStabilizeTimeout();
 
-            m_countdownTimer.start();
-            m_samplingTimer.start();
+            m_countdownTimer->start();
+            m_samplingTimer->start();
+            if (m_preRampPending) {
+                m_preRampPending = false;
+                m_preRampTimer->start(int(qMax<qint64>(0, m_clock->now().msecsTo(m_preRampDue))));
+            }
         } else if (m_pausedStage == ServoMoving) {
             // 如果在电机移动时暂停，恢复时重启超时计时（简化处理）
-            m_servoTimeoutTimer.start(20000);
+            m_servoTimeoutTimer->start(m_activeServoTimeoutMs);
         }
     }
 }
@@ -437,17 +849,34 @@ void CalibrationManager::onCountdownTimerTimeout() {
     int remaining = 0;
 
     if (m_pausedStage == SensorStabilizing) {
-        elapsed = m_waitStartTime.secsTo(QDateTime::currentDateTime());
+        elapsed = m_waitStartTime.secsTo(m_clock->now());
         remaining = m_waitTotalSeconds - elapsed;
         emit countdownUpdated(qMax(0, remaining), m_waitDescription);
     }
     else if (m_pausedStage == WaitingForNextMinute) {
-        elapsed = m_currentWaitStartTime.secsTo(QDateTime::currentDateTime());
+        elapsed = m_currentWaitStartTime.secsTo(m_clock->now());
         remaining = m_totalWaitSeconds - elapsed;
         emit countdownUpdated(qMax(0, remaining), m_currentCountdownStage);
     }
 }
 
+void CalibrationManager::setStage(PausedStage stage) {
+    m_pausedStage = stage;
+    updatePollProfile();
+}
+
+// 轮询档位随测量阶段切换：稳定判断和驻留采样期间快速轮询，其余运行阶段正常，未运行时慢速。
+// 档位设在本台架自己的设备轮询上，共用 COM 口的其他台架各按各的阶段轮询
+void CalibrationManager::updatePollProfile() {
+    ModbusTransactionScheduler::PollProfile profile = ModbusTransactionScheduler::IdlePoll;
+    if (m_currentState == Running) {
+        bool sampling = (m_pausedStage == StabilityCheck || m_pausedStage == SensorStabilizing);
+        profile = sampling ? ModbusTransactionScheduler::FastPoll : ModbusTransactionScheduler::NormalPoll;
+    }
+    if (m_blackbodyController) m_blackbodyController->setPollProfile(profile);
+    if (m_humidityController) m_humidityController->setPollProfile(profile);
+}
+
 void CalibrationManager::setCurrentOperation(const QString &operation) {
     currentOperation = operation;
     emit currentOperationChanged(operation);
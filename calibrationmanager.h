@@ -10,6 +10,9 @@
 #include <QTimer>
 #include <QStringList>
 #include "ServoMotorController.h"
+#include "calibrationclock.h"
+#include "planengine.h"
+#include "setpointshaper.h"
 
 // 定义任务结构体
 struct SensorTask {
@@ -67,7 +70,9 @@ public:
     };
     Q_ENUM(State)
 
-    explicit CalibrationManager(BlackbodyController *blackbodyController, HumidityController *humidityController, QObject *parent = nullptr);
+    // clock 为空时使用系统时钟；传入 SimulatedClock 即可在虚拟时间下运行完整流程
+    explicit CalibrationManager(BlackbodyController *blackbodyController, HumidityController *humidityController,
+                                QObject *parent = nullptr, CalibrationClock *clock = nullptr);
     ~CalibrationManager();
 
     // 增加 envType 参数
@@ -83,8 +88,29 @@ public:
     void setServoController(ServoMotorController *servo);
     void setMeasurementQueue(const QVector<SensorTask>& queue);
 
+    CalibrationClock *clock() const { return m_clock; }
+    // 测量记录保存目录（为空时保存到工作目录）
+    void setReportDirectory(const QString &dir);
+
     void onIrAverageReceived(const QString& comPort, const CalibrationManager::InfraredData& irData);
 
+    // 声明式流程：设置后每个温度点按计划执行；未设置时沿用内置流程
+    void setPlan(const CalibrationPlan &plan);
+    void clearPlan();
+    bool hasPlan() const { return m_usePlan; }
+    // 按当前计划（未设置时按默认流程）估算整次标校耗时，criticalPath 返回第一个温度点的关键路径
+    double estimateDurationSec(const QVector<float> &bbPoints, QStringList *criticalPath = nullptr) const;
+
+    // 流水线模式：最后一个测温仪驻留结束前 seconds 秒开始把恒温箱切到下一温度点，
+    // 本温度点测完后立即下发黑体炉下一设定值。0 表示关闭
+    void setPipelineLeadTime(int seconds);
+    int pipelineLeadTime() const { return m_pipelineLeadSeconds; }
+    // 测量期间允许恒温箱预设的最大温度跨度（℃），<=0 表示不限制
+    void setPreRampMaxChamberStep(float degrees);
+
+    // 黑体炉设定值整形（默认关闭，由 [setpoint_shaping] 配置）
+    SetpointShaper *setpointShaper() const { return m_shaper; }
+
 signals:
     void calibrationFinished(const QVector<CalibrationRecord> &calibrationData);
     void errorOccurred(const QString &error);
@@ -95,6 +121,8 @@ signals:
     void irMeasurementStarted(const QString &currentComPort);
     void irMeasurementStopped();
     void requestIrAverage(const QString& comPort, QObject* receiver);
+    void planEstimateUpdated(double totalSec, const QStringList &criticalPath);
+    void planStageFinished(const QString &nodeId, qint64 actualMs, double expectedSec);
 
 private slots:
     void checkStability(int index);
@@ -110,6 +138,9 @@ private slots:
     void onSensorStabilizeTimeout();
     void onSamplingTimerTimeout();
     void onServoTimeout(); // 【新增】电机移动超时处理槽函数
+    void onPlanNodeReady(int node);
+    void onPlanFinished(qint64 totalMs);
+    void onPreRampTimeout();
 
 private:
     BlackbodyController *m_blackbodyController;
@@ -126,14 +157,17 @@ private:
     QVector<CalibrationRecord> m_calibrationData;
 
     QString m_currentReportFileName;
+    QString m_reportDirectory;
     QString m_environmentType;
 
-    QTimer m_stabilityTimer;
-    QTimer m_sensorStabilizeTimer;
-    QTimer m_countdownTimer;
-    QTimer m_waitNextMinuteTimer;
-    QTimer m_samplingTimer;
-    QTimer m_servoTimeoutTimer; // 【新增】电机超时定时器
+    // 所有计时均经由时钟服务，便于在虚拟时间下仿真
+    CalibrationClock *m_clock;
+    CalibrationTimer *m_stabilityTimer;
+    CalibrationTimer *m_sensorStabilizeTimer;
+    CalibrationTimer *m_countdownTimer;
+    CalibrationTimer *m_waitNextMinuteTimer;
+    CalibrationTimer *m_samplingTimer;
+    CalibrationTimer *m_servoTimeoutTimer; // 【新增】电机超时定时器
 
     QVector<float> m_bbRealtimeSamples;
     QVector<float> m_stabilitySamples;
@@ -162,8 +196,49 @@ private:
 
     BatchReferenceData m_currentBatchData;
 
+    // 稳定判据与驻留参数（计划中的阶段参数会覆盖这些默认值）
+    struct StabilityCriteria {
+        int windowSamples = 150;
+        int intervalSec = 2;
+        float maxDeviation = 1.0f;
+        float maxFluctuation = 0.1f;
+    };
+    StabilityCriteria m_stabilityCriteria;
+    int m_dwellSeconds = 5 * 60;
+    int m_servoTimeoutMs = 0;         // 计划中显式配置的 servoTimeoutSec，0 表示按速度曲线推算
+    int m_activeServoTimeoutMs = 0;   // 本次转动使用的超时（暂停恢复时沿用）
+
+    // 声明式流程
+    PlanEngine *m_planEngine;
+    CalibrationPlan m_plan;
+    bool m_usePlan = false;
+    int m_stableNode = -1;   // 正在执行的 waitStable 节点
+    int m_alignNode = -1;    // 正在执行的 alignMinute 节点
+    int m_measureNode = -1;  // 正在执行的 measureSensor 节点
+    QVector<int> m_deferredPlanNodes; // 暂停期间到期的 delay 节点
+    void presetNextPoint(int node);
+
+    // 流水线预切换
+    CalibrationTimer *m_preRampTimer;
+    int m_pipelineLeadSeconds = 0;
+    float m_preRampMaxChamberStep = 20.0f;
+    QDateTime m_preRampDue;
+    bool m_preRampPending = false;
+    bool preRampNextPoint(const QString &device, bool measurementDone, QString *reason);
+
+    // 设定值整形：黑体炉设定值统一经由 m_shaper 下发
+    SetpointShaper *m_shaper;
+    QVector<SetpointShaper::SettleReport> m_settleReports;
+    void setBlackbodyTarget(float temperature, int pointIndex);
+    void onSettleReported(const SetpointShaper::SettleReport &report);
+
     void startSensorSequence();
+    void setStage(PausedStage stage);
+    void updatePollProfile();
     void processCurrentTask();
+    // 按转台速度曲线预测每个 measureSensor 节点的转动耗时，填入未显式配置的 servoSec
+    void fillServoEstimates(QVector<PlanNode> *nodes) const;
+    double slotAngle(int taskIndex) const;
     void finishSequence();
 };
 
@@ -0,0 +1,302 @@
+#include "calibrationplan.h"
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QtMath>
+
+namespace {
+
+// Kahn 拓扑排序；存在环路时返回 false
+bool topologicalOrder(const QVector<PlanNode> &nodes, QVector<int> *order)
+{
+    QVector<int> inDegree(nodes.size(), 0);
+    QVector<QVector<int>> successors(nodes.size());
+    for (int i = 0; i < nodes.size(); ++i) {
+        for (const PlanDependency &dep : nodes[i].deps) {
+            successors[dep.node].append(i);
+            ++inDegree[i];
+        }
+    }
+
+    order->clear();
+    for (int i = 0; i < nodes.size(); ++i) {
+        if (inDegree[i] == 0) order->append(i);
+    }
+    for (int k = 0; k < order->size(); ++k) {
+        for (int next : successors[order->at(k)]) {
+            if (--inDegree[next] == 0) order->append(next);
+        }
+    }
+    return order->size() == nodes.size();
+}
+
+} // namespace
+
+const QStringList &CalibrationPlan::knownActions()
+{
+    static const QStringList actions = {
+        "setpoint",      // 下发本温度点黑体炉/恒温箱设定值并启动
+        "servoZero",     // 转台回零
+        "waitStable",    // 等待黑体炉稳定
+        "openWindow",    // 打开恒温箱标定窗口
+        "closeWindow",   // 关闭恒温箱标定窗口
+        "alignMinute",   // 对齐到下一整分钟，记录本批次基准
+        "measureSensor", // 转到测温仪位置 → 驻留 → 求平均 → 记录
+        "saveReport",    // 保存中间测量记录
+        "delay",         // 纯延时
+        "presetNext"     // 提前把空闲设备切到下一温度点设定值
+    };
+    return actions;
+}
+
+bool CalibrationPlan::loadFromFile(const QString &path, CalibrationPlan *plan, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("无法打开流程文件：%1").arg(path);
+        return false;
+    }
+    return fromJson(file.readAll(), plan, error);
+}
+
+bool CalibrationPlan::fromJson(const QByteArray &json, CalibrationPlan *plan, QString *error)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        if (error) *error = QString("流程文件格式错误：%1").arg(parseError.errorString());
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    CalibrationPlan result;
+    result.name = root.value("name").toString();
+
+    const QJsonArray stages = root.value("stages").toArray();
+    if (stages.isEmpty()) {
+        if (error) *error = "流程文件中没有任何阶段 (stages)";
+        return false;
+    }
+
+    for (const QJsonValue &value : stages) {
+        QJsonObject obj = value.toObject();
+        PlanStage stage;
+        stage.id = obj.value("id").toString().trimmed();
+        stage.action = obj.value("action").toString().trimmed();
+        stage.delaySec = obj.value("delaySec").toDouble(0.0);
+        stage.forEach = obj.value("forEach").toString();
+        stage.params = obj.value("params").toObject().toVariantMap();
+        stage.expectedSec = obj.value("expectedSec").toDouble(-1.0);
+
+        QJsonValue after = obj.value("after");
+        if (after.isString()) {
+            stage.after.append(after.toString());
+        } else {
+            for (const QJsonValue &dep : after.toArray()) {
+                stage.after.append(dep.toString());
+            }
+        }
+        result.stages.append(stage);
+    }
+
+    // 用一个测温仪试展开，提前暴露引用和环路错误
+    QVector<PlanNode> nodes;
+    if (!result.expand(1, &nodes, error)) return false;
+
+    *plan = result;
+    return true;
+}
+
+CalibrationPlan CalibrationPlan::defaultPlan()
+{
+    CalibrationPlan plan;
+    plan.name = "默认流程";
+
+    auto add = [&plan](const QString &id, const QString &action, const QStringList &after,
+                       const QVariantMap &params = QVariantMap(), const QString &forEach = QString()) {
+        PlanStage stage;
+        stage.id = id;
+        stage.action = action;
+        stage.after = after;
+        stage.params = params;
+        stage.forEach = forEach;
+        plan.stages.append(stage);
+    };
+
+    add("setpoint", "setpoint", {});
+    add("servoHome", "servoZero", {"setpoint"});
+    add("stability", "waitStable", {"setpoint"},
+        {{"windowSamples", 150}, {"intervalSec", 2}, {"maxDeviation", 1.0}, {"maxFluctuation", 0.1},
+         {"rampRatePerMin", 1.0}});
+    add("openWindow", "openWindow", {"stability"});
+    add("alignMinute", "alignMinute", {"openWindow"});
+    add("measure", "measureSensor", {"alignMinute"},
+        {{"dwellSec", 300}}, "sensor");
+    add("saveReport", "saveReport", {"measure"});
+    add("closeWindow", "closeWindow", {"saveReport"});
+    add("servoReturn", "servoZero", {"closeWindow"});
+    add("settle", "delay", {"servoReturn"}, {{"sec", 5}});
+    return plan;
+}
+
+bool CalibrationPlan::expand(int sensorCount, QVector<PlanNode> *nodes, QString *error) const
+{
+    auto fail = [error](const QString &msg) {
+        if (error) *error = msg;
+        return false;
+    };
+
+    nodes->clear();
+    QHash<QString, QVector<int>> stageNodes;
+
+    // 1. 生成节点
+    for (const PlanStage &stage : stages) {
+        if (stage.id.isEmpty()) return fail("存在未命名的阶段");
+        if (stageNodes.contains(stage.id)) return fail(QString("阶段名重复：%1").arg(stage.id));
+        if (!knownActions().contains(stage.action)) {
+            return fail(QString("阶段 %1 使用了未知动作：%2").arg(stage.id, stage.action));
+        }
+        if (!stage.forEach.isEmpty() && stage.forEach != "sensor") {
+            return fail(QString("阶段 %1 的 forEach 只支持 \"sensor\"").arg(stage.id));
+        }
+
+        int instances = stage.forEach.isEmpty() ? 1 : sensorCount;
+        QVector<int> &indices = stageNodes[stage.id];
+        for (int i = 0; i < instances; ++i) {
+            PlanNode node;
+            node.stageId = stage.id;
+            node.action = stage.action;
+            node.params = stage.params;
+            node.delaySec = stage.delaySec;
+            node.expectedSec = stage.expectedSec;
+            if (stage.forEach.isEmpty()) {
+                node.id = stage.id;
+            } else {
+                node.sensorIndex = i;
+                node.id = QString("%1[%2]").arg(stage.id).arg(i + 1);
+            }
+            indices.append(nodes->size());
+            nodes->append(node);
+        }
+    }
+
+    // 2. 解析依赖引用：id、id[first|last|k]，可带 ":start"
+    static const QRegularExpression refPattern("^([^\\[\\]:]+)(?:\\[(first|last|\\d+)\\])?(:start)?$");
+    for (const PlanStage &stage : stages) {
+        const QVector<int> &own = stageNodes[stage.id];
+        for (const QString &ref : stage.after) {
+            QRegularExpressionMatch match = refPattern.match(ref.trimmed());
+            if (!match.hasMatch()) return fail(QString("阶段 %1 的依赖格式错误：%2").arg(stage.id, ref));
+
+            QString target = match.captured(1);
+            QString selector = match.captured(2);
+            bool onStart = !match.captured(3).isEmpty();
+            if (!stageNodes.contains(target)) {
+                return fail(QString("阶段 %1 依赖了不存在的阶段：%2").arg(stage.id, target));
+            }
+            if (target == stage.id) return fail(QString("阶段 %1 不能依赖自身").arg(stage.id));
+
+            const QVector<int> &targets = stageNodes[target];
+            QVector<int> selected;
+            if (selector.isEmpty()) {
+                selected = targets;
+            } else if (targets.isEmpty()) {
+                // 测温仪队列为空时 forEach 阶段没有实例，引用自动满足
+            } else if (selector == "first") {
+                selected.append(targets.first());
+            } else if (selector == "last") {
+                selected.append(targets.last());
+            } else {
+                int k = selector.toInt();
+                if (k < 1 || k > targets.size()) {
+                    return fail(QString("阶段 %1 引用的 %2 超出测温仪数量 %3").arg(stage.id, ref).arg(targets.size()));
+                }
+                selected.append(targets[k - 1]);
+            }
+
+            for (int nodeIndex : own) {
+                for (int dep : selected) {
+                    (*nodes)[nodeIndex].deps.append({dep, onStart});
+                }
+            }
+        }
+
+        // forEach 实例共用转台，必须串行
+        for (int i = 1; i < own.size(); ++i) {
+            (*nodes)[own[i]].deps.append({own[i - 1], false});
+        }
+    }
+
+    // 3. 检查环路
+    QVector<int> order;
+    if (!topologicalOrder(*nodes, &order)) return fail("流程中存在循环依赖");
+    return true;
+}
+
+double CalibrationPlan::expectedNodeSec(const PlanNode &node, double deltaTemp)
+{
+    if (node.expectedSec >= 0.0) return node.expectedSec;
+
+    const QVariantMap &p = node.params;
+    if (node.action == "delay") {
+        return p.value("sec", 0).toDouble();
+    }
+    if (node.action == "measureSensor") {
+        // servoSec 未配置时由 CalibrationManager 按转台速度曲线填入
+        return p.value("dwellSec", 300).toDouble() + p.value("servoSec", 10).toDouble();
+    }
+    if (node.action == "alignMinute") {
+        return 30.0; // 平均等待半分钟
+    }
+    if (node.action == "waitStable") {
+        double window = p.value("windowSamples", 150).toDouble() * p.value("intervalSec", 2).toDouble();
+        double rate = p.value("rampRatePerMin", 0).toDouble();
+        double ramp = (rate > 0.0) ? qAbs(deltaTemp) / rate * 60.0 : 0.0;
+        return ramp + window;
+    }
+    return 0.0;
+}
+
+PlanEstimate CalibrationPlan::estimate(const QVector<PlanNode> &nodes, double deltaTemp)
+{
+    PlanEstimate result;
+    QVector<int> order;
+    if (!topologicalOrder(nodes, &order)) return result;
+
+    const int n = nodes.size();
+    result.startSec.fill(0.0, n);
+    result.finishSec.fill(0.0, n);
+    QVector<int> critical(n, -1);     // 决定本节点开始时间的前驱
+    QVector<bool> criticalOnStart(n, false);
+
+    for (int i : order) {
+        double ready = 0.0;
+        for (const PlanDependency &dep : nodes[i].deps) {
+            double t = dep.onStart ? result.startSec[dep.node] : result.finishSec[dep.node];
+            if (t >= ready) {
+                ready = t;
+                critical[i] = dep.node;
+                criticalOnStart[i] = dep.onStart;
+            }
+        }
+        result.startSec[i] = ready + nodes[i].delaySec;
+        result.finishSec[i] = result.startSec[i] + expectedNodeSec(nodes[i], deltaTemp);
+    }
+
+    int last = -1;
+    for (int i = 0; i < n; ++i) {
+        if (last < 0 || result.finishSec[i] > result.finishSec[last]) last = i;
+    }
+    if (last < 0) return result;
+
+    result.totalSec = result.finishSec[last];
+    bool onStart = false;
+    for (int i = last; i >= 0; i = critical[i]) {
+        result.criticalPath.prepend(onStart ? nodes[i].id + ":start" : nodes[i].id);
+        onStart = criticalOnStart[i];
+    }
+    return result;
+}
@@ -0,0 +1,91 @@
+#ifndef CALIBRATIONPLAN_H
+#define CALIBRATIONPLAN_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+// ===================== 声明式标校流程 =====================
+// 一个温度点内要执行的阶段以 JSON 描述，阶段之间通过 after 构成有向无环图：
+//   "after": ["stability"]          等待 stability 完成
+//   "after": ["measure[last]:start"] 等待最后一个测温仪的测量阶段开始
+// forEach 为 "sensor" 的阶段按测温仪队列展开成串行实例 measure[1]..measure[N]，
+// 引用时可写 measure（全部完成）、measure[first]、measure[last] 或 measure[k]（从1开始）
+//
+// 示例：
+// {
+//   "name": "默认流程",
+//   "stages": [
+//     {"id": "setpoint",  "action": "setpoint"},
+//     {"id": "stability", "action": "waitStable", "after": ["setpoint"],
+//      "params": {"windowSamples": 150, "intervalSec": 2, "maxDeviation": 1.0, "maxFluctuation": 0.1}},
+//     {"id": "measure",   "action": "measureSensor", "forEach": "sensor", "after": ["stability"],
+//      "params": {"dwellSec": 300}}
+//   ]
+// }
+
+struct PlanStage {
+    QString id;
+    QString action;
+    QStringList after;          // 依赖的阶段引用
+    double delaySec = 0.0;      // 依赖满足后再延时多久开始
+    QString forEach;            // 为 "sensor" 时按测温仪展开
+    QVariantMap params;         // 动作参数
+    double expectedSec = -1.0;  // 预计耗时（秒），<0 时按动作参数推算
+};
+
+// 展开后的依赖：等待节点 node 完成（onStart 为 true 时只需等待其开始）
+struct PlanDependency {
+    int node = -1;
+    bool onStart = false;
+};
+
+// 展开后的执行节点
+struct PlanNode {
+    QString id;                 // 如 "measure[3]"
+    QString stageId;
+    QString action;
+    int sensorIndex = -1;       // forEach 实例对应的任务队列下标
+    double delaySec = 0.0;
+    double expectedSec = -1.0;
+    QVariantMap params;
+    QVector<PlanDependency> deps;
+};
+
+// 关键路径分析结果（单个温度点）
+struct PlanEstimate {
+    double totalSec = 0.0;
+    QStringList criticalPath;   // 关键路径上的节点，依赖于开始时间的节点带 ":start"
+    QVector<double> startSec;   // 每个节点的最早开始时间
+    QVector<double> finishSec;  // 每个节点的最早完成时间
+};
+
+class CalibrationPlan
+{
+public:
+    QString name;
+    QVector<PlanStage> stages;
+
+    bool isEmpty() const { return stages.isEmpty(); }
+
+    static bool loadFromFile(const QString &path, CalibrationPlan *plan, QString *error);
+    static bool fromJson(const QByteArray &json, CalibrationPlan *plan, QString *error);
+
+    // 与原有硬编码流程完全等价的内置计划
+    static CalibrationPlan defaultPlan();
+
+    // 引擎支持的动作
+    static const QStringList &knownActions();
+
+    // 按测温仪数量展开为节点图，并检查引用、动作名和环路
+    bool expand(int sensorCount, QVector<PlanNode> *nodes, QString *error) const;
+
+    // 单个节点的预计耗时；deltaTemp 为本温度点黑体炉需要变化的温度
+    static double expectedNodeSec(const PlanNode &node, double deltaTemp);
+
+    // 关键路径：各节点按依赖关系尽早开始时，一个温度点的总耗时
+    static PlanEstimate estimate(const QVector<PlanNode> &nodes, double deltaTemp);
+};
+
+#endif // CALIBRATIONPLAN_H
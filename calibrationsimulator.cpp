@@ -0,0 +1,241 @@
+#include "calibrationsimulator.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cmath>
+
+namespace {
+const int kModelStepMs = 1000; // 热模型积分步长
+}
+
+// ===================== SimulatedThermalModel =====================
+void SimulatedThermalModel::step(double dtSec, QRandomGenerator &rng)
+{
+    double target = running ? setpoint : ambient;
+    double alpha = (tauSec > 0.0) ? 1.0 - std::exp(-dtSec / tauSec) : 1.0;
+    value += (target - value) * alpha;
+    // 噪声只叠加在读数上，不累积进模型状态
+    measured = value + (rng.generateDouble() * 2.0 - 1.0) * noise;
+}
+
+// ===================== SimulatedBlackbody =====================
+SimulatedBlackbody::SimulatedBlackbody(CalibrationClock *clock, const SimulatedThermalModel &model,
+                                       quint32 seed, QObject *parent)
+    : BlackbodyController(parent), m_stepTimer(clock->createTimer(this)), m_model(model), m_rng(seed)
+{
+    connect(m_stepTimer, &CalibrationTimer::timeout, this, [this]() {
+        m_model.step(kModelStepMs / 1000.0, m_rng);
+        emit currentTemperatureUpdated(getCurrentTemperature());
+    });
+    m_stepTimer->start(kModelStepMs);
+}
+
+void SimulatedBlackbody::setMasterControl(bool enable)
+{
+    emit masterControlChanged(enable);
+}
+
+void SimulatedBlackbody::setTargetTemperature(float temperature)
+{
+    m_model.setpoint = temperature;
+    emit targetTemperatureSet(true);
+}
+
+void SimulatedBlackbody::readCurrentTemperature()
+{
+    emit currentTemperatureUpdated(getCurrentTemperature());
+}
+
+void SimulatedBlackbody::setDeviceState(bool start)
+{
+    m_model.running = start;
+}
+
+// ===================== SimulatedChamber =====================
+SimulatedChamber::SimulatedChamber(CalibrationClock *clock, const SimulatedThermalModel &model,
+                                   quint32 seed, QObject *parent)
+    : HumidityController(parent), m_stepTimer(clock->createTimer(this)), m_model(model), m_rng(seed)
+{
+    connect(m_stepTimer, &CalibrationTimer::timeout, this, [this]() {
+        m_model.step(kModelStepMs / 1000.0, m_rng);
+        emit currentTemperatureUpdated(getCurrentTemperature());
+    });
+    m_stepTimer->start(kModelStepMs);
+}
+
+void SimulatedChamber::setTargetTemperature(float temperature)
+{
+    m_model.setpoint = temperature;
+    emit targetTemperatureSet(true);
+}
+
+void SimulatedChamber::setDeviceState(bool start)
+{
+    m_model.running = start;
+}
+
+void SimulatedChamber::setMasterControl(bool enable)
+{
+    emit masterControlChanged(enable);
+}
+
+void SimulatedChamber::toggleCalibrationWindow(bool open)
+{
+    m_windowOpen = open;
+}
+
+// ===================== SimulatedServo =====================
+SimulatedServo::SimulatedServo(CalibrationClock *clock, double degreesPerSecond, QObject *parent)
+    : ServoMotorController(parent), m_moveTimer(clock->createTimer(this)),
+    m_degreesPerSecond(qMax(1.0, degreesPerSecond))
+{
+    m_moveTimer->setSingleShot(true);
+    connect(m_moveTimer, &CalibrationTimer::timeout, this, [this]() {
+        m_angle = m_targetAngle;
+        emit positionReached();
+    });
+}
+
+void SimulatedServo::resetZeroPoint()
+{
+    m_moveTimer->stop();
+    m_angle = 0.0;
+    m_targetAngle = 0.0;
+    emit zeroPointReset(true);
+}
+
+void SimulatedServo::moveRelative(double angle)
+{
+    startMove(m_angle + angle);
+}
+
+void SimulatedServo::moveToAbsolute(double angle)
+{
+    // 与实机一致：按最短方向转到圈内目标
+    startMove(m_angle + plannedMoveAngle(angle));
+}
+
+void SimulatedServo::startMove(double angle)
+{
+    m_targetAngle = angle;
+    double delta = qAbs(angle - m_angle);
+    if (delta <= 0.01) {
+        emit positionReached();
+        return;
+    }
+    // 匀速近似，另加 100ms 到位确认（对应实机预计到位附近 100ms 密集查询）
+    int predictedMs = predictedMoveMs(delta);
+    m_moveTimer->start(predictedMs + 100);
+    emit moveStarted(predictedMs);
+}
+
+int SimulatedServo::predictedMoveMs(double angle) const
+{
+    return static_cast<int>(qAbs(angle) / m_degreesPerSecond * 1000.0);
+}
+
+void SimulatedServo::stop()
+{
+    m_moveTimer->stop();
+}
+
+// ===================== CalibrationSimulation =====================
+CalibrationSimulation::CalibrationSimulation(const Config &config, QObject *parent)
+    : QObject(parent), m_config(config), m_rng(config.seed)
+{
+    m_clock = new SimulatedClock(QDateTime::currentDateTime(), this);
+    m_blackbody = new SimulatedBlackbody(m_clock, config.blackbody, config.seed + 1, this);
+    m_chamber = new SimulatedChamber(m_clock, config.chamber, config.seed + 2, this);
+    m_servo = new SimulatedServo(m_clock, config.servoDegreesPerSecond, this);
+
+    m_manager = new CalibrationManager(m_blackbody, m_chamber, this, m_clock);
+    m_manager->setServoController(m_servo);
+    m_manager->setReportDirectory(config.reportDirectory);
+    if (!config.plan.isEmpty()) m_manager->setPlan(config.plan);
+    m_manager->setPipelineLeadTime(config.pipelineLeadSec);
+    m_manager->setpointShaper()->setEnabled(config.setpointShaping);
+
+    // 与 MainWindow 相同：直接回调 onIrAverageReceived
+    connect(m_manager, &CalibrationManager::requestIrAverage,
+            this, [this](const QString &comPort, QObject *receiver) {
+                auto *manager = qobject_cast<CalibrationManager *>(receiver);
+                if (manager) {
+                    manager->onIrAverageReceived(comPort, syntheticIrData(comPort));
+                }
+            });
+}
+
+CalibrationManager::InfraredData CalibrationSimulation::syntheticIrData(const QString &comPort)
+{
+    Q_UNUSED(comPort);
+    // 红外读数 = 黑体炉温度 + 小幅偏差，环境温度取恒温箱温度
+    CalibrationManager::InfraredData data;
+    data.type = "单头";
+    float bb = m_blackbody->getCurrentTemperature();
+    float ambient = m_chamber->getCurrentTemperature();
+    float offset = static_cast<float>(m_rng.generateDouble() * 0.4 - 0.2);
+    data.toAvgs = {bb + offset};
+    data.taAvgs = {ambient};
+    data.lcAvgs = {bb + offset};
+    return data;
+}
+
+CalibrationSimulation::Result CalibrationSimulation::run()
+{
+    Result result;
+
+    QVector<SensorTask> queue;
+    for (int pos = 1; pos <= m_config.sensorCount; ++pos) {
+        queue.append({QString("SIM%1").arg(pos), pos});
+    }
+    m_manager->setMeasurementQueue(queue);
+
+    // 恒温箱温度点生成规则与 MainWindow::onStartCalibrationClicked 一致
+    QVector<float> humidityPoints;
+    bool isInside = (m_config.envType == "箱内");
+    for (float t : m_config.modelingPoints + m_config.verifyPoints) {
+        humidityPoints.append(isInside ? t : 25.0f);
+    }
+
+    bool done = false;
+    QVector<CalibrationManager::CalibrationRecord> records;
+    QMetaObject::Connection finishedConn = connect(m_manager, &CalibrationManager::calibrationFinished, this,
+                                                   [&](const QVector<CalibrationManager::CalibrationRecord> &data) {
+                                                       records = data;
+                                                       result.finished = true;
+                                                       done = true;
+                                                   });
+    QMetaObject::Connection errorConn = connect(m_manager, &CalibrationManager::errorOccurred, this,
+                                                [&](const QString &error) {
+                                                    result.error = error;
+                                                    done = true;
+                                                });
+    QMetaObject::Connection progressConn = connect(m_manager, &CalibrationManager::calibrationProgress, this,
+                                                   [&](int progress) {
+                                                       if (progress > 0) result.pointFinishedMs.append(m_clock->elapsedMs());
+                                                   });
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+
+    m_manager->startCalibration(m_config.modelingPoints, m_config.verifyPoints, humidityPoints, m_config.envType);
+    if (!done) {
+        m_clock->runUntil([&]() { return done; }, m_config.maxVirtualMs);
+    }
+
+    result.wallMs = wallTimer.elapsed();
+    result.virtualMs = m_clock->elapsedMs();
+    result.events = m_clock->firedEventCount();
+    result.records = records.size();
+    result.recordData = records;
+    if (!done && result.error.isEmpty()) {
+        result.error = "仿真未在限定虚拟时长内完成";
+    }
+
+    disconnect(finishedConn);
+    disconnect(errorConn);
+    disconnect(progressConn);
+
+    qDebug() << "仿真结束：虚拟耗时" << result.virtualMs / 1000 << "秒，实际耗时" << result.wallMs
+             << "ms，事件数" << result.events << "，记录数" << result.records;
+    return result;
+}
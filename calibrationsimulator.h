@@ -0,0 +1,152 @@
+#ifndef CALIBRATIONSIMULATOR_H
+#define CALIBRATIONSIMULATOR_H
+
+#include <QObject>
+#include <QRandomGenerator>
+#include "BlackbodyController.h"
+#include "humiditycontroller.h"
+#include "servomotorcontroller.h"
+#include "calibrationmanager.h"
+#include "calibrationclock.h"
+
+// 一阶热惯性模型：温度按时间常数 tau 逼近设定值，读数叠加均匀噪声
+struct SimulatedThermalModel {
+    double value = 25.0;       // 当前真实温度
+    double measured = 25.0;    // 最近一次读数（含噪声）
+    double setpoint = 25.0;    // 设定温度
+    double ambient = 25.0;     // 设备停止时回落到的环境温度
+    double tauSec = 300.0;     // 时间常数（秒）
+    double noise = 0.02;       // 噪声幅值（±℃）
+    bool running = false;
+
+    void step(double dtSec, QRandomGenerator &rng);
+};
+
+// ===================== 仿真黑体炉 =====================
+class SimulatedBlackbody : public BlackbodyController
+{
+    Q_OBJECT
+public:
+    SimulatedBlackbody(CalibrationClock *clock, const SimulatedThermalModel &model,
+                       quint32 seed, QObject *parent = nullptr);
+
+    bool isConnected() const override { return true; }
+    void setMasterControl(bool enable) override;
+    void setTargetTemperature(float temperature) override;
+    void readCurrentTemperature() override;
+    void setDeviceState(bool start) override;
+    float getCurrentTemperature() const override { return static_cast<float>(m_model.measured); }
+
+    const SimulatedThermalModel &model() const { return m_model; }
+
+private:
+    CalibrationTimer *m_stepTimer;
+    SimulatedThermalModel m_model;
+    QRandomGenerator m_rng;
+};
+
+// ===================== 仿真恒温箱 =====================
+class SimulatedChamber : public HumidityController
+{
+    Q_OBJECT
+public:
+    SimulatedChamber(CalibrationClock *clock, const SimulatedThermalModel &model,
+                     quint32 seed, QObject *parent = nullptr);
+
+    bool isConnected() const override { return true; }
+    void setTargetTemperature(float temperature) override;
+    void setDeviceState(bool start) override;
+    void setMasterControl(bool enable) override;
+    void toggleCalibrationWindow(bool open) override;
+    float getCurrentTemperature() const override { return static_cast<float>(m_model.measured); }
+    float getCurrentHumidity() const override { return 40.0f; }
+
+    bool isWindowOpen() const { return m_windowOpen; }
+    const SimulatedThermalModel &model() const { return m_model; }
+
+private:
+    CalibrationTimer *m_stepTimer;
+    SimulatedThermalModel m_model;
+    QRandomGenerator m_rng;
+    bool m_windowOpen = false;
+};
+
+// ===================== 仿真转台 =====================
+class SimulatedServo : public ServoMotorController
+{
+    Q_OBJECT
+public:
+    SimulatedServo(CalibrationClock *clock, double degreesPerSecond, QObject *parent = nullptr);
+
+    bool isConnected() const override { return true; }
+    void resetZeroPoint() override;
+    void moveRelative(double angle) override;
+    void moveToAbsolute(double angle) override;
+    void moveToZero() override { moveToAbsolute(0.0); }
+    void stop() override;
+    double currentAngle() const override { return m_angle; }
+    int predictedMoveMs(double angle) const override;
+    double plannedMoveAngleFrom(double fromAngle, double targetAngle) const override { return shortestRotation(fromAngle, targetAngle); }
+
+private:
+    void startMove(double targetAngle);
+
+    CalibrationTimer *m_moveTimer;
+    double m_degreesPerSecond;
+    double m_angle = 0.0;
+    double m_targetAngle = 0.0;
+};
+
+// ===================== 整站仿真 =====================
+// 在虚拟时钟下驱动 CalibrationManager 跑完完整标校流程，用于评估计划耗时和回归测试流程逻辑
+class CalibrationSimulation : public QObject
+{
+    Q_OBJECT
+public:
+    struct Config {
+        QVector<float> modelingPoints;
+        QVector<float> verifyPoints;
+        QString envType = "箱内";           // "箱内" 恒温箱跟随黑体炉，"箱外" 恒温箱固定25℃
+        int sensorCount = 10;               // 测温仪数量（位置 1..N）
+        SimulatedThermalModel blackbody;
+        SimulatedThermalModel chamber;
+        double servoDegreesPerSecond = 30.0;
+        QString reportDirectory;            // 中间/最终测量记录保存目录
+        CalibrationPlan plan;               // 为空时使用内置流程
+        int pipelineLeadSec = 0;            // 流水线预切换提前量（秒），0 表示关闭
+        bool setpointShaping = false;       // 黑体炉设定值整形（首个阶跃用于辨识模型）
+        qint64 maxVirtualMs = 7LL * 24 * 3600 * 1000;
+        quint32 seed = 1;
+    };
+
+    struct Result {
+        bool finished = false;              // 是否正常走完全部温度点
+        qint64 virtualMs = 0;               // 虚拟耗时
+        qint64 wallMs = 0;                  // 实际耗时
+        quint64 events = 0;                 // 触发的定时事件数
+        int records = 0;                    // 生成的测量记录条数
+        QVector<CalibrationManager::CalibrationRecord> recordData; // 全部测量记录（按测量顺序）
+        QVector<qint64> pointFinishedMs;    // 每个温度点完成时的虚拟时间
+        QString error;
+    };
+
+    explicit CalibrationSimulation(const Config &config, QObject *parent = nullptr);
+
+    Result run();
+
+    SimulatedClock *clock() const { return m_clock; }
+    CalibrationManager *manager() const { return m_manager; }
+
+private:
+    CalibrationManager::InfraredData syntheticIrData(const QString &comPort);
+
+    Config m_config;
+    SimulatedClock *m_clock;
+    SimulatedBlackbody *m_blackbody;
+    SimulatedChamber *m_chamber;
+    SimulatedServo *m_servo;
+    CalibrationManager *m_manager;
+    QRandomGenerator m_rng;
+};
+
+#endif // CALIBRATIONSIMULATOR_H
@@ -0,0 +1,42 @@
+# 标校流程仿真回归（独立程序，不依赖主工程界面）；默认跑内置流程，--plan 指定计划文件
+# 在虚拟时钟和仿真黑体炉/恒温箱/转台上跑完多温度点、多测温仪的完整流程，几秒内结束，
+# 检查记录数、记录顺序和虚拟耗时，并输出计划耗时估算，用于 CI 回归和计划时长对比
+QT = core gui widgets serialport serialbus
+
+include(../QXlsx/QXlsx.pri)
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = calibsim
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../blackbodycontroller.cpp \
+    ../calibrationclock.cpp \
+    ../calibrationmanager.cpp \
+    ../calibrationplan.cpp \
+    ../calibrationsimulator.cpp \
+    ../humiditycontroller.cpp \
+    ../modbusbusmanager.cpp \
+    ../modbuslinkstats.cpp \
+    ../modbustransactionscheduler.cpp \
+    ../planengine.cpp \
+    ../setpointshaper.cpp \
+    ../servomotorcontroller.cpp \
+    main.cpp
+
+HEADERS += \
+    ../BlackbodyController.h \
+    ../calibrationclock.h \
+    ../calibrationmanager.h \
+    ../calibrationplan.h \
+    ../calibrationsimulator.h \
+    ../humiditycontroller.h \
+    ../modbusbusmanager.h \
+    ../modbuslinkstats.h \
+    ../modbustransactionscheduler.h \
+    ../planengine.h \
+    ../setpointshaper.h \
+    ../servomotorcontroller.h
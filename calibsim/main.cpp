@@ -0,0 +1,164 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include "calibrationplan.h"
+#include "calibrationsimulator.h"
+
+// 用法：
+//   calibsim                                   内置流程、6 个建模点 + 2 个验证点、10 个测温仪
+//   calibsim --lead 600 --shaping              内置流程，开启流水线预切换和设定值整形
+//   calibsim --plan ../plans/default_plan.json 按计划文件执行（预切换只在内置流程中生效，不能与 --lead 同用）
+// 在虚拟时钟和仿真设备上跑完整个标校流程（通常几秒内结束），然后检查：
+//   记录数    = 温度点数 × 测温仪数
+//   记录顺序  温度点按建模、验证的输入顺序，点内位置 1..N 依次测量，测量时间不倒退
+//   虚拟耗时  不少于各点驻留时间之和，且不超过 --max-hours
+// 同时给出关键路径估算的计划耗时，便于比较计划改动前后的总时长。全部通过返回 0，否则返回 2
+namespace {
+QVector<float> parsePoints(const QString &text)
+{
+    QVector<float> points;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const float value = part.trimmed().toFloat(&ok);
+        if (ok) points.append(value);
+    }
+    return points;
+}
+
+double measureDwellSec(const CalibrationPlan &plan)
+{
+    for (const PlanStage &stage : plan.stages) {
+        if (stage.action == "measureSensor") return stage.params.value("dwellSec", 300.0).toDouble();
+    }
+    return 300.0;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("calibsim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("在虚拟时钟下仿真完整标校流程，检查记录和计划耗时");
+    parser.addHelpOption();
+    QCommandLineOption modelingOption("modeling", "建模温度点（逗号分隔）", "points", "-25,-10,0,30,50,70");
+    QCommandLineOption verifyOption("verify", "验证温度点（逗号分隔）", "points", "-20,40");
+    QCommandLineOption sensorsOption("sensors", "测温仪数量", "count", "10");
+    QCommandLineOption envOption("env", "箱内 或 箱外", "type", "箱内");
+    QCommandLineOption planOption("plan", "计划 JSON，不指定时按内置流程执行", "file");
+    QCommandLineOption leadOption("lead", "流水线预切换提前量（秒），0 为关闭；仅内置流程", "sec", "0");
+    QCommandLineOption shapingOption("shaping", "启用黑体炉设定值整形");
+    QCommandLineOption maxHoursOption("max-hours", "虚拟耗时上限（小时）", "hours", "72");
+    QCommandLineOption seedOption("seed", "随机种子", "seed", "1");
+    parser.addOptions({modelingOption, verifyOption, sensorsOption, envOption, planOption,
+                       leadOption, shapingOption, maxHoursOption, seedOption});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTemporaryDir reportDir;
+    if (!reportDir.isValid()) {
+        out << "无法创建临时报告目录\n";
+        return 1;
+    }
+
+    CalibrationSimulation::Config config;
+    config.modelingPoints = parsePoints(parser.value(modelingOption));
+    config.verifyPoints = parsePoints(parser.value(verifyOption));
+    config.sensorCount = qMax(1, parser.value(sensorsOption).toInt());
+    config.envType = parser.value(envOption);
+    config.reportDirectory = reportDir.path();
+    config.pipelineLeadSec = qMax(0, parser.value(leadOption).toInt());
+    config.setpointShaping = parser.isSet(shapingOption);
+    config.seed = parser.value(seedOption).toUInt();
+    const double maxHours = parser.value(maxHoursOption).toDouble();
+    config.maxVirtualMs = static_cast<qint64>(maxHours * 3600 * 1000);
+
+    if (parser.isSet(planOption)) {
+        if (config.pipelineLeadSec > 0) {
+            out << "--lead 只对内置流程生效，按计划执行时不会预切换\n";
+            return 1;
+        }
+        QString error;
+        if (!CalibrationPlan::loadFromFile(parser.value(planOption), &config.plan, &error)) {
+            out << "计划加载失败：" << error << "\n";
+            return 1;
+        }
+    }
+    // 估算与 CalibrationManager::estimateDurationSec 一致：内置流程按等价的默认计划估算
+    const CalibrationPlan estimatePlan = config.plan.isEmpty() ? CalibrationPlan::defaultPlan() : config.plan;
+
+    const QVector<float> points = config.modelingPoints + config.verifyPoints;
+    if (points.isEmpty()) {
+        out << "没有温度点\n";
+        return 1;
+    }
+
+    // 关键路径估算：黑体炉从环境温度 25℃ 出发，依次经过各温度点
+    QVector<PlanNode> nodes;
+    QString planError;
+    double estimateSec = 0.0;
+    if (estimatePlan.expand(config.sensorCount, &nodes, &planError)) {
+        float previous = 25.0f;
+        for (float t : points) {
+            estimateSec += CalibrationPlan::estimate(nodes, qAbs(t - previous)).totalSec;
+            previous = t;
+        }
+    } else {
+        out << "计划展开失败：" << planError << "\n";
+        return 1;
+    }
+
+    CalibrationSimulation simulation(config);
+    const CalibrationSimulation::Result result = simulation.run();
+
+    QStringList failures;
+    if (!result.finished) failures << "流程未完成：" + result.error;
+
+    const int expectedRecords = points.size() * config.sensorCount;
+    if (result.records != expectedRecords) {
+        failures << QString("记录数 %1，应为 %2").arg(result.records).arg(expectedRecords);
+    }
+
+    for (int i = 0; i < result.recordData.size() && i < expectedRecords; ++i) {
+        const CalibrationManager::CalibrationRecord &record = result.recordData[i];
+        const int pointIndex = i / config.sensorCount;
+        const int position = i % config.sensorCount + 1;
+        const QString pointType = pointIndex < config.modelingPoints.size() ? "建模" : "验证";
+        if (!qFuzzyCompare(record.blackbodyTarget + 1000.0f, points[pointIndex] + 1000.0f)
+            || record.physicalPosition != position || record.pointType != pointType) {
+            failures << QString("第 %1 条记录为 %2℃/位置%3/%4，应为 %5℃/位置%6/%7")
+                            .arg(i + 1).arg(record.blackbodyTarget).arg(record.physicalPosition).arg(record.pointType)
+                            .arg(points[pointIndex]).arg(position).arg(pointType);
+            break;
+        }
+        if (i > 0 && record.measureTime < result.recordData[i - 1].measureTime) {
+            failures << QString("第 %1 条记录的测量时间早于上一条").arg(i + 1);
+            break;
+        }
+    }
+
+    const double dwellFloorSec = points.size() * config.sensorCount * measureDwellSec(estimatePlan);
+    const double virtualSec = result.virtualMs / 1000.0;
+    if (result.finished && virtualSec < dwellFloorSec) {
+        failures << QString("虚拟耗时 %1 秒，少于驻留时间之和 %2 秒").arg(virtualSec, 0, 'f', 0).arg(dwellFloorSec, 0, 'f', 0);
+    }
+
+    out << QString("计划：%1，%2 个温度点 × %3 个测温仪\n")
+               .arg(config.plan.isEmpty() ? QString("内置流程") : config.plan.name).arg(points.size()).arg(config.sensorCount);
+    out << QString("虚拟耗时 %1 h（估算 %2 h，比值 %3），实际耗时 %4 ms，事件 %5，记录 %6\n")
+               .arg(virtualSec / 3600.0, 0, 'f', 2).arg(estimateSec / 3600.0, 0, 'f', 2)
+               .arg(estimateSec > 0.0 ? virtualSec / estimateSec : 0.0, 0, 'f', 2)
+               .arg(result.wallMs).arg(result.events).arg(result.records);
+    for (int i = 0; i < result.pointFinishedMs.size(); ++i) {
+        out << QString("  温度点 %1 完成于 %2 h\n").arg(i + 1).arg(result.pointFinishedMs[i] / 3600000.0, 0, 'f', 2);
+    }
+
+    if (!failures.isEmpty()) {
+        for (const QString &failure : failures) out << "失败：" << failure << "\n";
+        return 2;
+    }
+    out << "通过\n";
+    return 0;
+}
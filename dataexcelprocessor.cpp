@@ -1,70 +1,190 @@
 #include "dataexcelprocessor.h"
-#include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
 #include <QDebug>
 
+namespace {
+// 一个端口需要回填的时间点及对应的 TXT 文件（单头是一张工作表的一列，多头是一张工作表，标准数据是整个文件）
+struct PortJob {
+    QString sheetName;
+    QString port;
+    int col = 0;
+    QVector<ExcelTimeRow> rows;        // 时间点及 Excel 行号（按时间升序）
+    QMap<QDate, QStringList> txtFiles; // 日期 -> 该端口当天所有采集会话
+};
+
+QString txtIndexKey(const QString& path, TxtMinuteIndex::Format format)
+{
+    return QString::number(format) + '|' + QFileInfo(path).absoluteFilePath();
+}
+
+// 时间点对应的 TXT 分钟键
+void addTxtMinutes(const QVector<ExcelTimeRow>& rows, QSet<qint64>& minutes)
+{
+    for (const ExcelTimeRow &row : rows) minutes.insert(row.txtMinuteKey());
+}
+}
+
 DataExcelProcessor::DataExcelProcessor(QObject* parent)
     : QObject(parent)
 {}
 
-void DataExcelProcessor::startProcessing(ProcessType type, const QString& sourcePath,
-                                         const QString& outputPath,
-                                         const QString& templatePath)
+void DataExcelProcessor::setJobQueue(JobQueue *queue)
 {
-    clearError(); // 清空之前的错误
+    m_jobQueue = queue;
+}
 
+// 提交到任务队列，返回任务编号（参数无效时返回 -1）。同一处理器的任务共用一个分组依次执行，
+// 结束后在主线程发出 operationCompleted
+int DataExcelProcessor::startProcessing(ProcessType type, const QString& sourcePath,
+                                        const QString& outputPath,
+                                        const QString& templatePath,
+                                        JobQueue::Priority priority)
+{
     if (!QFile::exists(sourcePath)) {
-        m_lastError = "源文件不存在：" + sourcePath;
-        emit errorOccurred(m_lastError);
-        return;
+        setLastError("源文件不存在：" + sourcePath);
+        return -1;
+    }
+    if (type == MergeFiles && templatePath.isEmpty()) {
+        setLastError("合并文件需要提供模板路径！");
+        return -1;
     }
 
-    QFuture<void> future = QtConcurrent::run([=]() {
-        try {
-            switch(type) {
-            case StandardData:
-                processStandard(sourcePath);
-                break;
-            case SingleHead:
-                processSingleHead(sourcePath);
-                break;
-            case MultiHead:
-                processMultiHead(sourcePath);
-                break;
-            case MergeFiles:
-                if (templatePath.isEmpty()) {
-                    m_lastError = "合并文件需要提供模板路径！";
-                    QMetaObject::invokeMethod(this, [this] {
-                        emit errorOccurred(m_lastError);
-                    }, Qt::QueuedConnection);
-                    return;
-                }
-                mergeFiles(sourcePath, outputPath, templatePath);
-                break;
-            }
-        } catch (const std::exception& e) {
-            m_lastError = "处理过程中发生异常：" + QString(e.what());
-            QMetaObject::invokeMethod(this, [this] {
-                emit errorOccurred(m_lastError);
-            }, Qt::QueuedConnection);
-        } catch (...) {
-            m_lastError = "处理过程中发生未知异常";
-            QMetaObject::invokeMethod(this, [this] {
-                emit errorOccurred(m_lastError);
-            }, Qt::QueuedConnection);
-        }
+    if (!m_jobQueue) m_jobQueue = new JobQueue(this);
+
+    static const QStringList typeNames = {"标准数据处理", "单头数据处理", "多头数据处理", "多头箱内箱外合并"};
+    const QString title = typeNames.value(type) + "：" + QFileInfo(sourcePath).fileName();
+    int id = m_jobQueue->submit(title, m_jobGroup, priority, [=](const JobContext &ctx) {
+        return runJob(ctx, type, sourcePath, outputPath, templatePath);
+    });
+    m_jobQueue->whenFinished(id, this, [this](const JobQueue::JobInfo &info) {
+        if (!info.result.success) rememberError(info.result.error);
+        finishOperation(info.result.success, info.result.resultPath);
     });
+    return id;
+}
+
+// 在任务队列的工作线程中执行；分钟索引、目录索引、耗时统计都只在一次任务内有效
+JobResult DataExcelProcessor::runJob(const JobContext& ctx, ProcessType type, const QString& sourcePath,
+                                     const QString& outputPath, const QString& templatePath)
+{
+    clearError(); // 清空之前的错误
+    m_timings = StageTimings();
+    m_txtIndexes.clear(); // 分钟索引只在一次处理任务内复用，TXT 可能在两次任务之间被追加
+    m_txtDirectories.clear();
+    m_job = &ctx;
+    m_jobResult = JobResult::failed(QString());
+
+    try {
+        switch(type) {
+        case StandardData:
+            processStandard(sourcePath);
+            break;
+        case SingleHead:
+            processSingleHead(sourcePath);
+            break;
+        case MultiHead:
+            processMultiHead(sourcePath);
+            break;
+        case MergeFiles:
+            mergeFiles(sourcePath, outputPath, templatePath);
+            break;
+        }
+    } catch (const std::exception& e) {
+        setLastError("处理过程中发生异常：" + QString(e.what()));
+    } catch (...) {
+        setLastError("处理过程中发生未知异常");
+    }
+    m_job = nullptr;
+
+    JobResult result = m_jobResult;
+    if (!result.success && result.error.isEmpty()) {
+        QString error = lastError();
+        result.error = ctx.isCancelled() ? QString("已取消") : !error.isEmpty() ? error : QString("处理失败");
+    }
+    return result;
+}
+
+QString DataExcelProcessor::lastError() const
+{
+    QMutexLocker locker(&m_errorMutex);
+    return m_lastError;
+}
+
+void DataExcelProcessor::clearError()
+{
+    QMutexLocker locker(&m_errorMutex);
+    m_lastError.clear();
+}
+
+void DataExcelProcessor::rememberError(const QString& message)
+{
+    QMutexLocker locker(&m_errorMutex);
+    m_lastError = message;
+}
+
+void DataExcelProcessor::setLastError(const QString& message)
+{
+    rememberError(message);
+    postError(message);
+}
+
+// 处理函数可能运行在工作线程，信号统一转到处理器所在线程（主线程）发出；本身在主线程时直接发出
+void DataExcelProcessor::postError(const QString& message)
+{
+    if (QThread::currentThread() == thread()) {
+        emit errorOccurred(message);
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, message] {
+        emit errorOccurred(message);
+    }, Qt::QueuedConnection);
+}
+
+void DataExcelProcessor::postProgress(int percent)
+{
+    if (m_job) m_job->setProgress(percent);
+    QMetaObject::invokeMethod(this, [this, percent] {
+        emit progressUpdated(percent);
+    }, Qt::QueuedConnection);
+}
+
+// 队列任务中只记录结果，由任务结束回调发出 operationCompleted；直接调用时（合并单头文件等）照常发出
+void DataExcelProcessor::finishOperation(bool success, const QString& resultPath)
+{
+    if (m_job) {
+        m_jobResult = success ? JobResult::ok(resultPath) : JobResult::failed(lastError(), resultPath);
+        return;
+    }
+    if (QThread::currentThread() == thread()) {
+        emit operationCompleted(success, resultPath);
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, success, resultPath] {
+        emit operationCompleted(success, resultPath);
+    }, Qt::QueuedConnection);
+}
+
+bool DataExcelProcessor::isCancelled() const
+{
+    return m_job && m_job->isCancelled();
 }
 
 // 标准数据处理实现
 void DataExcelProcessor::processStandard(const QString& excelPath)
 {
+    QElapsedTimer stageTimer;
+    stageTimer.start();
     QXlsx::Document xlsx(excelPath);
+    m_timings.loadMs = stageTimer.restart();
 
     // 读取端口号
     QString portNumber = xlsx.read(1, 5).toString();
 
     // 建立时间-行号映射
-    QMap<QDateTime, int> dateTimeRowMap;
+    QVector<ExcelTimeRow> timeRows;
     int row = 3;
     const int maxEmptyRows = 5;
     int emptyCount = 0;
@@ -74,53 +194,21 @@ void DataExcelProcessor::processStandard(const QString& excelPath)
         QVariant aCell = xlsx.read(row, 1);
         bool aIsEmpty = aCell.isNull() || aCell.toString().trimmed().isEmpty();
 
-        // 读取日期（B列）
-        QVariant dateCell = xlsx.read(row, 2);
-        QDate date = dateCell.toDate();
-
-        // 读取时间（C列）
-        QVariant timeCell = xlsx.read(row, 3);
+        // 读取日期（B列）和时间（C列）
+        QDate date;
         QTime time;
-
-        // 类型优先级：1.直接获取QTime 2.数值格式 3.文本格式
-        bool timeIsEmpty = false;
-        if (timeCell.isNull() || timeCell.toString().trimmed().isEmpty()) {
-            timeIsEmpty = true;
-        } else if (timeCell.userType() == QMetaType::QTime) {
-            time = timeCell.toTime();
-        } else if (timeCell.canConvert<double>()) {
-            double excelTime = timeCell.toDouble();
-            if (excelTime == 0.0) {
-                timeIsEmpty = true;
-            } else {
-                int totalSeconds = static_cast<int>(excelTime * 86400);
-                time = QTime(0, 0).addSecs(totalSeconds);
-            }
-        } else {
-            QString timeStr = timeCell.toString().trimmed();
-            time = QTime::fromString(timeStr, "HH:mm:ss");
-            if (!time.isValid()) {
-                time = QTime::fromString(timeStr, "HH:mm");
-            }
-            if (!time.isValid()) {
-                timeIsEmpty = true;
-            }
-        }
+        ExcelTime::decodeDate(xlsx.read(row, 2), &date);
+        // 时间列为 0 是模板未填写的默认值，与空单元格一样按无时间处理
+        const QVariant timeCell = xlsx.read(row, 3);
+        bool timeIsEmpty = !ExcelTime::decodeTime(timeCell, &time) || ExcelTime::isZeroSerial(timeCell);
 
         // 检测空行（日期或时间有一个无效 且 A列也是空的）
         bool isEmptyRow = (date.isValid() || timeIsEmpty) ? false : aIsEmpty;
         // 等价于：(date无效 || timeIsEmpty) 并且 aIsEmpty
 
-        // 构建日期时间
-        QDateTime dt;
-        if (date.isValid() && time.isValid()) {
-            dt = QDateTime(date, time);
-            if (dt.isValid()) {
-                dateTimeRowMap[dt] = row;
-                emptyCount = 0;
-            } else {
-                ++emptyCount;
-            }
+        if (date.isValid() && !timeIsEmpty) {
+            timeRows.append({ExcelTime::secondKey(date, time), row});
+            emptyCount = 0;
         } else {
             ++emptyCount;
         }
@@ -133,29 +221,50 @@ void DataExcelProcessor::processStandard(const QString& excelPath)
         ++row;
     }
 
-    // 处理温度数据
-    QMap<QDateTime, QVector<double>> tempDataMap;
-    for (auto it = dateTimeRowMap.begin(); it != dateTimeRowMap.end(); ++it) {
-        const QDateTime& dt = it.key();
-        QString txtFile = findMatchingTxtFile(excelPath, portNumber, dt.date());
-        if (!txtFile.isEmpty()) {
-            QString fullPath = QFileInfo(excelPath).path() + "/" + txtFile;
-            tempDataMap[dt] = processTxtFile(fullPath, dt);
+    sortTimeRows(timeRows);
+
+    QMap<QDate, QStringList> txtFiles;
+    for (const ExcelTimeRow &timeRow : timeRows) {
+        const QDate date = timeRow.date();
+        if (!txtFiles.contains(date)) txtFiles[date] = findMatchingTxtFiles(excelPath, portNumber, date);
+    }
+    m_timings.readMs = stageTimer.restart();
+    if (isCancelled()) return;
+
+    // 并行建立所有日期的分钟索引
+    postProgress(20);
+    QSet<qint64> minutes;
+    addTxtMinutes(timeRows, minutes);
+    prefetchTxtIndexes(txtFiles.values(), TxtMinuteIndex::StandardLog, minutes);
+    m_timings.aggregateMs = stageTimer.restart();
+    if (isCancelled()) return;
+
+    // 处理温度数据（与 timeRows 一一对应，未找到 TXT 的时间点为空）
+    QVector<QVector<double>> temps(timeRows.size());
+    for (int i = 0; i < timeRows.size(); ++i) {
+        const QStringList files = txtFiles.value(timeRows[i].date());
+        if (!files.isEmpty()) {
+            temps[i] = processTxtFile(files, timeRows[i]);
         }
     }
 
+    postProgress(70);
+
     // 写入Excel
-    writeTemperatures(xlsx, tempDataMap, dateTimeRowMap);
+    writeTemperatures(xlsx, timeRows, temps);
+    m_timings.writeMs = stageTimer.restart();
 
     // 保存结果
     QString outputPath = excelPath;
     outputPath.replace(".xlsx", "_processed.xlsx");
     if (!xlsx.saveAs(outputPath)) {
-        emit errorOccurred("文件保存失败");
+        setLastError("文件保存失败：" + outputPath);
         return;
     }
+    m_timings.saveMs = stageTimer.elapsed();
+    logTimings("标准数据");
 
-    emit operationCompleted(true, outputPath);
+    finishOperation(true, outputPath);
 }
 
 // 单头数据处理实现
@@ -163,7 +272,10 @@ void DataExcelProcessor::processSingleHead(const QString& excelPath)
 {
     qDebug() << "开始处理 Excel：" << excelPath;
 
+    QElapsedTimer stageTimer;
+    stageTimer.start();
     QXlsx::Document xlsx(excelPath);
+    m_timings.loadMs = stageTimer.restart();
 
     // 遍历所有工作表，筛选出包含 "单头" 的工作表
     QStringList targetSheets;
@@ -175,7 +287,11 @@ void DataExcelProcessor::processSingleHead(const QString& excelPath)
 
     qDebug() << "筛选出的单头工作表：" << targetSheets;
 
+    // 先读出所有工作表、所有端口列的时间点和 TXT 文件，再统一并行解析
+    QVector<PortJob> jobs;
+
     foreach (const QString &sheetName, targetSheets) {
+        if (isCancelled()) return;
         xlsx.selectSheet(sheetName);
         qDebug() << "当前处理工作表：" << sheetName;
 
@@ -192,95 +308,93 @@ void DataExcelProcessor::processSingleHead(const QString& excelPath)
             QString port = comInfo.split("-").last().trimmed();
             qDebug() << "解析出的端口号：" << port;
 
-            // 建立时间-行号映射
-            QMap<QDateTime, int> dateTimeRowMap;
+            // 建立时间-行号映射（B列日期，C列时间）
+            QVector<ExcelTimeRow> timeRows;
             int row = 3;
             const int maxEmptyRows = 5;
             int emptyCount = 0;
 
             while (emptyCount < maxEmptyRows) {
-                // 读取日期（B列）
-                QDate date = xlsx.read(row, 2).toDate();
-
-                // 读取时间（C列）
-                QVariant timeCell = xlsx.read(row, 3);
+                QDate date;
                 QTime time;
-
-                // 类型优先级：1.直接获取QTime 2.数值格式 3.文本格式
-                if (timeCell.userType() == QMetaType::QTime) {
-                    // 情况1：QXlsx已直接解析为QTime
-                    time = timeCell.toTime();
-                } else if (timeCell.canConvert<double>()) {
-                    // 情况2：数值格式（Excel内部时间）
-                    double excelTime = timeCell.toDouble();
-                    int totalSeconds = static_cast<int>(excelTime * 86400);
-                    time = QTime(0, 0).addSecs(totalSeconds);
-                } else {
-                    // 情况3：文本格式（兼容带秒的情况）
-                    QString timeStr = timeCell.toString().trimmed();
-                    time = QTime::fromString(timeStr, "HH:mm:ss");
-                    if (!time.isValid()) {
-                        time = QTime::fromString(timeStr, "HH:mm");
-                    }
-                }
-
-                // 构建日期时间
-                QDateTime dt;
-                if (date.isValid() && time.isValid()) {
-                    dt = QDateTime(date, time);
-                    if (dt.isValid()) {
-                        dateTimeRowMap[dt] = row;
-                        emptyCount = 0;
-                    } else {
-                        ++emptyCount;
-                    }
+                if (ExcelTime::decodeDate(xlsx.read(row, 2), &date)
+                    && ExcelTime::decodeTime(xlsx.read(row, 3), &time)) {
+                    timeRows.append({ExcelTime::secondKey(date, time), row});
+                    emptyCount = 0;
                 } else {
                     ++emptyCount;
                 }
                 ++row;
-
             }
-
-            // 处理温度数据
-            QMap<QDateTime, QVector<double>> tempDataMap;
-            foreach (const QDateTime &dt, dateTimeRowMap.keys()) {
-                QString txtFile = findMatchingTxtFile(excelPath, port, dt.date());
-                if (!txtFile.isEmpty()) {
-                    QString fullPath = QFileInfo(excelPath).path() + "/" + txtFile;
-                    qDebug() << "找到匹配的 TXT 文件：" << fullPath << " 对应时间：" << dt.toString("yyyy-MM-dd HH:mm");
-
-                    QVector<double> temps = processSingleHeadTxtFile(fullPath, dt);
-                    qDebug() << "提取到的温度数据：" << temps;
-
-                    tempDataMap[dt] = temps;
-                } else {
-                    qDebug() << "未找到匹配的 TXT 文件：" << dt.toString("yyyy-MM-dd");
-                }
+            sortTimeRows(timeRows);
+
+            PortJob job;
+            job.sheetName = sheetName;
+            job.port = port;
+            job.col = col;
+            job.rows = timeRows;
+            for (const ExcelTimeRow &timeRow : timeRows) {
+                const QDate date = timeRow.date();
+                if (!job.txtFiles.contains(date)) job.txtFiles[date] = findMatchingTxtFiles(excelPath, port, date);
+            }
+            jobs.append(job);
+        }
+    }
+    m_timings.readMs = stageTimer.restart();
+    if (isCancelled()) return;
+
+    // 所有工作表、所有端口的 TXT 互相独立，一次性并行解析
+    QList<QStringList> fileSets;
+    QSet<qint64> minutes;
+    for (const PortJob &job : jobs) {
+        fileSets += job.txtFiles.values();
+        addTxtMinutes(job.rows, minutes);
+    }
+    postProgress(20);
+    prefetchTxtIndexes(fileSets, TxtMinuteIndex::SingleHeadLog, minutes);
+    m_timings.aggregateMs = stageTimer.restart();
+    if (isCancelled()) return;
+
+    postProgress(70);
+
+    // 写回共享的 Document 只能串行
+    for (const PortJob &job : jobs) {
+        if (isCancelled()) return;
+        xlsx.selectSheet(job.sheetName);
+
+        // 处理温度数据并写入
+        for (const ExcelTimeRow &timeRow : job.rows) {
+            QStringList txtFiles = job.txtFiles.value(timeRow.date());
+            if (txtFiles.isEmpty()) {
+                qDebug() << "未找到匹配的 TXT 文件：" << timeRow.date().toString("yyyy-MM-dd");
+                continue;
             }
+            qDebug() << "找到匹配的 TXT 文件：" << txtFiles << " 对应分钟：" << timeRow.txtMinuteKey();
 
-            // 写入数据
-            foreach (const QDateTime &dt, tempDataMap.keys()) {
-                int row = dateTimeRowMap[dt];
-                QVector<double> temps = tempDataMap[dt];
-                qDebug() << "写入 Excel：" << sheetName << " 行：" << row << " 列起始：" << col
-                         << " 温度数据：" << temps;
+            QVector<double> temps = processSingleHeadTxtFile(txtFiles, timeRow);
+            qDebug() << "写入 Excel：" << job.sheetName << " 行：" << timeRow.row << " 列起始：" << job.col
+                     << " 温度数据：" << temps;
 
-                for (int i = 0; i < 3; ++i) {
-                    xlsx.write(row, col + i, temps.value(i, 65535));
-                }
+            for (int i = 0; i < 3; ++i) {
+                xlsx.write(timeRow.row, job.col + i, temps.value(i, 65535));
             }
         }
     }
+    m_timings.writeMs = stageTimer.restart();
 
     QString outputPath = excelPath;
     bool saveSuccess = xlsx.saveAs(outputPath);
 
+    m_timings.saveMs = stageTimer.elapsed();
+    logTimings("单头数据");
+
     if (saveSuccess) {
         qDebug() << "单头数据处理完成，保存至：" << outputPath;
-        emit operationCompleted(true, outputPath);
+        finishOperation(true, outputPath);
     } else {
         qDebug() << "单头数据保存失败！路径：" << outputPath;
-        emit operationCompleted(false, outputPath);
+        setLastError("单头数据保存失败：" + outputPath);
+        finishOperation(false, outputPath);
     }
 }
 
@@ -289,7 +403,10 @@ void DataExcelProcessor::processMultiHead(const QString& excelPath)
 {
     qDebug() << "开始处理多头数据文件:" << excelPath;
 
+    QElapsedTimer stageTimer;
+    stageTimer.start();
     QXlsx::Document xlsx(excelPath);
+    m_timings.loadMs = stageTimer.restart();
 
     // 筛选所有含 "多" 的工作表
     QStringList multiHeadSheets;
@@ -301,16 +418,20 @@ void DataExcelProcessor::processMultiHead(const QString& excelPath)
 
     qDebug() << "找到" << multiHeadSheets.size() << "个包含'多'的工作表";
 
+    // 先读出所有工作表的时间点和 TXT 文件，再统一并行解析
+    QVector<PortJob> jobs;
+
     foreach (const QString &sheetName, multiHeadSheets) {
+        if (isCancelled()) return;
         xlsx.selectSheet(sheetName);
-        emit progressUpdated(20);
+        postProgress(20);
         qDebug() << "正在处理工作表:" << sheetName;
 
         // 从工作表名称提取端口号 (假设格式："COM9-多14")
         static const QRegularExpression regex(R"(COM(\d+)-多(\d+))");
         QRegularExpressionMatch match = regex.match(sheetName);
         if (!match.hasMatch()) {
-            emit errorOccurred("无法解析工作表端口号：" + sheetName);
+            postError("无法解析工作表端口号：" + sheetName);
             qDebug() << "警告: 无法从工作表名称解析端口号 -" << sheetName;
             continue;
         }
@@ -319,41 +440,21 @@ void DataExcelProcessor::processMultiHead(const QString& excelPath)
         qDebug() << "从工作表名称解析出端口号:" << portNumber;
 
         // 建立时间索引（B列日期，C列时间）
-        QMap<QDateTime, int> dateTimeRowMap;
+        QVector<ExcelTimeRow> timeRows;
         int row = 4;
         int emptyCount = 0;
         const int maxEmptyRows = 10;
 
         qDebug() << "开始建立时间-行号映射...";
         while (emptyCount < maxEmptyRows) {
-            // 读取日期
-            QDate date = xlsx.read(row, 2).toDate();
-
-            // 读取时间
-            QVariant timeCell = xlsx.read(row, 3);
+            QDate date;
             QTime time;
+            ExcelTime::decodeDate(xlsx.read(row, 2), &date);
+            ExcelTime::decodeTime(xlsx.read(row, 3), &time);
 
-            if (timeCell.userType() == QMetaType::QTime) {
-                time = timeCell.toTime();
-            } else if (timeCell.canConvert<double>()) {
-                double excelTime = timeCell.toDouble();
-                int totalSeconds = static_cast<int>(excelTime * 86400);
-                time = QTime(0, 0).addSecs(totalSeconds);
-            } else {
-                QString timeStr = timeCell.toString().trimmed();
-                time = QTime::fromString(timeStr, "HH:mm:ss");
-                if (!time.isValid()) {
-                    time = QTime::fromString(timeStr, "HH:mm");
-                }
-            }
-
-            // 构建日期时间
-            QDateTime dt;
             if (date.isValid() && time.isValid()) {
-                dt = QDateTime(date, time);
-                dateTimeRowMap[dt] = row;
+                timeRows.append({ExcelTime::secondKey(date, time), row});
                 emptyCount = 0;
-                qDebug() << "成功解析时间-行号映射:" << dt.toString("yyyy-MM-dd HH:mm") << "-> 行" << row;
             } else {
                 ++emptyCount;
                 qDebug() << "第" << row << "行时间解析失败 - 日期:" << date << "时间:" << time;
@@ -365,23 +466,53 @@ void DataExcelProcessor::processMultiHead(const QString& excelPath)
             ++row;
         }
 
-        qDebug() << "时间-行号映射建立完成，共找到" << dateTimeRowMap.size() << "个有效时间点";
+        sortTimeRows(timeRows);
+        qDebug() << "时间-行号映射建立完成，共找到" << timeRows.size() << "个有效时间点";
+
+        PortJob job;
+        job.sheetName = sheetName;
+        job.port = portNumber;
+        job.rows = timeRows;
+        for (const ExcelTimeRow &timeRow : timeRows) {
+            const QDate date = timeRow.date();
+            if (!job.txtFiles.contains(date)) job.txtFiles[date] = findMatchingTxtFiles(excelPath, portNumber, date);
+        }
+        jobs.append(job);
+    }
+    m_timings.readMs = stageTimer.restart();
+    if (isCancelled()) return;
+
+    // 每张工作表对应一个端口，各端口的 TXT 互相独立，一次性并行解析
+    QList<QStringList> fileSets;
+    QSet<qint64> minutes;
+    for (const PortJob &job : jobs) {
+        fileSets += job.txtFiles.values();
+        addTxtMinutes(job.rows, minutes);
+    }
+    prefetchTxtIndexes(fileSets, TxtMinuteIndex::MultiHeadLog, minutes);
+    m_timings.aggregateMs = stageTimer.restart();
+    if (isCancelled()) return;
+    postProgress(50);
+
+    // 写回共享的 Document 只能串行
+    int totalSteps = 0;
+    for (const PortJob &job : jobs) totalSteps += job.rows.size();
+    int currentStep = 0;
+    qDebug() << "开始处理温度数据，总行数:" << totalSteps;
 
-        // 处理温度数据
-        int totalSteps = dateTimeRowMap.size();
-        int currentStep = 0;
-        qDebug() << "开始处理温度数据，总行数:" << totalSteps;
+    for (const PortJob &job : jobs) {
+        if (isCancelled()) return;
+        xlsx.selectSheet(job.sheetName);
 
-        foreach (const QDateTime &dt, dateTimeRowMap.keys()) {
-            QString txtFile = findMatchingTxtFile(excelPath, portNumber, dt.date());
-            if (!txtFile.isEmpty()) {
-                QString fullPath = QDir(QFileInfo(excelPath).path()).filePath(txtFile);
-                qDebug() << "找到匹配的TXT文件:" << fullPath << "对应日期:" << dt.date().toString("yyyy-MM-dd");
+        for (const ExcelTimeRow &timeRow : job.rows) {
+            QStringList txtFiles = job.txtFiles.value(timeRow.date());
+            if (!txtFiles.isEmpty()) {
+                qDebug() << "找到匹配的TXT文件:" << txtFiles << "对应日期:" << timeRow.date().toString("yyyy-MM-dd");
 
-                QVector<double> temps = processMultiHeadTxtFile(fullPath, dt);
+                QVector<double> temps = processMultiHeadTxtFile(txtFiles, timeRow);
 
                 // 写入Excel（E-M列共9个温度值）
-                int targetRow = dateTimeRowMap[dt];
+                int targetRow = timeRow.row;
                 qDebug() << "准备写入第" << targetRow << "行的温度数据";
 
                 for (int i = 0; i < 9; ++i) {
@@ -393,14 +524,15 @@ void DataExcelProcessor::processMultiHead(const QString& excelPath)
                 qDebug() << "未找到日期为" << dt.date().toString("yyyy-MM-dd") << "的TXT文件";
             }
 
-            emit progressUpdated(20 + (++currentStep * 60 / totalSteps));
+            postProgress(50 + (++currentStep * 30 / totalSteps));
             if (currentStep % 10 == 0 || currentStep == totalSteps) {
-                qDebug() << "进度更新:" << (20 + (currentStep * 60 / totalSteps)) << "%，已处理" << currentStep << "/" << totalSteps;
+                qDebug() << "进度更新:" << (50 + (currentStep * 30 / totalSteps)) << "%，已处理" << currentStep << "/" << totalSteps;
             }
         }
 
-        qDebug() << "工作表" << sheetName << "处理完成";
+        qDebug() << "工作表" << job.sheetName << "处理完成";
     }
+    m_timings.writeMs = stageTimer.restart();
 
     // 保存处理结果
     QString baseName = QFileInfo(excelPath).completeBaseName();
@@ -408,274 +540,372 @@ void DataExcelProcessor::processMultiHead(const QString& excelPath)
     QString outputPath = QFileInfo(excelPath).path() + "/" + baseName + ".xlsx";
 
     if (!xlsx.saveAs(outputPath)) {
-        emit errorOccurred("多头文件保存失败");
+        setLastError("多头文件保存失败：" + outputPath);
         qDebug() << "错误: 保存文件失败 -" << outputPath;
         return;
     }
+    m_timings.saveMs = stageTimer.elapsed();
+    logTimings("多头数据");
 
     qDebug() << "多头数据处理完成，结果保存至:" << outputPath;
-    emit operationCompleted(true, outputPath);
+    finishOperation(true, outputPath);
 }
 
 
-// 单头TXT文件处理
-QVector<double> DataExcelProcessor::processSingleHeadTxtFile(const QString& txtFilePath,
-                                                             const QDateTime& dateTime)
+// 取得（必要时建立）TXT 文件的分钟索引，同一处理任务内每个文件只解析一次；
+// 跨任务由 TXT 旁的 .midx 缓存复用，文件被追加时只解析新增部分
+const TxtMinuteIndex *DataExcelProcessor::txtIndex(const QString& txtFilePath, TxtMinuteIndex::Format format)
 {
-    QFile file(txtFilePath);
-    QVector<double> result(3, 65535); // 初始化为无效值
-    QVector<QVector<double>> minuteData(3); // 存储每分钟各通道的有效数据
-    int validCount = 0;
-
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        // 目标时间格式改为只精确到分钟（忽略秒）
-        QString targetMinute = dateTime.toString("yyyy-MM-dd HH:mm");
-
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (!line.startsWith("[R:") || !line.contains(" ST,")) continue;
-
-            // 提取时间部分
-            int startIndex = line.indexOf("[R:") + 3;
-            int endIndex = line.indexOf("] ST,");
-            if (startIndex == -1 || endIndex == -1 || endIndex <= startIndex) continue;
-            QString timePart = line.mid(startIndex, endIndex - startIndex);
-
-            // 匹配到分钟（忽略秒）
-            if (!timePart.startsWith(targetMinute)) continue;
+    const QString key = txtIndexKey(txtFilePath, format);
+    auto it = m_txtIndexes.constFind(key);
+    if (it != m_txtIndexes.constEnd()) return &it.value();
+
+    TxtMinuteIndex index;
+    if (!index.load(txtFilePath, format)) return nullptr;
+    qDebug() << (index.loadedFromSidecar() ? "已读取分钟索引缓存：" : "已建立分钟索引：") << txtFilePath
+             << "，" << index.lineCount() << "行，" << index.minuteCount() << "分钟";
+    return &m_txtIndexes.insert(key, index).value();
+}
 
-            // 分割数据并清理空格
-            QStringList parts = line.split(',');
-            for (auto& part : parts) part = part.trimmed();
+// 并行建立这些文件的分钟索引：每个文件独立解析、独立读写自己的 .midx，互不共享状态；
+// 共享的 m_txtIndexes 只在调用线程里写入，之后 txtIndex() 直接命中。解析失败的文件不放入缓存，
+// 仍由 txtIndex() 按原来的路径报错
+void DataExcelProcessor::prefetchTxtIndexes(const QList<QStringList>& fileSets, TxtMinuteIndex::Format format,
+                                            const QSet<qint64>& minutes)
+{
+    struct Pending {
+        QString path;
+        TxtMinuteIndex index;
+        bool ok = false;
+    };
+    QVector<Pending> pending;
+    QSet<QString> queued;
+    for (const QStringList &files : fileSets) {
+        for (const QString &path : files) {
+            const QString key = txtIndexKey(path, format);
+            if (m_txtIndexes.contains(key) || queued.contains(key)) continue;
+            queued.insert(key);
+            Pending item;
+            item.path = path;
+            pending.append(item);
+        }
+    }
+    if (pending.isEmpty()) return;
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    m_timings.txtFiles += pending.size();
+    m_timings.threads = qMax(m_timings.threads, qMin(pending.size(), pool->maxThreadCount()));
+
+    // 已取消时剩余文件不再解析
+    const JobCancelToken token = m_job ? m_job->token() : JobCancelToken();
+    QtConcurrent::blockingMap(pending, [format, token, &minutes](Pending &item) {
+        if (token.isCancelled()) return;
+        item.index.setMinuteFilter(minutes); // 只影响没有缓存的压缩日志
+        item.ok = item.index.load(item.path, format);
+    });
 
-            // 温度提取逻辑（与原代码一致）
-            bool ok1 = false, ok2 = false, ok3 = false;
-            double temp1 = 65535, temp2 = 65535, temp3 = 65535;
+    for (const Pending &item : pending) {
+        if (!item.ok) continue;
+        qDebug() << (item.index.loadedFromSidecar() ? "已读取分钟索引缓存：" : "已建立分钟索引：") << item.path
+                 << "，" << item.index.lineCount() << "行，" << item.index.minuteCount() << "分钟";
+        m_txtIndexes.insert(txtIndexKey(item.path, format), item.index);
+    }
+}
 
-            if (parts.size() >= 4) {
-                temp1 = parts[2].toDouble(&ok1);
-            }
+void DataExcelProcessor::logTimings(const QString& jobName) const
+{
+    qDebug().noquote() << QString("%1处理耗时：加载Excel %2 ms，读取时间列 %3 ms，解析TXT %4 ms（%5 个文件，%6 线程），写入 %7 ms，保存 %8 ms")
+                              .arg(jobName)
+                              .arg(m_timings.loadMs)
+                              .arg(m_timings.readMs)
+                              .arg(m_timings.aggregateMs)
+                              .arg(m_timings.txtFiles)
+                              .arg(m_timings.threads)
+                              .arg(m_timings.writeMs)
+                              .arg(m_timings.saveMs);
+}
 
-            if (parts.size() >= 5) {
-                QString temp2_raw = parts[3];
-                if (temp2_raw.contains('|')) {
-                    QStringList temp2_split = temp2_raw.split('|');
-                    if (temp2_split.size() >= 2) {
-                        temp2 = temp2_split[0].toDouble(&ok2);
-                        temp3 = temp2_split[1].toDouble(&ok3);
-                    }
-                } else {
-                    if (parts.size() >= 6) {
-                        temp2 = parts[3].toDouble(&ok2);
-                        temp3 = parts[4].toDouble(&ok3);
-                    }
-                }
-            }
+// 同一端口同一天有多个采集会话时，把各文件的分钟汇总合并后再求均值
+const TxtMinuteIndex *DataExcelProcessor::txtIndex(const QStringList& txtFiles, TxtMinuteIndex::Format format)
+{
+    if (txtFiles.size() == 1) return txtIndex(txtFiles.first(), format);
+
+    const QString key = QString::number(format) + '|' + txtFiles.join('|');
+    auto it = m_txtIndexes.constFind(key);
+    if (it != m_txtIndexes.constEnd()) return &it.value();
+
+    TxtMinuteIndex merged;
+    bool first = true;
+    for (const QString &path : txtFiles) {
+        const TxtMinuteIndex *index = txtIndex(path, format);
+        if (!index) return nullptr;
+        if (first) merged = *index;
+        else merged.merge(*index);
+        first = false;
+    }
+    qDebug() << "合并" << txtFiles.size() << "个采集会话的分钟索引：" << txtFiles;
+    return &m_txtIndexes.insert(key, merged).value();
+}
 
-            // 有效性验证并收集数据（修改点）
-            if (ok1 && temp1 >= -40.0 && temp1 <= 150.0) {
-                minuteData[0].append(temp1);
-                validCount++;
-            }
-            if (ok2 && temp2 >= -40.0 && temp2 <= 150.0) {
-                minuteData[1].append(temp2);
-                validCount++;
-            }
-            if (ok3 && temp3 >= -40.0 && temp3 <= 150.0) {
-                minuteData[2].append(temp3);
-                validCount++;
-            }
-        }
-        file.close();
-
-        // 计算平均值（新增逻辑）
-        for (int i = 0; i < 3; i++) {
-            if (!minuteData[i].isEmpty()) {
-                double sum = 0;
-                for (double temp : minuteData[i]) {
-                    sum += temp;
-                }
-                result[i] = sum / minuteData[i].size(); // 计算平均值
-            } else {
-                result[i] = 65535; // 无数据时保持无效值
-            }
-        }
+// 单头TXT文件处理
+QVector<double> DataExcelProcessor::processSingleHeadTxtFile(const QStringList& txtFiles,
+                                                             const ExcelTimeRow& timeRow)
+{
+    QVector<double> result(3, 65535); // 初始化为无效值
 
-        // 无有效数据时标记为无效
-        if (validCount == 0) {
-            result.fill(65535);
-        }
+    const TxtMinuteIndex *index = txtIndex(txtFiles, TxtMinuteIndex::SingleHeadLog);
+    if (!index) {
+        postError("无法打开单头文件：" + txtFiles.join("; "));
+        return result;
+    }
 
-        // ===== 新增：温度范围检查 =====
-        if (validCount > 0) {
-            double temp1Avg = result[0];
-            double temp2Avg = result[1];
-
-            // 检查第一和第二通道温度是否在-40~90℃范围内
-            bool temp1OutOfRange = (temp1Avg < -40.0 || temp1Avg > 90.0);
-            bool temp2OutOfRange = (temp2Avg < -40.0 || temp2Avg > 90.0);
-
-            if (temp1OutOfRange || temp2OutOfRange) {
-                QString errorMsg = QString("温度超出正常范围\n"
-                                           "目标时间: %1\n"
-                                           "通道1平均温度: %.2f℃ (正常范围: -40~90℃)\n"
-                                           "通道2平均温度: %.2f℃ (正常范围: -40~90℃)")
-                                       .arg(dateTime.toString("yyyy-MM-dd HH:mm:ss"))
-                                       .arg(temp1Avg)
-                                       .arg(temp2Avg);
-
-                m_lastError = errorMsg;
-                emit errorOccurred(errorMsg);
-            }
+    // 目标时间只精确到分钟（忽略秒），无有效数据的通道保持无效值
+    const qint64 minuteKey = timeRow.txtMinuteKey();
+    result = index->averages(minuteKey);
+    const TxtMinuteAggregate *minute = index->minute(minuteKey);
+    int validCount = 0;
+    if (minute) {
+        for (const TxtChannelAggregate &channel : minute->channels) validCount += channel.count;
+    }
 
+    // ===== 新增：温度范围检查 =====
+    if (validCount > 0) {
+        double temp1Avg = result[0];
+        double temp2Avg = result[1];
+
+        // 检查第一和第二通道温度是否在-40~90℃范围内
+        bool temp1OutOfRange = (temp1Avg < -40.0 || temp1Avg > 90.0);
+        bool temp2OutOfRange = (temp2Avg < -40.0 || temp2Avg > 90.0);
+
+        if (temp1OutOfRange || temp2OutOfRange) {
+            QString errorMsg = QString("温度超出正常范围\n"
+                                       "目标时间: %1\n"
+                                       "通道1平均温度: %.2f℃ (正常范围: -40~90℃)\n"
+                                       "通道2平均温度: %.2f℃ (正常范围: -40~90℃)")
+                                   .arg(timeRow.dateTime().toString("yyyy-MM-dd HH:mm:ss"))
+                                   .arg(temp1Avg)
+                                   .arg(temp2Avg);
+
+            setLastError(errorMsg);
         }
-
-    } else {
-        emit errorOccurred("无法打开单头文件：" + txtFilePath);
     }
     return result;
 }
 
 
 // 多头TXT文件处理（优化版）
-QVector<double> DataExcelProcessor::processMultiHeadTxtFile(const QString& txtFilePath,
-                                                            const QDateTime& targetDateTime)
+QVector<double> DataExcelProcessor::processMultiHeadTxtFile(const QStringList& txtFiles,
+                                                            const ExcelTimeRow& timeRow)
 {
-    QFile file(txtFilePath);
     QVector<double> result(9, 65535); // 9个温度通道，默认无效值65535
-    QVector<QVector<double>> channelData(9);
-    const QString targetTimePrefix = targetDateTime.toString("yyyy-MM-dd HH:mm");
-
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-
-            // 有效性检查
-            if (!line.startsWith("[R:") || !line.contains(" ST,")) continue;
-            if (!line.contains(targetTimePrefix)) continue;
-
-            // 解析数据部分
-            QStringList parts = line.split(',', Qt::SkipEmptyParts);
-            if (parts.size() < 19) continue; // 确保数据行长度足够
-
-            // 提取9个温度值
-            QVector<int> indices = {6, 7, 8, 11, 12, 13, 16, 17, 18};
-            QVector<double> temps;
-
-            for (int idx : indices) {
-                QString tempStr = parts.value(idx).trimmed();
-                bool ok;
-                double temp = tempStr.toDouble(&ok) / 100.0; // 温度值需要除以100
-                if (ok && temp >= -40.0 && temp <= 150.0) {
-                    temps.append(temp);
-                } else {
-                    temps.append(65535); // 无效数据填充65535
-                }
-            }
 
-            // 只有当至少7个通道有效时，才记录该行数据
-            int validCount = std::count_if(temps.begin(), temps.end(),
-                                           [](double v){ return v != 65535; });
-            if (validCount >= 7) {
-                for (int i = 0; i < 9; ++i) {
-                    if (temps[i] != 65535) {
-                        channelData[i].append(temps[i]);
-                    }
-                }
-            }
-        }
-        file.close();
+    const TxtMinuteIndex *index = txtIndex(txtFiles, TxtMinuteIndex::MultiHeadLog);
+    if (!index) {
+        postError("无法打开多头文件：" + txtFiles.join("; "));
+        return result;
+    }
 
-        // 计算每个通道的分钟平均值
-        for (int i = 0; i < 9; ++i) {
-            if (!channelData[i].isEmpty()) {
-                result[i] = std::accumulate(channelData[i].begin(),
-                                            channelData[i].end(), 0.0) / channelData[i].size();
-            }
-        }
+    // 每个通道的分钟平均值（索引中只计入至少7个通道有效的行）
+    result = index->averages(timeRow.txtMinuteKey());
 
-        // ===== 新增：温度范围检查 =====
-        for (int i = 0; i < 9; ++i) {
-            double tempAvg = result[i];
-
-            if (tempAvg < -40.0 || tempAvg > 90.0) {
-                QString errorMsg = QString("温度超出正常范围\n"
-                                           "文件: %1\n"
-                                           "目标时间: %2\n"
-                                           "通道%3平均温度: %.2f℃ (正常范围: -40~90℃)")
-                                       .arg(txtFilePath)
-                                       .arg(targetDateTime.toString("yyyy-MM-dd HH:mm:ss"))
-                                       .arg(i + 1)
-                                       .arg(tempAvg);
-
-                m_lastError = errorMsg;
-                emit errorOccurred(errorMsg);
-            }
+    // ===== 新增：温度范围检查 =====
+    for (int i = 0; i < 9; ++i) {
+        double tempAvg = result[i];
+
+        if (tempAvg < -40.0 || tempAvg > 90.0) {
+            QString errorMsg = QString("温度超出正常范围\n"
+                                       "文件: %1\n"
+                                       "目标时间: %2\n"
+                                       "通道%3平均温度: %.2f℃ (正常范围: -40~90℃)")
+                                   .arg(txtFiles.join("; "))
+                                   .arg(timeRow.dateTime().toString("yyyy-MM-dd HH:mm:ss"))
+                                   .arg(i + 1)
+                                   .arg(tempAvg);
+
+            setLastError(errorMsg);
         }
-    } else {
-        emit errorOccurred("无法打开多头文件：" + txtFilePath);
     }
     return result;
 }
 
 
-QVector<double> DataExcelProcessor::processTxtFile(const QString& filePath,
-                                                   const QDateTime& targetDateTime)
+QVector<double> DataExcelProcessor::processTxtFile(const QStringList& txtFiles,
+                                                   const ExcelTimeRow& timeRow)
 {
-    QFile file(filePath);
     QVector<double> result(16, 65535);
-    QVector<QVector<double>> channelData(16);
+    const QString filePath = txtFiles.join("; ");
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        m_lastError = "无法打开文件：" + filePath;
-        emit errorOccurred(m_lastError);
+    const TxtMinuteIndex *index = txtIndex(txtFiles, TxtMinuteIndex::StandardLog);
+    if (!index) {
+        setLastError("无法打开文件：" + filePath);
         return result;
     }
 
-    QTextStream in(&file);
-    QString targetTime = targetDateTime.toString("yyyy-MM-dd HH:mm");
-    qDebug() << "目标日期时间：" << targetTime;
-    int validLines = 0;
-
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (!line.contains(targetTime)) continue;
-
-        QStringList parts = line.split(',');
-        if (parts.size() < 19) continue;
-
-        // 解析温度值
-        for (int i = 3; i <= 18; ++i) {
-            QString tempStr = parts[i].split(':').last().trimmed();
-            bool ok;
-            double temp = tempStr.toDouble(&ok);
-            if (ok && temp >= -40.0 && temp <= 150.0) {
-                channelData[i-3].append(temp);
+    const qint64 minuteKey = timeRow.txtMinuteKey();
+    const TxtMinuteAggregate *minute = index->minute(minuteKey);
+    if (!minute || minute->rows == 0) {
+        qDebug() << "警告：TXT文件中无匹配时间的记录，文件：" << filePath;
+
+        setLastError(QString("TXT文件中无匹配时间的记录\n文件: %1\n目标时间: %2")
+                          .arg(filePath).arg(timeRow.dateTime().toString("yyyy-MM-dd HH:mm")));
+    }
+
+    // 计算平均值
+    return index->averages(minuteKey);
+}
+
+// 合并结果中一张工作表的候选建模点（选择建模点对话框和批处理共用）
+void DataExcelProcessor::readModelingCandidates(QXlsx::Document& mergedDoc, const QString& sheetName, bool multiHead,
+                                                QVector<double>& temperatures, QVector<QString>& conditions)
+{
+    temperatures.clear();
+    conditions.clear();
+    mergedDoc.selectSheet(sheetName);
+
+    // 单头：第2行起，D列测试条件、E列温度；多头：第4行起，D列温度、P列测试条件
+    const int firstRow = multiHead ? 4 : 2;
+    const int tempCol = multiHead ? 4 : 5;
+    const int condCol = multiHead ? 16 : 4;
+    int emptyCount = 0;
+    for (int row = firstRow; emptyCount < 5; ++row) {
+        QVariant tempVar = mergedDoc.read(row, tempCol);
+        QVariant condVar = mergedDoc.read(row, condCol);
+        if (tempVar.isNull() || condVar.isNull()) {
+            ++emptyCount;
+            continue;
+        }
+        emptyCount = 0;
+        conditions.append(condVar.toString());
+        temperatures.append(tempVar.toDouble());
+    }
+}
+
+// 单头拟合模板："建模"、"验证"两张表，选中的点写入建模表，其余写入验证表
+QString DataExcelProcessor::writeSingleHeadTemplate(QXlsx::Document& srcDoc,
+                                                    const QString& sheetName,
+                                                    const QVector<bool>& selections,
+                                                    const QString& sourceFilePath)
+{
+    srcDoc.selectSheet(sheetName);
+
+    // 创建新文档
+    QXlsx::Document newXlsx;
+
+    // 添加两个工作表
+    newXlsx.addSheet("建模");
+    newXlsx.addSheet("验证");
+
+    // 写入表头
+    newXlsx.selectSheet("建模");
+    newXlsx.write(1, 1, "测试条件");
+    newXlsx.write(1, 2, "测量点温度");
+    newXlsx.write(1, 3, "目标");
+    newXlsx.write(1, 4, "腔体");
+    newXlsx.write(1, 5, "标准");
+
+    newXlsx.selectSheet("验证");
+    newXlsx.write(1, 1, "测试条件验证");
+    newXlsx.write(1, 2, "测量点温度验证");
+    newXlsx.write(1, 3, "目标验证");
+    newXlsx.write(1, 4, "腔体验证");
+    newXlsx.write(1, 5, "标准验证");
+
+    // 分类写入数据
+    int modelingRow = 2, validationRow = 2;
+    for (int i = 0; i < selections.size(); ++i) {
+        const int srcRow = 2 + i;
+        QVector<QVariant> rowData;
+
+        // 读取D(4), E(5), F(6), G(7), H(8)列
+        for (int col = 4; col <= 8; ++col) {
+            rowData.append(srcDoc.read(srcRow, col));
+        }
+
+        if (selections[i]) {
+            newXlsx.selectSheet("建模");
+            for (int col = 1; col <= 5; ++col) {
+                newXlsx.write(modelingRow, col, rowData[col-1]);
+            }
+            modelingRow++;
+        } else {
+            newXlsx.selectSheet("验证");
+            for (int col = 1; col <= 5; ++col) {
+                newXlsx.write(validationRow, col, rowData[col-1]);
             }
+            validationRow++;
         }
-        validLines++;
     }
 
-    file.close();
+    // 保存文件
+    QFileInfo sourceInfo(sourceFilePath);
+    QString outputPath = sourceInfo.path() + "/" + sheetName + ".xlsx";
 
-    if (validLines == 0) {
-        qDebug() << "警告：TXT文件中无匹配时间的记录，文件：" << filePath;
+    if (!newXlsx.saveAs(outputPath)) {
+        rememberError(QString("模板保存失败: %1").arg(outputPath));
+        return "";
+    }
+    return outputPath;
+}
 
-        m_lastError = QString("TXT文件中无匹配时间的记录\n文件: %1\n目标时间: %2")
-                          .arg(filePath).arg(targetTime);
-        emit errorOccurred(m_lastError);
+// 多头拟合模板：一张表，左侧 8 列为建模点，右侧 8 列为验证点
+QString DataExcelProcessor::writeMultiHeadTemplate(QXlsx::Document& srcDoc,
+                                                   const QString& sheetName,
+                                                   const QVector<bool>& selections,
+                                                   const QString& sourceFilePath)
+{
+    srcDoc.selectSheet(sheetName);
+
+    // 提取设备名称
+    static const QRegularExpression re(R"(多(\d+))");
+    QRegularExpressionMatch match = re.match(sheetName);
+    QString deviceName = match.hasMatch() ? "多" + match.captured(1) : "未知设备";
+
+    // 创建新文档
+    QXlsx::Document newXlsx;
+    newXlsx.addSheet(sheetName);
+    newXlsx.selectSheet(sheetName);
+
+    // 写入列标题
+    QStringList headers = {"测量点温度", "TO1", "TO2", "TO3", "TA1", "TA2", "TA3", "标准",
+                           "测量点温度验证", "TO1验证", "TO2验证", "TO3验证", "TA1验证", "TA2验证", "TA3验证", "标准验证"};
+    for(int col = 1; col <= headers.size(); ++col) {
+        newXlsx.write(1, col, headers[col-1]);
     }
 
-    // 计算平均值
-    for (int i = 0; i < 16; ++i) {
-        if (!channelData[i].isEmpty()) {
-            result[i] = std::accumulate(channelData[i].begin(), channelData[i].end(), 0.0) / channelData[i].size();
+    // 写入数据
+    int selectedRow = 2;
+    int unselectedRow = 2;
+    for (int i = 0; i < selections.size(); ++i) {
+        const int srcRow = 4 + i;
+        QVector<QVariant> rowData;
+
+        for (int col = 4; col <= 10; ++col) {
+            rowData.append(srcDoc.read(srcRow, col));
+        }
+        rowData.append(srcDoc.read(srcRow, 14)); // N列
+
+        if (selections[i]) {
+            for (int col = 1; col <= 8; ++col) {
+                newXlsx.write(selectedRow, col, rowData[col-1]);
+            }
+            ++selectedRow;
+        } else {
+            for (int col = 9; col <= 16; ++col) {
+                newXlsx.write(unselectedRow, col, rowData[col-9]);
+            }
+            ++unselectedRow;
         }
     }
 
-    return result;
+    // 保存文件并返回路径
+    QFileInfo sourceFileInfo(sourceFilePath);
+    QString outputPath = sourceFileInfo.path() + "/" + deviceName + ".xlsx";
+
+    if (!newXlsx.saveAs(outputPath)) {
+        rememberError(QString("模板保存失败: %1").arg(outputPath));
+        return "";
+    }
+    return outputPath;
 }
 
 // 合并Excel文件实现
@@ -684,7 +914,7 @@ void DataExcelProcessor::mergeFiles(const QString& file1, const QString& file2,
     // 加载模板文件
     QXlsx::Document templateXlsx(templatePath);
     if (!QFile::exists(templatePath) || !templateXlsx.load()) {
-        emit errorOccurred("模板文件加载失败");
+        postError("模板文件加载失败");
         return;
     }
 
@@ -692,12 +922,12 @@ void DataExcelProcessor::mergeFiles(const QString& file1, const QString& file2,
     QXlsx::Document xlsx1(file1);
     QXlsx::Document xlsx2(file2);
     if (!QFile::exists(file1) || !xlsx1.load() || !QFile::exists(file2) || !xlsx2.load()) {
-        emit errorOccurred("数据文件加载失败");
+        postError("数据文件加载失败");
         return;
     }
 
     // **从箱内 & 箱外 Excel 读取标准温度数据**
-    QMap<QString, double> standardTempData;
+    MinuteValueTable standardTempData;
     loadStandardTemperature(xlsx1, standardTempData);
     loadStandardTemperature(xlsx2, standardTempData);
 
@@ -731,11 +961,11 @@ void DataExcelProcessor::mergeFiles(const QString& file1, const QString& file2,
     // QString outputPath = "E:/研究生学习资料/研二/高低温实验数据/多头2025.5新/多头箱内箱外合并结果_20250325160303.xlsx";
 
     if (!templateXlsx.saveAs(outputPath)) {
-        emit errorOccurred("合并文件保存失败");
+        postError("合并文件保存失败");
         return;
     }
 
-    emit operationCompleted(true, outputPath);
+    finishOperation(true, outputPath);
 }
 
 void DataExcelProcessor::generateTemplateExcelforMulitiHead(const QString& file1, const QString& file2, QString& outputTemplatePath) {
@@ -744,7 +974,7 @@ void DataExcelProcessor::generateTemplateExcelforMulitiHead(const QString& file1
     QXlsx::Document xlsx2(file2);
 
     if (!xlsx1.load() || !xlsx2.load()) {
-        emit errorOccurred("箱内或箱外数据文件加载失败");
+        postError("箱内或箱外数据文件加载失败");
         return;
     }
 
@@ -793,57 +1023,49 @@ void DataExcelProcessor::generateTemplateExcelforMulitiHead(const QString& file1
 
     // **保存模板文件**
     if (!newTemplate.saveAs(outputTemplatePath)) {
-        emit errorOccurred("模板文件生成失败");
+        postError("模板文件生成失败");
         return;
     }
 
-     emit operationCompleted(true, outputTemplatePath);
+     finishOperation(true, outputTemplatePath);
 }
 
 
 
-// 查找匹配的TXT文件
-QString DataExcelProcessor::findMatchingTxtFile(const QString& excelFilePath,
-                                                const QString& portNumber,
-                                                const QDate& date)
+// 查找匹配的TXT文件：目录只在首次使用或目录内容变化后列一次
+QStringList DataExcelProcessor::findMatchingTxtFiles(const QString& excelFilePath,
+                                                     const QString& portNumber,
+                                                     const QDate& date)
 {
-    QDir dir(QFileInfo(excelFilePath).absolutePath());
-    QStringList txtFiles = dir.entryList(QStringList() << "*.txt", QDir::Files);
-    QString dateString = date.toString("yyyyMMdd");
-
-    foreach (const QString &fileName, txtFiles) {
-        QFileInfo fileInfo(fileName);
-        QString baseName = fileInfo.completeBaseName();
-        QStringList parts = baseName.split('_');
-
-        if (parts.size() >= 3 &&
-            parts[1].trimmed() == portNumber.trimmed() &&
-            parts[2] == dateString) {
-            return fileName;
-        }
+    const QString dirPath = QFileInfo(excelFilePath).absolutePath();
+    TxtDirectoryIndex &directory = m_txtDirectories[dirPath];
+    if (directory.dirPath().isEmpty() || directory.isStale()) {
+        directory.build(dirPath);
+        qDebug() << "已建立TXT目录索引：" << dirPath << "，共" << directory.fileCount() << "个文件";
     }
 
+    QStringList files = directory.files(portNumber, date);
+    if (!files.isEmpty()) return files;
+
     // 优化：记录详细的搜索条件
-    qDebug() << "搜索条件：端口=" << portNumber << "，日期=" << dateString;
-    emit errorOccurred(QString("未找到端口 %1 在 %2 的TXT文件")
+    qDebug() << "搜索条件：端口=" << portNumber << "，日期=" << date.toString("yyyyMMdd");
+    postError(QString("未找到端口 %1 在 %2 的TXT文件")
                            .arg(portNumber, date.toString("yyyy-MM-dd")));
-    return QString();
+    return QStringList();
 }
 
 // 写入温度数据的通用方法
 bool DataExcelProcessor::writeTemperatures(QXlsx::Document& xlsx,
-                                           const QMap<QDateTime, QVector<double>>& tempDataMap,
-                                           const QMap<QDateTime, int>& dateTimeRowMap)
+                                           const QVector<ExcelTimeRow>& timeRows,
+                                           const QVector<QVector<double>>& tempData)
 {
     qDebug() << "开始写入温度数据...";
 
     try {
-        for (auto it = tempDataMap.begin(); it != tempDataMap.end(); ++it) {
-            QDateTime dt = it.key();
-            int row = dateTimeRowMap.value(dt, -1);
-            if (row == -1) continue; // 跳过无效行
+        for (int index = 0; index < timeRows.size() && index < tempData.size(); ++index) {
+            int row = timeRows[index].row;
 
-            const QVector<double>& temps = it.value();
+            const QVector<double>& temps = tempData[index];
             if (temps.isEmpty()) continue; // 没有有效温度数据，跳过
 
             // 写入温度数据
@@ -858,8 +1080,8 @@ bool DataExcelProcessor::writeTemperatures(QXlsx::Document& xlsx,
         // 填充U列平均值
         qDebug() << "开始填充 U 列的平均值...";
         int validRows = 0;
-        for (auto it = dateTimeRowMap.begin(); it != dateTimeRowMap.end(); ++it) {
-            int row = it.value();
+        for (const ExcelTimeRow &timeRow : timeRows) {
+            int row = timeRow.row;
 
             QVariant gVar = xlsx.read(row, 7);
             QVariant hVar = xlsx.read(row, 8);
@@ -881,11 +1103,11 @@ bool DataExcelProcessor::writeTemperatures(QXlsx::Document& xlsx,
         return true;
     } catch (const std::exception& e) {
         qDebug() << "写入Excel时发生异常：" << e.what();
-        m_lastError = "写入Excel时发生异常：" + QString(e.what());
+        rememberError("写入Excel时发生异常：" + QString(e.what()));
         return false;
     } catch (...) {
         qDebug() << "写入Excel时发生未知异常";
-        m_lastError = "写入Excel时发生未知异常";
+        rememberError("写入Excel时发生未知异常");
         return false;
     }
 }
@@ -905,38 +1127,27 @@ int DataExcelProcessor::findRowByDateTime(QXlsx::Document& xlsx, const QDateTime
 
 int DataExcelProcessor::copySheetData(QXlsx::Document& srcXlsx, QXlsx::Document& destXlsx,
                                       int srcStartRow, int destStartRow, const QString& envType,
-                                      const QMap<QString, double>& standardTempData) {
+                                      const MinuteValueTable& standardTempData) {
     int colCount = srcXlsx.dimension().lastColumn();
     int rowCount = srcXlsx.dimension().lastRow();
     int rowOffset = 0;
 
     qDebug() << "开始复制数据: " << envType;
+    if (rowCount < srcStartRow || colCount < 4) return destStartRow;
+
+    // 源数据整块读出（行优先，每行 colCount 个值），逐行过滤后整段写出
+    const QVector<QVariant> block = srcXlsx.readRange(QXlsx::CellRange(srcStartRow, 1, rowCount, colCount));
 
     for (int row = srcStartRow; row <= rowCount; ++row) {
-        QDate date = srcXlsx.read(row, 2).toDate();
-        QVariant timeCell = srcXlsx.read(row, 3);
+        const int offset = (row - srcStartRow) * colCount; // block[offset + col - 1] 即 (row, col)
+        QDate date;
         QTime time;
-
-        if (timeCell.userType() == QMetaType::QTime) {
-            time = timeCell.toTime();
-        } else if (timeCell.canConvert<double>()) {
-            double excelTime = timeCell.toDouble();
-            int totalSeconds = static_cast<int>(excelTime * 86400);
-            time = QTime(0, 0).addSecs(totalSeconds);
-        } else {
-            QString timeStr = timeCell.toString().trimmed();
-            time = QTime::fromString(timeStr, "HH:mm:ss");
-            if (!time.isValid()) {
-                time = QTime::fromString(timeStr, "HH:mm");
-            }
-        }
-
-        // **构建日期时间键**
-        QString key = date.toString("yyyy-MM-dd") + " " + time.toString("HH:mm");
+        ExcelTime::decodeDate(block[offset + 1], &date);
+        ExcelTime::decodeTime(block[offset + 2], &time);
 
         // **读取温度数据**
-        QVariant tempVar = srcXlsx.read(row, 4);
-        if (time.isNull() || tempVar.isNull()) continue;
+        const QVariant &tempVar = block[offset + 3];
+        if (!time.isValid() || tempVar.isNull()) continue;
 
         // **A列（序号）**
         destXlsx.write(destStartRow + rowOffset, 1, destStartRow + rowOffset - 3);
@@ -946,20 +1157,18 @@ int DataExcelProcessor::copySheetData(QXlsx::Document& srcXlsx, QXlsx::Document&
         destXlsx.write(destStartRow + rowOffset, 3, time.toString("HH:mm"));
 
         // **复制所有列数据**
-        for (int col = 4; col <= colCount; ++col) {
-            QVariant value = srcXlsx.read(row, col);
-            destXlsx.write(destStartRow + rowOffset, col, value);
-        }
+        destXlsx.writeRange(destStartRow + rowOffset, 4, block.mid(offset + 3, colCount - 3), colCount - 3);
 
         // **P列（16列）：填充箱内/箱外**
         destXlsx.write(destStartRow + rowOffset, 16, envType);
 
         // **N列（14列）：写入标准温度**
-        if (standardTempData.contains(key)) {
-            destXlsx.write(destStartRow + rowOffset, 14, standardTempData[key]);
-            qDebug() << "[匹配成功] 标准温度填充:" << key << "->" << standardTempData[key];
+        const qint64 minute = ExcelTime::minuteKey(date, time);
+        if (date.isValid() && standardTempData.contains(minute)) {
+            destXlsx.write(destStartRow + rowOffset, 14, standardTempData.value(minute));
+            qDebug() << "[匹配成功] 标准温度填充:" << date << time << "->" << standardTempData.value(minute);
         } else {
-            qDebug() << "[匹配失败] 没找到标准温度:" << key;
+            qDebug() << "[匹配失败] 没找到标准温度:" << date << time;
         }
 
         rowOffset++;
@@ -980,46 +1189,36 @@ int DataExcelProcessor::getLastRow(QXlsx::Document& xlsx, int col) {
 }
 
 void DataExcelProcessor::sortSheetData(QXlsx::Document& xlsx, int startRow, int endRow, int col) {
-    struct RowData {
-        int rowNum;
-        double value;
-        QVector<QVariant> rowValues;
-    };
-
-    QVector<RowData> data;
-
-    for (int row = startRow; row <= endRow; ++row) {
-        QVariant tempVar = xlsx.read(row, col);
-        if (tempVar.isNull()) continue;  // 仅跳过空值
-
-        double temp = tempVar.toDouble();  // 允许 0 作为有效温度
-
-        QVector<QVariant> rowValues;
-        for (int col = 1; col <= xlsx.dimension().lastColumn(); ++col) {
-            rowValues.append(xlsx.read(row, col));
-        }
-
-        data.append({row, temp, rowValues});
+    if (endRow < startRow) return;
+
+    // 只读出排序列，求出新的行顺序后整行搬移，不再逐格读写
+    const QVector<QVariant> keys = xlsx.readRange(QXlsx::CellRange(startRow, col, endRow, col));
+    QVector<double> temps(keys.size());
+    QVector<int> order;   // 有值的行
+    QVector<int> blanks;  // 空值行，保持原顺序排在最后
+    for (int i = 0; i < keys.size(); ++i) {
+        temps[i] = keys[i].toDouble();  // 允许 0 作为有效温度
+        (keys[i].isNull() ? blanks : order).append(startRow + i);
     }
 
-    // 按D列降序排序
-    std::sort(data.begin(), data.end(), [](const RowData& a, const RowData& b) {
-        return a.value > b.value;  // 温度降序（保留 0）
+    // 按排序列降序排序
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return temps[a - startRow] > temps[b - startRow];  // 温度降序（保留 0）
     });
-
-    // 重新写入排序后数据
-    for (int i = 0; i < data.size(); ++i) {
-        for (int col = 1; col <= data[i].rowValues.size(); ++col) {
-            xlsx.write(startRow + i, col, data[i].rowValues[col - 1]);
+    const int valueRows = order.size();
+    order += blanks;
+    xlsx.permuteRows(startRow, order);
+
+    // A列（序号）：按新的行顺序填充，完全空白的行不补序号
+    for (int i = 0; i < order.size(); ++i) {
+        if (i < valueRows || !xlsx.read(startRow + i, 1).isNull()) {
+            xlsx.write(startRow + i, 1, i + 1);
         }
-
-        // A列（序号）：按新的行顺序填充
-        xlsx.write(startRow + i, 1, i + 1);
     }
 }
 
 void DataExcelProcessor::loadStandardTemperature(QXlsx::Document& srcXlsx,
-                                                 QMap<QString, double>& standardTempData) {
+                                                 MinuteValueTable& standardTempData) {
     if (!srcXlsx.sheetNames().contains("标准")) {
         qDebug() << "未找到标准工作表，跳过";
         return;
@@ -1035,15 +1234,10 @@ void DataExcelProcessor::loadStandardTemperature(QXlsx::Document& srcXlsx,
         QVariant timeVar = srcXlsx.read(row, 3);
         QVariant tempVar = srcXlsx.read(row, 21); // U列
 
-        QDate date = dateVar.toDate();
-        QTime time = timeVar.toTime(); // 直接转换时间
-
-        if (!time.isValid()) {
-            time = QTime::fromString(timeVar.toString(), "HH:mm:ss");
-        }
-        if (!time.isValid()) {
-            time = QTime::fromString(timeVar.toString(), "HH:mm");
-        }
+        QDate date;
+        QTime time;
+        ExcelTime::decodeDate(dateVar, &date);
+        ExcelTime::decodeTime(timeVar, &time);
 
         // **调试信息**
         qDebug() << "Row:" << row;
@@ -1079,12 +1273,13 @@ void DataExcelProcessor::loadStandardTemperature(QXlsx::Document& srcXlsx,
             continue;
         }
 
-        QString key = date.toString("yyyy-MM-dd") + " " + time.toString("HH:mm");
-        standardTempData[key] = temperature;
+        standardTempData.insert(ExcelTime::minuteKey(date, time), temperature);
 
-        qDebug() << "读取标准温度:" << key << "->" << temperature;
+        qDebug() << "读取标准温度:" << date << time << "->" << temperature;
     }
 
+    // 箱内、箱外两份依次读入同一张表，每次读完都重新排序，以便随时可查
+    standardTempData.finalize();
     qDebug() << "标准温度读取完成，共" << standardTempData.size() << "条数据";
 }
 
@@ -1096,13 +1291,13 @@ QString DataExcelProcessor::mergeSingleHeadFiles(const QString& inFile, const QS
         QXlsx::Document outDoc(outFile);
 
         if(inDoc.sheetNames().isEmpty() || outDoc.sheetNames().isEmpty()){
-            emit errorOccurred("文件缺少工作表");
+            setLastError(QString("文件缺少工作表：%1、%2").arg(inFile, outFile));
             return "";
         }
 
         // 验证第一个工作表是标准
         if(inDoc.sheetNames().first() != "标准" || outDoc.sheetNames().first() != "标准"){
-            emit errorOccurred("第一个工作表必须命名为'标准'");
+            setLastError(QString("第一个工作表必须命名为'标准'：%1、%2").arg(inFile, outFile));
             return "";
         }
 
@@ -1121,7 +1316,7 @@ QString DataExcelProcessor::mergeSingleHeadFiles(const QString& inFile, const QS
                        std::back_inserter(allDevices));
 
         // 加载标准温度数据
-        QMap<QString, double> stdTempMap;
+        MinuteValueTable stdTempMap;
         loadStandardTemperature(inDoc, stdTempMap);
         loadStandardTemperature(outDoc, stdTempMap);
 
@@ -1165,13 +1360,13 @@ QString DataExcelProcessor::mergeSingleHeadFiles(const QString& inFile, const QS
         QString outputPath = QFileInfo(inFile).path() + "/单头箱内箱外合并结果_"
                              + QDateTime::currentDateTime().toString("yyyyMMddHHmm") + ".xlsx";
         if (!templateDoc.saveAs(outputPath)) {
-            emit errorOccurred("文件保存失败");
+            setLastError("单头合并文件保存失败：" + outputPath);
             return "";
         }
-        emit operationCompleted(true, outputPath);
+        finishOperation(true, outputPath);
         return outputPath;
     } catch (...) {
-        emit errorOccurred("合并过程中发生未知错误");
+        setLastError(QString("合并过程中发生未知错误：%1、%2").arg(inFile, outFile));
         return "";
     }
 }
@@ -1225,11 +1420,11 @@ void DataExcelProcessor::processDeviceData(QXlsx::Document& srcXlsx,
                                            QXlsx::Document& destXlsx,
                                            const QString& envType,
                                            const QPair<int, QString>& device,
-                                           const QMap<QString, double>& stdTemp)
+                                           const MinuteValueTable& stdTemp)
 {
     QStringList sheetNames = srcXlsx.sheetNames();
     if (sheetNames.size() <= 1) { // 只有 "标准" 一个表
-        emit errorOccurred("没有足够的工作表，无法读取数据");
+        postError("没有足够的工作表，无法读取数据");
         return;
     }
 
@@ -1237,7 +1432,7 @@ void DataExcelProcessor::processDeviceData(QXlsx::Document& srcXlsx,
     QRegularExpression re("(\\d+)$");  // 匹配字符串末尾的数字
     QRegularExpressionMatch match = re.match(device.second);
     if (!match.hasMatch()) {
-        emit errorOccurred(QString("无法解析设备号: %1").arg(device.second));
+        postError(QString("无法解析设备号: %1").arg(device.second));
         return;
     }
     int deviceNumber = match.captured(1).toInt(); // 设备号，如 34
@@ -1260,7 +1455,7 @@ void DataExcelProcessor::processDeviceData(QXlsx::Document& srcXlsx,
     }
 
     if (selectedSheet.isEmpty()) {
-        emit errorOccurred(QString("未找到匹配的工作表: 设备号 %1").arg(deviceNumber));
+        postError(QString("未找到匹配的工作表: 设备号 %1").arg(deviceNumber));
         return;
     }
 
@@ -1283,8 +1478,10 @@ void DataExcelProcessor::processDeviceData(QXlsx::Document& srcXlsx,
 
     while(emptyCount < maxEmptyRows) {
         // 读取日期时间
-        QDate date = srcXlsx.read(srcRow, 2).toDate();
-        QTime time = srcXlsx.read(srcRow, 3).toTime();
+        QDate date;
+        QTime time;
+        ExcelTime::decodeDate(srcXlsx.read(srcRow, 2), &date);
+        ExcelTime::decodeTime(srcXlsx.read(srcRow, 3), &time);
 
         // 读取测试点温度（D列）
         QVariant testPointTemp = srcXlsx.read(srcRow, 4); // D列是第4列
@@ -1315,10 +1512,7 @@ void DataExcelProcessor::processDeviceData(QXlsx::Document& srcXlsx,
             destXlsx.write(destRow, 7, chamberTemp);
 
             // **写入标准温度**
-            QString timeKey = QString("%1 %2")
-                                  .arg(date.toString("yyyy-MM-dd"))
-                                  .arg(time.toString("HH:mm"));
-            destXlsx.write(destRow, 8, stdTemp.value(timeKey, 65535));
+            destXlsx.write(destRow, 8, stdTemp.value(ExcelTime::minuteKey(date, time), 65535));
 
             destRow++;
             emptyCount = 0;
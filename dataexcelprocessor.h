@@ -1,7 +1,12 @@
 #pragma once
 #include <QObject>
+#include <QMutex>
 #include <QtConcurrent/QtConcurrent>
 #include "xlsxdocument.h"
+#include "exceltime.h"
+#include "jobqueue.h"
+#include "txtminuteindex.h"
+#include "txtdirectoryindex.h"
 
 class DataExcelProcessor : public QObject
 {
@@ -20,8 +25,39 @@ public:
 
     void generateTemplateExcelforMulitiHead(const QString& file1, const QString& file2, QString& outputTemplatePath);
 
-    QString lastError() const { return m_lastError; }
-    void clearError() { m_lastError.clear(); }
+    // ---- 拟合模板（界面与批处理程序共用） ----
+    // 合并结果中一张工作表的候选建模点（温度、测试条件），按行顺序，与 selections 一一对应
+    static void readModelingCandidates(QXlsx::Document& mergedDoc, const QString& sheetName, bool multiHead,
+                                       QVector<double>& temperatures, QVector<QString>& conditions);
+    // 按建模点选择写出拟合模板，返回模板路径；保存失败返回空并记录 lastError()
+    QString writeSingleHeadTemplate(QXlsx::Document& mergedDoc, const QString& sheetName,
+                                    const QVector<bool>& selections, const QString& mergedFilePath);
+    QString writeMultiHeadTemplate(QXlsx::Document& mergedDoc, const QString& sheetName,
+                                   const QVector<bool>& selections, const QString& mergedFilePath);
+
+    // 任务分组：同一处理器的任务互斥，默认 "excel"；批处理程序每个数据集一个处理器、一个分组
+    void setJobGroup(const QString& group) { m_jobGroup = group; }
+
+    // 处理任务在工作线程中运行，错误信息加锁读写
+    QString lastError() const;
+    void clearError();
+
+    // 处理任务提交到这个队列（未设置时首次处理会自建一个）
+    void setJobQueue(JobQueue *queue);
+    JobQueue *jobQueue() const { return m_jobQueue; }
+
+    // 一次处理任务各阶段耗时（毫秒）。TXT 解析在全局线程池上按文件并行，
+    // 线程数由 QThreadPool::globalInstance()->maxThreadCount() 决定
+    struct StageTimings {
+        qint64 loadMs = 0;      // 加载工作簿
+        qint64 readMs = 0;      // 读取 Excel 时间列、定位 TXT 文件
+        qint64 aggregateMs = 0; // 并行建立分钟索引
+        qint64 writeMs = 0;     // 按分钟查表并写回单元格（串行）
+        qint64 saveMs = 0;      // 保存 xlsx
+        int txtFiles = 0;       // 本次实际解析（或读取缓存）的 TXT 文件数
+        int threads = 0;        // 解析阶段实际使用的线程数
+    };
+    StageTimings lastTimings() const { return m_timings; }
 
 signals:
     void progressUpdated(int percent);
@@ -29,11 +65,23 @@ signals:
     void errorOccurred(const QString& message);
 
 public slots:
-    void startProcessing(ProcessType type, const QString& sourcePath,
-                         const QString& templatePath = "",
-                         const QString& outputPath = "");
+    int startProcessing(ProcessType type, const QString& sourcePath,
+                        const QString& templatePath = "",
+                        const QString& outputPath = "",
+                        JobQueue::Priority priority = JobQueue::NormalPriority);
 
 private:
+    JobResult runJob(const JobContext& ctx, ProcessType type, const QString& sourcePath,
+                     const QString& outputPath, const QString& templatePath);
+
+    // 线程安全的结果上报：错误、进度和完成信号都在主线程发出
+    void rememberError(const QString& message);
+    void setLastError(const QString& message);
+    void postError(const QString& message);
+    void postProgress(int percent);
+    void finishOperation(bool success, const QString& resultPath);
+    bool isCancelled() const;
+
     // 核心处理方法
     void processStandard(const QString& excelPath);
     void processSingleHead(const QString& excelPath);
@@ -42,18 +90,29 @@ private:
                     const QString& templatePath);
 
     // 辅助方法
-    QString findMatchingTxtFile(const QString& excelFilePath,
-                                const QString& portNumber,
-                                const QDate& date);
-
-    QVector<double> processTxtFile(const QString& filePath,
-                                   const QDateTime& targetDateTime);
-
-    QVector<double> processSingleHeadTxtFile(const QString& txtFilePath,
-                                             const QDateTime& dateTime);
-
-    QVector<double> processMultiHeadTxtFile(const QString& txtFilePath,
-                                            const QDateTime& dateTime);
+    // 同一端口同一天的所有采集会话文件（绝对路径）
+    QStringList findMatchingTxtFiles(const QString& excelFilePath,
+                                     const QString& portNumber,
+                                     const QDate& date);
+
+    // 每个 TXT 文件在一次处理任务内只解析一遍，之后按分钟查表
+    const TxtMinuteIndex *txtIndex(const QString& txtFilePath, TxtMinuteIndex::Format format);
+    const TxtMinuteIndex *txtIndex(const QStringList& txtFiles, TxtMinuteIndex::Format format);
+    // 在线程池上并行建立尚未缓存的分钟索引，只能在处理线程（非工作线程）中调用。
+    // minutes 为本次任务用到的全部分钟，压缩日志据此只解压相关的块
+    void prefetchTxtIndexes(const QList<QStringList>& fileSets, TxtMinuteIndex::Format format,
+                            const QSet<qint64>& minutes = QSet<qint64>());
+    void logTimings(const QString& jobName) const;
+
+    // 按时间行所在分钟查 TXT 分钟汇总（键由 ExcelTimeRow::txtMinuteKey 直接换算）
+    QVector<double> processTxtFile(const QStringList& txtFiles,
+                                   const ExcelTimeRow& timeRow);
+
+    QVector<double> processSingleHeadTxtFile(const QStringList& txtFiles,
+                                             const ExcelTimeRow& timeRow);
+
+    QVector<double> processMultiHeadTxtFile(const QStringList& txtFiles,
+                                            const ExcelTimeRow& timeRow);
 
     int findRowByDateTime(QXlsx::Document& xlsx, const QDateTime& dt);
 
@@ -61,25 +120,33 @@ private:
 
     int copySheetData(QXlsx::Document& srcXlsx, QXlsx::Document& destXlsx,
                                           int srcStartRow, int destStartRow, const QString& envType,
-                      const QMap<QString, double>& standardTempData);
+                      const MinuteValueTable& standardTempData);
 
     void sortSheetData(QXlsx::Document& xlsx, int startRow, int endRow, int col);
 
     void loadStandardTemperature(QXlsx::Document& srcXlsx,
-                                 QMap<QString, double>& standardTempData);
+                                 MinuteValueTable& standardTempData);
 
     // Excel操作封装方法
     bool writeTemperatures(QXlsx::Document& xlsx,
-                           const QMap<QDateTime, QVector<double>>& dataMap,
-                           const QMap<QDateTime, int>& rowMap);
+                           const QVector<ExcelTimeRow>& timeRows,
+                           const QVector<QVector<double>>& tempData);
 
 
     QVector<QPair<int, QString>> detectDevices(QXlsx::Document& doc);
     void processDeviceData(QXlsx::Document& srcXlsx, QXlsx::Document& destXlsx,
                            const QString& envType, const QPair<int, QString>& device,
-                           const QMap<QString, double>& stdTemp);
+                           const MinuteValueTable& stdTemp);
 
     QString m_lastError; // 存储最新错误信息
+    mutable QMutex m_errorMutex;
+    JobQueue *m_jobQueue = nullptr;
+    QString m_jobGroup = "excel";
+    const JobContext *m_job = nullptr; // 当前运行的任务（"excel" 分组互斥，同一时刻只有一个）
+    JobResult m_jobResult;
+    QHash<QString, TxtMinuteIndex> m_txtIndexes; // 格式|绝对路径 -> 分钟索引
+    QHash<QString, TxtDirectoryIndex> m_txtDirectories; // 目录 -> (端口, 日期) 文件索引
+    StageTimings m_timings;
 
 
 };
@@ -0,0 +1,341 @@
+#include "batchrunner.h"
+#include "dataexcelprocessor.h"
+#include "pythonprocessor.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QDebug>
+#include <memory>
+
+const QStringList BatchRunner::AllStages = {"fill", "merge", "template", "fit"};
+
+BatchRunner::BatchRunner(JobQueue *queue, QObject *parent)
+    : QObject(parent), m_queue(queue)
+{
+}
+
+void BatchRunner::start(const QList<BatchRun> &runs)
+{
+    m_wallTimer.start();
+    m_runs.clear();
+    m_remaining = runs.size();
+    if (runs.isEmpty()) {
+        QMetaObject::invokeMethod(this, &BatchRunner::finished, Qt::QueuedConnection);
+        return;
+    }
+
+    for (const BatchRun &run : runs) {
+        RunState state;
+        state.run = run;
+        state.excel = new DataExcelProcessor(this);
+        state.excel->setJobQueue(m_queue);
+        state.excel->setJobGroup("excel:" + run.name);
+        state.python = new PythonProcessor(this);
+        state.python->setJobGroup("python:" + run.name);
+        if (!m_scriptDirectory.isEmpty()) state.python->setScriptDirectory(m_scriptDirectory);
+        state.insideFilled = run.insidePath;
+        state.outsideFilled = run.outsidePath;
+        state.mergedPath = run.mergedPath;
+        m_runs.append(state);
+    }
+
+    for (int i = 0; i < m_runs.size(); ++i) {
+        m_runs[i].timer.start();
+        if (hasStage("fill")) {
+            fill(i, 0);
+        } else if (hasStage("merge")) {
+            merge(i);
+        } else if (hasStage("template")) {
+            generateTemplates(i);
+        } else {
+            finishRun(i, "没有可执行的阶段");
+        }
+    }
+}
+
+void BatchRunner::fill(int index, int step)
+{
+    RunState &state = m_runs[index];
+    if (step >= 4) {
+        if (hasStage("merge")) {
+            merge(index);
+        } else {
+            finishRun(index);
+        }
+        return;
+    }
+
+    const bool inside = step < 2;
+    const bool standard = (step % 2) == 0;
+    const QString source = inside ? state.insideFilled : state.outsideFilled;
+    const DataExcelProcessor::ProcessType type = standard ? DataExcelProcessor::StandardData
+                                                          : (state.run.multiHead ? DataExcelProcessor::MultiHead
+                                                                                 : DataExcelProcessor::SingleHead);
+    const QString stageName = QString("fill.%1.%2").arg(standard ? "standard" : "head", inside ? "inside" : "outside");
+
+    int id = state.excel->startProcessing(type, source);
+    if (id < 0) {
+        finishRun(index, stageName + "：" + state.excel->lastError());
+        return;
+    }
+
+    m_queue->whenFinished(id, this, [this, index, step, inside, stageName](const JobQueue::JobInfo &info) {
+        recordStage(index, stageName, info, {info.result.resultPath}, true);
+        if (!info.result.success) {
+            finishRun(index, stageName + "：" + info.result.error);
+            return;
+        }
+        // 下一步以本步输出为输入（标准数据另存为 _processed，单头/多头原地写回）
+        if (inside) {
+            m_runs[index].insideFilled = info.result.resultPath;
+        } else {
+            m_runs[index].outsideFilled = info.result.resultPath;
+        }
+        fill(index, step + 1);
+    });
+}
+
+void BatchRunner::merge(int index)
+{
+    RunState &state = m_runs[index];
+    DataExcelProcessor *excel = state.excel;
+    const QString inFile = state.insideFilled;
+    const QString outFile = state.outsideFilled;
+
+    auto next = [this, index](const JobQueue::JobInfo &info) {
+        recordStage(index, "merge", info, {info.result.resultPath});
+        if (!info.result.success) {
+            finishRun(index, "merge：" + info.result.error);
+            return;
+        }
+        m_runs[index].mergedPath = info.result.resultPath;
+        if (hasStage("template")) {
+            generateTemplates(index);
+        } else {
+            finishRun(index);
+        }
+    };
+
+    if (!state.run.multiHead) {
+        int id = m_queue->submit("合并单头文件：" + state.run.name, excelGroup(state), JobQueue::NormalPriority,
+                                 [excel, inFile, outFile](const JobContext &) {
+            QString mergedPath = excel->mergeSingleHeadFiles(inFile, outFile);
+            return mergedPath.isEmpty() ? JobResult::failed(excel->lastError()) : JobResult::ok(mergedPath);
+        });
+        m_queue->whenFinished(id, this, next);
+        return;
+    }
+
+    // 多头：先按箱内箱外的工作表生成合并模板，再合并
+    int templateJob = m_queue->submit("生成多头合并模板：" + state.run.name, excelGroup(state), JobQueue::NormalPriority,
+                                      [excel, inFile, outFile](const JobContext &) {
+        excel->clearError();
+        QString templatePath;
+        excel->generateTemplateExcelforMulitiHead(inFile, outFile, templatePath);
+        if (templatePath.isEmpty() || !QFile::exists(templatePath)) {
+            return JobResult::failed(excel->lastError().isEmpty() ? QString("模板文件生成失败") : excel->lastError());
+        }
+        return JobResult::ok(templatePath);
+    });
+    m_queue->whenFinished(templateJob, this, [this, index, inFile, outFile, next](const JobQueue::JobInfo &info) {
+        recordStage(index, "merge.template", info, {info.result.resultPath});
+        if (!info.result.success) {
+            finishRun(index, "merge.template：" + info.result.error);
+            return;
+        }
+        int id = m_runs[index].excel->startProcessing(DataExcelProcessor::MergeFiles, inFile, outFile,
+                                                      info.result.resultPath);
+        if (id < 0) {
+            finishRun(index, "merge：" + m_runs[index].excel->lastError());
+            return;
+        }
+        m_queue->whenFinished(id, this, next);
+    });
+}
+
+void BatchRunner::generateTemplates(int index)
+{
+    RunState &state = m_runs[index];
+    if (state.mergedPath.isEmpty()) {
+        finishRun(index, "template：没有合并结果");
+        return;
+    }
+
+    DataExcelProcessor *excel = state.excel;
+    const QString mergedPath = state.mergedPath;
+    const bool multiHead = state.run.multiHead;
+    const BatchRun run = state.run;
+    auto templates = std::make_shared<QStringList>();
+
+    // 与界面流程相同：跳过“标准”表，多头只处理 COMx-多N 表；建模点不弹框，按清单或默认规则选择
+    int id = m_queue->submit("生成拟合模板：" + run.name, excelGroup(state), JobQueue::NormalPriority,
+                             [this, excel, mergedPath, multiHead, run, templates](const JobContext &ctx) {
+        QXlsx::Document mergedDoc(mergedPath);
+        if (!mergedDoc.load()) return JobResult::failed("合并文件加载失败：" + mergedPath);
+
+        static const QRegularExpression multiSheet(R"(^COM\d+-多(\d+)$)");
+        QStringList failedSheets;
+        for (const QString &sheetName : mergedDoc.sheetNames()) {
+            if (ctx.isCancelled()) return JobResult::failed("已取消");
+            if (sheetName == "标准") continue;
+            if (multiHead && !multiSheet.match(sheetName).hasMatch()) continue;
+
+            QVector<double> temperatures;
+            QVector<QString> conditions;
+            DataExcelProcessor::readModelingCandidates(mergedDoc, sheetName, multiHead, temperatures, conditions);
+            if (temperatures.isEmpty()) continue;
+
+            const QVector<bool> selections = selectionsFor(run, temperatures.size());
+            QString templatePath = multiHead
+                ? excel->writeMultiHeadTemplate(mergedDoc, sheetName, selections, mergedPath)
+                : excel->writeSingleHeadTemplate(mergedDoc, sheetName, selections, mergedPath);
+            if (templatePath.isEmpty()) {
+                failedSheets.append(sheetName);
+            } else {
+                templates->append(templatePath);
+            }
+        }
+
+        if (!failedSheets.isEmpty()) {
+            return JobResult::failed("模板保存失败：" + failedSheets.join("、"));
+        }
+        if (templates->isEmpty()) return JobResult::failed("未生成任何拟合模板");
+        return JobResult::ok(templates->first());
+    });
+
+    m_queue->whenFinished(id, this, [this, index, templates](const JobQueue::JobInfo &info) {
+        recordStage(index, "template", info, *templates);
+        m_runs[index].templates = *templates;
+        if (!info.result.success) {
+            finishRun(index, "template：" + info.result.error);
+            return;
+        }
+        if (hasStage("fit")) {
+            fit(index);
+        } else {
+            finishRun(index);
+        }
+    });
+}
+
+void BatchRunner::fit(int index)
+{
+    RunState &state = m_runs[index];
+    state.python->setTesterReviewerInfo(state.run.tester, state.run.reviewer);
+    state.python->setMergedFilePath(state.mergedPath);
+
+    auto pending = std::make_shared<int>(state.templates.size());
+    auto failed = std::make_shared<QStringList>();
+    for (const QString &templatePath : state.templates) {
+        int id = state.python->submitFittingJob(m_queue, templatePath, state.run.multiHead, JobQueue::NormalPriority);
+        const QString stageName = "fit." + QFileInfo(templatePath).completeBaseName();
+        m_queue->whenFinished(id, this, [this, index, stageName, pending, failed](const JobQueue::JobInfo &info) {
+            recordStage(index, stageName, info, {info.result.resultPath});
+            if (!info.result.success) failed->append(stageName);
+            if (--*pending > 0) return;
+            finishRun(index, failed->isEmpty() ? QString() : "fit：失败 " + failed->join("、"));
+        });
+    }
+}
+
+void BatchRunner::finishRun(int index, const QString &error)
+{
+    RunState &state = m_runs[index];
+    if (state.done) return;
+    state.done = true;
+    state.error = error;
+    state.totalMs = state.timer.elapsed();
+    qDebug().noquote() << QString("[%1] %2，用时 %3 ms%4")
+                              .arg(state.run.name, error.isEmpty() ? "完成" : "失败")
+                              .arg(state.totalMs)
+                              .arg(error.isEmpty() ? QString() : "：" + error);
+
+    if (--m_remaining == 0) {
+        m_wallMs = m_wallTimer.elapsed();
+        emit finished();
+    }
+}
+
+void BatchRunner::recordStage(int index, const QString &name, const JobQueue::JobInfo &info,
+                              const QStringList &outputs, bool withTimings)
+{
+    QJsonObject stage;
+    stage["name"] = name;
+    stage["ok"] = info.result.success;
+    if (!info.result.error.isEmpty()) stage["error"] = info.result.error;
+    const bool started = info.startedAt.isValid();
+    stage["queuedMs"] = info.queuedAt.msecsTo(started ? info.startedAt : info.finishedAt);
+    stage["ms"] = started ? info.startedAt.msecsTo(info.finishedAt) : 0;
+
+    QJsonArray files;
+    for (const QString &path : outputs) {
+        if (!path.isEmpty()) files.append(path);
+    }
+    stage["outputs"] = files;
+
+    if (withTimings) {
+        const DataExcelProcessor::StageTimings timings = m_runs[index].excel->lastTimings();
+        QJsonObject detail;
+        detail["loadMs"] = timings.loadMs;
+        detail["readMs"] = timings.readMs;
+        detail["aggregateMs"] = timings.aggregateMs;
+        detail["writeMs"] = timings.writeMs;
+        detail["saveMs"] = timings.saveMs;
+        detail["txtFiles"] = timings.txtFiles;
+        detail["threads"] = timings.threads;
+        stage["timings"] = detail;
+    }
+    m_runs[index].stages.append(stage);
+}
+
+QVector<bool> BatchRunner::selectionsFor(const BatchRun &run, int candidates) const
+{
+    const QVector<int> &modeling = !run.modeling.isEmpty() ? run.modeling : m_defaultModeling;
+    QVector<bool> selections(candidates, false);
+    if (modeling.isEmpty()) {
+        for (int i = 0; i < candidates; i += 2) selections[i] = true;
+        return selections;
+    }
+    for (int i : modeling) {
+        if (i >= 0 && i < candidates) selections[i] = true;
+    }
+    return selections;
+}
+
+int BatchRunner::failedCount() const
+{
+    int count = 0;
+    for (const RunState &state : m_runs) {
+        if (!state.done || !state.error.isEmpty()) ++count;
+    }
+    return count;
+}
+
+QJsonObject BatchRunner::report() const
+{
+    QJsonArray runs;
+    for (const RunState &state : m_runs) {
+        QJsonObject run;
+        run["name"] = state.run.name;
+        run["type"] = state.run.multiHead ? "multi" : "single";
+        run["inside"] = state.run.insidePath;
+        run["outside"] = state.run.outsidePath;
+        run["merged"] = state.mergedPath;
+        run["templates"] = QJsonArray::fromStringList(state.templates);
+        run["ok"] = state.done && state.error.isEmpty();
+        if (!state.error.isEmpty()) run["error"] = state.error;
+        run["totalMs"] = state.totalMs;
+        run["stages"] = state.stages;
+        runs.append(run);
+    }
+
+    QJsonObject report;
+    report["generatedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    report["jobs"] = m_queue->maxWorkers();
+    report["stages"] = QJsonArray::fromStringList(m_stages);
+    report["wallMs"] = m_wallMs;
+    report["failed"] = failedCount();
+    report["runs"] = runs;
+    return report;
+}
@@ -0,0 +1,97 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVector>
+#include "jobqueue.h"
+
+class DataExcelProcessor;
+class PythonProcessor;
+
+// 一组箱内、箱外数据（一次高低温试验）
+struct BatchRun
+{
+    QString name;
+    bool multiHead = false;
+    QString insidePath;     // 箱内 xlsx
+    QString outsidePath;    // 箱外 xlsx
+    QString mergedPath;     // 已有的合并结果（不执行 merge 阶段时从 template 开始）
+    QVector<int> modeling;  // 建模点在候选点中的序号（0 起），为空时按默认规则
+    QString tester;
+    QString reviewer;
+};
+
+// 无界面批处理：每组数据依次执行
+//   fill      标准温度 + 单头/多头数据回填（箱内、箱外各一遍）
+//   merge     箱内箱外合并（多头先生成合并模板）
+//   template  按建模点生成拟合模板
+//   fit       Python 拟合 + 证书
+// 每组数据一个 DataExcelProcessor、一个 PythonProcessor，各自一个任务分组；
+// 不同组之间经同一个 JobQueue 并行，并发数即队列的 max workers
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+public:
+    static const QStringList AllStages;
+
+    explicit BatchRunner(JobQueue *queue, QObject *parent = nullptr);
+
+    void setStages(const QStringList &stages) { m_stages = stages; }
+    void setScriptDirectory(const QString &dir) { m_scriptDirectory = dir; }
+    // 数据集未指定建模点时使用；也为空则隔一个取一个（第 0、2、4… 个候选点）
+    void setDefaultModeling(const QVector<int> &modeling) { m_defaultModeling = modeling; }
+
+    void start(const QList<BatchRun> &runs);
+
+    QJsonObject report() const;
+    int failedCount() const;
+
+signals:
+    void finished();
+
+private:
+    struct RunState {
+        BatchRun run;
+        DataExcelProcessor *excel = nullptr;
+        PythonProcessor *python = nullptr;
+        QString insideFilled;
+        QString outsideFilled;
+        QString mergedPath;
+        QStringList templates;
+        QJsonArray stages;
+        QString error;
+        bool done = false;
+        QElapsedTimer timer;
+        qint64 totalMs = -1;
+    };
+
+    bool hasStage(const QString &stage) const { return m_stages.contains(stage); }
+    QString excelGroup(const RunState &state) const { return "excel:" + state.run.name; }
+
+    // 回填：箱内标准、箱内单头/多头、箱外标准、箱外单头/多头，同一处理器依次执行
+    void fill(int index, int step);
+    void merge(int index);
+    void generateTemplates(int index);
+    void fit(int index);
+    void finishRun(int index, const QString &error = QString());
+
+    // 记录一个阶段：耗时取任务实际运行时间，另记排队等待时间
+    void recordStage(int index, const QString &name, const JobQueue::JobInfo &info,
+                     const QStringList &outputs = QStringList(), bool withTimings = false);
+    QVector<bool> selectionsFor(const BatchRun &run, int candidates) const;
+
+    JobQueue *m_queue;
+    QStringList m_stages = AllStages;
+    QString m_scriptDirectory;
+    QVector<int> m_defaultModeling;
+    QList<RunState> m_runs;
+    int m_remaining = 0;
+    QElapsedTimer m_wallTimer;
+    qint64 m_wallMs = 0;
+};
+
+#endif // BATCHRUNNER_H
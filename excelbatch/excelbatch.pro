@@ -0,0 +1,36 @@
+# 高低温数据无界面批处理（独立程序，与主工程共用数据处理、任务队列和 Python 拟合代码）
+# 按目录或 JSON 清单执行 回填 → 合并 → 拟合模板 → 拟合 + 证书，输出各阶段耗时报告
+# 证书 PDF 依赖 printsupport（会链接 QtWidgets，但不创建窗口）；无显示环境时设置 QT_QPA_PLATFORM=offscreen
+QT = core gui concurrent printsupport
+
+include(../QXlsx/QXlsx.pri)
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = excelbatch
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../dataexcelprocessor.cpp \
+    ../exceltime.cpp \
+    ../jobqueue.cpp \
+    ../pythonprocessor.cpp \
+    ../txtblocklog.cpp \
+    ../txtdirectoryindex.cpp \
+    ../txtlogscanner.cpp \
+    ../txtminuteindex.cpp \
+    batchrunner.cpp \
+    main.cpp
+
+HEADERS += \
+    ../dataexcelprocessor.h \
+    ../exceltime.h \
+    ../jobqueue.h \
+    ../pythonprocessor.h \
+    ../txtblocklog.h \
+    ../txtdirectoryindex.h \
+    ../txtlogscanner.h \
+    ../txtminuteindex.h \
+    batchrunner.h
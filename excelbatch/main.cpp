@@ -0,0 +1,206 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QDebug>
+#include "batchrunner.h"
+#include "jobqueue.h"
+
+// 用法：
+//   excelbatch --dir D:/高低温数据 --jobs 4 --report report.json
+//   excelbatch --manifest runs.json --stages fill,merge --jobs 2
+// --dir：目录本身及其下每个子目录视为一组数据，取其中文件名含“箱内”“箱外”的 xlsx 各一个
+//        （跳过 _processed 等中间结果），目录名或文件名含“多头”按多头处理
+// --manifest：JSON 清单，相对路径相对于清单所在目录
+//   { "runs": [ { "name": "B机-20240911", "type": "single" | "multi",
+//                 "inside": "箱内.xlsx", "outside": "箱外.xlsx", "merged": "可选，已有合并结果",
+//                 "modeling": [0, 2, 4], "tester": "张三", "reviewer": "李四" } ] }
+// 证书中的 PDF 需要 Qt 平台插件，无显示环境时运行前设置 QT_QPA_PLATFORM=offscreen
+namespace {
+QVector<int> parseIndexes(const QString &text)
+{
+    QVector<int> indexes;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        int value = part.trimmed().toInt(&ok);
+        if (ok) indexes.append(value);
+    }
+    return indexes;
+}
+
+bool isSourceWorkbook(const QFileInfo &info)
+{
+    const QString name = info.completeBaseName();
+    return !name.startsWith("~$") && !name.contains("_processed")
+           && !name.contains("合并结果") && !name.contains("自动生成模板");
+}
+
+// 一个目录即一组数据：箱内、箱外各取第一个（按文件名排序）
+bool runFromDirectory(const QString &dirPath, BatchRun &run)
+{
+    QDir dir(dirPath);
+    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.xlsx", QDir::Files, QDir::Name);
+    for (const QFileInfo &info : files) {
+        if (!isSourceWorkbook(info)) continue;
+        if (run.insidePath.isEmpty() && info.fileName().contains("箱内")) run.insidePath = info.absoluteFilePath();
+        if (run.outsidePath.isEmpty() && info.fileName().contains("箱外")) run.outsidePath = info.absoluteFilePath();
+    }
+    if (run.insidePath.isEmpty() || run.outsidePath.isEmpty()) return false;
+
+    run.name = dir.dirName();
+    run.multiHead = dirPath.contains("多头") || QFileInfo(run.insidePath).fileName().contains("多头");
+    return true;
+}
+
+QList<BatchRun> scanDirectory(const QString &root)
+{
+    QList<BatchRun> runs;
+    QStringList dirs = {QDir(root).absolutePath()};
+    QDirIterator it(root, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) dirs.append(it.next());
+    dirs.sort();
+
+    QSet<QString> names;
+    for (const QString &dirPath : dirs) {
+        BatchRun run;
+        if (!runFromDirectory(dirPath, run)) continue;
+        // 分组名用于任务分组，重名时加序号
+        QString name = run.name;
+        for (int i = 2; names.contains(name); ++i) name = QString("%1-%2").arg(run.name).arg(i);
+        run.name = name;
+        names.insert(name);
+        runs.append(run);
+    }
+    return runs;
+}
+
+bool loadManifest(const QString &path, QList<BatchRun> &runs, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = "无法打开清单：" + path;
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        *error = QString("清单格式错误：%1（偏移 %2）").arg(parseError.errorString()).arg(parseError.offset);
+        return false;
+    }
+
+    const QDir base = QFileInfo(path).absoluteDir();
+    auto resolve = [&base](const QString &value) {
+        return value.isEmpty() ? QString() : QDir::cleanPath(base.absoluteFilePath(value));
+    };
+
+    const QJsonArray items = doc.object().value("runs").toArray();
+    for (int i = 0; i < items.size(); ++i) {
+        const QJsonObject item = items.at(i).toObject();
+        BatchRun run;
+        run.name = item.value("name").toString(QString("run%1").arg(i + 1));
+        run.multiHead = item.value("type").toString() == "multi";
+        run.insidePath = resolve(item.value("inside").toString());
+        run.outsidePath = resolve(item.value("outside").toString());
+        run.mergedPath = resolve(item.value("merged").toString());
+        for (const QJsonValue &value : item.value("modeling").toArray()) run.modeling.append(value.toInt());
+        run.tester = item.value("tester").toString();
+        run.reviewer = item.value("reviewer").toString();
+        runs.append(run);
+    }
+    return true;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    // 证书通过 QPrinter/QPainter 输出 PDF，需要 GUI 应用对象（不创建任何窗口）
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setApplicationName("excelbatch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("高低温数据批处理：回填、合并、拟合模板、拟合与证书");
+    parser.addHelpOption();
+    QCommandLineOption dirOption("dir", "数据目录（每个含箱内、箱外 xlsx 的目录为一组）", "path");
+    QCommandLineOption manifestOption("manifest", "JSON 清单", "file");
+    QCommandLineOption jobsOption("jobs", "同时运行的任务数", "n",
+                                  QString::number(qBound(1, QThread::idealThreadCount() / 2, 4)));
+    QCommandLineOption stagesOption("stages", "执行的阶段（fill,merge,template,fit）", "list",
+                                    BatchRunner::AllStages.join(','));
+    QCommandLineOption noFitOption("no-fit", "不执行拟合和证书（无 Python 环境时）");
+    QCommandLineOption scriptsOption("scripts", "DNH.py、run.py 所在目录（默认程序所在目录）", "path");
+    QCommandLineOption modelingOption("modeling", "默认建模点序号（0 起，逗号分隔；默认隔一个取一个）", "list");
+    QCommandLineOption testerOption("tester", "默认测试员", "name");
+    QCommandLineOption reviewerOption("reviewer", "默认审核员", "name");
+    QCommandLineOption reportOption("report", "耗时报告（JSON），默认输出到标准输出", "file");
+    parser.addOptions({dirOption, manifestOption, jobsOption, stagesOption, noFitOption, scriptsOption,
+                       modelingOption, testerOption, reviewerOption, reportOption});
+    parser.process(app);
+
+    QList<BatchRun> runs;
+    if (parser.isSet(manifestOption)) {
+        QString error;
+        if (!loadManifest(parser.value(manifestOption), runs, &error)) {
+            qCritical().noquote() << error;
+            return 2;
+        }
+    } else if (parser.isSet(dirOption)) {
+        runs = scanDirectory(parser.value(dirOption));
+    } else {
+        parser.showHelp(2);
+    }
+    if (runs.isEmpty()) {
+        qCritical() << "没有找到可处理的数据";
+        return 2;
+    }
+    for (BatchRun &run : runs) {
+        if (run.tester.isEmpty()) run.tester = parser.value(testerOption);
+        if (run.reviewer.isEmpty()) run.reviewer = parser.value(reviewerOption);
+    }
+
+    QStringList stages;
+    for (const QString &stage : parser.value(stagesOption).split(',', Qt::SkipEmptyParts)) {
+        const QString name = stage.trimmed();
+        if (!BatchRunner::AllStages.contains(name)) {
+            qCritical().noquote() << "未知阶段：" + name;
+            return 2;
+        }
+        stages.append(name);
+    }
+    if (parser.isSet(noFitOption)) stages.removeAll("fit");
+
+    JobQueue queue;
+    queue.setMaxWorkers(qMax(1, parser.value(jobsOption).toInt()));
+
+    BatchRunner runner(&queue);
+    runner.setStages(stages);
+    runner.setScriptDirectory(parser.value(scriptsOption));
+    runner.setDefaultModeling(parseIndexes(parser.value(modelingOption)));
+
+    QObject::connect(&runner, &BatchRunner::finished, &app, [&]() {
+        const QByteArray json = QJsonDocument(runner.report()).toJson(QJsonDocument::Indented);
+        if (parser.isSet(reportOption)) {
+            QFile file(parser.value(reportOption));
+            if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                file.write(json);
+            } else {
+                qCritical().noquote() << "报告写入失败：" + parser.value(reportOption);
+            }
+        } else {
+            QTextStream(stdout) << json;
+        }
+        app.exit(runner.failedCount() > 0 ? 1 : 0);
+    });
+
+    qDebug().noquote() << QString("共 %1 组数据，并发 %2，阶段：%3")
+                              .arg(runs.size()).arg(queue.maxWorkers()).arg(stages.join(','));
+    runner.start(runs);
+    return app.exec();
+}
@@ -0,0 +1,207 @@
+#include "exceltime.h"
+#include <algorithm>
+
+namespace {
+const qint64 UnixEpochJulianDay = 2440588; // 1970-01-01
+const QDate ExcelEpoch(1899, 12, 30);      // 1900 日期系统的第 0 天（已含 1900-02-29 的偏差）
+
+int digitsAt(const QString &text, int pos, int count)
+{
+    if (pos + count > text.size()) return -1;
+    int value = 0;
+    for (int i = pos; i < pos + count; ++i) {
+        const ushort c = text.at(i).unicode();
+        if (c < '0' || c > '9') return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+// "H:mm"、"HH:mm"、"H:mm:ss"、"HH:mm:ss"，其余返回无效时间
+QTime parseTimeText(const QString &text)
+{
+    int pos = 0;
+    int hour = digitsAt(text, pos, 2);
+    if (hour >= 0) {
+        pos = 2;
+    } else {
+        hour = digitsAt(text, pos, 1);
+        pos = 1;
+    }
+    if (hour < 0 || pos >= text.size() || text.at(pos) != ':') return QTime();
+    const int minute = digitsAt(text, pos + 1, 2);
+    if (minute < 0) return QTime();
+    pos += 3;
+    int second = 0;
+    if (pos < text.size()) {
+        if (text.at(pos) != ':') return QTime();
+        second = digitsAt(text, pos + 1, 2);
+        if (second < 0 || pos + 3 != text.size()) return QTime();
+    }
+    return QTime(hour, minute, second);
+}
+
+QDate dateFromSerial(double serial)
+{
+    return serial >= 1.0 ? ExcelEpoch.addDays(static_cast<qint64>(serial)) : QDate();
+}
+
+// 与原实现一致：序列数 × 86400 截断为秒，超过一天的部分（带日期的序列数）按天回绕；0 为 00:00:00
+QTime timeFromSerial(double serial)
+{
+    const qint64 totalSeconds = static_cast<qint64>(serial * 86400);
+    return QTime(0, 0).addSecs(static_cast<int>(totalSeconds % 86400));
+}
+}
+
+qint64 ExcelTime::floorDiv(qint64 value, qint64 divisor)
+{
+    const qint64 quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+qint64 ExcelTime::secondKey(const QDate &date, const QTime &time)
+{
+    return (date.toJulianDay() - UnixEpochJulianDay) * 86400 + time.msecsSinceStartOfDay() / 1000;
+}
+
+qint64 ExcelTime::txtMinuteKey(qint64 second)
+{
+    const qint64 day = floorDiv(second, 86400);
+    const QDate date = QDate::fromJulianDay(day + UnixEpochJulianDay);
+    const int minuteOfDay = static_cast<int>(second - day * 86400) / 60;
+    return qint64(date.year()) * 100000000 + date.month() * 1000000 + date.day() * 10000
+           + (minuteOfDay / 60) * 100 + minuteOfDay % 60;
+}
+
+QDate ExcelTime::dateOf(qint64 second)
+{
+    return QDate::fromJulianDay(floorDiv(second, 86400) + UnixEpochJulianDay);
+}
+
+QDateTime ExcelTime::dateTimeOf(qint64 second)
+{
+    const qint64 day = floorDiv(second, 86400);
+    return QDateTime(QDate::fromJulianDay(day + UnixEpochJulianDay),
+                     QTime::fromMSecsSinceStartOfDay(static_cast<int>(second - day * 86400) * 1000));
+}
+
+bool ExcelTime::isNumeric(const QVariant &cell)
+{
+    switch (cell.userType()) {
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ExcelTime::decodeDate(const QVariant &cell, QDate *date)
+{
+    switch (cell.userType()) {
+    case QMetaType::QDate:
+        *date = cell.toDate();
+        break;
+    case QMetaType::QDateTime:
+        *date = cell.toDateTime().date();
+        break;
+    case QMetaType::QString: {
+        const QString text = cell.toString().trimmed();
+        const int year = digitsAt(text, 0, 4);
+        const QChar separator = text.size() > 4 ? text.at(4) : QChar();
+        if (year > 0 && (separator == '-' || separator == '/') && text.size() >= 10 && text.at(7) == separator) {
+            *date = QDate(year, digitsAt(text, 5, 2), digitsAt(text, 8, 2));
+        } else {
+            *date = QDate::fromString(text, Qt::ISODate);
+        }
+        // 未标类型（无 t 属性）的数值单元格读出来是序列数文本
+        bool ok = false;
+        const double serial = date->isValid() ? 0.0 : text.toDouble(&ok);
+        if (ok) *date = dateFromSerial(serial);
+        break;
+    }
+    default:
+        *date = isNumeric(cell) ? dateFromSerial(cell.toDouble()) : QDate();
+        break;
+    }
+    return date->isValid();
+}
+
+bool ExcelTime::isZeroSerial(const QVariant &cell)
+{
+    if (isNumeric(cell)) return cell.toDouble() == 0.0;
+    if (cell.userType() != QMetaType::QString) return false;
+    bool ok = false;
+    const double serial = cell.toString().trimmed().toDouble(&ok);
+    return ok && serial == 0.0;
+}
+
+bool ExcelTime::decodeTime(const QVariant &cell, QTime *time)
+{
+    switch (cell.userType()) {
+    case QMetaType::QTime:
+        *time = cell.toTime();
+        break;
+    case QMetaType::QDateTime:
+        *time = cell.toDateTime().time();
+        break;
+    case QMetaType::QString: {
+        const QString text = cell.toString().trimmed();
+        *time = parseTimeText(text);
+        bool ok = false;
+        const double serial = time->isValid() ? 0.0 : text.toDouble(&ok);
+        if (ok) *time = timeFromSerial(serial);
+        break;
+    }
+    default:
+        *time = isNumeric(cell) ? timeFromSerial(cell.toDouble()) : QTime();
+        break;
+    }
+    return time->isValid();
+}
+
+void sortTimeRows(QVector<ExcelTimeRow> &rows)
+{
+    std::stable_sort(rows.begin(), rows.end(), [](const ExcelTimeRow &a, const ExcelTimeRow &b) {
+        return a.second < b.second;
+    });
+    // 相同时间保留最后一个
+    int out = 0;
+    for (int i = 0; i < rows.size(); ++i) {
+        if (i + 1 < rows.size() && rows[i + 1].second == rows[i].second) continue;
+        rows[out++] = rows[i];
+    }
+    rows.resize(out);
+}
+
+void MinuteValueTable::finalize()
+{
+    std::stable_sort(m_items.begin(), m_items.end(), [](const Item &a, const Item &b) {
+        return a.minute < b.minute;
+    });
+    int out = 0;
+    for (int i = 0; i < m_items.size(); ++i) {
+        if (i + 1 < m_items.size() && m_items[i + 1].minute == m_items[i].minute) continue;
+        m_items[out++] = m_items[i];
+    }
+    m_items.resize(out);
+}
+
+int MinuteValueTable::find(qint64 minute) const
+{
+    auto it = std::lower_bound(m_items.begin(), m_items.end(), minute, [](const Item &item, qint64 key) {
+        return item.minute < key;
+    });
+    return (it != m_items.end() && it->minute == minute) ? static_cast<int>(it - m_items.begin()) : -1;
+}
+
+double MinuteValueTable::value(qint64 minute, double defaultValue) const
+{
+    const int index = find(minute);
+    return index >= 0 ? m_items.at(index).value : defaultValue;
+}
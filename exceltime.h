@@ -0,0 +1,80 @@
+#ifndef EXCELTIME_H
+#define EXCELTIME_H
+
+#include <QDate>
+#include <QTime>
+#include <QDateTime>
+#include <QVariant>
+#include <QVector>
+
+// Excel 时间列的统一解码和整数时间键。
+// 单元格可能是 QXlsx 已解析的 QDate/QDateTime/QTime、Excel 序列数（天数，小数部分为时间）或文本，
+// 各处原来各写一套 if/else，再拼 "yyyy-MM-dd HH:mm" 字符串做键；这里只解码一次，键为整数：
+//   secondKey     1970-01-01 00:00 起的秒数（不含时区，仅用于排序和比较）
+//   minuteKey     1970-01-01 00:00 起的分钟数，Excel 表之间（标准温度）对齐时使用
+//   txtMinuteKey  yyyyMMddHHmm 形式，与 TxtMinuteIndex::minuteKey 相同，查 TXT 分钟汇总时使用，
+//                 直接由秒数换算，不经过 QDateTime（TXT 的键已写入旁路缓存和压缩日志的块索引，不便改编码）
+class ExcelTime
+{
+public:
+    static qint64 secondKey(const QDate &date, const QTime &time);
+    static qint64 minuteKey(const QDate &date, const QTime &time) { return minuteOfSecond(secondKey(date, time)); }
+    static qint64 minuteOfSecond(qint64 second) { return floorDiv(second, 60); }
+    static qint64 txtMinuteKey(qint64 second);
+
+    static QDate dateOf(qint64 second);
+    static QDateTime dateTimeOf(qint64 second);
+
+    // 日期：QDate/QDateTime、Excel 序列数（1900 日期系统，也可以是序列数文本）、"yyyy-MM-dd" 或 "yyyy/MM/dd" 文本
+    static bool decodeDate(const QVariant &cell, QDate *date);
+    // 时间：QTime/QDateTime、Excel 序列数或序列数文本（取小数部分，按秒截断，与原实现一致）、"H:mm" 或 "H:mm:ss" 文本。
+    // 空单元格、空白文本视为无时间；序列数 0 是 00:00:00
+    static bool decodeTime(const QVariant &cell, QTime *time);
+    // 数值 0 或文本 "0"：模板中未填写的时间列默认值，标准数据表据此判断空行
+    static bool isZeroSerial(const QVariant &cell);
+
+    static bool isNumeric(const QVariant &cell);
+
+private:
+    static qint64 floorDiv(qint64 value, qint64 divisor);
+};
+
+// 时间列中的一个时间点及其行号
+struct ExcelTimeRow
+{
+    qint64 second = 0; // ExcelTime::secondKey
+    int row = 0;
+
+    qint64 minute() const { return ExcelTime::minuteOfSecond(second); }
+    qint64 txtMinuteKey() const { return ExcelTime::txtMinuteKey(second); }
+    QDate date() const { return ExcelTime::dateOf(second); }
+    QDateTime dateTime() const { return ExcelTime::dateTimeOf(second); }
+};
+
+// 按时间升序排列；同一时间（精确到秒）出现多次时只保留最后一行，与原来 QMap 逐行赋值的结果一致
+void sortTimeRows(QVector<ExcelTimeRow> &rows);
+
+// 分钟 -> 数值的只读查找表（有序数组 + 二分查找）。先 insert，再 finalize() 后查询；
+// 同一分钟插入多次时保留最后一次。finalize 之后可以继续 insert 再 finalize
+class MinuteValueTable
+{
+public:
+    void insert(qint64 minute, double value) { m_items.append({minute, value}); }
+    void finalize();
+
+    bool contains(qint64 minute) const { return find(minute) >= 0; }
+    double value(qint64 minute, double defaultValue = 0.0) const;
+    int size() const { return m_items.size(); }
+
+private:
+    struct Item {
+        qint64 minute;
+        double value;
+    };
+
+    int find(qint64 minute) const;
+
+    QVector<Item> m_items;
+};
+
+#endif // EXCELTIME_H
@@ -3,55 +3,80 @@
 #include <QModbusReply>
 #include <QVariant>
 #include <QDebug>
+#include "modbusbusmanager.h"
+#include "modbustransactionscheduler.h"
 
 HumidityController::HumidityController(QObject* parent)
     : QObject(parent), m_slaveAddress(0x03), m_connected(false)
 {
-    m_modbusDevice = new QModbusRtuSerialMaster(this);
-
-    // 连接状态信号
-    connect(m_modbusDevice, &QModbusClient::stateChanged, this, [this](QModbusDevice::State state) {
-        bool connected = (state == QModbusDevice::ConnectedState);
-        m_connected = connected;
-        emit connectionStatusChanged(connected);
-    });
 }
 
 HumidityController::~HumidityController()
 {
-    if (m_modbusDevice) {
-        m_modbusDevice->disconnectDevice();
-    }
+    releaseBus();
 }
 
 bool HumidityController::connectDevice(const QString& portName)
 {
-    if (m_connected) {
+    // 以是否持有总线为准：总线掉线后 m_connected 为 false，但引用和轮询仍在，重连前必须先释放
+    if (m_bus) {
         disconnectDevice();
     }
 
     m_portName = portName;
-    configureSerialPort(portName);  // 配置端口参数
 
-    if (m_modbusDevice->connectDevice()) {
-        m_connected = true;
-        emit connectionStatusChanged(true);
-        return true;
-    } else {
+    QString error;
+    m_bus = ModbusBusManager::instance()->acquire(portName, &error);
+    if (!m_bus) {
+        qDebug() << "恒温箱连接失败:" << portName << error;
         m_connected = false;
         emit connectionStatusChanged(false);
         return false;
     }
+
+    connect(m_bus, &ModbusBus::connectionStatusChanged, this, [this](bool connected) {
+        if (m_connected == connected) return;
+        m_connected = connected;
+        emit connectionStatusChanged(connected);
+    });
+
+    // 温度(0x0010-0x0011)与湿度(0x0014-0x0015)分别轮询，调度器会把它们合并为一次 0x0010-0x0015 读取
+    ModbusTransactionScheduler *scheduler = m_bus->scheduler();
+    m_pollIds.append(scheduler->addPoll(m_slaveAddress, 0x0010, 2, [this](bool ok, const QModbusDataUnit &unit) {
+        if (ok) updateTemperature(unit);
+    }));
+    m_pollIds.append(scheduler->addPoll(m_slaveAddress, 0x0014, 2, [this](bool ok, const QModbusDataUnit &unit) {
+        if (ok) updateHumidity(unit);
+    }));
+    for (int id : qAsConst(m_pollIds)) {
+        scheduler->setPollEnabled(id, m_pollingEnabled);
+        scheduler->setPollProfile(id, m_pollProfile);
+    }
+
+    m_connected = true;
+    emit connectionStatusChanged(true);
+    return true;
 }
 
 // 断开连接
 void HumidityController::disconnectDevice()
 {
-    if (m_modbusDevice->state() == QModbusDevice::ConnectedState) {
-        m_modbusDevice->disconnectDevice();
-        m_connected = false;
-        emit connectionStatusChanged(false);
+    if (!m_bus) return;
+    releaseBus();
+    m_connected = false;
+    emit connectionStatusChanged(false);
+}
+
+void HumidityController::releaseBus()
+{
+    if (!m_bus) return;
+    for (int id : qAsConst(m_pollIds)) {
+        m_bus->scheduler()->removePoll(id);
     }
+    m_pollIds.clear();
+    disconnect(m_bus, nullptr, this, nullptr);
+    ModbusBusManager::instance()->release(m_bus);
+    m_bus = nullptr;
 }
 
 // 获取连接状态
@@ -60,13 +85,30 @@ bool HumidityController::isConnected() const
     return m_connected;
 }
 
-void HumidityController::configureSerialPort(const QString& portName)
+ModbusTransactionScheduler *HumidityController::scheduler() const
+{
+    return m_bus ? m_bus->scheduler() : nullptr;
+}
+
+ModbusLinkStats HumidityController::linkStats() const
+{
+    return m_bus ? m_bus->scheduler()->stats(m_slaveAddress) : ModbusLinkStats();
+}
+
+qint64 HumidityController::temperatureAgeMs() const
 {
-    m_modbusDevice->setConnectionParameter(QModbusDevice::SerialPortNameParameter, portName);
-    m_modbusDevice->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, QVariant(9600));
-    m_modbusDevice->setConnectionParameter(QModbusDevice::SerialDataBitsParameter, QVariant(8));
-    m_modbusDevice->setConnectionParameter(QModbusDevice::SerialParityParameter, QVariant(QSerialPort::NoParity));
-    m_modbusDevice->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, QVariant(QSerialPort::OneStop));
+    return m_temperatureAge.isValid() ? m_temperatureAge.elapsed() : -1;
+}
+
+qint64 HumidityController::humidityAgeMs() const
+{
+    return m_humidityAge.isValid() ? m_humidityAge.elapsed() : -1;
+}
+
+QString HumidityController::busDescription() const
+{
+    return QString("%1 / 0x%2").arg(m_bus ? m_bus->portName() : QString("未连接"))
+        .arg(m_slaveAddress, 2, 16, QChar('0'));
 }
 
 void HumidityController::setTargetTemperature(float temperature)
@@ -111,50 +153,67 @@ void HumidityController::toggleCalibrationWindow(bool open)
     sendWriteRequest(unit);
 }
 
-void HumidityController::connectSignals()
-{
-    connect(m_modbusDevice, &QModbusClient::stateChanged, this, [this](QModbusDevice::State state) {
-        emit connectionStatusChanged(state == QModbusDevice::ConnectedState);
-    });
-
-    connect(m_modbusDevice, &QModbusDevice::errorOccurred, this, [this](QModbusDevice::Error error) {
-        emit errorOccurred(m_modbusDevice->errorString());
-    });
-}
-
 void HumidityController::readCurrentTemperature() {
     sendReadRequest(0x0010, 2, [this](const QModbusDataUnit& unit) {
-        if (unit.valueCount() == 2) {
-            // 检查大端/小端模式（若从站为小端，交换寄存器顺序）
-            quint32 tempData = (unit.value(0) << 16) | unit.value(1); // 大端模式
-            // quint32 tempData = (unit.value(1) << 16) | unit.value(0); // 小端模式
-            float temperature;
-            memcpy(&temperature, &tempData, sizeof(float));
-            m_currentTemperature = temperature; // 存储当前温度
-            // qDebug() << "读取到的温度数据：" << temperature;
-            emit currentTemperatureUpdated(temperature);
-        } else {
-            qDebug() << "读取温度数据长度错误，实际长度: " << unit.valueCount();
-        }
+        updateTemperature(unit);
     });
 }
 
 void HumidityController::readCurrentHumidity()
 {
     sendReadRequest(0x0014, 2, [this](const QModbusDataUnit& unit) {
-        if (unit.valueCount() == 2) {
-            quint32 humiData = (unit.value(0) << 16) | unit.value(1);
-            float humidity;
-            memcpy(&humidity, &humiData, sizeof(float));
-            m_currentHumidity = humidity;
-            // qDebug() << "读取到的湿度数据：" << humidity;
-            emit currentHumidityUpdated(humidity);
-        } else {
-            qDebug() << "读取湿度数据长度错误，实际长度: " << unit.valueCount();
-        }
+        updateHumidity(unit);
     });
 }
 
+void HumidityController::updateTemperature(const QModbusDataUnit& unit)
+{
+    if (unit.valueCount() == 2) {
+        // 检查大端/小端模式（若从站为小端，交换寄存器顺序）
+        quint32 tempData = (unit.value(0) << 16) | unit.value(1); // 大端模式
+        // quint32 tempData = (unit.value(1) << 16) | unit.value(0); // 小端模式
+        float temperature;
+        memcpy(&temperature, &tempData, sizeof(float));
+        m_currentTemperature = temperature; // 存储当前温度
+        m_temperatureAge.start();
+        emit currentTemperatureUpdated(temperature);
+    } else {
+        qDebug() << "读取温度数据长度错误，实际长度: " << unit.valueCount();
+    }
+}
+
+void HumidityController::updateHumidity(const QModbusDataUnit& unit)
+{
+    if (unit.valueCount() == 2) {
+        quint32 humiData = (unit.value(0) << 16) | unit.value(1);
+        float humidity;
+        memcpy(&humidity, &humiData, sizeof(float));
+        m_currentHumidity = humidity;
+        m_humidityAge.start();
+        emit currentHumidityUpdated(humidity);
+    } else {
+        qDebug() << "读取湿度数据长度错误，实际长度: " << unit.valueCount();
+    }
+}
+
+void HumidityController::setPollingEnabled(bool enabled)
+{
+    m_pollingEnabled = enabled;
+    if (!m_bus) return;
+    for (int id : qAsConst(m_pollIds)) {
+        m_bus->scheduler()->setPollEnabled(id, enabled);
+    }
+}
+
+void HumidityController::setPollProfile(ModbusTransactionScheduler::PollProfile profile)
+{
+    m_pollProfile = profile;
+    if (!m_bus) return;
+    for (int id : qAsConst(m_pollIds)) {
+        m_bus->scheduler()->setPollProfile(id, profile);
+    }
+}
+
 void HumidityController::writeRegister(quint16 address, float value)
 {
     quint32 data;
@@ -172,48 +231,36 @@ void HumidityController::writeRegister(quint16 address, float value)
 
 void HumidityController::sendReadRequest(quint16 address, int count, std::function<void(const QModbusDataUnit&)> callback)
 {
-
-    if (m_modbusDevice->state() != QModbusDevice::ConnectedState) {
-        qDebug() << "Modbus 设备未连接，无法发送读取请求，当前设备状态: " << m_modbusDevice->state();
+    if (!m_bus || !m_bus->isConnected()) {
+        qDebug() << "Modbus 设备未连接，无法发送读取请求";
         return;
     }
 
-    // 显式创建读取单元，便于调试
-    QModbusDataUnit readUnit(QModbusDataUnit::HoldingRegisters, address, count);
-
-    QModbusReply* reply = m_modbusDevice->sendReadRequest(readUnit, m_slaveAddress);
-
-    if (reply) {
-
-        connect(reply, &QModbusReply::finished, this, [this, callback, reply]() {
-            if (reply->error() == QModbusDevice::NoError) {
-                callback(reply->result());
-            } else {
-                qDebug() << "Modbus 读取错误：" << reply->errorString() << " 错误码: " << reply->error();
-            }
-            reply->deleteLater();
-        });
-    } else {
-        qDebug() << "发送读取请求失败：Modbus 回复为空";
-        qDebug() << "Modbus 设备错误：" << m_modbusDevice->errorString() << " 设备状态: " << m_modbusDevice->state();
-    }
+    m_bus->scheduler()->read(m_slaveAddress, address, quint16(count), [callback, address](bool ok, const QModbusDataUnit& unit) {
+        if (ok) {
+            callback(unit);
+        } else {
+            qDebug() << "恒温箱读取失败，地址=" << QString::number(address, 16);
+        }
+    }, ModbusTransactionScheduler::ReadPriority, this);
 }
 
 void HumidityController::sendWriteRequest(const QModbusDataUnit& unit, std::function<void(bool)> callback) {
     qDebug() << "写入请求：地址=" << QString::number(unit.startAddress(), 16)
              << "值=" << unit.value(0) << "," << unit.value(1);
 
-    if (auto* reply = m_modbusDevice->sendWriteRequest(unit, m_slaveAddress)) {
-        connect(reply, &QModbusReply::finished, this, [callback, reply]() {
-            if (reply->error() != QModbusDevice::NoError) {
-                qDebug() << "恒温箱Modbus 写入错误：" << reply->errorString(); // 新增错误日志
-            }
-            if (callback) callback(reply->error() == QModbusDevice::NoError);
-            reply->deleteLater();
-        });
-    } else {
-        qDebug() << "发送写入请求失败：" << m_modbusDevice->errorString(); // 新增错误日志
+    if (!m_bus) {
+        qDebug() << "恒温箱未连接，写入请求被丢弃";
+        if (callback) callback(false);
+        return;
     }
+
+    m_bus->scheduler()->write(m_slaveAddress, unit, [this, callback](bool ok) {
+        if (!ok) {
+            qDebug() << "恒温箱Modbus 写入错误：" << (m_bus ? m_bus->errorString() : QString("总线已断开")); // 新增错误日志
+        }
+        if (callback) callback(ok);
+    }, this);
 }
 
 void HumidityController::readCurrentData()
@@ -231,6 +278,10 @@ void HumidityController::readCurrentData()
             memcpy(&humidity, &humiData, sizeof(float));
 
             qDebug() << "Read temperature: " << temperature << ", humidity: " << humidity;
+            m_currentTemperature = temperature;
+            m_currentHumidity = humidity;
+            m_temperatureAge.start();
+            m_humidityAge.start();
             emit currentDataUpdated(temperature, humidity);
         } else {
             qDebug() << "Read current data length error, actual length: " << unit.valueCount();
@@ -2,8 +2,14 @@
 #define HUMIDITYCONTROLLER_H
 
 #include <QObject>
-#include <QSerialPort>
-#include <QModbusRtuSerialMaster>
+#include <QModbusDataUnit>
+#include <QVector>
+#include <QElapsedTimer>
+#include "modbuslinkstats.h"
+#include "modbustransactionscheduler.h"
+#include <functional>
+
+class ModbusBus;
 
 class HumidityController : public QObject
 {
@@ -12,21 +18,39 @@ public:
     explicit HumidityController(QObject* parent = nullptr);
     ~HumidityController();
 
+    // 挂接到 portName 对应的 RS-485 总线（可与黑体炉共用同一 COM 口）
     bool connectDevice(const QString& portName);
     void disconnectDevice();
-    bool isConnected() const;
-    void setTargetTemperature(float temperature);
-    void setDeviceState(bool start);
-    void setMasterControl(bool enable);
+    // 以下接口为虚函数，便于仿真设备（见 calibrationsimulator.h）替换实机通信
+    virtual bool isConnected() const;
+    virtual void setTargetTemperature(float temperature);
+    virtual void setDeviceState(bool start);
+    virtual void setMasterControl(bool enable);
     void changeSensor(int direction);
-    void toggleCalibrationWindow(bool open);
+    virtual void toggleCalibrationWindow(bool open);
 
     void readCurrentTemperature();
     void readCurrentHumidity();
     void readCurrentData();
 
-    float getCurrentTemperature() const;
-    float getCurrentHumidity() const;
+    virtual float getCurrentTemperature() const;
+    virtual float getCurrentHumidity() const;
+
+    // 从站地址，默认 0x03；需在 connectDevice 之前设置
+    void setSlaveAddress(quint8 address) { m_slaveAddress = address; }
+    quint8 slaveAddress() const { return m_slaveAddress; }
+
+    // 周期读取温度和湿度（两次读取合并为一帧，周期由本设备的轮询档位决定）
+    void setPollingEnabled(bool enabled);
+    void setPollProfile(ModbusTransactionScheduler::PollProfile profile);
+    // 所在总线的调度器，未连接时为 nullptr
+    ModbusTransactionScheduler *scheduler() const;
+
+    // 通信诊断：本从站的往返时间/错误统计，以及缓存温湿度距上次成功读取的时间（毫秒，-1 表示从未读到）
+    ModbusLinkStats linkStats() const;
+    qint64 temperatureAgeMs() const;
+    qint64 humidityAgeMs() const;
+    QString busDescription() const;
 
 
 signals:
@@ -39,11 +63,15 @@ signals:
     void currentDataUpdated(float temp, float humidity);
 
 private:
-    QModbusRtuSerialMaster* m_modbusDevice = nullptr;
+    ModbusBus* m_bus = nullptr;
+    QVector<int> m_pollIds;
+    bool m_pollingEnabled = false;
+    ModbusTransactionScheduler::PollProfile m_pollProfile = ModbusTransactionScheduler::IdlePoll;
     quint8 m_slaveAddress;
 
-    void configureSerialPort(const QString& portName);
-    void connectSignals();
+    void updateTemperature(const QModbusDataUnit& unit);
+    void updateHumidity(const QModbusDataUnit& unit);
+    void releaseBus();
 
     void writeRegister(quint16 address, float value);
     void sendReadRequest(quint16 address, int count, std::function<void(const QModbusDataUnit&)> callback);
@@ -51,6 +79,8 @@ private:
 
     float m_currentTemperature = 0.0f; // 新增成员变量用于存储当前温度
     float m_currentHumidity = 0.0f;    // 新增成员变量用于存储当前湿度
+    QElapsedTimer m_temperatureAge;
+    QElapsedTimer m_humidityAge;
 
     QString m_portName;       // 保存当前端口名
     bool m_connected = false; // 连接状态标识
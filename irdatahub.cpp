@@ -0,0 +1,118 @@
+#include "irdatahub.h"
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+IrDataHub::IrDataHub(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void IrDataHub::setWindowSeconds(int seconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_windowSeconds = qMax(1, seconds);
+}
+
+void IrDataHub::ingest(const QString &portName, const QDateTime &timestamp,
+                       const QVector<double> &groupST, const QVector<double> &groupTA,
+                       const QVector<double> &groupLC, bool isSingleHead)
+{
+    Sample sample;
+    sample.time = timestamp;
+    const int heads = isSingleHead ? 1 : 3;
+    for (int i = 0; i < heads; ++i) {
+        sample.to.append(i < groupST.size() ? float(groupST[i]) : NAN);
+        sample.ta.append(i < groupTA.size() ? float(groupTA[i]) : NAN);
+        sample.lc.append(i < groupLC.size() ? float(groupLC[i]) : NAN);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    PortBuffer &buffer = m_ports[portName];
+    if (buffer.singleHead != isSingleHead) {
+        buffer.samples.clear(); // 设备类型变化时旧数据作废
+        buffer.singleHead = isSingleHead;
+    }
+    buffer.samples.append(sample);
+
+    // 只保留最新样本一个窗口内的数据（限制内存；求平均时再按调用方的当前时间截取）
+    QDateTime cutoff = timestamp.addSecs(-m_windowSeconds);
+    int drop = 0;
+    while (drop < buffer.samples.size() && buffer.samples[drop].time < cutoff) ++drop;
+    if (drop > 0) buffer.samples.remove(0, drop);
+}
+
+CalibrationManager::InfraredData IrDataHub::average(const QString &comPort, const QDateTime &now) const
+{
+    CalibrationManager::InfraredData result;
+    const QDateTime end = now.isValid() ? now : QDateTime::currentDateTime();
+    QMutexLocker locker(&m_mutex);
+    const QDateTime begin = end.addSecs(-m_windowSeconds);
+
+    auto it = m_ports.constFind(comPort);
+    if (it == m_ports.constEnd()) {
+        qWarning() << "[IrDataHub] COM口" << comPort << "没有红外数据";
+        result.type = "未知设备";
+        return result;
+    }
+
+    // 样本按时间递增追加
+    const QVector<Sample> &samples = it->samples;
+    const auto first = std::lower_bound(samples.cbegin(), samples.cend(), begin,
+                                        [](const Sample &s, const QDateTime &t) { return s.time < t; });
+    if (first == samples.cend() || first->time > end) {
+        qWarning() << "[IrDataHub] COM口" << comPort << "最近" << m_windowSeconds << "秒没有红外数据";
+        result.type = "未知设备";
+        return result;
+    }
+
+    const PortBuffer &buffer = it.value();
+    result.type = buffer.singleHead ? "单头" : "多头";
+    const int heads = buffer.singleHead ? 1 : 3;
+
+    // 同一组 TO/TA/LC 均有效才计入（与原来主窗口按表格求平均的规则一致）
+    QVector<double> toSums(heads, 0.0), taSums(heads, 0.0), lcSums(heads, 0.0);
+    QVector<int> validCounts(heads, 0);
+    for (auto sample = first; sample != samples.cend() && sample->time <= end; ++sample) {
+        const Sample &s = *sample;
+        for (int i = 0; i < heads; ++i) {
+            if (std::isfinite(s.to[i]) && std::isfinite(s.ta[i]) && std::isfinite(s.lc[i])) {
+                toSums[i] += s.to[i];
+                taSums[i] += s.ta[i];
+                lcSums[i] += s.lc[i];
+                validCounts[i]++;
+            }
+        }
+    }
+
+    for (int i = 0; i < heads; ++i) {
+        result.toAvgs.append(validCounts[i] > 0 ? float(toSums[i] / validCounts[i]) : NAN);
+        result.taAvgs.append(validCounts[i] > 0 ? float(taSums[i] / validCounts[i]) : NAN);
+        result.lcAvgs.append(validCounts[i] > 0 ? float(lcSums[i] / validCounts[i]) : NAN);
+    }
+    return result;
+}
+
+int IrDataHub::sampleCount(const QString &comPort) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_ports.constFind(comPort);
+    return (it == m_ports.constEnd()) ? 0 : it->samples.size();
+}
+
+QDateTime IrDataHub::lastSampleTime(const QString &comPort) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_ports.constFind(comPort);
+    if (it == m_ports.constEnd() || it->samples.isEmpty()) return QDateTime();
+    return it->samples.last().time;
+}
+
+void IrDataHub::serveRequest(const QString &comPort, QObject *receiver)
+{
+    auto *manager = qobject_cast<CalibrationManager *>(receiver);
+    if (manager) {
+        manager->onIrAverageReceived(comPort, average(comPort, manager->clock()->now()));
+    }
+}
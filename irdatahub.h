@@ -0,0 +1,55 @@
+#ifndef IRDATAHUB_H
+#define IRDATAHUB_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QDateTime>
+#include <QMutex>
+#include "calibrationmanager.h"
+
+// 红外数据汇聚：所有测温仪串口线程的数据统一送到这里，按 COM 口缓存最近一段时间的样本，
+// 供任意台架的 CalibrationManager 求平均。多台架共用一份接收与统计，不再各自解析
+class IrDataHub : public QObject
+{
+    Q_OBJECT
+public:
+    explicit IrDataHub(QObject *parent = nullptr);
+
+    // 平均窗口（秒），默认 60，与原来的“最后一分钟平均”一致
+    void setWindowSeconds(int seconds);
+    int windowSeconds() const { return m_windowSeconds; }
+
+    // [now - 窗口, now] 内样本的平均值，now 无效时取当前时间；窗口内没有数据时 type 为“未知设备”。
+    // 虚拟时钟下运行的台架传入自己的 clock()->now()
+    CalibrationManager::InfraredData average(const QString &comPort, const QDateTime &now = QDateTime()) const;
+    int sampleCount(const QString &comPort) const;
+    QDateTime lastSampleTime(const QString &comPort) const;
+
+public slots:
+    // 可在串口线程中直接调用（内部加锁）
+    void ingest(const QString &portName, const QDateTime &timestamp,
+                const QVector<double> &groupST, const QVector<double> &groupTA,
+                const QVector<double> &groupLC, bool isSingleHead);
+
+    // 直接响应 CalibrationManager::requestIrAverage，窗口按该台架时钟的当前时间计算
+    void serveRequest(const QString &comPort, QObject *receiver);
+
+private:
+    struct Sample {
+        QDateTime time;
+        QVector<float> to;
+        QVector<float> ta;
+        QVector<float> lc;
+    };
+    struct PortBuffer {
+        bool singleHead = true;
+        QVector<Sample> samples;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QString, PortBuffer> m_ports;
+    int m_windowSeconds = 60;
+};
+
+#endif // IRDATAHUB_H
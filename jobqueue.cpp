@@ -0,0 +1,280 @@
+#include "jobqueue.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+
+void JobContext::setProgress(int percent, const QString &message) const
+{
+    JobQueue *queue = m_queue;
+    const int id = m_id;
+    QMetaObject::invokeMethod(queue, [queue, id, percent, message]() {
+        queue->updateProgress(id, percent, message);
+    }, Qt::QueuedConnection);
+}
+
+void JobContext::finish(const JobResult &result) const
+{
+    JobQueue *queue = m_queue;
+    const int id = m_id;
+    QMetaObject::invokeMethod(queue, [queue, id, result]() {
+        queue->completeJob(id, result);
+    }, Qt::QueuedConnection);
+}
+
+JobQueue::JobQueue(QObject *parent)
+    : QObject(parent)
+{
+    setMaxWorkers(qBound(1, QThread::idealThreadCount() / 2, 4));
+}
+
+JobQueue::~JobQueue()
+{
+    // 运行中的阻塞任务只能等它自己看到取消标志后返回
+    for (Job &job : m_jobs) job.token.cancel();
+    m_pool.waitForDone();
+}
+
+void JobQueue::loadSettings(QSettings &settings)
+{
+    setMaxWorkers(settings.value("jobs/max_workers", m_maxWorkers).toInt());
+}
+
+void JobQueue::setMaxWorkers(int count)
+{
+    m_maxWorkers = qMax(1, count);
+    m_pool.setMaxThreadCount(m_maxWorkers);
+    scheduleLater();
+}
+
+int JobQueue::submit(const QString &title, const QString &group, Priority priority, BlockingWork work)
+{
+    Job job;
+    job.info.title = title;
+    job.info.group = group;
+    job.info.priority = priority;
+    job.work = work;
+    return enqueue(job);
+}
+
+int JobQueue::submitAsync(const QString &title, const QString &group, Priority priority,
+                          AsyncWork start, CancelHandler onCancel)
+{
+    Job job;
+    job.info.title = title;
+    job.info.group = group;
+    job.info.priority = priority;
+    job.start = start;
+    job.onCancel = onCancel;
+    return enqueue(job);
+}
+
+int JobQueue::enqueue(Job job)
+{
+    job.info.id = m_nextId++;
+    job.info.state = Pending;
+    job.info.message = "排队中";
+    job.info.queuedAt = QDateTime::currentDateTime();
+    const int id = job.info.id;
+    m_jobs.insert(id, job);
+    qDebug() << "任务入队：" << id << job.info.title << "优先级" << priorityName(job.info.priority);
+    emit jobAdded(id);
+    scheduleLater();
+    return id;
+}
+
+void JobQueue::scheduleLater()
+{
+    if (m_scheduleQueued) return;
+    m_scheduleQueued = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_scheduleQueued = false;
+        schedule();
+    }, Qt::QueuedConnection);
+}
+
+void JobQueue::schedule()
+{
+    while (m_running < m_maxWorkers) {
+        QSet<QString> busyGroups;
+        for (const Job &job : m_jobs) {
+            if (job.info.state == Running && !job.info.group.isEmpty()) busyGroups.insert(job.info.group);
+        }
+
+        // 优先级高的先启动，同优先级按编号（提交顺序）
+        Job *next = nullptr;
+        for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+            Job &job = it.value();
+            if (job.info.state != Pending || busyGroups.contains(job.info.group)) continue;
+            if (!next || job.info.priority > next->info.priority) next = &job;
+        }
+        if (!next) return;
+        startJob(*next);
+    }
+}
+
+void JobQueue::startJob(Job &job)
+{
+    const int id = job.info.id;
+    job.info.state = Running;
+    job.info.message = "运行中";
+    job.info.startedAt = QDateTime::currentDateTime();
+    ++m_running;
+    emit jobChanged(id);
+
+    JobContext ctx(this, id, job.token);
+    if (job.start) {
+        job.start(ctx);
+        return;
+    }
+
+    BlockingWork work = job.work;
+    QFutureWatcher<JobResult> *watcher = new QFutureWatcher<JobResult>(this);
+    connect(watcher, &QFutureWatcher<JobResult>::finished, this, [this, watcher, id]() {
+        JobResult result = watcher->result();
+        watcher->deleteLater();
+        completeJob(id, result);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_pool, [work, ctx]() -> JobResult {
+        try {
+            return work(ctx);
+        } catch (const std::exception &e) {
+            return JobResult::failed("处理过程中发生异常：" + QString(e.what()));
+        } catch (...) {
+            return JobResult::failed("处理过程中发生未知异常");
+        }
+    }));
+}
+
+void JobQueue::updateProgress(int id, int percent, const QString &message)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end() || it->info.state != Running) return;
+    if (percent >= 0) it->info.progress = qBound(0, percent, 100);
+    if (!message.isEmpty()) it->info.message = message;
+    emit jobChanged(id);
+}
+
+void JobQueue::completeJob(int id, const JobResult &result)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end() || it->info.isFinished()) return; // 取消后异步任务迟到的完成通知
+
+    Job &job = it.value();
+    if (job.info.state == Running) --m_running;
+    job.info.result = result;
+    if (result.success) {
+        job.info.state = Succeeded;
+        job.info.progress = 100;
+        job.info.message = "完成";
+    } else if (job.token.isCancelled()) {
+        job.info.state = Cancelled;
+        job.info.message = "已取消";
+        if (job.info.result.error.isEmpty()) job.info.result.error = "已取消";
+    } else {
+        job.info.state = Failed;
+        job.info.message = result.error.isEmpty() ? QString("失败") : result.error;
+    }
+    job.info.finishedAt = QDateTime::currentDateTime();
+    job.work = nullptr;
+    job.start = nullptr;
+    job.onCancel = nullptr;
+
+    const JobInfo info = job.info;
+    const auto callbacks = job.callbacks;
+    job.callbacks.clear();
+    qDebug() << "任务结束：" << id << info.title << stateName(info.state) << info.result.error;
+
+    emit jobChanged(id);
+    emit jobFinished(id, info.result.success, info.result.resultPath, info.result.error);
+    for (const auto &callback : callbacks) {
+        if (callback.first) callback.second(info);
+    }
+    scheduleLater();
+}
+
+void JobQueue::cancel(int id)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end() || it->info.isFinished()) return;
+
+    Job &job = it.value();
+    job.token.cancel();
+    if (job.info.state == Pending) {
+        completeJob(id, JobResult::failed("已取消"));
+        return;
+    }
+
+    if (job.start) {
+        // 异步任务：由取消回调终止外部进程，不等它的完成通知
+        CancelHandler onCancel = job.onCancel;
+        if (onCancel) onCancel();
+        completeJob(id, JobResult::failed("已取消"));
+        return;
+    }
+    job.info.message = "正在取消...";
+    emit jobChanged(id);
+}
+
+void JobQueue::cancelAll()
+{
+    for (int id : m_jobs.keys()) cancel(id);
+}
+
+void JobQueue::whenFinished(int id, QObject *context, FinishedCallback callback)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end()) return;
+    if (it->info.isFinished()) {
+        const JobInfo info = it->info;
+        QTimer::singleShot(0, context, [callback, info]() { callback(info); });
+        return;
+    }
+    it->callbacks.append(qMakePair(QPointer<QObject>(context), callback));
+}
+
+JobQueue::JobInfo JobQueue::job(int id) const
+{
+    return m_jobs.value(id).info;
+}
+
+int JobQueue::pendingCount() const
+{
+    int count = 0;
+    for (const Job &job : m_jobs) {
+        if (job.info.state == Pending) ++count;
+    }
+    return count;
+}
+
+void JobQueue::clearFinished()
+{
+    for (int id : m_jobs.keys()) {
+        if (!m_jobs[id].info.isFinished()) continue;
+        m_jobs.remove(id);
+        emit jobRemoved(id);
+    }
+}
+
+QString JobQueue::stateName(State state)
+{
+    switch (state) {
+    case Pending: return "排队中";
+    case Running: return "运行中";
+    case Succeeded: return "成功";
+    case Failed: return "失败";
+    case Cancelled: return "已取消";
+    }
+    return QString();
+}
+
+QString JobQueue::priorityName(Priority priority)
+{
+    switch (priority) {
+    case LowPriority: return "低";
+    case NormalPriority: return "普通";
+    case HighPriority: return "高";
+    }
+    return QString();
+}
@@ -0,0 +1,170 @@
+#ifndef JOBQUEUE_H
+#define JOBQUEUE_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QDateTime>
+#include <QMap>
+#include <QPointer>
+#include <QSettings>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// 协作式取消标志：提交方和任务共享同一个标志，任务在自己的循环里检查，自行提前返回
+class JobCancelToken
+{
+public:
+    JobCancelToken() : m_flag(std::make_shared<std::atomic_bool>(false)) {}
+    void cancel() { m_flag->store(true); }
+    bool isCancelled() const { return m_flag->load(); }
+
+private:
+    std::shared_ptr<std::atomic_bool> m_flag;
+};
+
+struct JobResult
+{
+    bool success = false;
+    QString resultPath;
+    QString error;
+
+    static JobResult ok(const QString &path = QString()) { return {true, path, QString()}; }
+    static JobResult failed(const QString &error, const QString &path = QString()) { return {false, path, error}; }
+};
+
+class JobQueue;
+
+// 任务运行期间的句柄，可以复制、可以跨线程使用：检查取消、上报进度；
+// 异步任务（在主线程启动、靠信号结束，如 Python 进程）结束时调用 finish()
+class JobContext
+{
+public:
+    int id() const { return m_id; }
+    bool isCancelled() const { return m_token.isCancelled(); }
+    JobCancelToken token() const { return m_token; }
+
+    // percent 为 0..100，-1 表示只更新说明
+    void setProgress(int percent, const QString &message = QString()) const;
+    void finish(const JobResult &result) const;
+
+private:
+    friend class JobQueue;
+    JobContext(JobQueue *queue, int id, const JobCancelToken &token)
+        : m_queue(queue), m_id(id), m_token(token) {}
+
+    JobQueue *m_queue;
+    int m_id;
+    JobCancelToken m_token;
+};
+
+// 离线处理任务队列（Excel 处理、Python 拟合、证书生成）：
+// 1. 同时运行的任务数有上限（[jobs] max_workers），其余按优先级、再按提交顺序排队
+// 2. 同一分组（group）的任务互斥，用于共享状态的处理器（同一个 DataExcelProcessor、同一个 Python 进程）
+// 3. 阻塞任务在队列自己的线程池里执行；异步任务在主线程启动，由任务自己在完成时调用 ctx.finish()
+// 4. 取消为协作式：排队中的任务直接移除；运行中的任务置取消标志，异步任务另外调用其取消回调
+// 5. 所有信号、完成回调都在队列所在线程（主线程）发出
+class JobQueue : public QObject
+{
+    Q_OBJECT
+public:
+    enum Priority {
+        LowPriority = 0,
+        NormalPriority = 1,
+        HighPriority = 2
+    };
+
+    enum State {
+        Pending,
+        Running,
+        Succeeded,
+        Failed,
+        Cancelled
+    };
+
+    struct JobInfo {
+        int id = 0;
+        QString title;
+        QString group;
+        Priority priority = NormalPriority;
+        State state = Pending;
+        int progress = 0;
+        QString message;
+        JobResult result;
+        QDateTime queuedAt;
+        QDateTime startedAt;
+        QDateTime finishedAt;
+
+        bool isFinished() const { return state == Succeeded || state == Failed || state == Cancelled; }
+    };
+
+    using BlockingWork = std::function<JobResult(const JobContext &ctx)>;
+    using AsyncWork = std::function<void(const JobContext &ctx)>;
+    using CancelHandler = std::function<void()>;
+    using FinishedCallback = std::function<void(const JobInfo &info)>;
+
+    explicit JobQueue(QObject *parent = nullptr);
+    ~JobQueue();
+
+    // [jobs] max_workers，默认取 CPU 核数的一半（1..4）
+    void loadSettings(QSettings &settings);
+    void setMaxWorkers(int count);
+    int maxWorkers() const { return m_maxWorkers; }
+
+    int submit(const QString &title, const QString &group, Priority priority, BlockingWork work);
+    int submitAsync(const QString &title, const QString &group, Priority priority,
+                    AsyncWork start, CancelHandler onCancel = nullptr);
+
+    void cancel(int id);
+    void cancelAll();
+    // 等待线程池中的阻塞任务返回（退出前调用，之后不再有任务访问处理器）
+    void waitForDone() { m_pool.waitForDone(); }
+    // 任务结束（成功、失败或取消）后在主线程调用一次；任务已结束时立即排队调用。context 销毁后不再调用
+    void whenFinished(int id, QObject *context, FinishedCallback callback);
+
+    bool contains(int id) const { return m_jobs.contains(id); }
+    JobInfo job(int id) const;
+    QList<int> jobIds() const { return m_jobs.keys(); }
+    int pendingCount() const;
+    int runningCount() const { return m_running; }
+    // 从列表中移除已结束的任务
+    void clearFinished();
+
+    static QString stateName(State state);
+    static QString priorityName(Priority priority);
+
+signals:
+    void jobAdded(int id);
+    void jobChanged(int id);
+    void jobFinished(int id, bool success, const QString &resultPath, const QString &error);
+    void jobRemoved(int id);
+
+private:
+    friend class JobContext;
+
+    struct Job {
+        JobInfo info;
+        JobCancelToken token;
+        BlockingWork work;
+        AsyncWork start;
+        CancelHandler onCancel;
+        QList<QPair<QPointer<QObject>, FinishedCallback>> callbacks;
+    };
+
+    int enqueue(Job job);
+    // 启动所有能启动的任务；总是通过事件循环调用，避免在上一个任务的完成信号里重入
+    void scheduleLater();
+    void schedule();
+    void startJob(Job &job);
+    void updateProgress(int id, int percent, const QString &message);
+    void completeJob(int id, const JobResult &result);
+
+    QMap<int, Job> m_jobs;
+    QThreadPool m_pool;
+    int m_maxWorkers = 2;
+    int m_running = 0;
+    int m_nextId = 1;
+    bool m_scheduleQueued = false;
+};
+
+#endif // JOBQUEUE_H
@@ -0,0 +1,131 @@
+#include "jobqueuewidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QProgressBar>
+
+JobQueueWidget::JobQueueWidget(JobQueue *queue, QWidget *parent)
+    : QWidget(parent), m_queue(queue)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(10, 10, 10, 10);
+
+    QHBoxLayout *toolbar = new QHBoxLayout;
+    m_summaryLabel = new QLabel(this);
+    m_cancelButton = new QPushButton("取消所选", this);
+    m_clearButton = new QPushButton("清除已结束", this);
+    toolbar->addWidget(m_summaryLabel);
+    toolbar->addStretch();
+    toolbar->addWidget(m_cancelButton);
+    toolbar->addWidget(m_clearButton);
+    layout->addLayout(toolbar);
+
+    m_table = new QTableWidget(this);
+    m_table->setColumnCount(8);
+    m_table->setHorizontalHeaderLabels({"编号", "任务", "分组", "优先级", "状态", "进度", "说明", "耗时(s)"});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table);
+
+    connect(m_cancelButton, &QPushButton::clicked, this, &JobQueueWidget::cancelSelected);
+    connect(m_clearButton, &QPushButton::clicked, m_queue, &JobQueue::clearFinished);
+    connect(m_queue, &JobQueue::jobAdded, this, &JobQueueWidget::onJobAdded);
+    connect(m_queue, &JobQueue::jobChanged, this, &JobQueueWidget::refreshJob);
+    connect(m_queue, &JobQueue::jobRemoved, this, &JobQueueWidget::onJobRemoved);
+
+    for (int id : m_queue->jobIds()) onJobAdded(id);
+    updateSummary();
+}
+
+int JobQueueWidget::rowOf(int id) const
+{
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        QTableWidgetItem *item = m_table->item(row, 0);
+        if (item && item->data(Qt::UserRole).toInt() == id) return row;
+    }
+    return -1;
+}
+
+void JobQueueWidget::onJobAdded(int id)
+{
+    int row = m_table->rowCount();
+    m_table->insertRow(row);
+    for (int col = 0; col < m_table->columnCount(); ++col) {
+        if (col == 5) continue;
+        m_table->setItem(row, col, new QTableWidgetItem);
+    }
+    m_table->item(row, 0)->setData(Qt::UserRole, id);
+
+    QProgressBar *bar = new QProgressBar(m_table);
+    bar->setRange(0, 100);
+    m_table->setCellWidget(row, 5, bar);
+    refreshJob(id);
+}
+
+void JobQueueWidget::refreshJob(int id)
+{
+    int row = rowOf(id);
+    if (row < 0) return;
+
+    const JobQueue::JobInfo info = m_queue->job(id);
+    qint64 elapsedMs = 0;
+    if (info.startedAt.isValid()) {
+        QDateTime end = info.finishedAt.isValid() ? info.finishedAt : QDateTime::currentDateTime();
+        elapsedMs = info.startedAt.msecsTo(end);
+    }
+
+    const QStringList cells = {
+        QString::number(info.id),
+        info.title,
+        info.group,
+        JobQueue::priorityName(info.priority),
+        JobQueue::stateName(info.state),
+        QString(),
+        info.message,
+        info.startedAt.isValid() ? QString::number(elapsedMs / 1000.0, 'f', 1) : QString("-")
+    };
+    for (int col = 0; col < cells.size(); ++col) {
+        if (col == 5) continue;
+        m_table->item(row, col)->setText(cells[col]);
+    }
+    if (QProgressBar *bar = qobject_cast<QProgressBar *>(m_table->cellWidget(row, 5))) bar->setValue(info.progress);
+
+    // 失败时悬停显示完整错误，成功时显示结果文件
+    QString tip = info.state == JobQueue::Succeeded ? info.result.resultPath : info.result.error;
+    m_table->item(row, 6)->setToolTip(tip);
+    QColor color = info.state == JobQueue::Failed ? QColor("#FFE0E0")
+                 : info.state == JobQueue::Running ? QColor("#E0F0FF")
+                 : QColor();
+    for (int col = 0; col < m_table->columnCount(); ++col) {
+        if (QTableWidgetItem *item = m_table->item(row, col)) item->setBackground(color.isValid() ? QBrush(color) : QBrush());
+    }
+    updateSummary();
+}
+
+void JobQueueWidget::onJobRemoved(int id)
+{
+    int row = rowOf(id);
+    if (row >= 0) m_table->removeRow(row);
+    updateSummary();
+}
+
+void JobQueueWidget::cancelSelected()
+{
+    QList<int> ids;
+    for (const QModelIndex &index : m_table->selectionModel()->selectedRows()) {
+        ids.append(m_table->item(index.row(), 0)->data(Qt::UserRole).toInt());
+    }
+    for (int id : ids) m_queue->cancel(id);
+}
+
+void JobQueueWidget::updateSummary()
+{
+    m_summaryLabel->setText(QString("运行中 %1 / 上限 %2，排队 %3")
+                                .arg(m_queue->runningCount())
+                                .arg(m_queue->maxWorkers())
+                                .arg(m_queue->pendingCount()));
+}
@@ -0,0 +1,34 @@
+#ifndef JOBQUEUEWIDGET_H
+#define JOBQUEUEWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include "jobqueue.h"
+
+// 后台任务页：每行一个离线处理任务，显示状态、进度和耗时，可取消所选任务、清除已结束任务
+class JobQueueWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit JobQueueWidget(JobQueue *queue, QWidget *parent = nullptr);
+
+private slots:
+    void onJobAdded(int id);
+    void refreshJob(int id);
+    void onJobRemoved(int id);
+    void cancelSelected();
+
+private:
+    int rowOf(int id) const;
+    void updateSummary();
+
+    JobQueue *m_queue;
+    QTableWidget *m_table;
+    QPushButton *m_cancelButton;
+    QPushButton *m_clearButton;
+    QLabel *m_summaryLabel;
+};
+
+#endif // JOBQUEUEWIDGET_H
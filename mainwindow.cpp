@@ -5,6 +5,9 @@
 #include <QTableWidget>
 #include "dataexcelprocessor.h"
 #include <QWidget> // 新增：确保识别 QWidget 的信号
+#include "rigoverviewwidget.h"
+#include "modbusdiagnosticswidget.h"
+#include "jobqueuewidget.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -36,11 +39,20 @@ MainWindow::MainWindow(QWidget *parent)
     qDebug() << "MainWindow geometry:" << geometry();
     qDebug() << "MainWindow centralWidget geometry:" << centralWidget()->geometry();
 
+    // 【新增】Modbus 总线参数：同一 COM 口上的黑体炉、恒温箱共用一个 RTU 主站
+    ModbusBusManager::instance()->loadSettings(*m_settings);
+
+    // 【新增】离线处理任务队列：Excel 处理、Python 拟合和证书生成都经由它排队执行
+    m_jobQueue = new JobQueue(this);
+    m_jobQueue->loadSettings(*m_settings);
+    excelProcessor->setJobQueue(m_jobQueue);
+
     // 初始化恒温恒湿箱控制（新增）
     setupHumidityControls();
 
     // 【新增】初始化伺服电机控制器
     m_servoController = new ServoMotorController(this);
+    m_servoController->loadSettings(*m_settings); // 【新增】速度曲线与运动超时参数
 
     setupServoControls();
 
@@ -110,17 +122,54 @@ MainWindow::MainWindow(QWidget *parent)
      m_progressDialog->setRange(0, 100);
      m_progressDialog->setAutoClose(true);
 
-     // 连接取消按钮
+     // 连接取消按钮：【新增】取消本次排队的拟合任务（运行中的会终止 Python 进程）
      connect(m_progressDialog, &QProgressDialog::canceled, [this]{
-         m_pythonProcessor->terminateProcess(); // 需要添加终止方法
+         const QList<int> jobs = m_fittingJobs;
+         m_fittingJobs.clear();
+         for (int id : jobs) m_jobQueue->cancel(id);
          m_progressDialog->hide();
      });
 
+     // 【新增】多台架：先加载附加台架配置，串口线程需要覆盖它们的测温仪
+     m_irHub = new IrDataHub(this);
+     m_rigOrchestrator = new RigOrchestrator(m_irHub, this);
+     int extraRigs = m_rigOrchestrator->loadFromSettings(*m_settings);
+
      // 初始化IRTCommTab
      setupIRTCommTab();
 
      setupCalibrationManager();
 
+     m_rigOrchestrator->addPrimaryRig("主台架", m_calibrationManager);
+     connect(m_rigOrchestrator, &RigOrchestrator::primaryStartRequested, this, &MainWindow::startPrimaryCalibration);
+     if (extraRigs > 0) {
+         // 【新增】台架总览可单独启动、暂停、取消某个台架；未配置温度点的附加台架使用界面输入
+         RigOverviewWidget *overview = new RigOverviewWidget(m_rigOrchestrator);
+         connect(overview, &RigOverviewWidget::startRequested, this, [this](int index) {
+             QString error;
+             if (!m_rigOrchestrator->startRig(index, parseTemperatureString(ui->blackbodyModelingTempInput->text()),
+                                              parseTemperatureString(ui->blackbodyVerifyTempInput->text()), &error)
+                 && !error.isEmpty()) {
+                 QMessageBox::warning(this, "附加台架", error);
+             }
+         });
+         ui->IRTCommTab->addTab(overview, "台架总览");
+     }
+
+     // 【新增】通信诊断页：各台架黑体炉、恒温箱的往返时间、错误计数和数值时效
+     ModbusDiagnosticsWidget *diagnostics = new ModbusDiagnosticsWidget;
+     diagnostics->addDevice("黑体炉", m_blackbodyController);
+     diagnostics->addDevice("恒温箱", m_humidityController);
+     for (RigContext *rig : m_rigOrchestrator->rigs()) {
+         if (!rig->ownsDevices()) continue;
+         diagnostics->addDevice(rig->config().name + " 黑体炉", rig->blackbody());
+         diagnostics->addDevice(rig->config().name + " 恒温箱", rig->chamber());
+     }
+     ui->IRTCommTab->addTab(diagnostics, "通信诊断");
+
+     // 【新增】后台任务页：离线处理任务的排队、进度和取消
+     ui->IRTCommTab->addTab(new JobQueueWidget(m_jobQueue), "后台任务");
+
      // 初始化 UI 中的进度条
      ui->calibrationProgressBar->setRange(0, 100);
      ui->calibrationProgressBar->setValue(0);
@@ -271,22 +320,18 @@ MainWindow::MainWindow(QWidget *parent)
      m_irDataTimer->setInterval(1000);
      connect(m_irDataTimer, &QTimer::timeout, this, &MainWindow::updateIrChartFromTable);
 
+     // 【修改】主台架与附加台架一样由红外汇聚求最近一分钟平均
      connect(m_calibrationManager, &CalibrationManager::requestIrAverage,
-             this, [this](const QString& comPort, QObject* receiver) {
-                 // 1. 计算数据
-                 auto irData = getIrAverage(comPort);
-
-                 // 2. 【修改】直接调用，代替 invokeMethod
-                 auto* manager = qobject_cast<CalibrationManager*>(receiver);
-                 if (manager) {
-                     manager->onIrAverageReceived(comPort, irData);
-                 }
-             });
+             m_irHub, &IrDataHub::serveRequest);
 
 }
 
 MainWindow::~MainWindow()
 {
+    // 【新增】先取消并等待后台任务，它们引用的处理器随后才析构
+    m_jobQueue->cancelAll();
+    m_jobQueue->waitForDone();
+
     // 清理串口线程
     for (SerialPortThread* thread : m_serialThreads) {
         if (thread) {
@@ -311,12 +356,6 @@ MainWindow::~MainWindow()
         m_humidityController = nullptr;
     }
 
-    if (humidityTimer) { // 显式清理成员定时器
-        humidityTimer->stop();
-        delete humidityTimer;
-        humidityTimer = nullptr;
-    }
-
     delete ui;
 
     delete m_calibrationManager;
@@ -330,22 +369,17 @@ void MainWindow::setupBlackbodyControls()
 
     // 初始化控制器（传入配置的端口）
     m_blackbodyController = new BlackbodyController(this);
-
-    // 初始化定时器
-    QTimer *timer = new QTimer(this);
-    timer->setInterval(1000);
+    m_blackbodyController->setSlaveAddress(quint8(settings.value("blackbody/slave_address", 0x02).toInt())); // 【新增】
 
     // 初始禁用操作按钮
     ui->setTempButton->setEnabled(false);
     ui->startStopButton->setEnabled(false);
 
-    // 控制权状态控制定时器
-    connect(m_blackbodyController, &BlackbodyController::masterControlChanged, timer, [timer](bool acquired) {
-        acquired ? timer->start() : timer->stop();
+    // 控制权状态控制温度轮询（轮询周期由事务调度器按测量阶段调整）
+    connect(m_blackbodyController, &BlackbodyController::masterControlChanged, this, [this](bool acquired) {
+        m_blackbodyController->setPollingEnabled(acquired);
     });
 
-    connect(timer, &QTimer::timeout, m_blackbodyController, &BlackbodyController::readCurrentTemperature);
-
     // 连接状态信号
     connect(m_blackbodyController, &BlackbodyController::connectionStatusChanged,
             this, [this](bool connected) {
@@ -486,6 +520,7 @@ void MainWindow::onOpenComButtonClicked()
         // 初始化控制器
         QString portName = ui->COMcomboBox->currentText();
         m_blackbodyController = new BlackbodyController(this);
+        m_blackbodyController->setSlaveAddress(quint8(m_settings->value("blackbody/slave_address", 0x02).toInt())); // 【新增】
 
         // 连接状态信号到UI更新
         connect(m_blackbodyController, &BlackbodyController::connectionStatusChanged,
@@ -612,10 +647,7 @@ void MainWindow::setupHumidityControls() {
     QString portName = settings.value("humidity/com_port", "COM12").toString();
 
     m_humidityController = new HumidityController(this);
-
-    // 初始化定时器
-    humidityTimer = new QTimer(this);
-    humidityTimer->setInterval(1000);
+    m_humidityController->setSlaveAddress(quint8(settings.value("humidity/slave_address", 0x03).toInt())); // 【新增】
 
     // 初始禁用操作按钮
     ui->setTempButton_2->setEnabled(false);
@@ -655,9 +687,6 @@ void MainWindow::setupHumidityControls() {
 
     connect(ui->openWindowButton, &QPushButton::clicked, this, &MainWindow::onToggleCalibrationWindowClicked);
 
-    connect(humidityTimer, &QTimer::timeout, m_humidityController, &HumidityController::readCurrentTemperature);
-    connect(humidityTimer, &QTimer::timeout, m_humidityController, &HumidityController::readCurrentHumidity);
-
     // 恒温箱保存功能连接
     connect(ui->enableSaveCheckBox_3, &QCheckBox::toggled, this, &MainWindow::onHumidityEnableSaveToggled);
     connect(ui->selectPathButton_3, &QPushButton::clicked, this, &MainWindow::onHumiditySelectPathClicked);
@@ -684,8 +713,8 @@ void MainWindow::onHumidityConnectionStatusChanged(bool connected) {
         ui->setTempButton_2->setEnabled(false);
         ui->startStopButton_2->setEnabled(false);
         ui->openWindowButton->setEnabled(false);
-        humidityTimer->stop();
-        qDebug() << "湿度定时器已停止";
+        m_humidityController->setPollingEnabled(false);
+        qDebug() << "恒温箱轮询已停止";
     }
 
 
@@ -702,11 +731,11 @@ void MainWindow::onHumidityMasterControlChanged(bool acquired) {
 
     if (acquired) {
         // 获得控制：启动定时器，更新按钮文本
-        humidityTimer->start();
+        m_humidityController->setPollingEnabled(true); // 温湿度合并为一次读取
         ui->masterControlButton_2->setText("释放控制");
     } else {
         // 释放控制或获取失败：停止定时器，禁用按钮，清空显示
-        humidityTimer->stop();
+        m_humidityController->setPollingEnabled(false);
         ui->currentTempDisplay_2->clear();
         ui->currentHumDisplay->clear();
 
@@ -752,6 +781,7 @@ void MainWindow::onOpenComButton2Clicked()
     if (!m_humidityController) {
         QString portName = ui->COMcomboBox_2->currentText();
         m_humidityController = new HumidityController(this);
+        m_humidityController->setSlaveAddress(quint8(m_humiditySettings->value("humidity/slave_address", 0x03).toInt())); // 【新增】
 
         // 只在初始化时连接一次信号（使用一次性连接或检查是否已连接）
         if (!connect(m_humidityController, &HumidityController::connectionStatusChanged,
@@ -947,51 +977,43 @@ void MainWindow::onSingleHeadButtonClicked()
     QString sourcePath = QFileDialog::getOpenFileName(this, "选择数据文件", "", "Excel文件 (*.xlsx)");
     if (sourcePath.isEmpty()) return;
 
-    // 第一步：处理标准数据
-    excelProcessor->startProcessing(DataExcelProcessor::StandardData, sourcePath);
-
-    // 标准处理完成的连接（使用可断开的连接）
-    QMetaObject::Connection* stdConn = new QMetaObject::Connection;
-    *stdConn = QObject::connect(excelProcessor, &DataExcelProcessor::operationCompleted, this,
-                                [this, sourcePath, stdConn](bool success, const QString& stdOutputPath) {
-                                    QObject::disconnect(*stdConn);
-                                    delete stdConn;
-
-                                    if (!success) {
-                                        // 错误处理优化：获取最新错误信息并显示
-                                        QString errorMsg = excelProcessor->lastError();
-                                        QMessageBox::critical(this, "标准数据处理失败",
-                                                              QString("处理失败: %1\n文件: %2")
-                                                                  .arg(errorMsg.isEmpty() ? "未知错误" : errorMsg)
-                                                                  .arg(QFileInfo(stdOutputPath).fileName()));
-                                        return;
-                                    }
-
-                                    qDebug() << "标准数据处理完成，输出路径：" << stdOutputPath;
-
-                                    // 第二步：处理单头数据
-                                    excelProcessor->startProcessing(DataExcelProcessor::SingleHead, stdOutputPath);
-
-                                    // 单头处理完成的连接
-                                    QMetaObject::Connection* singleConn = new QMetaObject::Connection;
-                                    *singleConn = QObject::connect(excelProcessor, &DataExcelProcessor::operationCompleted, this,
-                                                                   [this, singleConn](bool success, const QString& singleOutputPath) {
-                                                                       QObject::disconnect(*singleConn);
-                                                                       delete singleConn;
-
-                                                                       if (success) {
-                                                                           QMessageBox::information(this, "完成",
-                                                                                                    QString("标准+单头数据处理完成！\n结果文件：%1")
-                                                                                                        .arg(singleOutputPath));
-                                                                       } else {
-                                                                           QString errorMsg = excelProcessor->lastError();
-                                                                           QMessageBox::critical(this, "单头数据处理失败",
-                                                                                                 QString("处理失败: %1\n文件: %2")
-                                                                                                     .arg(errorMsg.isEmpty() ? "未知错误" : errorMsg)
-                                                                                                     .arg(QFileInfo(singleOutputPath).fileName()));
-                                                                       }
-                                                                   });
-                                });
+    // 第一步：处理标准数据（【新增】经任务队列执行，完成回调在主线程）
+    int stdJob = excelProcessor->startProcessing(DataExcelProcessor::StandardData, sourcePath);
+    if (stdJob < 0) return; // 参数错误已通过 errorOccurred 提示
+
+    m_jobQueue->whenFinished(stdJob, this, [this](const JobQueue::JobInfo &stdInfo) {
+        const QString stdOutputPath = stdInfo.result.resultPath;
+        if (!stdInfo.result.success) {
+            // 错误处理优化：获取最新错误信息并显示
+            QString errorMsg = stdInfo.result.error;
+            QMessageBox::critical(this, "标准数据处理失败",
+                                  QString("处理失败: %1\n文件: %2")
+                                      .arg(errorMsg.isEmpty() ? "未知错误" : errorMsg)
+                                      .arg(QFileInfo(stdOutputPath).fileName()));
+            return;
+        }
+
+        qDebug() << "标准数据处理完成，输出路径：" << stdOutputPath;
+
+        // 第二步：处理单头数据
+        int singleJob = excelProcessor->startProcessing(DataExcelProcessor::SingleHead, stdOutputPath);
+        if (singleJob < 0) return;
+
+        m_jobQueue->whenFinished(singleJob, this, [this](const JobQueue::JobInfo &singleInfo) {
+            const QString singleOutputPath = singleInfo.result.resultPath;
+            if (singleInfo.result.success) {
+                QMessageBox::information(this, "完成",
+                                         QString("标准+单头数据处理完成！\n结果文件：%1")
+                                             .arg(singleOutputPath));
+            } else {
+                QString errorMsg = singleInfo.result.error;
+                QMessageBox::critical(this, "单头数据处理失败",
+                                      QString("处理失败: %1\n文件: %2")
+                                          .arg(errorMsg.isEmpty() ? "未知错误" : errorMsg)
+                                          .arg(QFileInfo(singleOutputPath).fileName()));
+            }
+        });
+    });
 }
 
 // 多头数据处理按钮
@@ -1000,43 +1022,32 @@ void MainWindow::onMultiHeadButtonClicked()
     QString sourcePath = QFileDialog::getOpenFileName(this, "选择数据文件", "", "Excel文件 (*.xlsx)");
     if (sourcePath.isEmpty()) return;
 
-    // 第一步：处理标准数据
-    excelProcessor->startProcessing(DataExcelProcessor::StandardData, sourcePath);
-
-    // 使用原始指针代替unique_ptr（简化方案）
-    QMetaObject::Connection* stdConn = new QMetaObject::Connection;
-    *stdConn = QObject::connect(excelProcessor, &DataExcelProcessor::operationCompleted, this,
-                                [this, sourcePath, stdConn](bool success, const QString& stdOutputPath) {
-                                    // 断开连接并释放内存
-                                    QObject::disconnect(*stdConn);
-                                    delete stdConn;
+    // 第一步：处理标准数据（【新增】经任务队列执行，完成回调在主线程）
+    int stdJob = excelProcessor->startProcessing(DataExcelProcessor::StandardData, sourcePath);
+    if (stdJob < 0) return;
 
-                                    if (!success) {
-                                        QMessageBox::critical(this, "错误", "标准数据处理失败！");
-                                        return;
-                                    }
-
-                                    qDebug() << "标准数据处理完成，输出路径：" << stdOutputPath;
+    m_jobQueue->whenFinished(stdJob, this, [this](const JobQueue::JobInfo &stdInfo) {
+        if (!stdInfo.result.success) {
+            QMessageBox::critical(this, "错误", "标准数据处理失败！");
+            return;
+        }
 
-                                    // 第二步：处理多头数据
-                                    excelProcessor->startProcessing(DataExcelProcessor::MultiHead, stdOutputPath);
+        const QString stdOutputPath = stdInfo.result.resultPath;
+        qDebug() << "标准数据处理完成，输出路径：" << stdOutputPath;
 
-                                    // 使用原始指针处理多头连接
-                                    QMetaObject::Connection* multiConn = new QMetaObject::Connection;
-                                    *multiConn = QObject::connect(excelProcessor, &DataExcelProcessor::operationCompleted, this,
-                                                                  [this, multiConn](bool success, const QString& multiOutputPath) {
-                                                                      // 断开连接并释放内存
-                                                                      QObject::disconnect(*multiConn);
-                                                                      delete multiConn;
+        // 第二步：处理多头数据
+        int multiJob = excelProcessor->startProcessing(DataExcelProcessor::MultiHead, stdOutputPath);
+        if (multiJob < 0) return;
 
-                                                                      if (success) {
-                                                                          QMessageBox::information(this, "完成",
-                                                                                                   QString("标准+多头数据处理完成！\n结果文件：\n%1").arg(multiOutputPath));
-                                                                      } else {
-                                                                          QMessageBox::critical(this, "错误", "多头数据处理失败！");
-                                                                      }
-                                                                  });
-                                });
+        m_jobQueue->whenFinished(multiJob, this, [this](const JobQueue::JobInfo &multiInfo) {
+            if (multiInfo.result.success) {
+                QMessageBox::information(this, "完成",
+                                         QString("标准+多头数据处理完成！\n结果文件：\n%1").arg(multiInfo.result.resultPath));
+            } else {
+                QMessageBox::critical(this, "错误", "多头数据处理失败！");
+            }
+        });
+    });
 }
 
 
@@ -1138,66 +1149,17 @@ void MainWindow::processMergedFile(const QString& filePath)
 
 
 
-// 改为返回生成的模板路径
+// 改为返回生成的模板路径（【新增】模板写出移至 DataExcelProcessor，批处理程序共用）
 QString MainWindow::processSelectedData(QXlsx::Document& srcDoc,
                                         const QString& sheetName,
                                         const QVector<bool>& selections,
                                         const QString& sourceFilePath)
 {
-    // 提取设备名称（逻辑不变）
-    static const QRegularExpression re(R"(多(\d+))");
-    QRegularExpressionMatch match = re.match(sheetName);
-    QString deviceName = match.hasMatch() ? "多" + match.captured(1) : "未知设备";
-
-    // 创建新文档（逻辑不变）
-    QXlsx::Document newXlsx;
-    newXlsx.addSheet(sheetName);
-    newXlsx.selectSheet(sheetName);
-
-    // 写入列标题（逻辑不变）
-    QStringList headers = {"测量点温度", "TO1", "TO2", "TO3", "TA1", "TA2", "TA3", "标准",
-                           "测量点温度验证", "TO1验证", "TO2验证", "TO3验证", "TA1验证", "TA2验证", "TA3验证", "标准验证"};
-    for(int col = 1; col <= headers.size(); ++col) {
-        newXlsx.write(1, col, headers[col-1]);
-    }
-
-    // 写入数据（逻辑不变）
-    int selectedRow = 2;
-    int unselectedRow = 2;
-    for (int i = 0; i < selections.size(); ++i) {
-        const int srcRow = 4 + i;
-        QVector<QVariant> rowData;
-
-        for (int col = 4; col <= 10; ++col) {
-            rowData.append(srcDoc.read(srcRow, col));
-        }
-        rowData.append(srcDoc.read(srcRow, 14)); // N列
-
-        if (selections[i]) {
-            for (int col = 1; col <= 8; ++col) {
-                newXlsx.write(selectedRow, col, rowData[col-1]);
-            }
-            ++selectedRow;
-        } else {
-            for (int col = 9; col <= 16; ++col) {
-                newXlsx.write(unselectedRow, col, rowData[col-9]);
-            }
-            ++unselectedRow;
-        }
-    }
-
-    // 保存文件并返回路径（关键修改）
-    QFileInfo sourceFileInfo(sourceFilePath);
-    QString outputPath = sourceFileInfo.path() + "/" + deviceName + ".xlsx";
-
-    if (newXlsx.saveAs(outputPath)) {
-        // 整合流程中无需自动打开文件，注释此行
-        // QDesktopServices::openUrl(QUrl::fromLocalFile(outputPath));
-        return outputPath; // 返回生成的模板路径
-    } else {
+    QString outputPath = excelProcessor->writeMultiHeadTemplate(srcDoc, sheetName, selections, sourceFilePath);
+    if (outputPath.isEmpty()) {
         QMessageBox::critical(this, "错误", "文件保存失败");
-        return ""; // 保存失败返回空路径
     }
+    return outputPath;
 }
 
 void MainWindow::onPythonProgress(const QString& message)
@@ -1352,9 +1314,27 @@ void MainWindow::setupCalibrationManager()
     m_calibrationManager->setServoController(m_servoController);
     connect(m_calibrationManager, &CalibrationManager::calibrationFinished, this, &MainWindow::onCalibrationFinished);
     connect(m_calibrationManager, &CalibrationManager::errorOccurred, this, &MainWindow::onCalibrationError);
+
+    // 【新增】设定值整形：辨识出的黑体炉模型写回 config.ini，下次启动直接使用
+    connect(m_calibrationManager->setpointShaper(), &SetpointShaper::modelUpdated, this, [this]() {
+        m_calibrationManager->setpointShaper()->saveModels(*m_settings);
+    });
 }
 
 void MainWindow::onStartCalibrationClicked()
+{
+    if (!startPrimaryCalibration()) return;
+
+    // 【新增】附加台架并行启动（各自的设备、流程和温度点）
+    QStringList rigErrors = m_rigOrchestrator->startSecondaryRigs(parseTemperatureString(ui->blackbodyModelingTempInput->text()),
+                                                                  parseTemperatureString(ui->blackbodyVerifyTempInput->text()));
+    if (!rigErrors.isEmpty()) {
+        QMessageBox::warning(this, "附加台架", rigErrors.join("\n"));
+    }
+}
+
+// 【新增】只启动主台架（开始按钮和台架总览共用）；参数或设备有误时提示并返回 false
+bool MainWindow::startPrimaryCalibration()
 {
     calibrationButtonClickCount++;
 
@@ -1369,7 +1349,7 @@ void MainWindow::onStartCalibrationClicked()
 
     if (modPoints.isEmpty() && verPoints.isEmpty()) {
         QMessageBox::warning(this, "错误", "请输入有效的黑体炉温度点（建模或验证至少填写一项）");
-        return;
+        return false;
     }
 
     // 合并温度点：先跑建模，再跑验证
@@ -1396,7 +1376,7 @@ void MainWindow::onStartCalibrationClicked()
         if (!m_servoController->connectDevice(servoPort)) {
             QMessageBox::critical(this, "连接失败",
                                   QString("无法连接伺服电机 (端口: %1)\n请在 config.ini 中配置 [servo] com_port=COMx").arg(servoPort));
-            return;
+            return false;
         }
     }
 
@@ -1423,18 +1403,39 @@ void MainWindow::onStartCalibrationClicked()
 
     if (taskQueue.isEmpty()) {
         QMessageBox::critical(this, "配置错误", "未解析到有效的设备位置信息！\n请检查 config.ini 的 [devices] com_ports 设置。");
-        return;
+        return false;
     }
 
     // 4. 将任务队列传递给管理器
     m_calibrationManager->setMeasurementQueue(taskQueue);
 
+    // 【新增】声明式流程：config.ini 中 [calibration] plan_file 指定流程文件时按文件执行，否则使用内置流程
+    QString planFile = m_settings->value("calibration/plan_file").toString().trimmed();
+    if (planFile.isEmpty()) {
+        m_calibrationManager->clearPlan();
+    } else {
+        CalibrationPlan plan;
+        QString planError;
+        if (!CalibrationPlan::loadFromFile(planFile, &plan, &planError)) {
+            QMessageBox::critical(this, "流程文件错误", planError);
+            return false;
+        }
+        m_calibrationManager->setPlan(plan);
+    }
+
+    // 【新增】流水线模式：最后一个测温仪驻留期间提前切换恒温箱（秒，0 表示关闭）
+    m_calibrationManager->setPipelineLeadTime(m_settings->value("calibration/pipeline_lead_sec", 0).toInt());
+
+    // 【新增】黑体炉设定值整形（[setpoint_shaping] enabled=true 时启用）
+    m_calibrationManager->setpointShaper()->loadSettings(*m_settings);
+
     checkAutoSaveSettings();
     calibrationInProgress = true;
     ui->startCalibrationButton->setEnabled(false);
 
     // 【修改】启动标定，传入第4个参数 envType
     m_calibrationManager->startCalibration(modPoints, verPoints, humidityTempPoints, envType);
+    return true;
 }
 
 
@@ -1444,10 +1445,12 @@ void MainWindow::onPauseResumeClicked()
 
     if (state == CalibrationManager::Running) {
         m_calibrationManager->pauseCalibration();
+        m_rigOrchestrator->pauseSecondaryRigs();
         ui->pauseResumeButton->setText("继续");
     }
     else if (state == CalibrationManager::Paused) {
         m_calibrationManager->resumeCalibration();
+        m_rigOrchestrator->resumeSecondaryRigs();
         ui->pauseResumeButton->setText("暂停");
     }
 }
@@ -1459,6 +1462,7 @@ void MainWindow::onCancelClicked()
 
     if (reply == QMessageBox::Yes) {
         m_calibrationManager->cancelCalibration();
+        m_rigOrchestrator->cancelSecondaryRigs();
 
     }
 }
@@ -1693,11 +1697,14 @@ void MainWindow::onIntegratedProcessClicked()
     m_integratedMergedPath = "";
     m_integratedTemplatePaths.clear();
 
-    // 异步合并文件，并设置后续处理回调
-    QFutureWatcher<void>* mergeWatcher = new QFutureWatcher<void>(this);
-    connect(mergeWatcher, &QFutureWatcher<void>::finished, [this, mergeWatcher]() {
-        mergeWatcher->deleteLater();
-
+    // 异步合并文件，并设置后续处理回调（【新增】经任务队列执行，与 Excel 处理共用 "excel" 分组）
+    int mergeJob = m_jobQueue->submit("合并单头文件：" + QFileInfo(inFile).fileName(), "excel", JobQueue::NormalPriority,
+                                      [this, inFile, outFile](const JobContext &) {
+        QString mergedPath = excelProcessor->mergeSingleHeadFiles(inFile, outFile);
+        return mergedPath.isEmpty() ? JobResult::failed(excelProcessor->lastError()) : JobResult::ok(mergedPath);
+    });
+    m_jobQueue->whenFinished(mergeJob, this, [this](const JobQueue::JobInfo &info) {
+        m_integratedMergedPath = info.result.success ? info.result.resultPath : QString();
         if (!m_integratedMergedPath.isEmpty()) {
             m_progressDialog->setLabelText("正在生成拟合模板...");
             m_progressDialog->setValue(30);
@@ -1707,12 +1714,6 @@ void MainWindow::onIntegratedProcessClicked()
             QMessageBox::critical(this, "错误", "文件合并失败，无法继续");
         }
     });
-
-    // 启动合并任务
-    QFuture<void> mergeFuture = QtConcurrent::run([=]() {
-        m_integratedMergedPath = excelProcessor->mergeSingleHeadFiles(inFile, outFile);
-    });
-    mergeWatcher->setFuture(mergeFuture);
 }
 
 void MainWindow::processIntegratedTemplatesWithDialog(const QString& mergedFilePath)
@@ -1738,25 +1739,10 @@ void MainWindow::processIntegratedTemplatesWithDialog(const QString& mergedFileP
         // 跳过标准工作表
         if (sheetName == "标准") continue;
 
-        mergedDoc.selectSheet(sheetName);
+        // 读取数据
         QVector<double> temperatures;
         QVector<QString> conditions;
-        int emptyCount = 0;
-
-        // 读取数据
-        for (int row = 2; emptyCount < 5; ++row) {
-            QVariant condVar = mergedDoc.read(row, 4); // D列（测试条件）
-            QVariant tempVar = mergedDoc.read(row, 5);  // E列（温度）
-
-            if (condVar.isNull() || tempVar.isNull()) {
-                ++emptyCount;
-                continue;
-            }
-
-            emptyCount = 0;
-            conditions.append(condVar.toString());
-            temperatures.append(tempVar.toDouble());
-        }
+        DataExcelProcessor::readModelingCandidates(mergedDoc, sheetName, false, temperatures, conditions);
 
         if (temperatures.isEmpty()) continue;
 
@@ -1800,88 +1786,49 @@ void MainWindow::processAllTemplatesFitting()
         return;
     }
 
-    // 初始化模板处理队列和索引
-    m_templateQueue = QStringList::fromVector(m_integratedTemplatePaths);
-    m_currentTemplateIndex = 0;
-    int total = m_templateQueue.size();
-
     m_progressDialog->setLabelText("开始处理所有模板...");
     m_progressDialog->setRange(70, 100);
     m_progressDialog->setValue(70);
     m_progressDialog->show();
 
-    qDebug() << "待处理模板数量:" << total;
-    processNextTemplate();
+    qDebug() << "待处理模板数量:" << m_integratedTemplatePaths.size();
+    startFittingJobs(QStringList::fromVector(m_integratedTemplatePaths), false, 70);
 }
 
-// 在 processNextTemplate 函数中增加状态检查和延迟处理机制
-void MainWindow::processNextTemplate()
+// 【新增】批量提交拟合任务，全部结束后汇总提示；进度对话框从 progressBase 走到 100
+void MainWindow::startFittingJobs(const QStringList& templates, bool multiHead, int progressBase)
 {
-    qDebug() << "进入processNextTemplate，当前索引:" << m_currentTemplateIndex;
-
-    // 检查是否所有模板都已处理
-    if (m_currentTemplateIndex >= m_templateQueue.size()) {
-        qDebug() << "所有设备拟合完成";
-        m_progressDialog->hide();
-        QMessageBox::information(this, "完成", "所有设备拟合完成！");
-        return;
-    }
-
-    // 确保Python进程完全终止
-    if (m_pythonProcessor->isProcessing()) {
-        qDebug() << "Python进程仍在运行，强制终止...";
-        m_pythonProcessor->terminateProcess();
-        QThread::msleep(500); // 确保进程完全终止
-    }
-
-    const QString& templatePath = m_templateQueue[m_currentTemplateIndex];
-    qDebug() << "当前处理模板:" << templatePath << "("
-             << (m_currentTemplateIndex + 1) << "/" << m_templateQueue.size() << ")";
-
-    // 更新进度
-    int progress = 70 + (30 * m_currentTemplateIndex / m_templateQueue.size());
-    m_progressDialog->setValue(progress);
-    m_progressDialog->setLabelText(QString("正在处理模板 %1/%2: %3")
-                                       .arg(m_currentTemplateIndex + 1)
-                                       .arg(m_templateQueue.size())
-                                       .arg(QFileInfo(templatePath).fileName()));
-
-    // 获取测试员和审核员信息
-    QString tester = ui->testerlineEdit->text().trimmed();
-    QString reviewer = ui->reviewerslineEdit->text().trimmed();
-
-    // 传递信息给Python处理器
-    emit m_pythonProcessor->setTesterReviewerInfo(tester, reviewer);
-
-    // 传递合并文件路径给Python处理器
+    m_fittingJobs.clear();
+    auto finished = std::make_shared<int>(0);
+    auto failed = std::make_shared<int>(0);
+    const int total = templates.size();
+
+    // 获取测试员和审核员信息，与合并文件路径一起传递给Python处理器
+    m_pythonProcessor->setTesterReviewerInfo(ui->testerlineEdit->text().trimmed(),
+                                             ui->reviewerslineEdit->text().trimmed());
     m_pythonProcessor->setMergedFilePath(m_integratedMergedPath);
 
+    for (const QString &templatePath : templates) {
+        int id = m_pythonProcessor->submitFittingJob(m_jobQueue, templatePath, multiHead);
+        m_fittingJobs.append(id);
+        m_jobQueue->whenFinished(id, this, [this, id, finished, failed, total, progressBase, multiHead](const JobQueue::JobInfo &info) {
+            if (!m_fittingJobs.contains(id)) return; // 已被取消
+            ++*finished;
+            if (!info.result.success) ++*failed;
+            m_progressDialog->setValue(progressBase + (100 - progressBase) * *finished / total);
+            if (*finished < total) {
+                m_progressDialog->setLabelText(QString("正在拟合 %1/%2：%3").arg(*finished + 1).arg(total)
+                                                   .arg(m_jobQueue->job(m_fittingJobs.value(*finished)).title));
+                return;
+            }
 
-    // 使用一次性连接确保只处理当前模板
-    auto connection = std::make_shared<QMetaObject::Connection>();
-    *connection = connect(m_pythonProcessor, &PythonProcessor::processingFinished,
-                          this, [this, templatePath, connection](bool success, const QString& resultPath) {
-                              // 断开连接，避免重复触发
-                              disconnect(*connection);
-
-                              if (success) {
-                                  qDebug() << "模板处理成功:" << templatePath;
-                              } else {
-                                  qDebug() << "模板处理失败:" << templatePath;
-                              }
-
-                              // 移动到下一个模板
-                              m_currentTemplateIndex++;
-
-                              // 延迟处理下一个模板，确保资源释放
-                              QTimer::singleShot(500, this, [this] {
-                                  processNextTemplate();
-                              });
-                          });
-
-
-    // 启动Python处理
-    m_pythonProcessor->startProcessing(templatePath);
+            m_fittingJobs.clear();
+            m_progressDialog->hide();
+            QString text = multiHead ? "所有多头设备数据处理完成！" : "所有设备拟合完成！";
+            if (*failed > 0) text += QString("\n其中 %1 个失败，详见“后台任务”页").arg(*failed);
+            QMessageBox::information(this, "完成", text);
+        });
+    }
 }
 
 
@@ -1891,64 +1838,12 @@ QString MainWindow::generateIntegratedTemplate(QXlsx::Document& srcDoc,
                                                const QVector<bool>& selections,
                                                const QString& sourceFilePath)
 {
-    // 创建新文档
-    QXlsx::Document newXlsx;
-
-    // 添加两个工作表
-    newXlsx.addSheet("建模");
-    newXlsx.addSheet("验证");
-
-    // 写入表头
-    newXlsx.selectSheet("建模");
-    newXlsx.write(1, 1, "测试条件");
-    newXlsx.write(1, 2, "测量点温度");
-    newXlsx.write(1, 3, "目标");
-    newXlsx.write(1, 4, "腔体");
-    newXlsx.write(1, 5, "标准");
-
-    newXlsx.selectSheet("验证");
-    newXlsx.write(1, 1, "测试条件验证");
-    newXlsx.write(1, 2, "测量点温度验证");
-    newXlsx.write(1, 3, "目标验证");
-    newXlsx.write(1, 4, "腔体验证");
-    newXlsx.write(1, 5, "标准验证");
-
-    // 分类写入数据
-    int modelingRow = 2, validationRow = 2;
-    for (int i = 0; i < selections.size(); ++i) {
-        const int srcRow = 2 + i;
-        QVector<QVariant> rowData;
-
-        // 读取D(4), E(5), F(6), G(7), H(8)列
-        for (int col = 4; col <= 8; ++col) {
-            rowData.append(srcDoc.read(srcRow, col));
-        }
-
-        if (selections[i]) {
-            newXlsx.selectSheet("建模");
-            for (int col = 1; col <= 5; ++col) {
-                newXlsx.write(modelingRow, col, rowData[col-1]);
-            }
-            modelingRow++;
-        } else {
-            newXlsx.selectSheet("验证");
-            for (int col = 1; col <= 5; ++col) {
-                newXlsx.write(validationRow, col, rowData[col-1]);
-            }
-            validationRow++;
-        }
-    }
-
-    // 保存文件
-    QFileInfo sourceInfo(sourceFilePath);
-    QString outputPath = sourceInfo.path() + "/" + sheetName + ".xlsx";
-
-    if (newXlsx.saveAs(outputPath)) {
-        return outputPath;
-    } else {
-        QMessageBox::critical(this, "错误", QString("模板保存失败: %1").arg(outputPath));
-        return "";
+    // 【新增】模板写出移至 DataExcelProcessor，批处理程序共用
+    QString outputPath = excelProcessor->writeSingleHeadTemplate(srcDoc, sheetName, selections, sourceFilePath);
+    if (outputPath.isEmpty()) {
+        QMessageBox::critical(this, "错误", excelProcessor->lastError());
     }
+    return outputPath;
 }
 
 // 整合三个按钮功能的新按钮槽函数
@@ -1964,8 +1859,6 @@ void MainWindow::onIntegratedMultiProcessClicked()
 
     m_integratedMergedPath = "";
     m_integratedTemplatePaths.clear();
-    m_templateQueue.clear();
-    m_currentTemplateIndex = 0;
 
     m_progressDialog->setWindowTitle("多头数据处理中");
     m_progressDialog->setLabelText("正在合并文件...");
@@ -1994,24 +1887,21 @@ void MainWindow::onIntegratedMultiProcessClicked()
     bool mergeSuccess = false;
     QString actualOutputPath;
 
-    // 连接合并完成信号（主线程处理）
-    QMetaObject::Connection conn = connect(excelProcessor, &DataExcelProcessor::operationCompleted,
-                                           this, [&](bool success, const QString& outputPath) {
-                                               mergeSuccess = success;
-                                               actualOutputPath = outputPath;
-                                               loop.quit(); // 信号触发后退出事件循环
-                                           }, Qt::QueuedConnection);
-
     // 启动合并（注意：原startProcessing参数需调整）
-    excelProcessor->startProcessing(DataExcelProcessor::MergeFiles, inFile, outFile, templatePath);
-
-    // 阻塞等待合并完成（界面保持响应）
-    m_progressDialog->setLabelText("合并文件中...");
-    m_progressDialog->setValue(25);
-    loop.exec(); // 进入事件循环，等待信号触发
+    int mergeJob = excelProcessor->startProcessing(DataExcelProcessor::MergeFiles, inFile, outFile, templatePath);
+    if (mergeJob >= 0) {
+        // 【新增】等待该任务结束（只认这个任务，不会被其他处理的完成信号误触发）
+        m_jobQueue->whenFinished(mergeJob, &loop, [&](const JobQueue::JobInfo &info) {
+            mergeSuccess = info.result.success;
+            actualOutputPath = info.result.resultPath;
+            loop.quit(); // 任务结束后退出事件循环
+        });
 
-    // 断开信号连接（避免重复触发）
-    disconnect(conn);
+        // 阻塞等待合并完成（界面保持响应）
+        m_progressDialog->setLabelText("合并文件中...");
+        m_progressDialog->setValue(25);
+        loop.exec(); // 进入事件循环，等待任务结束
+    }
 
     // 步骤3：验证合并结果
     m_progressDialog->setLabelText("验证合并结果...");
@@ -2067,23 +1957,10 @@ void MainWindow::processIntegratedMergedFileWithDialog(const QString& mergedFile
         static const QRegularExpression re(R"(^COM\d+-多(\d+)$)");
         if (!re.match(sheetName).hasMatch()) continue;
 
-        mergedDoc.selectSheet(sheetName);
+        // 读取D列和P列数据（逻辑不变）
         QVector<double> temperatures;
         QVector<QString> conditions;
-        int emptyCount = 0;
-
-        // 读取D列和P列数据（逻辑不变）
-        for (int row = 4; emptyCount < 5; ++row) {
-            QVariant tempVar = mergedDoc.read(row, 4);   // D列
-            QVariant condVar = mergedDoc.read(row, 16);  // P列
-            if (tempVar.isNull() || condVar.isNull()) {
-                ++emptyCount;
-                continue;
-            }
-            emptyCount = 0;
-            conditions.append(condVar.toString());
-            temperatures.append(tempVar.toDouble());
-        }
+        DataExcelProcessor::readModelingCandidates(mergedDoc, sheetName, true, temperatures, conditions);
 
         if (temperatures.isEmpty()) continue;
 
@@ -2140,95 +2017,13 @@ void MainWindow::processAllMultiTemplatesFitting()
         return;
     }
 
-    // 初始化模板处理队列和索引
-    m_templateQueue = QStringList::fromVector(m_integratedTemplatePaths);
-    m_currentTemplateIndex = 0;
-    int total = m_templateQueue.size();
-
     m_progressDialog->setLabelText("开始处理所有拟合模板...");
     m_progressDialog->setRange(60, 100);
     m_progressDialog->setValue(60);
     m_progressDialog->show();
 
-    qDebug() << "待处理多头模板数量:" << total;
-    processNextMultiTemplate();
-}
-
-// 处理下一个模板的拟合任务
-void MainWindow::processNextMultiTemplate()
-{
-    qDebug() << "进入processNextMultiTemplate，当前索引:" << m_currentTemplateIndex;
-
-    // 检查是否所有模板都已处理
-    if (m_currentTemplateIndex >= m_templateQueue.size()) {
-        qDebug() << "所有多头设备拟合完成";
-        m_progressDialog->hide();
-        QMessageBox::information(this, "完成", "所有多头设备数据处理完成！");
-        return;
-    }
-
-    // 确保Python进程完全终止（如果有残留）
-    if (m_pythonProcessor->isProcessing()) {
-        qDebug() << "Python进程仍在运行，等待终止...";
-        // 可以添加等待逻辑或强制终止
-        QThread::msleep(1000);
-    }
-
-    const QString& templatePath = m_templateQueue[m_currentTemplateIndex];
-    qDebug() << "当前处理模板:" << templatePath << "("
-             << (m_currentTemplateIndex + 1) << "/" << m_templateQueue.size() << ")";
-
-    // 提取设备编号用于进度显示
-    QFileInfo fileInfo(templatePath);
-    QString deviceName = fileInfo.baseName();
-    if (deviceName.startsWith("多")) {
-        deviceName = deviceName.left(deviceName.indexOf('.')); // 去除文件扩展名
-    } else {
-        deviceName = "设备" + QString::number(m_currentTemplateIndex + 1);
-    }
-
-    // 更新进度
-    int progress = 60 + (40 * m_currentTemplateIndex / m_templateQueue.size());
-    m_progressDialog->setValue(progress);
-    m_progressDialog->setLabelText(QString("正在拟合 %1: %2")
-                                       .arg(deviceName)
-                                       .arg(QFileInfo(templatePath).fileName()));
-
-    // 使用一次性连接确保只处理当前模板
-    auto connection = std::make_shared<QMetaObject::Connection>();
-    *connection = connect(m_pythonProcessor, &PythonProcessor::processingFinished,
-                          this, [this, templatePath, connection](bool success, const QString& resultPath) {
-                              // 断开连接，避免重复触发
-                              disconnect(*connection);
-
-                              if (success) {
-                                  qDebug() << "模板拟合成功:" << templatePath;
-                              } else {
-                                  qDebug() << "模板拟合失败:" << templatePath;
-                              }
-
-                              // 移动到下一个模板
-                              m_currentTemplateIndex++;
-
-                              // 延迟处理下一个模板，确保资源释放
-                              QTimer::singleShot(1000, this, [this] {
-                                  processNextMultiTemplate();
-                              });
-                          });
-
-    // 启动Python拟合处理（调用现有第三按钮的逻辑）
-    QFileInfo fi(templatePath);
-    QString baseName = fi.baseName();
-    static QRegularExpression nidRegex("^多\\d+"); // 匹配多设备编号
-    QRegularExpressionMatch match = nidRegex.match(baseName);
-
-    if (match.hasMatch()) {
-        QString nid = match.captured(0);
-        m_pythonProcessor->startMultiProcessing(templatePath, nid);
-    } else {
-        // 处理可能的命名不规范情况
-        m_pythonProcessor->startMultiProcessing(templatePath, "多未知");
-    }
+    qDebug() << "待处理多头模板数量:" << m_integratedTemplatePaths.size();
+    startFittingJobs(QStringList::fromVector(m_integratedTemplatePaths), true, 60);
 }
 
 void MainWindow::setupIRTCommTab()
@@ -2260,6 +2055,13 @@ void MainWindow::setupIRTCommTab()
         }
     }
 
+    // 【新增】附加台架的测温仪与主台架共用同一套串口线程
+    if (m_rigOrchestrator) {
+        for (const QString &port : m_rigOrchestrator->irPorts()) {
+            if (!portNames.contains(port)) portNames.append(port);
+        }
+    }
+
     if (portNames.isEmpty()) {
         qWarning() << "配置文件中未找到串口号！";
     } else {
@@ -2394,6 +2196,10 @@ void MainWindow::setupIRTCommTab()
         SerialPortThread *thread = new SerialPortThread(portNames[i], 9600, this);
         m_serialThreads.append(thread);
 
+        // 【新增】数据同时送入红外汇聚（内部加锁，直接在串口线程中调用）
+        connect(thread, &SerialPortThread::temperatureDataReceived,
+                m_irHub, &IrDataHub::ingest, Qt::DirectConnection);
+
         // 连接温度数据信号（保留LC列数据处理逻辑）
         connect(thread, &SerialPortThread::temperatureDataReceived,
                 this, [=](const QString& portName,
@@ -3241,72 +3047,14 @@ void MainWindow::updateIrChartFromTable() {
         return;
     }
 
-    // 2. 获取设备类型（表格第1列）
-    QTableWidgetItem* typeItem = m_tempTable->item(targetRow, 1);
-    QString deviceType = typeItem ? typeItem->text() : "未知";
-    bool isSingle = (deviceType == "单头");
-    qDebug() << "[MainWindow] 设备类型：" << deviceType << "，行：" << targetRow;
-
-    // 声明图表更新用的温度变量
+    // 2. 单头、多头都只用 TO1（第2列）和 TA1（第3列）刷新图表；标校用的平均值由 IrDataHub 计算
     float toTemp = NAN, taTemp = NAN;
+    if (auto toItem = m_tempTable->item(targetRow, 2))
+        toTemp = toItem->text().toFloat();
+    if (auto taItem = m_tempTable->item(targetRow, 3))
+        taTemp = taItem->text().toFloat();
 
-    // 3. 提取温度数据并缓存（单头/多头区分）
-    QMutexLocker locker(&m_irCacheMutex); // 加锁保证线程安全
-    if (isSingle) {
-        // 单头：提取TO1（第2列）、TA1（第3列）、LC1（第4列）
-        float to1 = NAN, ta1 = NAN, lc1 = NAN;
-        if (auto toItem = m_tempTable->item(targetRow, 2))
-            to1 = toItem->text().toFloat();
-        if (auto taItem = m_tempTable->item(targetRow, 3))
-            ta1 = taItem->text().toFloat();
-        if (auto lcItem = m_tempTable->item(targetRow, 4))  // 新增：提取LC1值
-            lc1 = lcItem->text().toFloat();
-
-        // 缓存最后60秒数据（1秒1条）- 改为存储包含LC1的复合结构
-        auto& cache = m_irSingleCache[m_currentIrComPort];
-        if (cache.size() >= 60) cache.removeFirst();
-        // 修复：使用复合结构存储<<TO1, TA1>, LC1>
-        cache.append(qMakePair(qMakePair(to1, ta1), lc1));
-        qDebug() << "[MainWindow] 单头缓存更新，当前条数：" << cache.size();
-
-        // 赋值图表用变量
-        toTemp = to1;
-        taTemp = ta1;
-    } else {
-        // 多头：提取TO1-3（第2/4/6列）、TA1-3（第3/5/7列）、LC1-3（第4/7/10列）
-        QVector<float> toList, taList, lcList;  // 新增：LC列表
-        int toCols[] = {2, 4, 6};   // TO1-3对应列索引
-        int taCols[] = {3, 5, 7};   // TA1-3对应列索引
-        int lcCols[] = {4, 7, 10};  // 新增：LC1-3对应列索引
-        for (int i = 0; i < 3; ++i) {
-            if (auto toItem = m_tempTable->item(targetRow, toCols[i]))
-                toList.append(toItem->text().toFloat());
-            else
-                toList.append(NAN);
-            if (auto taItem = m_tempTable->item(targetRow, taCols[i]))
-                taList.append(taItem->text().toFloat());
-            else
-                taList.append(NAN);
-            // 新增：提取LC值
-            if (auto lcItem = m_tempTable->item(targetRow, lcCols[i]))
-                lcList.append(lcItem->text().toFloat());
-            else
-                lcList.append(NAN);
-        }
-
-        // 缓存最后60秒数据 - 改为存储包含LC的复合结构
-        auto& cache = m_irMultiCache[m_currentIrComPort];
-        if (cache.size() >= 60) cache.removeFirst();
-        // 修复：使用复合结构存储<<TOs, TAs>, LCs>
-        cache.append(qMakePair(qMakePair(toList, taList), lcList));
-        qDebug() << "[MainWindow] 多头缓存更新，当前条数：" << cache.size();
-
-        // 仅使用TO1和TA1更新图表（满足需求）
-        toTemp = toList.size() > 0 ? toList[0] : NAN;
-        taTemp = taList.size() > 0 ? taList[0] : NAN;
-    }
-
-    // 4. 更新图表（仅当数据有效时）
+    // 3. 更新图表（仅当数据有效时）
     if (std::isfinite(toTemp) && std::isfinite(taTemp)) {
         qDebug() << "[MainWindow] 提取到有效温度数据 - TO:" << toTemp << "℃, TA:" << taTemp << "℃，更新图表";
         m_dualTempChart->updateIrData(QDateTime::currentDateTime(), toTemp, taTemp);
@@ -3317,117 +3065,6 @@ void MainWindow::updateIrChartFromTable() {
 
 
 
-CalibrationManager::InfraredData MainWindow::getIrAverage(const QString& comPort) {
-    CalibrationManager::InfraredData result;
-    QMutexLocker locker(&m_irCacheMutex);
-
-    // 1. 查找对应COM口的表格行（原有逻辑不变）
-    int targetRow = -1;
-    for (int row = 0; row < m_tempTable->rowCount(); ++row) {
-        QTableWidgetItem* portItem = m_tempTable->item(row, 0);
-        if (portItem && portItem->text() == comPort) {
-            targetRow = row;
-            break;
-        }
-    }
-    if (targetRow == -1) {
-        qWarning() << "[getIrAverage] 未找到COM口" << comPort << "对应的表格行";
-        result.type = "未知设备";
-        return result;
-    }
-
-    // 2. 获取设备类型（原有逻辑不变）
-    QTableWidgetItem* typeItem = m_tempTable->item(targetRow, 1);
-    result.type = typeItem ? typeItem->text().trimmed() : "未知类型";
-    bool isSingle = (result.type == "单头");
-    qDebug() << "[getIrAverage] 处理COM口" << comPort << "，设备类型：" << result.type;
-
-    // 3. 单头设备数据处理（补充LC1）
-    if (isSingle) {
-        // 提取TO1（2列）、TA1（3列）、LC1（4列）
-        float to1 = NAN, ta1 = NAN, lc1 = NAN;
-        if (auto toItem = m_tempTable->item(targetRow, 2)) to1 = toItem->text().toFloat();
-        if (auto taItem = m_tempTable->item(targetRow, 3)) ta1 = taItem->text().toFloat();
-        if (auto lcItem = m_tempTable->item(targetRow, 4)) lc1 = lcItem->text().toFloat(); // LC1列索引4
-
-        // 缓存最后60秒数据（补充LC）
-        auto& cache = m_irSingleCache[comPort];
-        if (cache.size() >= 60) cache.removeFirst();
-        cache.append(qMakePair(qMakePair(to1, ta1), lc1)); // 缓存结构：<<TO, TA>, LC>
-
-        // 计算平均值（补充LC）
-        float toSum = 0, taSum = 0, lcSum = 0;
-        int validCount = 0;
-        for (auto& data : cache) {
-            auto& toTa = data.first;
-            float lc = data.second;
-            if (std::isfinite(toTa.first) && std::isfinite(toTa.second) && std::isfinite(lc)) {
-                toSum += toTa.first;
-                taSum += toTa.second;
-                lcSum += lc;
-                validCount++;
-            }
-        }
-
-        if (validCount > 0) {
-            result.toAvgs.append(toSum / validCount);
-            result.taAvgs.append(taSum / validCount);
-            result.lcAvgs.append(lcSum / validCount); // 存入LC1平均值
-        } else {
-            result.toAvgs.append(NAN);
-            result.taAvgs.append(NAN);
-            result.lcAvgs.append(NAN);
-        }
-    }
-    // 4. 多头设备数据处理（补充LC1-LC3）
-    else {
-        // 提取TO1(2)/TO2(5)/TO3(8)、TA1(3)/TA2(6)/TA3(9)、LC1(4)/LC2(7)/LC3(10)
-        int toCols[] = {2, 5, 8};   // TO列索引
-        int taCols[] = {3, 6, 9};   // TA列索引
-        int lcCols[] = {4, 7, 10};  // LC列索引（新增）
-
-        QVector<float> toList, taList, lcList;
-        for (int i = 0; i < 3; ++i) {
-            if (auto toItem = m_tempTable->item(targetRow, toCols[i])) toList.append(toItem->text().toFloat());
-            else toList.append(NAN);
-            if (auto taItem = m_tempTable->item(targetRow, taCols[i])) taList.append(taItem->text().toFloat());
-            else taList.append(NAN);
-            if (auto lcItem = m_tempTable->item(targetRow, lcCols[i])) lcList.append(lcItem->text().toFloat()); // 提取LC
-            else lcList.append(NAN);
-        }
-
-        // 缓存最后60秒数据（补充LC）
-        auto& cache = m_irMultiCache[comPort];
-        if (cache.size() >= 60) cache.removeFirst();
-        cache.append(qMakePair(qMakePair(toList, taList), lcList)); // 缓存结构：<<TOs, TAs>, LCs>
-
-        // 计算平均值（补充LC）
-        QVector<float> toSums(3, 0), taSums(3, 0), lcSums(3, 0);
-        QVector<int> validCounts(3, 0);
-        for (auto& data : cache) {
-            auto& toTas = data.first;
-            auto& lcs = data.second;
-            for (int i = 0; i < 3; ++i) {
-                if (std::isfinite(toTas.first[i]) && std::isfinite(toTas.second[i]) && std::isfinite(lcs[i])) {
-                    toSums[i] += toTas.first[i];
-                    taSums[i] += toTas.second[i];
-                    lcSums[i] += lcs[i]; // 累加LC值
-                    validCounts[i]++;
-                }
-            }
-        }
-
-        // 填充平均值（补充LC）
-        for (int i = 0; i < 3; ++i) {
-            result.toAvgs.append(validCounts[i] > 0 ? toSums[i]/validCounts[i] : NAN);
-            result.taAvgs.append(validCounts[i] > 0 ? taSums[i]/validCounts[i] : NAN);
-            result.lcAvgs.append(validCounts[i] > 0 ? lcSums[i]/validCounts[i] : NAN); // 存入LC平均值
-        }
-    }
-
-    return result;
-}
-
 void MainWindow::setupServoControls()
 {
     // A. 填充串口下拉框
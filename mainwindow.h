@@ -23,6 +23,10 @@
 #include <QUrl>
 #include "dualtemperaturechart.h"
 #include "ServoMotorController.h"
+#include "irdatahub.h"
+#include "rigorchestrator.h"
+#include "modbusbusmanager.h"
+#include "jobqueue.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -40,9 +44,6 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-    // 获取指定COM口的红外平均数据
-    CalibrationManager::InfraredData getIrAverage(const QString& comPort);
-
 private slots:
     // 新增恒温恒湿箱相关槽函数
     void setupHumidityControls();          // 初始化湿度控制
@@ -84,6 +85,7 @@ private slots:
     void onHumiditySelectPathClicked();
 
     void onStartCalibrationClicked();
+    bool startPrimaryCalibration();
     void onPauseResumeClicked();      // 新增
     void onCancelClicked();           // 新增
     void onCalibrationStateChanged(CalibrationManager::State state); // 新增
@@ -107,7 +109,6 @@ private slots:
                                        const QString& sourceFilePath);
     void processAllTemplatesFitting();
     void processIntegratedTemplatesWithDialog(const QString& mergedFilePath);
-    void processNextTemplate();
 
     void onIntegratedMultiProcessClicked();
 
@@ -165,7 +166,6 @@ private:
                               const QString& sheetName,
                               const QVector<bool>& selections,
                               const QString& sourceFilePath);
-    QTimer* humidityTimer;
 
     QList<QPair<QDateTime, float>> temperatureHistory2;    // 恒温箱温度历史数据
     QList<QPair<QDateTime, float>> humidityHistory;       // 湿度历史数据
@@ -175,6 +175,10 @@ private:
     QString m_blackbodySavePath; // 黑体炉保存路径变量（新增）
 
     CalibrationManager *m_calibrationManager;
+
+    // 【新增】多台架：红外数据汇聚与台架调度（主台架仍由本窗口直接控制）
+    IrDataHub *m_irHub = nullptr;
+    RigOrchestrator *m_rigOrchestrator = nullptr;
     void setupCalibrationManager();
     void checkAutoSaveSettings();
     QProgressBar *calibrationProgressBar;
@@ -185,8 +189,10 @@ private:
 
     QString m_integratedMergedPath;
     QVector<QString> m_integratedTemplatePaths;
-    QStringList m_templateQueue;            // 模板处理队列（新增）
-    int m_currentTemplateIndex;             // 当前处理索引（新增）
+    // 【新增】离线处理任务队列；m_fittingJobs 为本次批量拟合提交的任务
+    JobQueue *m_jobQueue = nullptr;
+    QList<int> m_fittingJobs;
+    void startFittingJobs(const QStringList& templates, bool multiHead, int progressBase);
 
     QString m_mergedFilePath; // 保存合并后的文件路径
     QStringList m_templateFiles; // 保存生成的模板文件路径列表
@@ -196,7 +202,6 @@ private:
     // 新增私有函数声明
     void processIntegratedMergedFileWithDialog(const QString& mergedFilePath);
     void processAllMultiTemplatesFitting();
-    void processNextMultiTemplate();
 
 
     // 添加IRTCommTab相关成员
@@ -240,10 +245,6 @@ private:
     QString m_currentIrComPort; // 当前正在测量的红外COM口
     QTableWidget *m_tempTable; // 指向IRTCommTab第一标签的表格
 
-    // 在MainWindow的private成员中修改缓存定义
-    QMap<QString, QVector<QPair<QPair<float, float>, float>>> m_irSingleCache; // 单头：<<TO1, TA1>, LC1>
-    QMap<QString, QVector<QPair<QPair<QVector<float>, QVector<float>>, QVector<float>>>> m_irMultiCache; // 多头：<<TOs, TAs>, LCs>
-    QMutex m_irCacheMutex; // 缓存锁（线程安全）
 
     // 【新增】辅助函数：解析温度字符串
     QVector<float> parseTemperatureString(const QString &text);
@@ -0,0 +1,163 @@
+#include "modbusbusmanager.h"
+#include <QModbusRtuSerialMaster>
+#include <QModbusTcpClient>
+#include <QUrl>
+#include <QSerialPort>
+#include <QVariant>
+#include <QDebug>
+#include "modbustransactionscheduler.h"
+
+// ===================== ModbusBus =====================
+ModbusBus::ModbusBus(const QString &portName, QObject *parent)
+    : QObject(parent), m_portName(portName)
+{
+    // "tcp://host:port" 走 Modbus TCP（如本机的 modbussim 模拟器），其余按串口处理
+    if (isTcpEndpoint(portName)) {
+        m_client = new QModbusTcpClient(this);
+    } else {
+        m_client = new QModbusRtuSerialMaster(this);
+    }
+    // RTU 总线半双工，同一时刻只允许一个在途请求；TCP 也保持 1 个，与实机时序一致
+    m_scheduler = new ModbusTransactionScheduler(m_client, this);
+    m_scheduler->setMaxInFlight(1);
+
+    connect(m_client, &QModbusClient::stateChanged, this, [this](QModbusDevice::State state) {
+        if (state == QModbusDevice::ConnectedState) {
+            emit connectionStatusChanged(true);
+        } else if (state == QModbusDevice::UnconnectedState) {
+            emit connectionStatusChanged(false);
+        }
+    });
+    connect(m_client, &QModbusDevice::errorOccurred, this, [this](QModbusDevice::Error error) {
+        if (error == QModbusDevice::ConnectionError) {
+            qWarning() << "总线" << m_portName << "连接错误：" << m_client->errorString();
+            emit connectionStatusChanged(false);
+        }
+    });
+}
+
+bool ModbusBus::isTcpEndpoint(const QString &portName)
+{
+    return portName.startsWith("tcp://", Qt::CaseInsensitive);
+}
+
+bool ModbusBus::isConnected() const
+{
+    return m_client->state() == QModbusDevice::ConnectedState;
+}
+
+QString ModbusBus::errorString() const
+{
+    return m_client->errorString();
+}
+
+// ===================== ModbusBusManager =====================
+ModbusBusManager::ModbusBusManager(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ModbusBusManager::~ModbusBusManager()
+{
+    for (ModbusBus *bus : qAsConst(m_buses)) {
+        if (bus->isConnected()) bus->client()->disconnectDevice();
+    }
+}
+
+ModbusBusManager *ModbusBusManager::instance()
+{
+    static ModbusBusManager *manager = new ModbusBusManager;
+    return manager;
+}
+
+void ModbusBusManager::loadSettings(QSettings &settings)
+{
+    m_serialSettings.baudRate = settings.value("modbus/baud_rate", 9600).toInt();
+    m_serialSettings.interFrameDelayUs = settings.value("modbus/inter_frame_delay_us", 0).toInt();
+    m_serialSettings.frameGapMs = settings.value("modbus/frame_gap_ms", 5).toInt();
+    m_serialSettings.timeoutMs = settings.value("modbus/timeout_ms", 1000).toInt();
+    m_serialSettings.retries = settings.value("modbus/retries", 2).toInt();
+}
+
+int ModbusBusManager::defaultInterFrameDelayUs(int baudRate)
+{
+    if (baudRate <= 0 || baudRate > 19200) return 1750;
+    // 1 个字符 = 11 位（起始 + 8 数据 + 校验/停止 + 停止）
+    return int(3.5 * 11 * 1000000.0 / baudRate + 0.5);
+}
+
+ModbusBus *ModbusBusManager::acquire(const QString &portName, QString *error)
+{
+    const QString key = portName.trimmed().toUpper();
+    if (key.isEmpty()) {
+        if (error) *error = "端口名为空";
+        return nullptr;
+    }
+
+    ModbusBus *bus = m_buses.value(key, nullptr);
+    if (!bus) {
+        bus = new ModbusBus(portName.trimmed(), this);
+        m_buses.insert(key, bus);
+    }
+
+    if (bus->client()->state() == QModbusDevice::UnconnectedState && !openBus(bus, error)) {
+        if (bus->m_refCount == 0) {
+            m_buses.remove(key);
+            bus->deleteLater();
+        }
+        return nullptr;
+    }
+
+    ++bus->m_refCount;
+    qDebug() << "总线" << bus->portName() << "挂接设备数：" << bus->m_refCount;
+    return bus;
+}
+
+void ModbusBusManager::release(ModbusBus *bus)
+{
+    if (!bus || bus->m_refCount <= 0) return;
+    if (--bus->m_refCount > 0) return;
+
+    // 最后一个设备离开：丢弃排队请求并关闭端口
+    bus->scheduler()->clear();
+    if (bus->isConnected()) bus->client()->disconnectDevice();
+    m_buses.remove(bus->portName().toUpper());
+    bus->deleteLater();
+    qDebug() << "已关闭总线:" << bus->portName();
+}
+
+bool ModbusBusManager::openBus(ModbusBus *bus, QString *error)
+{
+    QModbusClient *client = bus->client();
+    if (ModbusBus::isTcpEndpoint(bus->portName())) {
+        QUrl url(bus->portName());
+        client->setConnectionParameter(QModbusDevice::NetworkAddressParameter, url.host());
+        client->setConnectionParameter(QModbusDevice::NetworkPortParameter, url.port(502));
+    } else {
+        client->setConnectionParameter(QModbusDevice::SerialPortNameParameter, bus->portName());
+        client->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, QVariant(m_serialSettings.baudRate));
+        client->setConnectionParameter(QModbusDevice::SerialDataBitsParameter, QVariant(8));
+        client->setConnectionParameter(QModbusDevice::SerialParityParameter, QVariant(QSerialPort::NoParity));
+        client->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, QVariant(QSerialPort::OneStop));
+    }
+
+    if (auto *rtu = qobject_cast<QModbusRtuSerialMaster *>(client)) {
+        int delayUs = m_serialSettings.interFrameDelayUs > 0
+                          ? m_serialSettings.interFrameDelayUs
+                          : defaultInterFrameDelayUs(m_serialSettings.baudRate);
+        rtu->setInterFrameDelay(delayUs);
+    }
+    bus->scheduler()->setMinimumFrameGap(m_serialSettings.frameGapMs);
+
+    // 重试交给调度器，主站只发一次，否则重试次数和往返时间都统计不到
+    client->setTimeout(m_serialSettings.timeoutMs);
+    client->setNumberOfRetries(0);
+    bus->scheduler()->setRetryCount(m_serialSettings.retries);
+
+    if (!client->connectDevice()) {
+        if (error) *error = client->errorString();
+        qWarning() << "总线" << bus->portName() << "打开失败：" << client->errorString();
+        return false;
+    }
+    return true;
+}
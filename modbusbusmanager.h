@@ -0,0 +1,86 @@
+#ifndef MODBUSBUSMANAGER_H
+#define MODBUSBUSMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSettings>
+#include <QModbusClient>
+
+class ModbusTransactionScheduler;
+
+// 一条物理总线（一个 COM 口，或 tcp://host:port 形式的 Modbus TCP 端点）：一个 RTU 主站 + 一个事务调度器，
+// 挂在这条线上的所有从站（黑体炉、恒温箱……）共用，请求在调度器里排队，不会在线上相互冲突
+class ModbusBus : public QObject
+{
+    Q_OBJECT
+public:
+    QString portName() const { return m_portName; }
+    QModbusClient *client() const { return m_client; }
+    ModbusTransactionScheduler *scheduler() const { return m_scheduler; }
+    bool isConnected() const;
+    int clientCount() const { return m_refCount; }
+    QString errorString() const;
+
+    static bool isTcpEndpoint(const QString &portName);
+
+signals:
+    void connectionStatusChanged(bool connected);
+
+private:
+    friend class ModbusBusManager;
+    ModbusBus(const QString &portName, QObject *parent);
+
+    QString m_portName;
+    QModbusClient *m_client = nullptr;
+    ModbusTransactionScheduler *m_scheduler = nullptr;
+    int m_refCount = 0;
+};
+
+// 总线管理：按 COM 口创建并共享 ModbusBus，设备通过 acquire/release 挂接。
+// 配置（config.ini）：
+// [modbus]
+// baud_rate=9600
+// inter_frame_delay_us=0   ; RTU 帧间静默时间，0 表示按波特率取 3.5 个字符时间
+// frame_gap_ms=5           ; 一帧应答结束到下一帧发出的最小间隔，多从站共线时给从站留出收发切换时间
+// timeout_ms=1000          ; 单帧应答超时
+// retries=2                ; 超时/帧错误后的重试次数（由调度器执行并计入统计）
+class ModbusBusManager : public QObject
+{
+    Q_OBJECT
+public:
+    struct SerialSettings {
+        int baudRate = 9600;
+        int interFrameDelayUs = 0;
+        int frameGapMs = 5;
+        int timeoutMs = 1000;
+        int retries = 2;
+    };
+
+    explicit ModbusBusManager(QObject *parent = nullptr);
+    ~ModbusBusManager();
+
+    // 进程内共用的总线管理器
+    static ModbusBusManager *instance();
+
+    void loadSettings(QSettings &settings);
+    void setSerialSettings(const SerialSettings &settings) { m_serialSettings = settings; }
+    SerialSettings serialSettings() const { return m_serialSettings; }
+
+    // 取得端口对应的总线，首次使用时打开端口；失败返回 nullptr
+    ModbusBus *acquire(const QString &portName, QString *error = nullptr);
+    // 最后一个设备释放后关闭端口
+    void release(ModbusBus *bus);
+
+    QList<ModbusBus *> buses() const { return m_buses.values(); }
+
+    // 按波特率计算 3.5 个字符的帧间静默时间（微秒），19200 以上固定 1750
+    static int defaultInterFrameDelayUs(int baudRate);
+
+private:
+    bool openBus(ModbusBus *bus, QString *error);
+
+    SerialSettings m_serialSettings;
+    QHash<QString, ModbusBus *> m_buses;
+};
+
+#endif // MODBUSBUSMANAGER_H
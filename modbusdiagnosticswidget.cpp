@@ -0,0 +1,95 @@
+#include "modbusdiagnosticswidget.h"
+#include <QVBoxLayout>
+#include <QHeaderView>
+
+ModbusDiagnosticsWidget::ModbusDiagnosticsWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(10, 10, 10, 10);
+
+    m_table = new QTableWidget(this);
+    m_table->setColumnCount(12);
+    m_table->setHorizontalHeaderLabels({"设备", "总线/从站", "请求", "成功率", "平均RTT(ms)", "P95(ms)",
+                                        "最大(ms)", "超时", "帧错误", "异常应答", "重试", "数值时效"});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &ModbusDiagnosticsWidget::refreshAll);
+    m_refreshTimer->start();
+}
+
+void ModbusDiagnosticsWidget::addDevice(const QString &name, BlackbodyController *controller)
+{
+    Entry entry;
+    entry.name = name;
+    entry.device = controller;
+    entry.stats = [controller]() { return controller->linkStats(); };
+    entry.bus = [controller]() { return controller->busDescription(); };
+    entry.freshness = [controller]() { return "温度 " + formatValueAge(controller->temperatureAgeMs()); };
+    m_entries.append(entry);
+    refreshAll();
+}
+
+void ModbusDiagnosticsWidget::addDevice(const QString &name, HumidityController *controller)
+{
+    Entry entry;
+    entry.name = name;
+    entry.device = controller;
+    entry.stats = [controller]() { return controller->linkStats(); };
+    entry.bus = [controller]() { return controller->busDescription(); };
+    entry.freshness = [controller]() {
+        return QString("温度 %1，湿度 %2").arg(formatValueAge(controller->temperatureAgeMs()),
+                                             formatValueAge(controller->humidityAgeMs()));
+    };
+    m_entries.append(entry);
+    refreshAll();
+}
+
+void ModbusDiagnosticsWidget::refreshAll()
+{
+    if (m_table->rowCount() != m_entries.size()) m_table->setRowCount(m_entries.size());
+
+    for (int row = 0; row < m_entries.size(); ++row) {
+        const Entry &entry = m_entries[row];
+        QStringList cells;
+        QString tip;
+        if (!entry.device) {
+            cells << entry.name << "已移除";
+        } else {
+            const ModbusLinkStats stats = entry.stats();
+            cells << entry.name
+                  << entry.bus()
+                  << QString::number(stats.requests)
+                  << (stats.requests > 0 ? QString("%1%").arg(stats.successRate() * 100.0, 0, 'f', 1) : QString("-"))
+                  << (stats.successes > 0 ? QString::number(stats.meanRttMs(), 'f', 1) : QString("-"))
+                  << (stats.successes > 0 ? QString::number(stats.percentileMs(0.95)) : QString("-"))
+                  << (stats.successes > 0 ? QString::number(stats.rttMaxMs) : QString("-"))
+                  << QString::number(stats.timeouts)
+                  << QString::number(stats.frameErrors)
+                  << QString::number(stats.exceptions)
+                  << QString::number(stats.retries)
+                  << entry.freshness();
+            // 悬停显示 RTT 分布和最近一次错误
+            tip = "RTT 分布：" + stats.histogramText();
+            if (!stats.lastError.isEmpty()) tip += "\n最近错误：" + stats.lastError;
+        }
+
+        for (int col = 0; col < m_table->columnCount(); ++col) {
+            QTableWidgetItem *item = m_table->item(row, col);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(row, col, item);
+            }
+            item->setText(col < cells.size() ? cells[col] : QString());
+            item->setToolTip(tip);
+        }
+    }
+}
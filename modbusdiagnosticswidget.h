@@ -0,0 +1,40 @@
+#ifndef MODBUSDIAGNOSTICSWIDGET_H
+#define MODBUSDIAGNOSTICSWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QTimer>
+#include <QPointer>
+#include <functional>
+#include "BlackbodyController.h"
+#include "HumidityController.h"
+
+// 通信诊断：每行一个 Modbus 从站，显示往返时间分布、超时/帧错误/重试次数和缓存值时效，
+// 用于判断稳定判断变慢是仪表本身还是总线造成的
+class ModbusDiagnosticsWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ModbusDiagnosticsWidget(QWidget *parent = nullptr);
+
+    void addDevice(const QString &name, BlackbodyController *controller);
+    void addDevice(const QString &name, HumidityController *controller);
+
+private slots:
+    void refreshAll();
+
+private:
+    struct Entry {
+        QString name;
+        QPointer<QObject> device;
+        std::function<ModbusLinkStats()> stats;
+        std::function<QString()> bus;
+        std::function<QString()> freshness;
+    };
+
+    QVector<Entry> m_entries;
+    QTableWidget *m_table;
+    QTimer *m_refreshTimer; // 每秒刷新
+};
+
+#endif // MODBUSDIAGNOSTICSWIDGET_H
@@ -0,0 +1,94 @@
+#include "modbuslinkstats.h"
+#include <QStringList>
+
+const int ModbusLinkStats::kBucketUpperMs[ModbusLinkStats::kBucketCount - 1] = {10, 20, 50, 100, 200, 500, 1000};
+
+void ModbusLinkStats::recordSuccess(int rttMs)
+{
+    ++successes;
+    rttSumMs += rttMs;
+    if (rttMinMs < 0 || rttMs < rttMinMs) rttMinMs = rttMs;
+    if (rttMs > rttMaxMs) rttMaxMs = rttMs;
+
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && rttMs > kBucketUpperMs[bucket]) ++bucket;
+    ++histogram[bucket];
+    lastSuccess = QDateTime::currentDateTime();
+}
+
+void ModbusLinkStats::recordFailure(QModbusDevice::Error error, bool isException, const QString &errorText)
+{
+    switch (error) {
+    case QModbusDevice::TimeoutError:
+        ++timeouts;
+        break;
+    case QModbusDevice::ProtocolError:
+        if (isException) ++exceptions;
+        else ++frameErrors;
+        break;
+    default:
+        ++otherErrors;
+        break;
+    }
+    lastError = errorText;
+}
+
+double ModbusLinkStats::meanRttMs() const
+{
+    return successes > 0 ? rttSumMs / successes : 0.0;
+}
+
+int ModbusLinkStats::percentileMs(double p) const
+{
+    if (successes == 0) return -1;
+    quint64 target = quint64(p * successes + 0.5);
+    if (target == 0) target = 1;
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += histogram[i];
+        if (seen >= target) {
+            return (i < kBucketCount - 1) ? kBucketUpperMs[i] : rttMaxMs;
+        }
+    }
+    return rttMaxMs;
+}
+
+double ModbusLinkStats::successRate() const
+{
+    return requests > 0 ? double(successes) / requests : 0.0;
+}
+
+QString ModbusLinkStats::bucketLabel(int bucket)
+{
+    if (bucket < kBucketCount - 1) return QString("≤%1").arg(kBucketUpperMs[bucket]);
+    return QString(">%1").arg(kBucketUpperMs[kBucketCount - 2]);
+}
+
+QString ModbusLinkStats::histogramText() const
+{
+    QStringList parts;
+    for (int i = 0; i < kBucketCount; ++i) {
+        if (histogram[i] > 0) parts.append(QString("%1:%2").arg(bucketLabel(i)).arg(histogram[i]));
+    }
+    return parts.isEmpty() ? QString("-") : parts.join(' ');
+}
+
+QString ModbusLinkStats::summary() const
+{
+    return QString("请求 %1，成功率 %2%，平均 %3 ms，P95 %4 ms，超时 %5，帧错误 %6，异常应答 %7，重试 %8")
+        .arg(requests)
+        .arg(successRate() * 100.0, 0, 'f', 1)
+        .arg(meanRttMs(), 0, 'f', 1)
+        .arg(percentileMs(0.95))
+        .arg(timeouts)
+        .arg(frameErrors)
+        .arg(exceptions)
+        .arg(retries);
+}
+
+QString formatValueAge(qint64 ageMs)
+{
+    if (ageMs < 0) return "未更新";
+    if (ageMs < 10000) return QString("%1 s").arg(ageMs / 1000.0, 0, 'f', 1);
+    return QString("%1 s").arg(ageMs / 1000);
+}
@@ -0,0 +1,49 @@
+#ifndef MODBUSLINKSTATS_H
+#define MODBUSLINKSTATS_H
+
+#include <QString>
+#include <QDateTime>
+#include <QModbusDevice>
+
+// 单个从站的通信统计：往返时间分布与各类错误计数，用于区分“仪表慢”还是“总线慢”。
+// 说明：Qt 的 RTU 主站会直接丢弃 CRC 校验失败的应答帧，这类错误最终表现为超时；
+// frameErrors 只统计能识别出来的非法应答（长度、功能码不符等）
+struct ModbusLinkStats
+{
+    static const int kBucketCount = 8;
+    // 直方图各桶上限（毫秒），最后一桶为 >1000
+    static const int kBucketUpperMs[kBucketCount - 1];
+
+    quint64 requests = 0;      // 实际发出的帧数（含重试）
+    quint64 successes = 0;
+    quint64 timeouts = 0;
+    quint64 frameErrors = 0;   // CRC/帧格式错误
+    quint64 exceptions = 0;    // 从站返回的异常应答
+    quint64 otherErrors = 0;
+    quint64 retries = 0;
+    quint64 histogram[kBucketCount] = {};
+    double rttSumMs = 0.0;
+    int rttMinMs = -1;
+    int rttMaxMs = -1;
+    QDateTime lastSuccess;
+    QString lastError;
+
+    void recordSuccess(int rttMs);
+    void recordFailure(QModbusDevice::Error error, bool isException, const QString &errorText);
+
+    double meanRttMs() const;
+    // 按直方图估计的分位数（取所在桶的上限），无数据时为 -1
+    int percentileMs(double p) const;
+    double successRate() const;
+    // 直方图文本，例如 "≤20:12 ≤50:3 >1000:1"
+    QString histogramText() const;
+    // 一行摘要，写入运行日志
+    QString summary() const;
+
+    static QString bucketLabel(int bucket);
+};
+
+// 缓存值的时效文本：ageMs < 0 表示从未更新
+QString formatValueAge(qint64 ageMs);
+
+#endif // MODBUSLINKSTATS_H
@@ -0,0 +1,66 @@
+#include "fopdtmodel.h"
+#include <cmath>
+
+FopdtModel::Parameters FopdtModel::Parameters::fromSettings(QSettings &settings, const QString &group,
+                                                           const Parameters &defaults)
+{
+    Parameters p = defaults;
+    settings.beginGroup(group);
+    p.gain = settings.value("gain", p.gain).toDouble();
+    p.tauSec = settings.value("tau_sec", p.tauSec).toDouble();
+    p.deadTimeSec = settings.value("dead_time_sec", p.deadTimeSec).toDouble();
+    p.noiseSigma = settings.value("noise_sigma", p.noiseSigma).toDouble();
+    p.ambient = settings.value("ambient", p.ambient).toDouble();
+    p.initial = settings.value("initial", p.initial).toDouble();
+    settings.endGroup();
+    return p;
+}
+
+FopdtModel::FopdtModel(const Parameters &parameters, quint32 seed)
+    : m_parameters(parameters),
+      m_input(parameters.ambient),
+      m_value(parameters.initial),
+      m_measured(parameters.initial),
+      m_rng(seed),
+      m_noise(0.0, qMax(0.0, parameters.noiseSigma))
+{
+    m_history.append({0.0, m_input});
+}
+
+double FopdtModel::delayedInput() const
+{
+    const double t = m_time - m_parameters.deadTimeSec;
+    // 历史按时间递增，取 t 时刻生效的输入
+    double value = m_history.first().input;
+    for (const Sample &s : m_history) {
+        if (s.time > t) break;
+        value = s.input;
+    }
+    return value;
+}
+
+void FopdtModel::step(double dtSec)
+{
+    if (dtSec <= 0.0) return;
+    m_time += dtSec;
+
+    if (m_history.last().input != m_input) {
+        m_history.append({m_time, m_input});
+    }
+    // 丢弃滞后窗口之外的历史，但保留窗口起点处生效的那一条
+    const double cutoff = m_time - m_parameters.deadTimeSec;
+    while (m_history.size() > 1 && m_history[1].time <= cutoff) {
+        m_history.removeFirst();
+    }
+
+    const Parameters &p = m_parameters;
+    const double target = p.ambient + p.gain * (delayedInput() - p.ambient);
+    const double alpha = (p.tauSec > 0.0) ? 1.0 - std::exp(-dtSec / p.tauSec) : 1.0;
+    m_value += (target - m_value) * alpha;
+
+    if (m_disturbance > 0.0) {
+        m_value += (p.ambient - m_value) * (1.0 - std::exp(-dtSec * m_disturbance));
+    }
+
+    m_measured = m_value + (p.noiseSigma > 0.0 ? m_noise(m_rng) : 0.0);
+}
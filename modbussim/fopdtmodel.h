@@ -0,0 +1,58 @@
+#ifndef FOPDTMODEL_H
+#define FOPDTMODEL_H
+
+#include <QSettings>
+#include <QVector>
+#include <random>
+
+// 一阶惯性加纯滞后（FOPDT）热模型：
+//   y' = (ambient + gain * (u(t - deadTime) - ambient) - y) / tau
+// 设备停止时输入 u 取环境温度；读数叠加高斯噪声，噪声不进入模型状态
+class FopdtModel
+{
+public:
+    struct Parameters {
+        double gain = 1.0;          // 稳态增益（1 表示最终到达设定值）
+        double tauSec = 300.0;      // 时间常数（秒）
+        double deadTimeSec = 20.0;  // 纯滞后（秒）
+        double noiseSigma = 0.02;   // 读数噪声标准差（℃）
+        double ambient = 25.0;      // 环境温度
+        double initial = 25.0;      // 初始温度
+
+        // 从 settings 的 group 节读取，缺省项保留默认值
+        static Parameters fromSettings(QSettings &settings, const QString &group, const Parameters &defaults);
+    };
+
+    explicit FopdtModel(const Parameters &parameters = Parameters(), quint32 seed = 1);
+
+    void setInput(double input) { m_input = input; }
+    double input() const { return m_input; }
+    // 附加扰动：开窗时箱内温度额外向环境温度靠拢，rate 为每秒靠拢的比例
+    void setDisturbance(double rate) { m_disturbance = rate; }
+
+    void step(double dtSec);
+
+    double value() const { return m_value; }
+    double measured() const { return m_measured; }
+    const Parameters &parameters() const { return m_parameters; }
+
+private:
+    struct Sample {
+        double time;
+        double input;
+    };
+
+    double delayedInput() const;
+
+    Parameters m_parameters;
+    double m_time = 0.0;
+    double m_input;
+    double m_value;
+    double m_measured;
+    double m_disturbance = 0.0;
+    QVector<Sample> m_history;   // 输入历史，用于实现纯滞后
+    std::mt19937 m_rng;
+    std::normal_distribution<double> m_noise;
+};
+
+#endif // FOPDTMODEL_H
@@ -0,0 +1,88 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSettings>
+#include <QTimer>
+#include <QDebug>
+#include "simulatedmodbusdevice.h"
+
+// 用法：
+//   modbussim --config modbussim.ini
+//   modbussim --blackbody tcp://127.0.0.1:1502 --chamber tcp://127.0.0.1:1503 --time-scale 10
+// 主程序 config.ini 中把 blackbody/com_port、humidity/com_port 设为相同的端点即可闭环。
+// 串口方式可用 socat 创建一对伪终端：socat -d -d pty,raw,echo=0 pty,raw,echo=0，
+// 一端给模拟器，另一端给主程序。Qt 的 RTU 从站只应答一个地址，两台设备需各用一对伪终端
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("modbussim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("黑体炉/恒温箱 Modbus 从站模拟器");
+    parser.addHelpOption();
+    QCommandLineOption configOption("config", "配置文件（默认 modbussim.ini）", "file", "modbussim.ini");
+    QCommandLineOption blackbodyOption("blackbody", "黑体炉端点，tcp://host:port 或串口名", "endpoint");
+    QCommandLineOption chamberOption("chamber", "恒温箱端点，tcp://host:port 或串口名", "endpoint");
+    QCommandLineOption scaleOption("time-scale", "模型时间倍率", "factor");
+    QCommandLineOption seedOption("seed", "噪声随机种子", "seed");
+    parser.addOptions({configOption, blackbodyOption, chamberOption, scaleOption, seedOption});
+    parser.process(app);
+
+    QSettings settings(parser.value(configOption), QSettings::IniFormat);
+
+    const QString blackbodyEndpoint = parser.isSet(blackbodyOption)
+        ? parser.value(blackbodyOption)
+        : settings.value("server/blackbody_endpoint", "tcp://127.0.0.1:1502").toString();
+    const QString chamberEndpoint = parser.isSet(chamberOption)
+        ? parser.value(chamberOption)
+        : settings.value("server/chamber_endpoint", "tcp://127.0.0.1:1503").toString();
+    const double timeScale = parser.isSet(scaleOption)
+        ? parser.value(scaleOption).toDouble()
+        : settings.value("server/time_scale", 1.0).toDouble();
+    const quint32 seed = parser.isSet(seedOption)
+        ? parser.value(seedOption).toUInt()
+        : settings.value("server/seed", 1).toUInt();
+    const int baudRate = settings.value("server/baud_rate", 9600).toInt();
+
+    if (!blackbodyEndpoint.startsWith("tcp://", Qt::CaseInsensitive)
+        && blackbodyEndpoint.compare(chamberEndpoint, Qt::CaseInsensitive) == 0) {
+        qCritical() << "RTU 方式下黑体炉和恒温箱需使用不同的串口";
+        return 1;
+    }
+
+    // 黑体炉升降温快、滞后小；恒温箱慢、滞后大
+    FopdtModel::Parameters blackbodyDefaults;
+    blackbodyDefaults.tauSec = 180.0;
+    blackbodyDefaults.deadTimeSec = 10.0;
+    blackbodyDefaults.noiseSigma = 0.01;
+    FopdtModel::Parameters chamberDefaults;
+    chamberDefaults.tauSec = 600.0;
+    chamberDefaults.deadTimeSec = 45.0;
+    chamberDefaults.noiseSigma = 0.03;
+
+    SimulatedModbusDevice blackbody(SimulatedModbusDevice::Blackbody,
+                                    FopdtModel::Parameters::fromSettings(settings, "blackbody", blackbodyDefaults),
+                                    seed);
+    SimulatedModbusDevice chamber(SimulatedModbusDevice::Chamber,
+                                  FopdtModel::Parameters::fromSettings(settings, "chamber", chamberDefaults),
+                                  seed + 1);
+    blackbody.setTimeScale(timeScale);
+    chamber.setTimeScale(timeScale);
+    chamber.setWindowLossPerSec(settings.value("chamber/window_loss_per_sec", 0.002).toDouble());
+
+    QString error;
+    if (!blackbody.listen(blackbodyEndpoint, settings.value("blackbody/slave_address", 0x02).toInt(), baudRate, &error)
+        || !chamber.listen(chamberEndpoint, settings.value("chamber/slave_address", 0x03).toInt(), baudRate, &error)) {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+    // 定期输出状态，便于浸泡测试时观察
+    QTimer statusTimer;
+    QObject::connect(&statusTimer, &QTimer::timeout, [&]() {
+        qInfo().noquote() << blackbody.statusLine();
+        qInfo().noquote() << chamber.statusLine();
+    });
+    statusTimer.start(settings.value("server/status_interval_sec", 10).toInt() * 1000);
+
+    return app.exec();
+}
@@ -0,0 +1,20 @@
+# 黑体炉/恒温箱 Modbus 从站模拟器（独立程序，不依赖主工程）
+# 在一台 Linux 机器上与主程序闭环运行，用于吞吐量和长时间浸泡测试
+QT = core serialport serialbus network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = modbussim
+
+SOURCES += \
+    fopdtmodel.cpp \
+    main.cpp \
+    simulatedmodbusdevice.cpp
+
+HEADERS += \
+    fopdtmodel.h \
+    simulatedmodbusdevice.h
+
+DISTFILES += \
+    modbussim.ini
@@ -0,0 +1,162 @@
+#include "simulatedmodbusdevice.h"
+#include <QModbusRtuSerialSlave>
+#include <QModbusTcpServer>
+#include <QSerialPort>
+#include <QUrl>
+#include <QVariant>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+const int kStepMs = 100;               // 模型步长
+const quint16 kRegisterCount = 0x40;   // 两种设备都只用到 0x001A 以内的寄存器
+const double kSensorBias = 0.05;       // 切换传感器后每个传感器的读数偏置（℃）
+}
+
+SimulatedModbusDevice::SimulatedModbusDevice(Kind kind, const FopdtModel::Parameters &parameters,
+                                             quint32 seed, QObject *parent)
+    : QObject(parent), m_kind(kind), m_model(parameters, seed)
+{
+    m_setpoint = float(parameters.ambient);
+    m_stepTimer.setInterval(kStepMs);
+    connect(&m_stepTimer, &QTimer::timeout, this, &SimulatedModbusDevice::onStep);
+}
+
+QString SimulatedModbusDevice::name() const
+{
+    return m_kind == Blackbody ? "黑体炉" : "恒温箱";
+}
+
+bool SimulatedModbusDevice::listen(const QString &endpoint, int slaveAddress, int baudRate, QString *error)
+{
+    m_endpoint = endpoint;
+    if (endpoint.startsWith("tcp://", Qt::CaseInsensitive)) {
+        QUrl url(endpoint);
+        m_server = new QModbusTcpServer(this);
+        m_server->setConnectionParameter(QModbusDevice::NetworkAddressParameter, url.host());
+        m_server->setConnectionParameter(QModbusDevice::NetworkPortParameter, url.port(502));
+    } else {
+        m_server = new QModbusRtuSerialSlave(this);
+        m_server->setConnectionParameter(QModbusDevice::SerialPortNameParameter, endpoint);
+        m_server->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, QVariant(baudRate));
+        m_server->setConnectionParameter(QModbusDevice::SerialDataBitsParameter, QVariant(8));
+        m_server->setConnectionParameter(QModbusDevice::SerialParityParameter, QVariant(QSerialPort::NoParity));
+        m_server->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, QVariant(QSerialPort::OneStop));
+    }
+    m_server->setServerAddress(slaveAddress);
+
+    QModbusDataUnitMap map;
+    map.insert(QModbusDataUnit::HoldingRegisters, QModbusDataUnit(QModbusDataUnit::HoldingRegisters, 0, kRegisterCount));
+    m_server->setMap(map);
+
+    // 先写入初值，再关联写入信号（setData 也会触发 dataWritten）
+    writeFloat(0x000A, m_setpoint);
+    onStep();
+    connect(m_server, &QModbusServer::dataWritten, this, &SimulatedModbusDevice::onDataWritten);
+
+    if (!m_server->connectDevice()) {
+        if (error) *error = QString("%1 监听 %2 失败：%3").arg(name(), endpoint, m_server->errorString());
+        return false;
+    }
+
+    m_sinceStep.start();
+    m_stepTimer.start();
+    qInfo().noquote() << QString("%1 已就绪：%2，从站地址 %3").arg(name(), endpoint).arg(slaveAddress);
+    return true;
+}
+
+quint16 SimulatedModbusDevice::readRegister(quint16 address) const
+{
+    quint16 value = 0;
+    m_server->data(QModbusDataUnit::HoldingRegisters, address, &value);
+    return value;
+}
+
+float SimulatedModbusDevice::readFloat(quint16 address) const
+{
+    quint32 raw = (quint32(readRegister(address)) << 16) | readRegister(address + 1);
+    float value;
+    std::memcpy(&value, &raw, sizeof(float));
+    return value;
+}
+
+void SimulatedModbusDevice::writeFloat(quint16 address, float value)
+{
+    quint32 raw;
+    std::memcpy(&raw, &value, sizeof(quint32));
+    m_server->setData(QModbusDataUnit::HoldingRegisters, address, quint16(raw >> 16));
+    m_server->setData(QModbusDataUnit::HoldingRegisters, address + 1, quint16(raw & 0xFFFF));
+}
+
+void SimulatedModbusDevice::onDataWritten(QModbusDataUnit::RegisterType table, int address, int size)
+{
+    if (table != QModbusDataUnit::HoldingRegisters) return;
+
+    // 只处理主站写入的控制寄存器，读数寄存器由模型自己刷新
+    for (int reg = address; reg < address + size; ++reg) {
+        switch (reg) {
+        case 0x0000:
+            qInfo().noquote() << name() << (readRegister(0x0000) ? "上位机控制已获取" : "上位机控制已释放");
+            break;
+        case 0x0001:
+            m_running = readRegister(0x0001) != 0;
+            qInfo().noquote() << name() << (m_running ? "启动" : "停止");
+            break;
+        case 0x000B:
+            m_setpoint = readFloat(0x000A);
+            qInfo().noquote() << name() << "设定值" << m_setpoint;
+            break;
+        case 0x0018:
+            if (m_kind == Chamber) {
+                quint16 cmd = readRegister(0x0018);
+                if (cmd == 0x01) ++m_sensorIndex;
+                else if (cmd == 0x02) --m_sensorIndex;
+                qInfo().noquote() << name() << "切换传感器，当前序号" << m_sensorIndex;
+            }
+            break;
+        case 0x001A:
+            if (m_kind == Chamber) {
+                m_windowOpen = readRegister(0x001A) != 0;
+                qInfo().noquote() << name() << (m_windowOpen ? "打开标定窗口" : "关闭标定窗口");
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    ++m_writes;
+    updateModelInput();
+}
+
+void SimulatedModbusDevice::updateModelInput()
+{
+    m_model.setInput(m_running ? m_setpoint : m_model.parameters().ambient);
+    m_model.setDisturbance(m_windowOpen ? m_windowLossPerSec : 0.0);
+}
+
+void SimulatedModbusDevice::onStep()
+{
+    double dt = m_sinceStep.isValid() ? m_sinceStep.restart() / 1000.0 : 0.0;
+    m_model.step(dt * m_timeScale);
+
+    // 写读数寄存器时暂不响应 dataWritten
+    const bool blocked = m_server->blockSignals(true);
+    if (m_kind == Blackbody) {
+        writeFloat(0x000C, float(m_model.measured()));
+    } else {
+        writeFloat(0x0010, float(m_model.measured() + m_sensorIndex * kSensorBias));
+        // 湿度不建模，固定 40%RH 附近，借用温度噪声做少量波动
+        writeFloat(0x0014, float(40.0 + (m_model.measured() - m_model.value()) * 5.0));
+    }
+    m_server->blockSignals(blocked);
+}
+
+QString SimulatedModbusDevice::statusLine() const
+{
+    return QString("%1 [%2] %3 设定 %4℃ 当前 %5℃%6，写入 %7 次")
+        .arg(name(), m_endpoint, m_running ? "运行" : "停止")
+        .arg(double(m_setpoint), 0, 'f', 2)
+        .arg(m_model.value(), 0, 'f', 2)
+        .arg(m_windowOpen ? "，窗口开" : "")
+        .arg(m_writes);
+}
@@ -0,0 +1,64 @@
+#ifndef SIMULATEDMODBUSDEVICE_H
+#define SIMULATEDMODBUSDEVICE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QModbusServer>
+#include "fopdtmodel.h"
+
+// 一个 Modbus 从站：按主程序使用的寄存器表应答，数值来自 FOPDT 热模型。
+// 黑体炉：0x0000 控制权，0x0001 运行，0x000A-0x000B 设定值，0x000C-0x000D 当前温度
+// 恒温箱：0x0000 控制权，0x0001 运行，0x000A-0x000B 设定值，0x0010-0x0011 温度，
+//         0x0014-0x0015 湿度，0x0018 切换传感器，0x001A 标定窗口
+// 浮点数与主程序一致：IEEE754，高字在前
+class SimulatedModbusDevice : public QObject
+{
+    Q_OBJECT
+public:
+    enum Kind {
+        Blackbody,
+        Chamber
+    };
+
+    SimulatedModbusDevice(Kind kind, const FopdtModel::Parameters &parameters, quint32 seed,
+                          QObject *parent = nullptr);
+
+    // endpoint 为 "tcp://127.0.0.1:1502" 或串口/伪终端名（如 /dev/pts/3、COM20）
+    bool listen(const QString &endpoint, int slaveAddress, int baudRate, QString *error);
+
+    // 模型时间相对真实时间的倍率，>1 时热过程加快，便于缩短浸泡测试
+    void setTimeScale(double scale) { m_timeScale = qMax(0.01, scale); }
+    // 开窗时箱内温度每秒向环境温度靠拢的比例
+    void setWindowLossPerSec(double rate) { m_windowLossPerSec = rate; }
+
+    QString name() const;
+    QString statusLine() const;
+
+private slots:
+    void onDataWritten(QModbusDataUnit::RegisterType table, int address, int size);
+    void onStep();
+
+private:
+    float readFloat(quint16 address) const;
+    void writeFloat(quint16 address, float value);
+    quint16 readRegister(quint16 address) const;
+    void updateModelInput();
+
+    Kind m_kind;
+    FopdtModel m_model;
+    QModbusServer *m_server = nullptr;
+    QString m_endpoint;
+    QTimer m_stepTimer;
+    QElapsedTimer m_sinceStep;
+    double m_timeScale = 1.0;
+    double m_windowLossPerSec = 0.002;
+
+    bool m_running = false;
+    float m_setpoint = 25.0f;
+    bool m_windowOpen = false;
+    int m_sensorIndex = 0;
+    quint64 m_writes = 0;
+};
+
+#endif // SIMULATEDMODBUSDEVICE_H
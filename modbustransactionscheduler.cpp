@@ -0,0 +1,341 @@
+#include "modbustransactionscheduler.h"
+#include <QModbusReply>
+#include <QElapsedTimer>
+#include <QDebug>
+
+namespace {
+const int kMaxReadRegisters = 125; // 功能码 03 单次最多读取的寄存器数
+}
+
+ModbusTransactionScheduler::ModbusTransactionScheduler(QModbusClient *client, QObject *parent)
+    : QObject(parent), m_client(client)
+{
+    // 派发推迟到下一轮事件循环，使同一时刻发起的读请求有机会合并
+    m_dispatchTimer.setSingleShot(true);
+    m_dispatchTimer.setInterval(0);
+    connect(&m_dispatchTimer, &QTimer::timeout, this, &ModbusTransactionScheduler::dispatch);
+
+    m_pollTimer = new QTimer(this);
+    m_pollTimer->setInterval(m_pollIntervals[IdlePoll]);
+    connect(m_pollTimer, &QTimer::timeout, this, &ModbusTransactionScheduler::onPollTimeout);
+}
+
+void ModbusTransactionScheduler::setMaxInFlight(int count)
+{
+    m_maxInFlight = qMax(1, count);
+    scheduleDispatch();
+}
+
+void ModbusTransactionScheduler::setMaxMergeGap(int registers)
+{
+    m_maxMergeGap = qMax(0, registers);
+}
+
+void ModbusTransactionScheduler::read(int slave, quint16 address, quint16 count, ReadCallback callback,
+                                      Priority priority, QObject *context)
+{
+    Transaction t;
+    t.isWrite = false;
+    t.slave = slave;
+    t.priority = priority;
+    t.address = address;
+    t.count = count;
+    t.waiters.append({address, count, callback, -1, context != nullptr, context});
+    enqueue(t);
+}
+
+void ModbusTransactionScheduler::write(int slave, const QModbusDataUnit &unit, WriteCallback callback, QObject *context)
+{
+    Transaction t;
+    t.isWrite = true;
+    t.slave = slave;
+    t.priority = WritePriority;
+    t.writeUnit = unit;
+    t.writeCallback = callback;
+    t.hasWriteContext = (context != nullptr);
+    t.writeContext = context;
+    enqueue(t);
+}
+
+int ModbusTransactionScheduler::addPoll(int slave, quint16 address, quint16 count, ReadCallback callback)
+{
+    int id = m_nextPollId++;
+    m_polls.insert(id, {slave, address, count, callback, true, IdlePoll, QElapsedTimer()});
+    updatePollTimer();
+    return id;
+}
+
+void ModbusTransactionScheduler::removePoll(int pollId)
+{
+    m_polls.remove(pollId);
+    updatePollTimer();
+}
+
+void ModbusTransactionScheduler::setPollEnabled(int pollId, bool enabled)
+{
+    auto it = m_polls.find(pollId);
+    if (it == m_polls.end()) return;
+    it->enabled = enabled;
+    updatePollTimer();
+}
+
+void ModbusTransactionScheduler::setPollingEnabled(bool enabled)
+{
+    m_pollingEnabled = enabled;
+    updatePollTimer();
+}
+
+// 定时器按启用轮询中最快的档位走，各轮询在 onPollTimeout 里再按自己的周期决定是否发出
+void ModbusTransactionScheduler::updatePollTimer()
+{
+    int interval = 0;
+    for (const Poll &poll : qAsConst(m_polls)) {
+        if (!poll.enabled) continue;
+        const int pollInterval = m_pollIntervals[poll.profile];
+        if (interval == 0 || pollInterval < interval) interval = pollInterval;
+    }
+    if (!m_pollingEnabled || interval == 0) {
+        m_pollTimer->stop();
+        return;
+    }
+    if (m_pollTimer->interval() != interval) {
+        m_pollTimer->setInterval(interval);
+        if (m_pollTimer->isActive()) m_pollTimer->start(); // 立即按新周期重新计时
+    }
+    if (!m_pollTimer->isActive()) m_pollTimer->start();
+}
+
+void ModbusTransactionScheduler::setMinimumFrameGap(int msec)
+{
+    m_minimumFrameGap = qMax(0, msec);
+}
+
+void ModbusTransactionScheduler::setRetryCount(int count)
+{
+    m_retryCount = qMax(0, count);
+}
+
+void ModbusTransactionScheduler::resetStats()
+{
+    m_stats.clear();
+}
+
+void ModbusTransactionScheduler::setPollProfile(int pollId, PollProfile profile)
+{
+    auto it = m_polls.find(pollId);
+    if (it == m_polls.end() || it->profile == profile) return;
+    const bool faster = m_pollIntervals[profile] < m_pollIntervals[it->profile];
+    it->profile = profile;
+    // 切到更快的档位时下一拍立即读一次，不必等满旧周期
+    if (faster) it->lastIssued.invalidate();
+    updatePollTimer();
+}
+
+ModbusTransactionScheduler::PollProfile ModbusTransactionScheduler::pollProfile(int pollId) const
+{
+    auto it = m_polls.constFind(pollId);
+    return it == m_polls.constEnd() ? IdlePoll : it->profile;
+}
+
+void ModbusTransactionScheduler::setPollInterval(PollProfile profile, int msec)
+{
+    m_pollIntervals[profile] = qMax(100, msec);
+    updatePollTimer();
+}
+
+int ModbusTransactionScheduler::pollInterval(PollProfile profile) const
+{
+    return m_pollIntervals[profile];
+}
+
+void ModbusTransactionScheduler::onPollTimeout()
+{
+    // 定时器抖动会让到期时刻略早于周期，留半拍余量，避免慢档位被拖到下一拍
+    const int slack = m_pollTimer->interval() / 2;
+    for (auto it = m_polls.begin(); it != m_polls.end(); ++it) {
+        const int id = it.key();
+        Poll &poll = it.value();
+        if (!poll.enabled || m_pendingPolls.contains(id)) continue; // 上一次还没回来，本周期跳过
+        if (poll.lastIssued.isValid() && poll.lastIssued.elapsed() + slack < m_pollIntervals[poll.profile]) continue;
+        poll.lastIssued.start();
+        Transaction t;
+        t.slave = poll.slave;
+        t.priority = PollPriority;
+        t.address = poll.address;
+        t.count = poll.count;
+        t.waiters.append({poll.address, poll.count, poll.callback, id, false, nullptr});
+        m_pendingPolls.insert(id);
+        enqueue(t);
+    }
+}
+
+void ModbusTransactionScheduler::enqueue(const Transaction &transaction)
+{
+    Transaction t = transaction;
+    t.sequence = m_nextSequence++;
+
+    // 按优先级插入，同优先级先来先服务
+    int pos = m_queue.size();
+    while (pos > 0 && m_queue[pos - 1].priority > t.priority) --pos;
+    m_queue.insert(pos, t);
+    scheduleDispatch();
+}
+
+void ModbusTransactionScheduler::requeueFront(const Transaction &transaction)
+{
+    int pos = 0;
+    while (pos < m_queue.size() && m_queue[pos].priority < transaction.priority) ++pos;
+    m_queue.insert(pos, transaction);
+    scheduleDispatch();
+}
+
+void ModbusTransactionScheduler::scheduleDispatch()
+{
+    if (!m_dispatchTimer.isActive()) m_dispatchTimer.start(0);
+}
+
+void ModbusTransactionScheduler::dispatch()
+{
+    while (m_inFlight < m_maxInFlight && !m_queue.isEmpty()) {
+        // 帧间隔未到时稍后再派发
+        if (m_minimumFrameGap > 0 && m_sinceLastFrame.isValid() && m_sinceLastFrame.elapsed() < m_minimumFrameGap) {
+            m_dispatchTimer.start(int(m_minimumFrameGap - m_sinceLastFrame.elapsed()));
+            return;
+        }
+        Transaction head = m_queue.takeFirst();
+        if (!head.isWrite) mergeReads(head);
+        send(head);
+    }
+}
+
+void ModbusTransactionScheduler::mergeReads(Transaction &head)
+{
+    // 反复扫描，直到没有能并入的读请求（合并后范围变大，可能又能吸收新的请求）
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < m_queue.size(); ++i) {
+            const Transaction &other = m_queue[i];
+            if (other.isWrite || other.slave != head.slave) continue;
+
+            int headEnd = head.address + head.count;       // 不含
+            int otherEnd = other.address + other.count;
+            int gap = qMax(int(other.address) - headEnd, int(head.address) - otherEnd);
+            if (gap > m_maxMergeGap) continue;
+
+            int start = qMin<int>(head.address, other.address);
+            int end = qMax(headEnd, otherEnd);
+            if (end - start > kMaxReadRegisters) continue;
+
+            head.address = quint16(start);
+            head.count = quint16(end - start);
+            head.priority = qMin(head.priority, other.priority);
+            head.waiters += other.waiters;
+            m_readsMerged += other.waiters.size();
+            m_queue.removeAt(i);
+            merged = true;
+            break;
+        }
+    }
+}
+
+void ModbusTransactionScheduler::send(const Transaction &transaction)
+{
+    QModbusReply *reply = nullptr;
+    if (m_client && m_client->state() == QModbusDevice::ConnectedState) {
+        if (transaction.isWrite) {
+            reply = m_client->sendWriteRequest(transaction.writeUnit, transaction.slave);
+        } else {
+            QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, transaction.address, transaction.count);
+            reply = m_client->sendReadRequest(unit, transaction.slave);
+        }
+    }
+
+    if (!reply) {
+        qDebug() << "Modbus 请求发送失败：" << (m_client ? m_client->errorString() : QString("总线不存在"));
+        finish(transaction, nullptr);
+        return;
+    }
+
+    ++m_framesSent;
+    ++m_stats[transaction.slave].requests;
+    if (reply->isFinished()) {
+        // 广播请求会立即完成
+        finish(transaction, reply);
+        reply->deleteLater();
+        return;
+    }
+
+    ++m_inFlight;
+    QElapsedTimer rtt;
+    rtt.start();
+    connect(reply, &QModbusReply::finished, this, [this, transaction, reply, rtt]() {
+        --m_inFlight;
+        m_sinceLastFrame.start();
+        reply->deleteLater();
+
+        ModbusLinkStats &stats = m_stats[transaction.slave];
+        const QModbusDevice::Error error = reply->error();
+        if (error == QModbusDevice::NoError) {
+            stats.recordSuccess(int(rtt.elapsed()));
+        } else {
+            const bool isException = reply->rawResult().isException();
+            stats.recordFailure(error, isException, reply->errorString());
+
+            // 超时、帧错误属于线路问题，重试；异常应答是从站明确拒绝，重试无意义
+            const bool retryable = (error == QModbusDevice::TimeoutError)
+                                   || (error == QModbusDevice::ProtocolError && !isException);
+            if (retryable && transaction.attempt < m_retryCount) {
+                Transaction retry = transaction;
+                ++retry.attempt;
+                ++stats.retries;
+                requeueFront(retry);
+                return;
+            }
+        }
+
+        finish(transaction, reply);
+        scheduleDispatch();
+    });
+}
+
+void ModbusTransactionScheduler::finish(const Transaction &transaction, QModbusReply *reply)
+{
+    bool ok = reply && reply->error() == QModbusDevice::NoError;
+    if (reply && !ok) {
+        qDebug() << "Modbus 事务失败：从站" << transaction.slave << reply->errorString();
+    }
+
+    if (transaction.isWrite) {
+        if (transaction.hasWriteContext && !transaction.writeContext) return;
+        if (transaction.writeCallback) transaction.writeCallback(ok);
+        return;
+    }
+
+    const QModbusDataUnit result = ok ? reply->result() : QModbusDataUnit();
+    for (const Waiter &waiter : transaction.waiters) {
+        if (waiter.pollId >= 0) {
+            m_pendingPolls.remove(waiter.pollId);
+            if (!m_polls.contains(waiter.pollId)) continue; // 轮询已注销（设备已离开总线）
+        }
+        if (!waiter.callback || (waiter.hasContext && !waiter.context)) continue;
+
+        int offset = waiter.address - transaction.address;
+        if (ok && offset >= 0 && offset + waiter.count <= int(result.valueCount())) {
+            QModbusDataUnit slice(QModbusDataUnit::HoldingRegisters, waiter.address,
+                                  result.values().mid(offset, waiter.count));
+            waiter.callback(true, slice);
+        } else {
+            waiter.callback(false, QModbusDataUnit());
+        }
+    }
+}
+
+void ModbusTransactionScheduler::clear()
+{
+    const QList<Transaction> dropped = m_queue;
+    m_queue.clear();
+    for (const Transaction &t : dropped) {
+        finish(t, nullptr);
+    }
+}
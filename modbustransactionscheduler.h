@@ -0,0 +1,153 @@
+#ifndef MODBUSTRANSACTIONSCHEDULER_H
+#define MODBUSTRANSACTIONSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+#include <QModbusClient>
+#include <QModbusDataUnit>
+#include <QHash>
+#include <functional>
+#include "modbuslinkstats.h"
+
+// 单条总线上的 Modbus 事务调度：
+// 1. 写请求（设定值、开关窗等）优先于读请求，轮询读最后
+// 2. 同一从站相邻或重叠的保持寄存器读请求合并为一次功能码 03 读取，结果再按各自地址切分回调
+// 3. 限制同时在途的请求数（RTU 总线默认 1 个），其余在本地排队，保证优先级真正生效
+// 4. 内置周期轮询，每个轮询按各自的档位计时（稳定判断时快、空闲时慢），共线的设备互不覆盖
+// 5. 同一总线上挂多个从站时，可设定两帧之间的最小间隔
+// 6. 超时/帧错误由调度器自行重试，并按从站统计往返时间和错误（主站自身的重试应设为 0，否则统计不到）
+class ModbusTransactionScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum Priority {
+        WritePriority = 0,
+        ReadPriority = 1,
+        PollPriority = 2
+    };
+
+    enum PollProfile {
+        IdlePoll,     // 空闲：慢速轮询
+        NormalPoll,   // 标校进行中但不在采样
+        FastPoll      // 稳定判断、驻留采样
+    };
+    Q_ENUM(PollProfile)
+
+    using ReadCallback = std::function<void(bool ok, const QModbusDataUnit &unit)>;
+    using WriteCallback = std::function<void(bool ok)>;
+
+    explicit ModbusTransactionScheduler(QModbusClient *client, QObject *parent = nullptr);
+
+    void setMaxInFlight(int count);
+    // 两段读取之间允许夹带的无用寄存器数，超过则不合并
+    void setMaxMergeGap(int registers);
+
+    // context 非空时，context 被销毁后不再调用回调（总线上的设备可能先于总线析构）
+    void read(int slave, quint16 address, quint16 count, ReadCallback callback,
+              Priority priority = ReadPriority, QObject *context = nullptr);
+    void write(int slave, const QModbusDataUnit &unit, WriteCallback callback = nullptr, QObject *context = nullptr);
+
+    // 注册周期轮询，返回轮询编号；新注册的轮询默认启用
+    int addPoll(int slave, quint16 address, quint16 count, ReadCallback callback);
+    void removePoll(int pollId);
+    // 单个轮询的启停（同一总线上的各设备各自控制）
+    void setPollEnabled(int pollId, bool enabled);
+    // 总开关
+    void setPollingEnabled(bool enabled);
+    bool isPollingEnabled() const { return m_pollingEnabled; }
+    // 单个轮询的档位，由注册它的设备按自己的测量阶段设置；新注册的轮询为 IdlePoll
+    void setPollProfile(int pollId, PollProfile profile);
+    PollProfile pollProfile(int pollId) const;
+    void setPollInterval(PollProfile profile, int msec);
+    int pollInterval(PollProfile profile) const;
+
+    // 一帧结束到下一帧开始的最小间隔（毫秒），用于多从站共线时给从站留出收发切换时间
+    void setMinimumFrameGap(int msec);
+    // 超时或帧错误后的重试次数
+    void setRetryCount(int count);
+
+    ModbusLinkStats stats(int slave) const { return m_stats.value(slave); }
+    void resetStats();
+
+    // 丢弃排队中的请求（断开连接时调用），回调以失败结束
+    void clear();
+
+    int queuedCount() const { return m_queue.size(); }
+    int inFlightCount() const { return m_inFlight; }
+    quint64 framesSent() const { return m_framesSent; }
+    quint64 readsMerged() const { return m_readsMerged; }
+
+private:
+    struct Waiter {
+        quint16 address;
+        quint16 count;
+        ReadCallback callback;
+        int pollId;
+        bool hasContext;
+        QPointer<QObject> context;
+    };
+
+    struct Transaction {
+        bool isWrite = false;
+        int slave = 0;
+        Priority priority = ReadPriority;
+        quint64 sequence = 0;
+        quint16 address = 0;
+        quint16 count = 0;
+        QModbusDataUnit writeUnit;
+        WriteCallback writeCallback;
+        int attempt = 0;
+        bool hasWriteContext = false;
+        QPointer<QObject> writeContext;
+        QVector<Waiter> waiters;
+    };
+
+    struct Poll {
+        int slave;
+        quint16 address;
+        quint16 count;
+        ReadCallback callback;
+        bool enabled;
+        PollProfile profile;
+        QElapsedTimer lastIssued;   // 上次发出的时刻，未发出过时无效
+    };
+
+    void enqueue(const Transaction &transaction);
+    // 重试：插到同优先级请求的最前面
+    void requeueFront(const Transaction &transaction);
+    void scheduleDispatch();
+    void dispatch();
+    void mergeReads(Transaction &head);
+    void send(const Transaction &transaction);
+    void finish(const Transaction &transaction, QModbusReply *reply);
+    void onPollTimeout();
+    void updatePollTimer();
+
+    QModbusClient *m_client;
+    QList<Transaction> m_queue;     // 按 (priority, sequence) 有序
+    QTimer m_dispatchTimer;
+    QTimer *m_pollTimer;
+    QMap<int, Poll> m_polls;
+    int m_nextPollId = 0;
+    bool m_pollingEnabled = true;
+    QSet<int> m_pendingPolls;       // 已排队或在途的轮询，避免总线慢时堆积
+    int m_pollIntervals[3] = {5000, 2000, 1000};
+
+    int m_maxInFlight = 1;
+    int m_maxMergeGap = 4;
+    int m_inFlight = 0;
+    int m_minimumFrameGap = 0;
+    int m_retryCount = 2;
+    QHash<int, ModbusLinkStats> m_stats;
+    QElapsedTimer m_sinceLastFrame;
+    quint64 m_nextSequence = 0;
+    quint64 m_framesSent = 0;
+    quint64 m_readsMerged = 0;
+};
+
+#endif // MODBUSTRANSACTIONSCHEDULER_H
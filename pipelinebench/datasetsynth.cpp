@@ -0,0 +1,308 @@
+#include "datasetsynth.h"
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include "xlsxdocument.h"
+
+QString DatasetSynthesizer::formatName(Format format)
+{
+    switch (format) {
+    case Standard: return "standard";
+    case SingleHead: return "single";
+    case MultiHead: return "multi";
+    }
+    return QString();
+}
+
+bool DatasetSynthesizer::parseFormat(const QString &name, Format *format)
+{
+    for (Format candidate : {Standard, SingleHead, MultiHead}) {
+        if (formatName(candidate) == name.trimmed()) {
+            *format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+DataExcelProcessor::ProcessType DatasetSynthesizer::processType(Format format)
+{
+    switch (format) {
+    case Standard: return DataExcelProcessor::StandardData;
+    case SingleHead: return DataExcelProcessor::SingleHead;
+    case MultiHead: return DataExcelProcessor::MultiHead;
+    }
+    return DataExcelProcessor::StandardData;
+}
+
+int DatasetSynthesizer::channelsPerRow(Format format)
+{
+    // 与 DataExcelProcessor 写回的列数一致：标准 16 通道，单头 3 列，多头 E..M 共 9 列
+    switch (format) {
+    case Standard: return TxtMinuteIndex::channelCount(TxtMinuteIndex::StandardLog);
+    case SingleHead: return 3;
+    case MultiHead: return 9;
+    }
+    return 0;
+}
+
+DatasetSynthesizer::DatasetSynthesizer(const QString &seedRoot)
+    : m_seedRoot(seedRoot)
+{
+}
+
+// 与 DataExcelProcessor 读取时间列的规则一致：B 列日期，C 列时间（QTime、Excel 数值或文本）
+bool DatasetSynthesizer::readTimePoint(const QVariant &dateCell, const QVariant &timeCell, QDate *date, QTime *time)
+{
+    *date = dateCell.toDate();
+    if (timeCell.userType() == QMetaType::QTime) {
+        *time = timeCell.toTime();
+    } else if (timeCell.userType() == QMetaType::QDateTime) {
+        *time = timeCell.toDateTime().time();
+    } else if (timeCell.canConvert<double>() && timeCell.toDouble() > 0.0) {
+        *time = QTime(0, 0).addSecs(static_cast<int>(timeCell.toDouble() * 86400));
+    } else {
+        const QString text = timeCell.toString().trimmed();
+        *time = QTime::fromString(text, "HH:mm:ss");
+        if (!time->isValid()) *time = QTime::fromString(text, "HH:mm");
+    }
+    return date->isValid() && time->isValid();
+}
+
+bool DatasetSynthesizer::loadSeed(Format format, QString *error)
+{
+    Seed &seed = m_seeds[format];
+    if (seed.loaded) return true;
+
+    static const QStringList seedDirs = {"标准", "单头", "多头"};
+    const QDir dir(m_seedRoot + "/" + seedDirs.at(format));
+    for (const QFileInfo &info : dir.entryInfoList(QStringList() << "*.xlsx", QDir::Files, QDir::Name)) {
+        if (!info.completeBaseName().contains("_processed")) {
+            seed.workbookPath = info.absoluteFilePath();
+            break;
+        }
+    }
+    if (seed.workbookPath.isEmpty()) {
+        *error = "种子目录中没有模板工作簿：" + dir.absolutePath();
+        return false;
+    }
+
+    QXlsx::Document doc(seed.workbookPath);
+    static const QRegularExpression multiSheet(R"(^COM\d+-多\d+$)");
+    for (const QString &name : doc.sheetNames()) {
+        const bool match = (format == Standard) || (format == SingleHead && name.contains("单头"))
+                           || (format == MultiHead && multiSheet.match(name).hasMatch());
+        if (match) {
+            seed.sheetName = name;
+            break;
+        }
+    }
+    if (seed.sheetName.isEmpty()) {
+        *error = "种子工作簿中没有" + formatName(format) + "格式的工作表：" + seed.workbookPath;
+        return false;
+    }
+
+    // 原型工作表中的时间点，按日期分组
+    seed.firstRow = (format == MultiHead) ? 4 : 3;
+    doc.selectSheet(seed.sheetName);
+    int emptyCount = 0;
+    for (int row = seed.firstRow; emptyCount < 10; ++row) {
+        QDate date;
+        QTime time;
+        if (!readTimePoint(doc.read(row, 2), doc.read(row, 3), &date, &time)) {
+            ++emptyCount;
+            continue;
+        }
+        emptyCount = 0;
+        seed.times[date].append(time);
+        seed.lastRow = row;
+    }
+    seed.days = QVector<QDate>::fromList(seed.times.keys());
+    if (seed.days.isEmpty()) {
+        *error = "种子工作表中没有时间点：" + seed.sheetName;
+        return false;
+    }
+
+    // 种子 TXT：<会话时间>_<端口>_<yyyyMMdd>.txt
+    static const QRegularExpression txtName(R"(^\d+_(COM\d+)_(\d{8})\.txt$)", QRegularExpression::CaseInsensitiveOption);
+    for (const QFileInfo &info : dir.entryInfoList(QStringList() << "*.txt", QDir::Files, QDir::Name)) {
+        QRegularExpressionMatch match = txtName.match(info.fileName());
+        if (!match.hasMatch()) continue;
+        const QDate date = QDate::fromString(match.captured(2), "yyyyMMdd");
+        if (!date.isValid()) continue;
+        QMap<QDate, QString> &files = seed.txt[match.captured(1).toUpper()];
+        if (!files.contains(date)) files.insert(date, info.absoluteFilePath());
+    }
+    seed.ports = seed.txt.keys();
+    std::sort(seed.ports.begin(), seed.ports.end(), [](const QString &a, const QString &b) {
+        return a.mid(3).toInt() < b.mid(3).toInt();
+    });
+    if (seed.ports.isEmpty()) {
+        *error = "种子目录中没有 TXT 日志：" + dir.absolutePath();
+        return false;
+    }
+
+    seed.loaded = true;
+    return true;
+}
+
+// 把种子日志中的日期（含跨零点的次日）改写为目标日期；同一 (种子文件, 目标日期) 只生成一次
+QString DatasetSynthesizer::writeTxt(const QString &seedFile, const QDate &seedDate, const QDate &targetDate,
+                                     const QString &targetPath, QHash<QString, QString> &written, QString *error) const
+{
+    const QString key = seedFile + "|" + targetDate.toString(Qt::ISODate);
+    const QString existing = written.value(key);
+    if (!existing.isEmpty()) {
+#ifdef Q_OS_WIN
+        const bool copy = true; // Windows 下 QFile::link 生成的是 .lnk 快捷方式
+#else
+        const bool copy = m_copyFiles;
+#endif
+        if (copy ? QFile::copy(existing, targetPath) : QFile::link(existing, targetPath)) return targetPath;
+        *error = "无法生成 TXT：" + targetPath;
+        return QString();
+    }
+
+    QFile in(seedFile);
+    if (!in.open(QIODevice::ReadOnly)) {
+        *error = "无法读取种子 TXT：" + seedFile;
+        return QString();
+    }
+    QByteArray data = in.readAll();
+
+    // 先把次日换成占位符，避免目标日期与种子次日相同时被二次替换
+    const QDate seedNext = seedDate.addDays(1);
+    const QDate targetNext = targetDate.addDays(1);
+    const QList<QPair<QString, QString>> formats = {{"yyyy-MM-dd", "\x01" "D" "\x01"}, {"yyyyMMdd", "\x01" "N" "\x01"}};
+    for (const auto &format : formats) data.replace(seedNext.toString(format.first).toLatin1(), format.second.toLatin1());
+    for (const auto &format : formats) data.replace(seedDate.toString(format.first).toLatin1(), targetDate.toString(format.first).toLatin1());
+    for (const auto &format : formats) data.replace(format.second.toLatin1(), targetNext.toString(format.first).toLatin1());
+
+    QFile out(targetPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || out.write(data) != data.size()) {
+        *error = "无法写入 TXT：" + targetPath;
+        return QString();
+    }
+    written.insert(key, targetPath);
+    return targetPath;
+}
+
+bool DatasetSynthesizer::generate(Format format, int ports, int days, const QString &workRoot,
+                                  Dataset *dataset, QString *error)
+{
+    if (!loadSeed(format, error)) return false;
+    const Seed &seed = m_seeds[format];
+    if (format == Standard) ports = 1; // 标准温度计只有一个端口
+    ports = qMax(1, ports);
+    days = qMax(1, days);
+
+    Dataset result;
+    result.format = format;
+    result.ports = ports;
+    result.days = days;
+    result.dir = QDir(workRoot).absoluteFilePath(QString("%1-p%2-d%3").arg(formatName(format)).arg(ports).arg(days));
+    QDir(result.dir).removeRecursively();
+    if (!QDir().mkpath(result.dir + "/pristine")) {
+        *error = "无法创建目录：" + result.dir;
+        return false;
+    }
+
+    // ---- 工作表与端口 ----
+    // 标准：原型表本身；单头：每表 4 个端口（E/I/M/Q 列）；多头：每表一个端口，表名 COMn-多n
+    QXlsx::Document doc(seed.workbookPath);
+    QStringList sheets;
+    QVector<QStringList> sheetPorts;
+    if (format == Standard) {
+        sheets << seed.sheetName;
+        sheetPorts << QStringList{"COM1"};
+    } else if (format == SingleHead) {
+        for (int i = 0; i * 4 < ports; ++i) {
+            QStringList group;
+            for (int k = i * 4; k < qMin(ports, i * 4 + 4); ++k) group << QString("COM%1").arg(k + 1);
+            sheets << QString("单头4支-%1").arg(i + 1);
+            sheetPorts << group;
+        }
+    } else {
+        for (int p = 1; p <= ports; ++p) {
+            sheets << QString("COM%1-多%1").arg(p);
+            sheetPorts << QStringList{QString("COM%1").arg(p)};
+        }
+    }
+
+    if (format != Standard) {
+        QStringList seedSheets;
+        static const QRegularExpression multiSheet(R"(^COM\d+-多\d+$)");
+        for (const QString &name : doc.sheetNames()) {
+            if ((format == SingleHead && name.contains("单头")) || (format == MultiHead && multiSheet.match(name).hasMatch())) {
+                seedSheets << name;
+            }
+        }
+        for (const QString &name : sheets) {
+            if (!doc.copySheet(seed.sheetName, name)) {
+                *error = "复制工作表失败：" + name;
+                return false;
+            }
+        }
+        for (const QString &name : seedSheets) doc.deleteSheet(name);
+    }
+
+    // ---- 时间点：第 d 天沿用种子第 d % 种子天数 天的时间点 ----
+    const QDate firstDay = seed.days.first();
+    for (int s = 0; s < sheets.size(); ++s) {
+        doc.selectSheet(sheets[s]);
+        if (format == Standard) {
+            doc.write(1, 5, sheetPorts[s].first());
+        } else if (format == SingleHead) {
+            const QVector<int> comCols = {5, 9, 13, 17};
+            for (int k = 0; k < comCols.size(); ++k) {
+                doc.write(2, comCols[k], k < sheetPorts[s].size() ? QVariant("单头-" + sheetPorts[s][k]) : QVariant());
+            }
+        }
+
+        int row = seed.firstRow;
+        for (int d = 0; d < days; ++d) {
+            const QDate target = firstDay.addDays(d);
+            for (const QTime &time : seed.times.value(seed.days[d % seed.days.size()])) {
+                doc.write(row, 2, target);
+                doc.write(row, 3, time);
+                ++row;
+            }
+        }
+        result.timePoints += (row - seed.firstRow) * sheetPorts[s].size();
+        for (; row <= seed.lastRow; ++row) {
+            doc.write(row, 2, QVariant());
+            doc.write(row, 3, QVariant());
+        }
+    }
+
+    const QString fileName = QString("%1-p%2-d%3-模板.xlsx").arg(formatName(format)).arg(ports).arg(days);
+    result.pristinePath = result.dir + "/pristine/" + fileName;
+    result.workbookPath = result.dir + "/" + fileName;
+    if (!doc.saveAs(result.pristinePath)) {
+        *error = "工作簿保存失败：" + result.pristinePath;
+        return false;
+    }
+    result.workbookBytes = QFileInfo(result.pristinePath).size();
+
+    // ---- TXT：第 p 个端口第 d 天 ----
+    QHash<QString, QString> written;
+    for (int p = 0; p < ports; ++p) {
+        const QMap<QDate, QString> &seedFiles = seed.txt[seed.ports[p % seed.ports.size()]];
+        for (int d = 0; d < days; ++d) {
+            const QDate seedDay = seed.days[d % seed.days.size()];
+            // 种子端口缺这一天时用它最早的一天
+            const QDate seedDate = seedFiles.contains(seedDay) ? seedDay : seedFiles.firstKey();
+            const QDate target = firstDay.addDays(d);
+            const QString day = target.toString("yyyyMMdd");
+            const QString targetPath = result.dir + "/" + day + "080000_COM" + QString::number(p + 1) + "_" + day + ".txt";
+            if (writeTxt(seedFiles.value(seedDate), seedDate, target, targetPath, written, error).isEmpty()) return false;
+            ++result.txtFiles;
+            result.txtBytes += QFileInfo(targetPath).size();
+        }
+    }
+
+    *dataset = result;
+    return true;
+}
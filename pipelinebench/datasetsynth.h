@@ -0,0 +1,79 @@
+#ifndef DATASETSYNTH_H
+#define DATASETSYNTH_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMap>
+#include <QDate>
+#include <QDateTime>
+#include <QVector>
+#include "dataexcelprocessor.h"
+
+// 以 Data模板 中的真实数据为种子生成任意规模的数据集：
+//   工作簿  复制种子工作簿中对应格式的工作表，按端口数增删工作表、改写端口号，
+//           按天数重复种子中每天的时间点（第 d 天使用种子第 d % 种子天数 天的时间点）
+//   TXT     第 p 个端口第 d 天的日志取种子中第 p % 种子端口数 个端口、第 d % 种子天数 天的文件，
+//           只把其中的日期改写为目标日期，内容与真实采集完全相同
+// 内容相同的 TXT 只写一份，其余默认建符号链接（Windows 下或 setCopyFiles(true) 时写独立副本，
+// 磁盘占用为 端口数 × 天数 × 种子文件大小，且不再共享页缓存，更接近真实采集）
+class DatasetSynthesizer
+{
+public:
+    enum Format {
+        Standard,
+        SingleHead,
+        MultiHead
+    };
+
+    struct Dataset {
+        Format format = Standard;
+        int ports = 0;
+        int days = 0;
+        QString dir;
+        QString workbookPath;   // 每次运行前从 pristinePath 复制（单头、多头原地写回）
+        QString pristinePath;
+        int timePoints = 0;     // 所有端口的时间点总数（= 需要回填的行数）
+        int txtFiles = 0;
+        qint64 txtBytes = 0;
+        qint64 workbookBytes = 0;
+    };
+
+    static QString formatName(Format format);
+    static bool parseFormat(const QString &name, Format *format);
+    static DataExcelProcessor::ProcessType processType(Format format);
+    // 每个时间点写回的单元格数
+    static int channelsPerRow(Format format);
+
+    // seedRoot 为 Data模板 目录：标准/、单头/、多头/ 下各有一个模板工作簿和若干 TXT
+    explicit DatasetSynthesizer(const QString &seedRoot);
+
+    void setCopyFiles(bool copy) { m_copyFiles = copy; }
+
+    // 在 workRoot 下生成 <格式>-p<端口数>-d<天数>/，已存在时先清空。标准格式只有一个端口，ports 取 1
+    bool generate(Format format, int ports, int days, const QString &workRoot, Dataset *dataset, QString *error);
+
+private:
+    struct Seed {
+        QString workbookPath;
+        QString sheetName;                       // 原型工作表
+        int firstRow = 3;                        // 时间点起始行
+        int lastRow = 0;                         // 原型中最后一个时间点所在行
+        QVector<QDate> days;                     // 种子中出现的日期（升序）
+        QMap<QDate, QVector<QTime>> times;       // 每天的时间点
+        QStringList ports;                       // 种子 TXT 的端口（按编号升序）
+        QMap<QString, QMap<QDate, QString>> txt; // 端口 -> 日期 -> 文件
+        bool loaded = false;
+    };
+
+    bool loadSeed(Format format, QString *error);
+    QString writeTxt(const QString &seedFile, const QDate &seedDate, const QDate &targetDate,
+                     const QString &targetPath, QHash<QString, QString> &written, QString *error) const;
+    static bool readTimePoint(const QVariant &dateCell, const QVariant &timeCell, QDate *date, QTime *time);
+
+    QString m_seedRoot;
+    bool m_copyFiles = false;
+    QMap<Format, Seed> m_seeds;
+};
+
+#endif // DATASETSYNTH_H
@@ -0,0 +1,338 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QDebug>
+#include "dataexcelprocessor.h"
+#include "datasetsynth.h"
+#include "jobqueue.h"
+#include "txtlogscanner.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+// 用法：
+//   pipelinebench --seeds ../Data模板 --formats single,multi --ports 10,50,100 --days 1,7,14 --report bench.json
+// 以 Data模板 为种子生成各规模数据集（见 DatasetSynthesizer），对每个数据集运行 DataExcelProcessor，
+// 记录各阶段耗时：加载工作簿、读取时间列、TXT 汇总、写回单元格、saveAs，以及吞吐量和峰值内存。
+// 每个规模先预热一次（不计入），再重复 --repeat 次取平均。默认每次运行前删除 .midx 旁路缓存（冷启动），
+// --warm 时保留，测的是缓存命中后的耗时。结果为 JSON，便于逐次比较
+namespace {
+QList<int> parseList(const QString &text)
+{
+    QList<int> values;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        int value = part.trimmed().toInt(&ok);
+        if (ok && value > 0 && !values.contains(value)) values.append(value);
+    }
+    return values;
+}
+
+// 进程峰值常驻内存（KB）；Linux 下可以在每次运行前清零，其他平台为进程启动以来的峰值
+qint64 peakRssKb()
+{
+#if defined(Q_OS_LINUX)
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        for (const QByteArray &line : status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+    }
+    return -1;
+#elif defined(Q_OS_MACOS)
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss / 1024 : -1; // macOS 为字节
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+#else
+    return -1;
+#endif
+}
+
+bool resetPeakRss()
+{
+#if defined(Q_OS_LINUX)
+    QFile clearRefs("/proc/self/clear_refs");
+    return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+#else
+    return false;
+#endif
+}
+
+double perSecond(double amount, qint64 ms)
+{
+    return ms > 0 ? amount / (ms / 1000.0) : 0.0;
+}
+
+struct RunResult {
+    bool ok = false;
+    QString error;
+    DataExcelProcessor::StageTimings timings;
+    qint64 totalMs = 0;
+    qint64 outputBytes = 0;
+    qint64 peakRssKb = -1;
+};
+
+// 恢复原始工作簿后运行一次处理任务并等待结束
+RunResult runOnce(DataExcelProcessor &processor, JobQueue &queue, const DatasetSynthesizer::Dataset &dataset, bool warm)
+{
+    RunResult result;
+    QString outputPath = dataset.workbookPath;
+    if (dataset.format == DatasetSynthesizer::Standard) outputPath.replace(".xlsx", "_processed.xlsx");
+    QFile::remove(dataset.workbookPath);
+    QFile::remove(outputPath);
+    if (!QFile::copy(dataset.pristinePath, dataset.workbookPath)) {
+        result.error = "无法复制工作簿：" + dataset.workbookPath;
+        return result;
+    }
+    if (!warm) {
+        QDir dir(dataset.dir);
+        for (const QString &name : dir.entryList(QStringList() << "*.midx", QDir::Files)) dir.remove(name);
+    }
+
+    resetPeakRss();
+    QElapsedTimer timer;
+    timer.start();
+    int id = processor.startProcessing(DatasetSynthesizer::processType(dataset.format), dataset.workbookPath);
+    if (id < 0) {
+        result.error = processor.lastError();
+        return result;
+    }
+    QEventLoop loop;
+    JobQueue::JobInfo info;
+    queue.whenFinished(id, &loop, [&](const JobQueue::JobInfo &finished) {
+        info = finished;
+        loop.quit();
+    });
+    loop.exec();
+
+    result.totalMs = timer.elapsed();
+    result.ok = info.result.success;
+    result.error = info.result.error;
+    result.timings = processor.lastTimings();
+    result.outputBytes = QFileInfo(outputPath).size();
+    result.peakRssKb = peakRssKb();
+    return result;
+}
+
+QJsonObject timingsJson(const RunResult &run)
+{
+    QJsonObject object;
+    object["ok"] = run.ok;
+    if (!run.error.isEmpty()) object["error"] = run.error;
+    object["loadMs"] = run.timings.loadMs;
+    object["readMs"] = run.timings.readMs;
+    object["aggregateMs"] = run.timings.aggregateMs;
+    object["writeMs"] = run.timings.writeMs;
+    object["saveMs"] = run.timings.saveMs;
+    object["totalMs"] = run.totalMs;
+    object["txtFiles"] = run.timings.txtFiles;
+    object["threads"] = run.timings.threads;
+    object["peakRssKb"] = run.peakRssKb;
+    return object;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    // QXlsx 的格式、字体依赖 QtGui；无显示环境时设置 QT_QPA_PLATFORM=offscreen
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setApplicationName("pipelinebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Excel 数据处理流程规模基准");
+    parser.addHelpOption();
+    QCommandLineOption seedsOption("seeds", "种子目录（含 标准/、单头/、多头/）", "path", "../Data模板");
+    QCommandLineOption workOption("work", "生成数据集的目录", "path", QDir::tempPath() + "/pipelinebench");
+    QCommandLineOption formatsOption("formats", "数据格式（standard,single,multi）", "list", "standard,single,multi");
+    QCommandLineOption portsOption("ports", "端口数（标准格式固定为 1）", "list", "10,50,100");
+    QCommandLineOption daysOption("days", "天数", "list", "1,7,14");
+    QCommandLineOption repeatOption("repeat", "每个规模重复次数（不含预热）", "n", "3");
+    QCommandLineOption threadsOption("threads", "TXT 解析线程数（默认 CPU 核数）", "n");
+    QCommandLineOption warmOption("warm", "保留 .midx 旁路缓存（测缓存命中后的耗时）");
+    QCommandLineOption copyOption("copy", "TXT 写独立副本而不是符号链接");
+    QCommandLineOption keepOption("keep", "保留生成的数据集");
+    QCommandLineOption reportOption("report", "JSON 报告，默认输出到标准输出", "file");
+    QCommandLineOption verboseOption("verbose", "输出处理过程的调试信息");
+    parser.addOptions({seedsOption, workOption, formatsOption, portsOption, daysOption, repeatOption, threadsOption,
+                       warmOption, copyOption, keepOption, reportOption, verboseOption});
+    parser.process(app);
+
+    // DataExcelProcessor 每行都有调试输出，计时时关闭
+    if (!parser.isSet(verboseOption)) QLoggingCategory::setFilterRules("default.debug=false");
+
+    QList<DatasetSynthesizer::Format> formats;
+    for (const QString &name : parser.value(formatsOption).split(',', Qt::SkipEmptyParts)) {
+        DatasetSynthesizer::Format format;
+        if (!DatasetSynthesizer::parseFormat(name, &format)) {
+            qCritical().noquote() << "未知格式：" + name;
+            return 2;
+        }
+        formats.append(format);
+    }
+    const QList<int> portsList = parseList(parser.value(portsOption));
+    const QList<int> daysList = parseList(parser.value(daysOption));
+    const int repeat = qMax(1, parser.value(repeatOption).toInt());
+    const bool warm = parser.isSet(warmOption);
+    if (formats.isEmpty() || portsList.isEmpty() || daysList.isEmpty()) parser.showHelp(2);
+    if (parser.isSet(threadsOption)) {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, parser.value(threadsOption).toInt()));
+    }
+
+    DatasetSynthesizer synthesizer(parser.value(seedsOption));
+    synthesizer.setCopyFiles(parser.isSet(copyOption));
+    JobQueue queue;
+    queue.setMaxWorkers(1);
+    DataExcelProcessor processor;
+    processor.setJobQueue(&queue);
+
+    QTextStream err(stderr);
+    QJsonArray cases;
+    int failures = 0;
+    for (DatasetSynthesizer::Format format : formats) {
+        const QList<int> formatPorts = (format == DatasetSynthesizer::Standard) ? QList<int>{1} : portsList;
+        for (int ports : formatPorts) {
+            for (int days : daysList) {
+                QJsonObject entry;
+                entry["format"] = DatasetSynthesizer::formatName(format);
+                entry["ports"] = ports;
+                entry["days"] = days;
+
+                QElapsedTimer generateTimer;
+                generateTimer.start();
+                DatasetSynthesizer::Dataset dataset;
+                QString error;
+                if (!synthesizer.generate(format, ports, days, parser.value(workOption), &dataset, &error)) {
+                    err << "生成失败：" << error << "\n";
+                    entry["error"] = error;
+                    cases.append(entry);
+                    ++failures;
+                    continue;
+                }
+                entry["generateMs"] = generateTimer.elapsed();
+                entry["timePoints"] = dataset.timePoints;
+                entry["cells"] = dataset.timePoints * DatasetSynthesizer::channelsPerRow(format);
+                entry["txtFiles"] = dataset.txtFiles;
+                entry["txtBytes"] = dataset.txtBytes;
+                entry["workbookBytes"] = dataset.workbookBytes;
+
+                // 第 0 次为预热
+                QJsonArray runs;
+                RunResult sum;
+                sum.ok = true;
+                qint64 peak = -1;
+                qint64 outputBytes = 0;
+                for (int round = 0; round <= repeat; ++round) {
+                    const RunResult run = runOnce(processor, queue, dataset, warm);
+                    if (!run.ok) {
+                        sum.ok = false;
+                        sum.error = run.error;
+                    }
+                    if (round == 0) continue;
+                    runs.append(timingsJson(run));
+                    sum.timings.loadMs += run.timings.loadMs;
+                    sum.timings.readMs += run.timings.readMs;
+                    sum.timings.aggregateMs += run.timings.aggregateMs;
+                    sum.timings.writeMs += run.timings.writeMs;
+                    sum.timings.saveMs += run.timings.saveMs;
+                    sum.totalMs += run.totalMs;
+                    sum.timings.txtFiles = run.timings.txtFiles;
+                    sum.timings.threads = run.timings.threads;
+                    peak = qMax(peak, run.peakRssKb);
+                    outputBytes = run.outputBytes;
+                }
+
+                RunResult mean = sum;
+                mean.timings.loadMs /= repeat;
+                mean.timings.readMs /= repeat;
+                mean.timings.aggregateMs /= repeat;
+                mean.timings.writeMs /= repeat;
+                mean.timings.saveMs /= repeat;
+                mean.totalMs /= repeat;
+                mean.peakRssKb = peak;
+                entry["runs"] = runs;
+                entry["mean"] = timingsJson(mean);
+                if (!sum.ok) ++failures;
+
+                // 吞吐量按平均耗时计算
+                QJsonObject throughput;
+                throughput["loadMBps"] = perSecond(dataset.workbookBytes / 1048576.0, mean.timings.loadMs);
+                throughput["readRowsPerSec"] = perSecond(dataset.timePoints, mean.timings.readMs);
+                throughput["txtMBps"] = perSecond(dataset.txtBytes / 1048576.0, mean.timings.aggregateMs);
+                throughput["writeCellsPerSec"] = perSecond(entry["cells"].toDouble(), mean.timings.writeMs);
+                throughput["saveMBps"] = perSecond(outputBytes / 1048576.0, mean.timings.saveMs);
+                throughput["rowsPerSec"] = perSecond(dataset.timePoints, mean.totalMs);
+                entry["throughput"] = throughput;
+                entry["peakRssKb"] = peak;
+                cases.append(entry);
+
+                err << QString("%1 p%2 d%3：加载 %4 读取 %5 汇总 %6 写入 %7 保存 %8 共 %9 ms，峰值 %10 MB%11\n")
+                           .arg(entry["format"].toString()).arg(ports).arg(days)
+                           .arg(mean.timings.loadMs).arg(mean.timings.readMs).arg(mean.timings.aggregateMs)
+                           .arg(mean.timings.writeMs).arg(mean.timings.saveMs).arg(mean.totalMs)
+                           .arg(peak < 0 ? -1.0 : peak / 1024.0, 0, 'f', 1)
+                           .arg(sum.ok ? QString() : "，失败：" + sum.error);
+                err.flush();
+
+                if (!parser.isSet(keepOption)) QDir(dataset.dir).removeRecursively();
+            }
+        }
+    }
+
+    QJsonObject machine;
+    machine["os"] = QSysInfo::prettyProductName();
+    machine["cpu"] = QSysInfo::currentCpuArchitecture();
+    machine["idealThreads"] = QThread::idealThreadCount();
+    machine["poolThreads"] = QThreadPool::globalInstance()->maxThreadCount();
+    machine["simd"] = TxtLogScanner::simdLevel();
+    machine["qt"] = QString(qVersion());
+    machine["peakRssPerRun"] = resetPeakRss(); // false 时峰值为进程启动以来的累计值
+
+    QJsonObject report;
+    report["generatedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    report["machine"] = machine;
+    report["repeat"] = repeat;
+    report["warm"] = warm;
+#ifdef Q_OS_WIN
+    report["symlinkedTxt"] = false;
+#else
+    report["symlinkedTxt"] = !parser.isSet(copyOption);
+#endif
+    report["cases"] = cases;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(reportOption)) {
+        QFile file(parser.value(reportOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            qCritical().noquote() << "报告写入失败：" + parser.value(reportOption);
+            return 2;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return failures > 0 ? 1 : 0;
+}
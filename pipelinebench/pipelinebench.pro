@@ -0,0 +1,36 @@
+# Excel 数据处理流程规模基准（独立程序，不依赖主工程界面）
+# 以 Data模板 为种子生成 10~100 端口、1~14 天的标准/单头/多头数据集，
+# 分阶段记录 DataExcelProcessor 的耗时、吞吐量和峰值内存，输出 JSON 便于跟踪回归
+QT = core gui concurrent
+
+include(../QXlsx/QXlsx.pri)
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = pipelinebench
+
+win32: LIBS += -lpsapi
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../dataexcelprocessor.cpp \
+    ../exceltime.cpp \
+    ../jobqueue.cpp \
+    ../txtblocklog.cpp \
+    ../txtdirectoryindex.cpp \
+    ../txtlogscanner.cpp \
+    ../txtminuteindex.cpp \
+    datasetsynth.cpp \
+    main.cpp
+
+HEADERS += \
+    ../dataexcelprocessor.h \
+    ../exceltime.h \
+    ../jobqueue.h \
+    ../txtblocklog.h \
+    ../txtdirectoryindex.h \
+    ../txtlogscanner.h \
+    ../txtminuteindex.h \
+    datasetsynth.h
@@ -0,0 +1,168 @@
+#include "planengine.h"
+#include <QDebug>
+
+PlanEngine::PlanEngine(CalibrationClock *clock, QObject *parent)
+    : QObject(parent), m_clock(clock ? clock : CalibrationClock::systemClock())
+{
+}
+
+bool PlanEngine::load(const CalibrationPlan &plan, int sensorCount, QString *error)
+{
+    QVector<PlanNode> nodes;
+    if (!plan.expand(sensorCount, &nodes, error)) return false;
+
+    cancel();
+    qDeleteAll(m_delayTimers);
+    m_delayTimers.clear();
+
+    m_plan = plan;
+    m_nodes = nodes;
+    m_status.fill(Pending, m_nodes.size());
+    m_startTime.fill(QDateTime(), m_nodes.size());
+    m_finishTime.fill(QDateTime(), m_nodes.size());
+    m_delayDue.fill(QDateTime(), m_nodes.size());
+    m_delayRemainingMs.fill(0, m_nodes.size());
+
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        CalibrationTimer *timer = m_clock->createTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &CalibrationTimer::timeout, this, [this, i]() {
+            if (!m_running || m_paused || m_status[i] != Delaying) return;
+            beginNode(i);
+        });
+        m_delayTimers.append(timer);
+    }
+    return true;
+}
+
+QStringList PlanEngine::runningNodeIds() const
+{
+    QStringList ids;
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        if (m_status[i] == Running) ids.append(m_nodes[i].id);
+    }
+    return ids;
+}
+
+void PlanEngine::start()
+{
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        m_status[i] = Pending;
+        m_startTime[i] = QDateTime();
+        m_finishTime[i] = QDateTime();
+        m_delayTimers[i]->stop();
+    }
+    m_running = true;
+    m_paused = false;
+    m_roundStart = m_clock->now();
+
+    if (m_nodes.isEmpty()) {
+        m_running = false;
+        emit planFinished(0);
+        return;
+    }
+    evaluate();
+}
+
+void PlanEngine::completeNode(int index)
+{
+    if (!m_running || index < 0 || index >= m_nodes.size() || m_status[index] != Running) return;
+
+    m_status[index] = Done;
+    m_finishTime[index] = m_clock->now();
+    emit nodeFinished(index, actualNodeMs(index));
+    evaluate();
+}
+
+bool PlanEngine::dependenciesMet(int index) const
+{
+    for (const PlanDependency &dep : m_nodes[index].deps) {
+        NodeStatus s = m_status[dep.node];
+        if (dep.onStart ? (s != Running && s != Done) : (s != Done)) return false;
+    }
+    return true;
+}
+
+void PlanEngine::beginNode(int index)
+{
+    m_status[index] = Running;
+    m_startTime[index] = m_clock->now();
+    emit nodeReady(index);
+}
+
+void PlanEngine::evaluate()
+{
+    // nodeReady 的处理函数可能同步调用 completeNode，这里不递归，改为循环重扫
+    if (m_evaluating) {
+        m_reevaluate = true;
+        return;
+    }
+    m_evaluating = true;
+
+    do {
+        m_reevaluate = false;
+        for (int i = 0; i < m_nodes.size() && m_running && !m_paused; ++i) {
+            if (m_status[i] != Pending || !dependenciesMet(i)) continue;
+
+            int delayMs = qRound(m_nodes[i].delaySec * 1000.0);
+            if (delayMs > 0) {
+                m_status[i] = Delaying;
+                m_delayDue[i] = m_clock->now().addMSecs(delayMs);
+                m_delayTimers[i]->start(delayMs);
+            } else {
+                beginNode(i);
+                m_reevaluate = true;
+            }
+        }
+    } while (m_reevaluate && m_running && !m_paused);
+
+    m_evaluating = false;
+
+    if (!m_running) return;
+    for (NodeStatus s : qAsConst(m_status)) {
+        if (s != Done) return;
+    }
+    m_running = false;
+    emit planFinished(m_roundStart.msecsTo(m_clock->now()));
+}
+
+void PlanEngine::pause()
+{
+    if (!m_running || m_paused) return;
+    m_paused = true;
+    QDateTime now = m_clock->now();
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        if (m_status[i] != Delaying) continue;
+        // 记录剩余延时，恢复时接着计
+        m_delayRemainingMs[i] = qMax<qint64>(0, now.msecsTo(m_delayDue[i]));
+        m_delayTimers[i]->stop();
+    }
+}
+
+void PlanEngine::resume()
+{
+    if (!m_running || !m_paused) return;
+    m_paused = false;
+    QDateTime now = m_clock->now();
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        if (m_status[i] != Delaying) continue;
+        m_delayDue[i] = now.addMSecs(m_delayRemainingMs[i]);
+        m_delayTimers[i]->start(int(m_delayRemainingMs[i]));
+    }
+    evaluate();
+}
+
+void PlanEngine::cancel()
+{
+    m_running = false;
+    m_paused = false;
+    for (CalibrationTimer *timer : qAsConst(m_delayTimers)) {
+        timer->stop();
+    }
+}
+
+qint64 PlanEngine::actualNodeMs(int index) const
+{
+    if (!m_startTime[index].isValid() || !m_finishTime[index].isValid()) return -1;
+    return m_startTime[index].msecsTo(m_finishTime[index]);
+}
@@ -0,0 +1,73 @@
+#ifndef PLANENGINE_H
+#define PLANENGINE_H
+
+#include <QObject>
+#include <QVector>
+#include <QDateTime>
+#include "calibrationplan.h"
+#include "calibrationclock.h"
+
+// 流程执行引擎：只负责调度（依赖、延时、并行），具体动作由使用者在 nodeReady 中执行，
+// 动作完成后调用 completeNode。每个温度点调用一次 start()
+class PlanEngine : public QObject
+{
+    Q_OBJECT
+public:
+    enum NodeStatus {
+        Pending,    // 依赖未满足
+        Delaying,   // 依赖已满足，等待 delaySec
+        Running,    // 动作执行中
+        Done
+    };
+
+    explicit PlanEngine(CalibrationClock *clock, QObject *parent = nullptr);
+
+    bool load(const CalibrationPlan &plan, int sensorCount, QString *error);
+    const CalibrationPlan &plan() const { return m_plan; }
+    const QVector<PlanNode> &nodes() const { return m_nodes; }
+    const PlanNode &node(int index) const { return m_nodes[index]; }
+    NodeStatus status(int index) const { return m_status[index]; }
+    // 运行前补充节点参数（如按转台速度曲线预测的 servoSec）
+    void setNodeParam(int index, const QString &key, const QVariant &value) { m_nodes[index].params.insert(key, value); }
+
+    bool isRunning() const { return m_running; }
+    // 当前正在执行的节点（用于界面显示）
+    QStringList runningNodeIds() const;
+
+    void start();
+    void completeNode(int index);
+    void pause();
+    void resume();
+    void cancel();
+
+    // 本轮每个节点实际耗时（毫秒），未执行的为 -1
+    qint64 actualNodeMs(int index) const;
+
+signals:
+    void nodeReady(int index);                         // 需要执行动作
+    void nodeFinished(int index, qint64 actualMs);
+    void planFinished(qint64 totalMs);
+
+private:
+    void evaluate();
+    bool dependenciesMet(int index) const;
+    void beginNode(int index);
+
+    CalibrationClock *m_clock;
+    CalibrationPlan m_plan;
+    QVector<PlanNode> m_nodes;
+    QVector<NodeStatus> m_status;
+    QVector<QDateTime> m_startTime;
+    QVector<QDateTime> m_finishTime;
+    QVector<CalibrationTimer *> m_delayTimers;
+    QVector<QDateTime> m_delayDue;       // 延时到期时间
+    QVector<qint64> m_delayRemainingMs;  // 暂停时剩余的延时
+    QDateTime m_roundStart;
+
+    bool m_running = false;
+    bool m_paused = false;
+    bool m_evaluating = false;
+    bool m_reevaluate = false;
+};
+
+#endif // PLANENGINE_H
@@ -1,5 +1,4 @@
 #include "pythonprocessor.h"
-#include <QFileDialog>
 #include <QDir>
 #include <QDebug>
 #include <QCoreApplication>
@@ -9,6 +8,9 @@
 #include <QDateTime> // 添加以获取当前时间
 #include <QDesktopServices>
 #include <QTimer>
+#include <QHash>
+#include <xlsxsheetreader.h>
+#include <memory>
 
 PythonProcessor::PythonProcessor(QObject *parent)
     : QObject(parent), m_process(new QProcess(this))
@@ -22,6 +24,56 @@ PythonProcessor::PythonProcessor(QObject *parent)
             this, &PythonProcessor::handleProcessFinished);
 }
 
+QString PythonProcessor::scriptDirectory() const
+{
+    return m_scriptDirectory.isEmpty() ? QCoreApplication::applicationDirPath() : m_scriptDirectory;
+}
+
+// 一个模板一个拟合任务，证书和能量配置命令在进程结束后生成，也算在任务内。
+// 同一处理器只有一个 Python 进程，任务放在同一分组里依次执行；结束（含失败、取消）由完成信号驱动
+int PythonProcessor::submitFittingJob(JobQueue *queue, const QString& templatePath, bool multiHead,
+                                      JobQueue::Priority priority)
+{
+    QString nid;
+    if (multiHead) {
+        static QRegularExpression nidRegex("^多\\d+"); // 匹配多设备编号
+        QRegularExpressionMatch match = nidRegex.match(QFileInfo(templatePath).baseName());
+        nid = match.hasMatch() ? match.captured(0) : QString("多未知"); // 处理可能的命名不规范情况
+    }
+
+    const QString title = QString("%1拟合：%2").arg(multiHead ? "多头" : "单头", QFileInfo(templatePath).fileName());
+    // 测试员、审核员和合并文件路径按提交时的值，排队期间再次设置不影响已提交的任务
+    const QString tester = m_testerName;
+    const QString reviewer = m_reviewerName;
+    const QString mergedPath = m_mergedFilePath;
+    return queue->submitAsync(title, m_jobGroup, priority,
+        [this, templatePath, multiHead, nid, tester, reviewer, mergedPath](const JobContext &ctx) {
+            setTesterReviewerInfo(tester, reviewer);
+            setMergedFilePath(mergedPath);
+
+            // 使用一次性连接确保只处理当前模板
+            auto connections = std::make_shared<QList<QMetaObject::Connection>>();
+            *connections << connect(this, &PythonProcessor::progressUpdated, this,
+                                    [ctx](int percentage, const QString &message) {
+                                        ctx.setProgress(percentage, message);
+                                    });
+            *connections << connect(this, &PythonProcessor::processingFinished, this,
+                                    [ctx, connections, templatePath](bool success, const QString &resultPath) {
+                                        for (const QMetaObject::Connection &connection : *connections) disconnect(connection);
+                                        qDebug() << (success ? "模板拟合成功:" : "模板拟合失败:") << templatePath;
+                                        ctx.finish(success ? JobResult::ok(resultPath)
+                                                           : JobResult::failed("Python 拟合失败：" + templatePath));
+                                    });
+
+            if (multiHead) {
+                startMultiProcessing(templatePath, nid);
+            } else {
+                startProcessing(templatePath);
+            }
+        },
+        [this]() { terminateProcess(); });
+}
+
 void PythonProcessor::startProcessing(const QString& inputFilePath, const QString& nid)
 {
     // 重置进程状态
@@ -30,6 +82,7 @@ void PythonProcessor::startProcessing(const QString& inputFilePath, const QStrin
     QFileInfo inputFile(inputFilePath);
     if (!inputFile.exists()) {
         emit errorOccurred("输入文件不存在");
+        emit processingFinished(false, ""); // 任务队列靠完成信号结束当前任务
         return;
     }
 
@@ -47,7 +100,7 @@ void PythonProcessor::startProcessing(const QString& inputFilePath, const QStrin
 
     // 启动进程（指定Python绝对路径）
     QString pythonExe = "python";
-    QString scriptPath = QCoreApplication::applicationDirPath() + "/DNH.py";
+    QString scriptPath = scriptDirectory() + "/DNH.py";
 
     // ========== 新增调试信息：验证Python和脚本路径 ==========
     qDebug() << "\n===== 启动单头处理 =====";
@@ -69,6 +122,8 @@ void PythonProcessor::startProcessing(const QString& inputFilePath, const QStrin
         qDebug() << "Python进程启动失败！原因：" << m_process->errorString();
         qDebug() << "可能原因：1. Python路径错误；2. 脚本路径错误；3. 权限不足；4. 架构不匹配（32/64位）";
         emit errorOccurred("启动Python进程失败，请检查Python环境或脚本路径！错误详情：" + m_process->errorString());
+        m_isProcessing = false;
+        emit processingFinished(false, "");
         return;
     }
 
@@ -192,8 +247,8 @@ void PythonProcessor::handleProcessFinished(int exitCode, QProcess::ExitStatus e
         emit processingFinished(false, "");
     }
 
+    // 完成信号只发一次（任务队列按它结束当前任务，重复发出会误结束下一个任务）
     m_isProcessing = false;
-    emit processingFinished(true, resultPath);
 }
 
 void PythonProcessor::startMultiProcessing(const QString& inputFilePath, const QString& nid)
@@ -202,6 +257,7 @@ void PythonProcessor::startMultiProcessing(const QString& inputFilePath, const Q
     m_outputPath = generateOutputPath(inputFile, true); // 生成多头专用路径
     if (!inputFile.exists()) {
         emit errorOccurred("输入文件不存在");
+        emit processingFinished(false, "");
         return;
     }
 
@@ -212,11 +268,12 @@ void PythonProcessor::startMultiProcessing(const QString& inputFilePath, const Q
     // NID格式验证
     if (!nid.startsWith("多") || nid.length() < 2) {
         emit errorOccurred("无效的NID格式，示例：多8");
+        emit processingFinished(false, "");
         return;
     }
 
     // 脚本路径验证
-    QString scriptPath = QCoreApplication::applicationDirPath() + "/run.py";
+    QString scriptPath = scriptDirectory() + "/run.py";
     // ========== 新增调试：验证多头处理的脚本和Python路径 ==========
     QString pythonExe = "python";
     qDebug() << "\n===== 启动多头处理 =====";
@@ -231,13 +288,15 @@ void PythonProcessor::startMultiProcessing(const QString& inputFilePath, const Q
     args << filesPath << nid;
 
     // 启动进程
-    m_process->setWorkingDirectory(QCoreApplication::applicationDirPath());
+    m_process->setWorkingDirectory(scriptDirectory());
     m_process->start(pythonExe, QStringList() << scriptPath << args); // 这里也改用绝对路径，之前可能漏改
 
     // 超时处理（新增调试）
     if (!m_process->waitForStarted(5000)) {
         qDebug() << "多头处理Python启动失败！原因：" << m_process->errorString();
         emit errorOccurred("启动Python进程超时（多头处理）：" + m_process->errorString());
+        emit processingFinished(false, "");
+        return;
     }
 
     // 连接自定义槽函数处理多头数据结束后的逻辑
@@ -648,8 +707,9 @@ QList<QList<QList<double>>> PythonProcessor::extractMultiDataFromExcel(const QSt
     QList<QList<QList<double>>> allFilesData;
 
     for (const QString& filePath : excelPaths) {
-        QXlsx::Document xlsx(filePath);
-        if (!xlsx.load()) {
+        // 【新增】流式读取：只解码用到的 8 列、前 MAX_SCAN_ROWS 行，不构建整张表
+        QXlsx::SheetReader reader(filePath);
+        if (!reader.isLoaded()) {
             emit errorOccurred(QString("无法加载 Excel 文件: %1").arg(filePath));
             return multiData;
         }
@@ -657,8 +717,7 @@ QList<QList<QList<double>>> PythonProcessor::extractMultiDataFromExcel(const QSt
         qDebug() << "Processing file:" << filePath;
 
         // 获取第一个工作表
-        QXlsx::Worksheet* sheet = dynamic_cast<QXlsx::Worksheet*>(xlsx.sheet(xlsx.sheetNames().first()));
-        if (!sheet) {
+        if (!reader.selectSheet(0)) {
             emit errorOccurred(QString("无法获取工作表: %1").arg(filePath));
             return multiData;
         }
@@ -668,25 +727,43 @@ QList<QList<QList<double>>> PythonProcessor::extractMultiDataFromExcel(const QSt
 
         const int MAX_SCAN_ROWS = 100; // 假设数据最多在前1000行，可根据实际调整
 
+        // A、H、I、P、AM、AN、AO、AP 列
+        const QList<int> columns = {1, 8, 9, 16, 39, 40, 41, 42};
+        reader.setColumns(columns);
+        QHash<int, QHash<int, QVariant>> rows; // 行号 -> 列号 -> 值
+        while (reader.readNextRow() && reader.row() <= MAX_SCAN_ROWS) {
+            if (reader.row() < 2 || reader.lastColumn() == 0) continue;
+            QHash<int, QVariant> &cells = rows[reader.row()];
+            for (int column : columns) {
+                const QVariant value = reader.read(column);
+                if (!value.isNull()) cells.insert(column, value);
+            }
+        }
+        if (reader.hasError()) {
+            emit errorOccurred(QString("读取 Excel 文件失败: %1（%2）").arg(filePath, reader.errorString()));
+            return multiData;
+        }
+        auto cellValue = [&rows](int row, int column) { return rows.value(row).value(column); };
+
         for (double targetTemp : targetTemperatures) {
             QList<std::tuple<double, double, int, bool>> candidateRows; // 绝对值, 温度值, 行号, 是否来自A列
 
             // 扫描A列寻找目标温度点（对应AO列）
             for (int row = 2; row <= MAX_SCAN_ROWS; ++row) {
-                std::shared_ptr<QXlsx::Cell> cellA = sheet->cellAt(row, 1); // A列
-                if (!cellA || cellA->value().toString().isEmpty()) {
+                const QVariant cellA = cellValue(row, 1); // A列
+                if (cellA.toString().isEmpty()) {
                     continue; // 遇到空行不停止，继续扫描
                 }
 
-                double calibTemp = cellA->value().toDouble();
+                double calibTemp = cellA.toDouble();
 
                 if (calibTemp != targetTemp) {
                     continue;
                 }
 
                 // 获取AO列值并计算绝对值
-                std::shared_ptr<QXlsx::Cell> cellAO = sheet->cellAt(row, 41); // AO列
-                double aoValue = cellAO ? cellAO->value().toDouble() : std::numeric_limits<double>::max();
+                const QVariant cellAO = cellValue(row, 41); // AO列
+                double aoValue = cellAO.isNull() ? std::numeric_limits<double>::max() : cellAO.toDouble();
                 double absValue = qAbs(aoValue);
 
                 candidateRows.append({absValue, calibTemp, row, true});
@@ -694,20 +771,20 @@ QList<QList<QList<double>>> PythonProcessor::extractMultiDataFromExcel(const QSt
 
             // 扫描I列寻找目标温度点（对应AP列）
             for (int row = 2; row <= MAX_SCAN_ROWS; ++row) {
-                std::shared_ptr<QXlsx::Cell> cellI = sheet->cellAt(row, 9); // I列
-                if (!cellI || cellI->value().toString().isEmpty()) {
+                const QVariant cellI = cellValue(row, 9); // I列
+                if (cellI.toString().isEmpty()) {
                     continue; // 遇到空行不停止，继续扫描
                 }
 
-                double calibTemp = cellI->value().toDouble();
+                double calibTemp = cellI.toDouble();
 
                 if (calibTemp != targetTemp) {
                     continue;
                 }
 
                 // 获取AP列值并计算绝对值
-                std::shared_ptr<QXlsx::Cell> cellAP = sheet->cellAt(row, 42); // AP列
-                double apValue = cellAP ? cellAP->value().toDouble() : std::numeric_limits<double>::max();
+                const QVariant cellAP = cellValue(row, 42); // AP列
+                double apValue = cellAP.isNull() ? std::numeric_limits<double>::max() : cellAP.toDouble();
                 double absValue = qAbs(apValue);
 
                 candidateRows.append({absValue, calibTemp, row, false});
@@ -740,24 +817,14 @@ QList<QList<QList<double>>> PythonProcessor::extractMultiDataFromExcel(const QSt
 
             if (fromAColumn) {
                 // 从A列提取
-                std::shared_ptr<QXlsx::Cell> cellH = sheet->cellAt(rowNum, 8); // H列
-                if (cellH) standardTemp = cellH->value().toDouble();
-
-                std::shared_ptr<QXlsx::Cell> cellAM = sheet->cellAt(rowNum, 39); // AM列(39)
-                if (cellAM) measuredTemp = cellAM->value().toDouble();
-
-                std::shared_ptr<QXlsx::Cell> cellAO = sheet->cellAt(rowNum, 41); // AO列(41)
-                if (cellAO) error = cellAO->value().toDouble();
+                standardTemp = cellValue(rowNum, 8).toDouble();  // H列
+                measuredTemp = cellValue(rowNum, 39).toDouble(); // AM列(39)
+                error = cellValue(rowNum, 41).toDouble();        // AO列(41)
             } else {
                 // 从I列提取
-                std::shared_ptr<QXlsx::Cell> cellP = sheet->cellAt(rowNum, 16); // P列(16)
-                if (cellP) standardTemp = cellP->value().toDouble();
-
-                std::shared_ptr<QXlsx::Cell> cellAN = sheet->cellAt(rowNum, 40); // AN列(40)
-                if (cellAN) measuredTemp = cellAN->value().toDouble();
-
-                std::shared_ptr<QXlsx::Cell> cellAP = sheet->cellAt(rowNum, 42); // AP列(42)
-                if (cellAP) error = cellAP->value().toDouble();
+                standardTemp = cellValue(rowNum, 16).toDouble(); // P列(16)
+                measuredTemp = cellValue(rowNum, 40).toDouble(); // AN列(40)
+                error = cellValue(rowNum, 42).toDouble();        // AP列(42)
             }
 
             // 存储当前温度点的四个值: 校准温度, 标准温度, 测量温度, 误差
@@ -1316,36 +1383,42 @@ QDateTime PythonProcessor::extractLatestDateFromMergedFile()
         return QDateTime::currentDateTime();
     }
 
-    // 加载合并后的Excel文件
-    QXlsx::Document doc(m_mergedFilePath);
-    if (!doc.load()) {
+    // 【新增】流式读取合并后的Excel文件，只解码B列，不构建整张表
+    QXlsx::SheetReader reader(m_mergedFilePath);
+    if (!reader.isLoaded()) {
         qDebug() << "合并文件加载失败:" << m_mergedFilePath;
         return QDateTime::currentDateTime();
     }
+    reader.setColumns({2}); // B列是第2列（列号从1开始）
 
     // 遍历所有工作表（跳过"标准"工作表）
-    foreach (const QString& sheetName, doc.sheetNames()) {
+    foreach (const QString& sheetName, reader.sheetNames()) {
         if (sheetName == "标准") continue;
+        if (!reader.selectSheet(sheetName)) continue;
 
-        doc.selectSheet(sheetName);
-        int lastRow = doc.dimension().lastRow();  // 获取当前工作表最后一行
-
-        // 从第2行开始读取B列（第2列）日期
-        for (int row = 2; row <= lastRow; ++row) {
-            QVariant dateVar = doc.read(row, 2);  // B列是第2列（列号从1开始）
+        // 从第2行开始读取B列日期
+        while (reader.readNextRow()) {
+            if (reader.row() < 2) continue;
+            QVariant dateVar = reader.read(2);
             if (dateVar.isNull()) continue;
 
-            // 解析日期（支持多种格式）
+            // 日期格式的单元格已解码为 QDateTime/QDate，其余按文本解析（支持多种格式）
             QDateTime currentDate;
-            QString dateStr = dateVar.toString().trimmed();
-            QList<QString> formats = {
-                "yyyy-MM-dd", "yyyy/MM/dd", "yyyyMMdd",
-                "yyyy-MM-dd hh:mm:ss", "yyyy/MM/dd hh:mm:ss", "yyyyMMddhhmmss"
-            };
-
-            foreach (const QString& format, formats) {
-                currentDate = QDateTime::fromString(dateStr, format);
-                if (currentDate.isValid()) break;
+            if (dateVar.userType() == QMetaType::QDateTime) {
+                currentDate = dateVar.toDateTime();
+            } else if (dateVar.userType() == QMetaType::QDate) {
+                currentDate = QDateTime(dateVar.toDate(), QTime(0, 0));
+            } else {
+                QString dateStr = dateVar.toString().trimmed();
+                QList<QString> formats = {
+                    "yyyy-MM-dd", "yyyy/MM/dd", "yyyyMMdd",
+                    "yyyy-MM-dd hh:mm:ss", "yyyy/MM/dd hh:mm:ss", "yyyyMMddhhmmss"
+                };
+
+                foreach (const QString& format, formats) {
+                    currentDate = QDateTime::fromString(dateStr, format);
+                    if (currentDate.isValid()) break;
+                }
             }
 
             // 更新最新日期
@@ -5,6 +5,7 @@
 #include <QProcess>
 #include <QFileInfo>
 #include <xlsxdocument.h>
+#include "jobqueue.h"
 
 class PythonProcessor : public QObject
 {
@@ -18,6 +19,15 @@ public:
 
     void startMultiProcessing(const QString& inputFilePath, const QString& nid);
 
+    // 提交一个拟合任务（拟合 + 证书），返回任务编号；多头模板按文件名提取 NID
+    int submitFittingJob(JobQueue *queue, const QString& templatePath, bool multiHead,
+                         JobQueue::Priority priority = JobQueue::LowPriority);
+    // 任务分组，默认 "python"；批处理程序每个数据集一个处理器、一个分组
+    void setJobGroup(const QString& group) { m_jobGroup = group; }
+    // DNH.py、run.py 所在目录，默认程序所在目录
+    void setScriptDirectory(const QString& dir) { m_scriptDirectory = dir; }
+    QString scriptDirectory() const;
+
     void generateEnergyConfigCommand(const QString& deviceNumber); // 新增命令生成函数
 
     // 新增：生成能量配置命令（带系数参数）
@@ -83,6 +93,8 @@ private:
     QString m_testerName;
     QString m_reviewerName;
     QString m_mergedFilePath;
+    QString m_jobGroup = "python";
+    QString m_scriptDirectory;
 };
 
 #endif // PYTHONPROCESSOR_H
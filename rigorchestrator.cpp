@@ -0,0 +1,310 @@
+#include "rigorchestrator.h"
+#include <QDebug>
+
+namespace {
+
+QVector<float> parsePoints(const QString &text)
+{
+    QVector<float> points;
+    for (const QString &part : QString(text).remove('"').split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        float value = part.trimmed().toFloat(&ok);
+        if (ok) points.append(value);
+    }
+    return points;
+}
+
+} // namespace
+
+// ===================== RigConfig =====================
+QVector<SensorTask> RigConfig::parseTaskQueue(const QString &mapping)
+{
+    QVector<SensorTask> tasks;
+    for (const QString &pair : QString(mapping).remove('"').split(',', Qt::SkipEmptyParts)) {
+        QStringList parts = pair.split('-');
+        if (parts.size() != 2) continue;
+        bool ok = false;
+        int pos = parts[0].trimmed().toInt(&ok);
+        if (ok && pos >= 1 && pos <= 10) {
+            tasks.append({parts[1].trimmed(), pos});
+        } else {
+            qWarning() << "忽略无效的位置配置:" << pair;
+        }
+    }
+    return tasks;
+}
+
+RigConfig RigConfig::fromSettings(QSettings &settings, const QString &group)
+{
+    RigConfig config;
+    settings.beginGroup(group);
+    config.id = group;
+    config.name = settings.value("name", group).toString();
+    config.blackbodyPort = settings.value("blackbody_port").toString();
+    config.chamberPort = settings.value("chamber_port").toString();
+    config.servoPort = settings.value("servo_port").toString();
+    config.blackbodySlave = quint8(settings.value("blackbody_slave", 0x02).toInt());
+    config.chamberSlave = quint8(settings.value("chamber_slave", 0x03).toInt());
+    config.tasks = parseTaskQueue(settings.value("com_ports").toString());
+    config.envType = settings.value("env_type", "箱内").toString();
+    config.modelingPoints = parsePoints(settings.value("modeling_points").toString());
+    config.verifyPoints = parsePoints(settings.value("verify_points").toString());
+    config.planFile = settings.value("plan_file").toString().trimmed();
+    config.pipelineLeadSec = settings.value("pipeline_lead_sec", 0).toInt();
+    settings.endGroup();
+    return config;
+}
+
+// ===================== RigContext =====================
+RigContext::RigContext(const RigConfig &config, IrDataHub *hub, QObject *parent)
+    : QObject(parent), m_config(config), m_ownsDevices(true)
+{
+    m_blackbody = new BlackbodyController(this);
+    m_chamber = new HumidityController(this);
+    m_servo = new ServoMotorController(this);
+    m_blackbody->setSlaveAddress(config.blackbodySlave);
+    m_chamber->setSlaveAddress(config.chamberSlave);
+
+    m_manager = new CalibrationManager(m_blackbody, m_chamber, this);
+    m_manager->setServoController(m_servo);
+    m_manager->setPipelineLeadTime(config.pipelineLeadSec);
+    connect(m_manager, &CalibrationManager::requestIrAverage, hub, &IrDataHub::serveRequest);
+
+    m_status.name = config.name;
+    trackManager();
+}
+
+RigContext::RigContext(const QString &name, CalibrationManager *manager, QObject *parent)
+    : QObject(parent), m_manager(manager)
+{
+    m_config.id = "primary";
+    m_config.name = name;
+    m_status.name = name;
+    trackManager();
+}
+
+void RigContext::trackManager()
+{
+    connect(m_manager, &CalibrationManager::stateChanged, this, [this](CalibrationManager::State state) {
+        m_status.state = state;
+        if (state == CalibrationManager::Running && !m_status.startTime.isValid()) {
+            m_status.startTime = m_manager->clock()->now();
+        } else if (state == CalibrationManager::Idle) {
+            m_status.startTime = QDateTime();
+        }
+        emit statusChanged();
+    });
+    connect(m_manager, &CalibrationManager::currentOperationChanged, this, [this](const QString &operation) {
+        m_status.operation = operation;
+        emit statusChanged();
+    });
+    connect(m_manager, &CalibrationManager::calibrationProgress, this, [this](int progress) {
+        m_status.progress = progress;
+        emit statusChanged();
+    });
+    connect(m_manager, &CalibrationManager::planEstimateUpdated, this, [this](double totalSec, const QStringList &) {
+        m_status.expectedSec = totalSec;
+        emit statusChanged();
+    });
+}
+
+bool RigContext::connectDevices(QString *error)
+{
+    if (!m_ownsDevices) return true;
+
+    if (!m_blackbody->isConnected() && !m_blackbody->connectDevice(m_config.blackbodyPort)) {
+        if (error) *error = QString("%1：黑体炉连接失败 (%2)").arg(m_config.name, m_config.blackbodyPort);
+        return false;
+    }
+    if (!m_chamber->isConnected() && !m_chamber->connectDevice(m_config.chamberPort)) {
+        if (error) *error = QString("%1：恒温箱连接失败 (%2)").arg(m_config.name, m_config.chamberPort);
+        return false;
+    }
+    if (!m_servo->isConnected() && !m_servo->connectDevice(m_config.servoPort)) {
+        if (error) *error = QString("%1：伺服电机连接失败 (%2)").arg(m_config.name, m_config.servoPort);
+        return false;
+    }
+    // 轮询周期由 CalibrationManager 按测量阶段切换
+    m_blackbody->setPollingEnabled(true);
+    m_chamber->setPollingEnabled(true);
+    return true;
+}
+
+bool RigContext::start(const QVector<float> &modelingPoints, const QVector<float> &verifyPoints, QString *error)
+{
+    if (!m_ownsDevices) return false;
+    if (m_manager->getCurrentState() != CalibrationManager::Idle) {
+        if (error) *error = QString("%1：标校正在进行中").arg(m_config.name);
+        return false;
+    }
+    if (m_config.tasks.isEmpty()) {
+        if (error) *error = QString("%1：未配置测温仪机位 (com_ports)").arg(m_config.name);
+        return false;
+    }
+    if (!connectDevices(error)) return false;
+
+    if (m_config.planFile.isEmpty()) {
+        m_manager->clearPlan();
+    } else {
+        CalibrationPlan plan;
+        QString planError;
+        if (!CalibrationPlan::loadFromFile(m_config.planFile, &plan, &planError)) {
+            if (error) *error = QString("%1：%2").arg(m_config.name, planError);
+            return false;
+        }
+        m_manager->setPlan(plan);
+    }
+
+    bool useConfigPoints = !m_config.modelingPoints.isEmpty() || !m_config.verifyPoints.isEmpty();
+    QVector<float> modPoints = useConfigPoints ? m_config.modelingPoints : modelingPoints;
+    QVector<float> verPoints = useConfigPoints ? m_config.verifyPoints : verifyPoints;
+
+    // 恒温箱温度点规则与主窗口一致：箱内跟随黑体炉，箱外固定 25℃
+    QVector<float> humidityPoints;
+    bool isInside = (m_config.envType == "箱内");
+    for (float t : modPoints + verPoints) {
+        humidityPoints.append(isInside ? t : 25.0f);
+    }
+
+    m_manager->setMeasurementQueue(m_config.tasks);
+    m_manager->startCalibration(modPoints, verPoints, humidityPoints, m_config.envType);
+    return true;
+}
+
+void RigContext::pause()
+{
+    if (m_manager->getCurrentState() == CalibrationManager::Running) m_manager->pauseCalibration();
+}
+
+void RigContext::resume()
+{
+    if (m_manager->getCurrentState() == CalibrationManager::Paused) m_manager->resumeCalibration();
+}
+
+void RigContext::cancel()
+{
+    CalibrationManager::State state = m_manager->getCurrentState();
+    if (state == CalibrationManager::Running || state == CalibrationManager::Paused) {
+        m_manager->cancelCalibration();
+    }
+}
+
+// ===================== RigOrchestrator =====================
+RigOrchestrator::RigOrchestrator(IrDataHub *hub, QObject *parent)
+    : QObject(parent), m_hub(hub)
+{
+}
+
+void RigOrchestrator::addRig(RigContext *rig)
+{
+    int index = m_rigs.size();
+    m_rigs.append(rig);
+    connect(rig, &RigContext::statusChanged, this, [this, index]() {
+        emit rigStatusChanged(index);
+    });
+}
+
+int RigOrchestrator::loadFromSettings(QSettings &settings)
+{
+    QStringList names = settings.value("rigs/names").toString().remove('"').split(',', Qt::SkipEmptyParts);
+    int loaded = 0;
+    for (QString group : names) {
+        group = group.trimmed();
+        RigConfig config = RigConfig::fromSettings(settings, group);
+        if (config.blackbodyPort.isEmpty() || config.chamberPort.isEmpty() || config.servoPort.isEmpty()) {
+            qWarning() << "台架" << group << "缺少设备端口配置，已忽略";
+            continue;
+        }
+        addRig(new RigContext(config, m_hub, this));
+        ++loaded;
+    }
+    return loaded;
+}
+
+RigContext *RigOrchestrator::addPrimaryRig(const QString &name, CalibrationManager *manager)
+{
+    RigContext *rig = new RigContext(name, manager, this);
+    addRig(rig);
+    return rig;
+}
+
+int RigOrchestrator::secondaryRigCount() const
+{
+    int count = 0;
+    for (RigContext *rig : m_rigs) {
+        if (rig->ownsDevices()) ++count;
+    }
+    return count;
+}
+
+QStringList RigOrchestrator::irPorts() const
+{
+    QStringList ports;
+    for (RigContext *rig : m_rigs) {
+        for (const SensorTask &task : rig->config().tasks) {
+            if (!ports.contains(task.comPort)) ports.append(task.comPort);
+        }
+    }
+    return ports;
+}
+
+bool RigOrchestrator::startRig(int index, const QVector<float> &modelingPoints, const QVector<float> &verifyPoints,
+                               QString *error)
+{
+    RigContext *target = rig(index);
+    if (!target) return false;
+    if (!target->ownsDevices()) {
+        emit primaryStartRequested();
+        return true;
+    }
+    return target->start(modelingPoints, verifyPoints, error);
+}
+
+void RigOrchestrator::pauseRig(int index)
+{
+    if (RigContext *target = rig(index)) target->pause();
+}
+
+void RigOrchestrator::resumeRig(int index)
+{
+    if (RigContext *target = rig(index)) target->resume();
+}
+
+void RigOrchestrator::cancelRig(int index)
+{
+    if (RigContext *target = rig(index)) target->cancel();
+}
+
+QStringList RigOrchestrator::startSecondaryRigs(const QVector<float> &modelingPoints, const QVector<float> &verifyPoints)
+{
+    QStringList errors;
+    for (RigContext *rig : qAsConst(m_rigs)) {
+        if (!rig->ownsDevices()) continue;
+        QString error;
+        if (!rig->start(modelingPoints, verifyPoints, &error)) {
+            errors.append(error);
+        }
+    }
+    return errors;
+}
+
+void RigOrchestrator::pauseSecondaryRigs()
+{
+    for (RigContext *rig : qAsConst(m_rigs)) {
+        if (rig->ownsDevices()) rig->pause();
+    }
+}
+
+void RigOrchestrator::resumeSecondaryRigs()
+{
+    for (RigContext *rig : qAsConst(m_rigs)) {
+        if (rig->ownsDevices()) rig->resume();
+    }
+}
+
+void RigOrchestrator::cancelSecondaryRigs()
+{
+    for (RigContext *rig : qAsConst(m_rigs)) {
+        if (rig->ownsDevices()) rig->cancel();
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef RIGORCHESTRATOR_H
+#define RIGORCHESTRATOR_H
+
+#include <QObject>
+#include <QSettings>
+#include <QVector>
+#include "calibrationmanager.h"
+#include "irdatahub.h"
+
+// 单个台架的配置，对应 config.ini 中的一个节，例如：
+// [rigs]
+// names=rig2,rig3
+// [rig2]
+// name=2号台架
+// blackbody_port=COM20
+// chamber_port=COM21        ; 与 blackbody_port 相同时两台设备共用一条 RS-485 总线
+// blackbody_slave=2
+// chamber_slave=3
+// servo_port=COM22
+// com_ports="1-COM30,2-COM31"
+// env_type=箱内
+// modeling_points="-20,0,20"     ; 为空时沿用界面输入的温度点
+// verify_points="10"
+// plan_file=plans/default_plan.json
+// pipeline_lead_sec=120
+struct RigConfig {
+    QString id;
+    QString name;
+    QString blackbodyPort;
+    QString chamberPort;
+    QString servoPort;
+    quint8 blackbodySlave = 0x02;
+    quint8 chamberSlave = 0x03;
+    QVector<SensorTask> tasks;
+    QString envType = "箱内";
+    QVector<float> modelingPoints;
+    QVector<float> verifyPoints;
+    QString planFile;
+    int pipelineLeadSec = 0;
+
+    static RigConfig fromSettings(QSettings &settings, const QString &group);
+    // 解析 "1-COM3,2-COM4" 形式的机位配置
+    static QVector<SensorTask> parseTaskQueue(const QString &mapping);
+};
+
+// 一个台架：独立的黑体炉、恒温箱、转台、CalibrationManager 和流程
+class RigContext : public QObject
+{
+    Q_OBJECT
+public:
+    struct Status {
+        QString name;
+        CalibrationManager::State state = CalibrationManager::Idle;
+        QString operation;
+        int progress = 0;
+        double expectedSec = 0.0;   // 本次标校预计总耗时
+        QDateTime startTime;
+    };
+
+    // 按配置创建并拥有一套设备
+    RigContext(const RigConfig &config, IrDataHub *hub, QObject *parent = nullptr);
+    // 包装主窗口已有的台架（不拥有设备）
+    RigContext(const QString &name, CalibrationManager *manager, QObject *parent = nullptr);
+
+    const RigConfig &config() const { return m_config; }
+    CalibrationManager *manager() const { return m_manager; }
+    // 仅 ownsDevices() 时有效
+    BlackbodyController *blackbody() const { return m_blackbody; }
+    HumidityController *chamber() const { return m_chamber; }
+    bool ownsDevices() const { return m_ownsDevices; }
+    Status status() const { return m_status; }
+
+    bool connectDevices(QString *error);
+    // modelingPoints/verifyPoints 在配置中未指定温度点时使用；主台架由主窗口启动，这里返回 false
+    bool start(const QVector<float> &modelingPoints, const QVector<float> &verifyPoints, QString *error);
+    // 以下对主台架同样有效，状态不符时不做任何事
+    void pause();
+    void resume();
+    void cancel();
+
+signals:
+    void statusChanged();
+
+private:
+    void trackManager();
+
+    RigConfig m_config;
+    bool m_ownsDevices = false;
+    BlackbodyController *m_blackbody = nullptr;
+    HumidityController *m_chamber = nullptr;
+    ServoMotorController *m_servo = nullptr;
+    CalibrationManager *m_manager = nullptr;
+    Status m_status;
+};
+
+// 多台架调度：同一进程内并行运行多个台架，共用红外数据汇聚，并向总览界面汇报
+class RigOrchestrator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RigOrchestrator(IrDataHub *hub, QObject *parent = nullptr);
+
+    // 读取 [rigs] names 下列出的台架，返回加载数量
+    int loadFromSettings(QSettings &settings);
+    RigContext *addPrimaryRig(const QString &name, CalibrationManager *manager);
+
+    const QVector<RigContext *> &rigs() const { return m_rigs; }
+    RigContext *rig(int index) const { return (index >= 0 && index < m_rigs.size()) ? m_rigs[index] : nullptr; }
+    int secondaryRigCount() const;
+    // 附加台架的测温仪 COM 口（需要一并创建串口线程）
+    QStringList irPorts() const;
+
+    // 单个台架的控制；主台架需要界面上的温度点和计划，startRig 对它只发出 primaryStartRequested
+    bool startRig(int index, const QVector<float> &modelingPoints, const QVector<float> &verifyPoints, QString *error);
+    void pauseRig(int index);
+    void resumeRig(int index);
+    void cancelRig(int index);
+
+    // 主台架由主窗口控制，以下操作只作用于附加台架
+    QStringList startSecondaryRigs(const QVector<float> &modelingPoints, const QVector<float> &verifyPoints);
+    void pauseSecondaryRigs();
+    void resumeSecondaryRigs();
+    void cancelSecondaryRigs();
+
+signals:
+    void rigStatusChanged(int index);
+    void primaryStartRequested();
+
+private:
+    void addRig(RigContext *rig);
+
+    IrDataHub *m_hub;
+    QVector<RigContext *> m_rigs;
+};
+
+#endif // RIGORCHESTRATOR_H
@@ -0,0 +1,140 @@
+#include "rigoverviewwidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+
+RigOverviewWidget::RigOverviewWidget(RigOrchestrator *orchestrator, QWidget *parent)
+    : QWidget(parent), m_orchestrator(orchestrator)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(10, 10, 10, 10);
+
+    m_table = new QTableWidget(this);
+    m_table->setColumnCount(5);
+    m_table->setHorizontalHeaderLabels({"台架", "状态", "当前操作", "进度", "预计剩余"});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setAlternatingRowColors(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
+    layout->addWidget(m_table);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    m_startButton = new QPushButton("启动", this);
+    m_pauseResumeButton = new QPushButton("暂停", this);
+    m_cancelButton = new QPushButton("取消", this);
+    buttons->addStretch();
+    buttons->addWidget(m_startButton);
+    buttons->addWidget(m_pauseResumeButton);
+    buttons->addWidget(m_cancelButton);
+    layout->addLayout(buttons);
+
+    connect(m_startButton, &QPushButton::clicked, this, [this]() {
+        int index = selectedRig();
+        if (index >= 0) emit startRequested(index);
+    });
+    connect(m_pauseResumeButton, &QPushButton::clicked, this, &RigOverviewWidget::onPauseResumeClicked);
+    connect(m_cancelButton, &QPushButton::clicked, this, &RigOverviewWidget::onCancelClicked);
+    connect(m_table, &QTableWidget::itemSelectionChanged, this, &RigOverviewWidget::updateButtons);
+
+    connect(m_orchestrator, &RigOrchestrator::rigStatusChanged, this, &RigOverviewWidget::refreshRow);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &RigOverviewWidget::refreshAll);
+    m_refreshTimer->start();
+
+    refreshAll();
+    updateButtons();
+}
+
+QString RigOverviewWidget::stateText(CalibrationManager::State state)
+{
+    switch (state) {
+    case CalibrationManager::Idle:      return "空闲";
+    case CalibrationManager::Running:   return "运行中";
+    case CalibrationManager::Paused:    return "已暂停";
+    case CalibrationManager::Canceling: return "取消中";
+    case CalibrationManager::Finished:  return "已完成";
+    }
+    return "未知";
+}
+
+void RigOverviewWidget::refreshAll()
+{
+    const auto &rigs = m_orchestrator->rigs();
+    if (m_table->rowCount() != rigs.size()) m_table->setRowCount(rigs.size());
+    for (int i = 0; i < rigs.size(); ++i) refreshRow(i);
+}
+
+int RigOverviewWidget::selectedRig() const
+{
+    const QList<QTableWidgetSelectionRange> ranges = m_table->selectedRanges();
+    return ranges.isEmpty() ? -1 : ranges.first().topRow();
+}
+
+void RigOverviewWidget::updateButtons()
+{
+    RigContext *rig = m_orchestrator->rig(selectedRig());
+    CalibrationManager::State state = rig ? rig->manager()->getCurrentState() : CalibrationManager::Canceling;
+    m_startButton->setEnabled(rig && (state == CalibrationManager::Idle || state == CalibrationManager::Finished));
+    m_pauseResumeButton->setEnabled(rig && (state == CalibrationManager::Running || state == CalibrationManager::Paused));
+    m_pauseResumeButton->setText(state == CalibrationManager::Paused ? "继续" : "暂停");
+    m_cancelButton->setEnabled(rig && (state == CalibrationManager::Running || state == CalibrationManager::Paused));
+}
+
+void RigOverviewWidget::onPauseResumeClicked()
+{
+    int index = selectedRig();
+    RigContext *rig = m_orchestrator->rig(index);
+    if (!rig) return;
+    if (rig->manager()->getCurrentState() == CalibrationManager::Paused) {
+        m_orchestrator->resumeRig(index);
+    } else {
+        m_orchestrator->pauseRig(index);
+    }
+    updateButtons();
+}
+
+void RigOverviewWidget::onCancelClicked()
+{
+    int index = selectedRig();
+    RigContext *rig = m_orchestrator->rig(index);
+    if (!rig) return;
+    int reply = QMessageBox::question(this, "确认取消", QString("确定要取消 %1 的标定过程吗？").arg(rig->status().name),
+                                      QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+    if (reply == QMessageBox::Yes) m_orchestrator->cancelRig(index);
+    updateButtons();
+}
+
+void RigOverviewWidget::refreshRow(int index)
+{
+    const auto &rigs = m_orchestrator->rigs();
+    if (index < 0 || index >= rigs.size()) return;
+    if (m_table->rowCount() != rigs.size()) m_table->setRowCount(rigs.size());
+
+    RigContext::Status status = rigs[index]->status();
+
+    QString remaining = "-";
+    if (status.state == CalibrationManager::Running && status.startTime.isValid() && status.expectedSec > 0) {
+        qint64 elapsed = status.startTime.secsTo(rigs[index]->manager()->clock()->now());
+        qint64 left = qMax<qint64>(0, qint64(status.expectedSec) - elapsed);
+        remaining = QString("%1:%2:%3").arg(left / 3600).arg(left / 60 % 60, 2, 10, QChar('0'))
+                        .arg(left % 60, 2, 10, QChar('0'));
+    }
+
+    const QStringList cells = {status.name, stateText(status.state), status.operation,
+                               QString("%1%").arg(status.progress), remaining};
+    for (int col = 0; col < cells.size(); ++col) {
+        QTableWidgetItem *item = m_table->item(index, col);
+        if (!item) {
+            item = new QTableWidgetItem();
+            m_table->setItem(index, col, item);
+        }
+        item->setText(cells[col]);
+    }
+    if (index == selectedRig()) updateButtons();
+}
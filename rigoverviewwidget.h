@@ -0,0 +1,41 @@
+#ifndef RIGOVERVIEWWIDGET_H
+#define RIGOVERVIEWWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QTimer>
+#include <QPushButton>
+#include "rigorchestrator.h"
+
+// 多台架总览：每行一个台架，显示状态、当前操作、进度和预计剩余时间；
+// 下方按钮对选中的台架单独启动、暂停/继续、取消
+class RigOverviewWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit RigOverviewWidget(RigOrchestrator *orchestrator, QWidget *parent = nullptr);
+
+signals:
+    // 启动需要界面上的温度点，由主窗口调用 RigOrchestrator::startRig
+    void startRequested(int index);
+
+private slots:
+    void refreshRow(int index);
+    void refreshAll();
+    void updateButtons();
+    void onPauseResumeClicked();
+    void onCancelClicked();
+
+private:
+    static QString stateText(CalibrationManager::State state);
+    int selectedRig() const;
+
+    RigOrchestrator *m_orchestrator;
+    QTableWidget *m_table;
+    QPushButton *m_startButton;
+    QPushButton *m_pauseResumeButton;
+    QPushButton *m_cancelButton;
+    QTimer *m_refreshTimer; // 每秒刷新剩余时间
+};
+
+#endif // RIGOVERVIEWWIDGET_H
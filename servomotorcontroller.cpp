@@ -1,13 +1,41 @@
 #include "servomotorcontroller.h"
-#include <QThread>
-#include <QCoreApplication>
+#include <cmath>
+
+namespace {
+const int kCommandGapMs = 20;      // 两条指令之间的最小间隔，防止粘包
+const int kReplyTimeoutMs = 300;   // 单条指令应答超时
+const int kPollIntervalMs = 100;   // 预计到位附近的位置查询间隔
+const int kPollLeadMs = 300;       // 提前于预计到位时刻开始查询
+const int kDrainQuietMs = 150;     // 超时后线路须静默这么久才发下一条，迟到的应答在此期间丢弃
+const int kDrainMaxMs = 1000;      // 静默等待的上限，线路持续有杂散数据时也不无限推迟
+}
 
 ServoMotorController::ServoMotorController(QObject *parent)
     : QObject(parent), m_serial(new QSerialPort(this)), m_pollTimer(new QTimer(this))
 {
-    // 配置轮询定时器，用于检查电机是否到位
-    m_pollTimer->setInterval(200);
+    // 指令节拍与应答超时
+    m_pacingTimer = new QTimer(this);
+    m_pacingTimer->setSingleShot(true);
+    connect(m_pacingTimer, &QTimer::timeout, this, &ServoMotorController::sendNextCommand);
+    m_replyTimer = new QTimer(this);
+    m_replyTimer->setSingleShot(true);
+    connect(m_replyTimer, &QTimer::timeout, this, &ServoMotorController::onReplyTimeout);
+
+    // 配置轮询定时器，用于检查电机是否到位：运动开始后先按速度曲线等到预计到位前，再密集查询
+    m_pollTimer->setInterval(kPollIntervalMs);
     connect(m_pollTimer, &QTimer::timeout, this, &ServoMotorController::checkPositionStatus);
+    // 空闲时定期读回实际位置
+    m_resyncTimer = new QTimer(this);
+    m_resyncTimer->setInterval(60000);
+    connect(m_resyncTimer, &QTimer::timeout, this, &ServoMotorController::resyncPosition);
+
+    m_arrivalTimer = new QTimer(this);
+    m_arrivalTimer->setSingleShot(true);
+    connect(m_arrivalTimer, &QTimer::timeout, this, [this]() {
+        if (!m_isMoving) return;
+        checkPositionStatus();
+        m_pollTimer->start();
+    });
     connect(m_serial, &QSerialPort::readyRead, this, &ServoMotorController::onDataReceived);
 
     // 【新增】超时定时器：防止电机到位了但软件没识别到
@@ -17,8 +45,10 @@ ServoMotorController::ServoMotorController(QObject *parent)
         if(m_isMoving) {
             m_isMoving = false;
             m_pollTimer->stop();
+            m_arrivalTimer->stop();
             // 超时强制认为到位，保证流程不卡死
             emit logMessage("警告：电机运动等待超时，强制跳过等待");
+            resyncPosition(); // 实际位置不确定，读回校正
             emit positionReached();
         }
     });
@@ -40,6 +70,7 @@ bool ServoMotorController::connectDevice(const QString &portName, int baudRate)
 
     if (m_serial->open(QIODevice::ReadWrite)) {
         emit logMessage(QString("伺服电机连接成功: %1").arg(portName));
+        if (m_resyncTimer->interval() > 0) m_resyncTimer->start();
         return true;
     } else {
         emit errorOccurred("伺服电机串口打开失败");
@@ -49,8 +80,11 @@ bool ServoMotorController::connectDevice(const QString &portName, int baudRate)
 
 void ServoMotorController::disconnectDevice() {
     if (m_serial->isOpen()) {
-        m_serial->close();
         m_pollTimer->stop();
+        m_arrivalTimer->stop();
+        m_resyncTimer->stop();
+        clearCommandQueue();
+        m_serial->close();
     }
 }
 
@@ -58,18 +92,79 @@ bool ServoMotorController::isConnected() const {
     return m_serial && m_serial->isOpen();
 }
 
-void ServoMotorController::sendCommand(const QString &cmd) {
-    if (!isConnected()) return;
-    QByteArray data = (cmd + "\r\n").toLatin1();
-    m_serial->write(data);
-    m_serial->waitForBytesWritten(50);
-    // 稍微延时防止指令粘包
-    QThread::msleep(20);
+// 指令入队，由 sendNextCommand 按节拍发出
+void ServoMotorController::sendCommand(const QString &cmd, ReplyCallback callback, int delayAfterMs) {
+    if (!isConnected()) {
+        if (callback) callback(false, 0);
+        return;
+    }
+    m_commandQueue.enqueue({cmd, callback, delayAfterMs});
+    if (!m_inFlight && !m_pacingTimer->isActive()) {
+        m_pacingTimer->start(0);
+    }
+}
+
+void ServoMotorController::sendNextCommand() {
+    if (m_inFlight || m_commandQueue.isEmpty() || !m_serial->isOpen()) return;
+
+    m_draining = false;
+    m_current = m_commandQueue.dequeue();
+    m_inFlight = true;
+    m_serial->write((m_current.text + "\r\n").toLatin1());
+    m_replyTimer->start(kReplyTimeoutMs);
+}
+
+void ServoMotorController::finishCurrent(bool ok, qint64 value) {
+    m_replyTimer->stop();
+    m_inFlight = false;
+    Command finished = m_current;
+    m_current = Command();
+    if (!ok) m_sequenceFailed = true;
+
+    // 下一条指令按节拍发出（清零等指令需要额外等待生效；超时后至少等线路静默）
+    int gap = qMax(kCommandGapMs, finished.delayAfterMs);
+    if (m_draining) gap = qMax(gap, kDrainQuietMs);
+    m_pacingTimer->start(gap);
+    if (finished.callback) finished.callback(ok, value);
+}
+
+void ServoMotorController::onReplyTimeout() {
+    if (!m_inFlight) return;
+    emit logMessage(QString("警告：指令 \"%1\" 应答超时").arg(m_current.text));
+    // 协议应答不带序号：丢弃已收到的半行和串口缓冲，并等线路静默后再发下一条，
+    // 迟到的应答在静默期内到达时直接丢弃，不会被当成下一条指令的应答
+    m_buffer.clear();
+    m_serial->clear(QSerialPort::Input);
+    m_draining = true;
+    m_drainTimer.start();
+    finishCurrent(false, 0);
+}
+
+void ServoMotorController::clearCommandQueue() {
+    m_pacingTimer->stop();
+    m_replyTimer->stop();
+    QQueue<Command> dropped;
+    dropped.swap(m_commandQueue);
+    if (m_inFlight) {
+        dropped.prepend(m_current);
+        m_inFlight = false;
+        m_current = Command();
+    }
+    m_buffer.clear();
+    m_draining = false;
+    // 回调仍以失败结束（调用方要复位各自的等待状态），但这是主动撤销，不是驱动器没有应答
+    m_cancellingCommands = true;
+    for (const Command &cmd : dropped) {
+        if (cmd.callback) cmd.callback(false, 0);
+    }
+    m_cancellingCommands = false;
+    m_positionQueryPending = false;
 }
 
 // 【关键】发送全套初始化参数（防飞车配置）
 void ServoMotorController::initDriverParameters() {
     emit logMessage("正在初始化电机参数...");
+    m_sequenceFailed = false;
 
     sendCommand("s r0xa4 0xffff"); // 1. 先清除之前的错误
     //sendCommand("s r0xe3 100");    // 增益倍率
@@ -83,14 +178,15 @@ void ServoMotorController::initDriverParameters() {
 
     // 【修改点2】降低加速度 (让起步更柔和，防止“闪了腰”)
     // 之前是 100000，建议改小，例如 20000 或 50000
-    sendCommand("s r0xcc 20000");  // 加速度: 2000 counts/s^2
-    sendCommand("s r0xcd 20000");  // 减速度: 2000 counts/s^2
+    sendCommand(QString("s r0xcc %1").arg(m_profile.acceleration));  // 加速度，默认 20000
+    sendCommand(QString("s r0xcd %1").arg(m_profile.deceleration));  // 减速度，默认 20000
 
-    sendCommand("s r0xcb 1310720");// 最大速度
+    sendCommand(QString("s r0xcb %1").arg(m_profile.maxVelocity));   // 最大速度
     sendCommand("s r0xc8 256");    // 相对运动模式
-    sendCommand("s r0x24 21");     // 使能
-
-    emit logMessage("电机参数初始化完成");
+    sendCommand("s r0x24 21", [this](bool, qint64) {  // 使能
+        emit logMessage(m_sequenceFailed ? "电机参数初始化存在失败的指令" : "电机参数初始化完成");
+        emit driverParametersInitialized(!m_sequenceFailed);
+    });
 }
 
 // 【关键】复位零点逻辑
@@ -103,30 +199,100 @@ void ServoMotorController::resetZeroPoint() {
 
     // 1. 清除可能存在的报错 (Fault)
     // 这一步必须做，防止之前跳闸导致无法写入
-    sendCommand("s r0xa4 0xffff");
-    QThread::msleep(50);
+    sendCommand("s r0xa4 0xffff", nullptr, 50);
 
     // 2. 【核心修改】强制将电机内部的“实际位置寄存器”设为 0
     // 依据：您提供的日志证明 s r0x32 0 是有效的
-    sendCommand("s r0x32 0");
-    QThread::msleep(100); // 给一点点时间让设置生效
+    sendCommand("s r0x32 0", nullptr, 100); // 给一点点时间让设置生效
 
     // 3. (可选) 如果不放心，可以再发一次初始化参数确保电流够大
     // 但如果您之前已经发过且没掉电，这里不发也可以
     initDriverParameters();
 
-    // 4. 将软件内部的计数器也同步归零
+    // 4. 将软件内部的计数器也同步归零（后续运动指令排在复位指令之后，坐标一致）
     m_currentSoftwareCounts = 0;
     m_targetSoftwareCounts = 0;
+    m_zeroEstablished = false;
+
+    // 5. 读回确认是不是真的变0了
+    sendCommand("g r0x32", [this](bool ok, qint64 counts) {
+        bool zeroed = ok && !m_sequenceFailed && qAbs(counts) <= POSITION_TOLERANCE;
+        if (zeroed) {
+            m_lastDriverRaw = qint32(counts);
+            m_driverCounts = counts;
+            m_zeroEstablished = true;
+        }
+        emit logMessage(zeroed ? "零点复位完成：硬件坐标已强制置 0"
+                               : QString("零点复位未确认 (读回 %1)").arg(ok ? QString::number(counts) : QString("超时")));
+        emit zeroPointReset(zeroed);
+    });
+}
 
-    // 5. (可选调试) 查一下是不是真的变0了
-    // sendCommand("g r0x32");
+void ServoMotorController::loadSettings(QSettings &settings) {
+    settings.beginGroup("servo");
+    m_profile.acceleration = qMax(1, settings.value("acceleration", m_profile.acceleration).toInt());
+    m_profile.deceleration = qMax(1, settings.value("deceleration", m_profile.deceleration).toInt());
+    m_profile.maxVelocity = qMax(1, settings.value("max_velocity", m_profile.maxVelocity).toInt());
+    m_timeoutFactor = qMax(1.0, settings.value("timeout_factor", m_timeoutFactor).toDouble());
+    m_timeoutMarginMs = qMax(0, settings.value("timeout_margin_ms", m_timeoutMarginMs).toInt());
+    m_maxTurns = qMax(0, settings.value("max_turns", m_maxTurns).toInt());
+    m_resyncTimer->setInterval(qMax(0, settings.value("resync_interval_ms", m_resyncTimer->interval()).toInt()));
+    if (m_resyncTimer->interval() <= 0) m_resyncTimer->stop();
+    settings.endGroup();
+}
 
-    emit logMessage("零点复位完成：硬件坐标已强制置 0");
+int ServoMotorController::predictedMoveMs(double angle) const {
+    const double distance = qAbs(angle) / 360.0 * COUNTS_PER_REV;   // counts
+    if (distance <= 0.0) return 0;
+    const double a = m_profile.acceleration * 10.0;  // counts/s²
+    const double d = m_profile.deceleration * 10.0;
+    const double v = m_profile.maxVelocity * 0.1;    // counts/s
+
+    // 加速到最高速再减速所需的最短距离；走不满时为三角形曲线
+    const double rampDistance = v * v / (2.0 * a) + v * v / (2.0 * d);
+    double seconds;
+    if (distance >= rampDistance) {
+        seconds = v / a + v / d + (distance - rampDistance) / v;
+    } else {
+        double peak = std::sqrt(2.0 * distance * a * d / (a + d));
+        seconds = peak / a + peak / d;
+    }
+    return int(std::ceil(seconds * 1000.0));
+}
+
+int ServoMotorController::moveTimeoutMs(double angle) const {
+    return int(predictedMoveMs(angle) * m_timeoutFactor) + m_timeoutMarginMs;
+}
+
+qint64 ServoMotorController::angleToCounts(double angle) const {
+    return qRound64((angle / 360.0) * COUNTS_PER_REV);
+}
+
+double ServoMotorController::shortestRotation(double fromAngle, double toAngle) {
+    double delta = std::fmod(toAngle - fromAngle, 360.0);
+    if (delta > 180.0) delta -= 360.0;
+    else if (delta <= -180.0) delta += 360.0;
+    return delta;
 }
 
-int ServoMotorController::angleToCounts(double angle) {
-    return static_cast<int>((angle / 360.0) * COUNTS_PER_REV);
+qint64 ServoMotorController::plannedMoveCounts(qint64 fromCounts, double targetAngle) const {
+    // 目标取圈内位置，当前位置也取圈内余数，先按最短方向
+    const qint64 rev = COUNTS_PER_REV;
+    qint64 target = angleToCounts(std::fmod(targetAngle, 360.0));
+    qint64 current = fromCounts % rev;
+    qint64 delta = (target - current) % rev;
+    if (delta > rev / 2) delta -= rev;
+    else if (delta <= -rev / 2) delta += rev;
+
+    // 超出允许的圈数时反向走（防止线缆越缠越多）
+    if (m_maxTurns > 0 && qAbs(fromCounts + delta) > m_maxTurns * rev) {
+        delta += (delta > 0) ? -rev : rev;
+    }
+    return delta;
+}
+
+double ServoMotorController::plannedMoveAngleFrom(double fromAngle, double targetAngle) const {
+    return double(plannedMoveCounts(angleToCounts(fromAngle), targetAngle)) / COUNTS_PER_REV * 360.0;
 }
 
 double ServoMotorController::currentAngle() const {
@@ -136,8 +302,12 @@ double ServoMotorController::currentAngle() const {
 // 纯相对运动指令
 void ServoMotorController::moveRelative(double angle) {
     if (!isConnected()) return;
+    moveRelativeCounts(angleToCounts(angle));
+}
+
+void ServoMotorController::moveRelativeCounts(qint64 counts) {
+    if (!isConnected()) return;
 
-    int counts = angleToCounts(angle);
     if (counts == 0) {
         emit positionReached();
         return;
@@ -146,60 +316,133 @@ void ServoMotorController::moveRelative(double angle) {
     // 1. 设置相对位移量
     sendCommand(QString("s r0xca %1").arg(counts));
 
-    // 2. 触发运动
-    sendCommand("t 1");
+    // 2. 触发运动，驱动器确认后按预测时间安排位置查询
+    const double angle = double(counts) / COUNTS_PER_REV * 360.0;
+    const int predictedMs = predictedMoveMs(angle);
+    sendCommand("t 1", [this, predictedMs](bool ok, qint64) {
+        if (!ok) {
+            // 急停、断开时排队的运动指令被撤销，不算错误
+            if (!m_cancellingCommands) emit errorOccurred("伺服电机运动指令未被确认");
+            return;
+        }
+        if (!m_isMoving) return;
+        m_arrivalTimer->start(qMax(0, predictedMs - kPollLeadMs));
+        emit moveStarted(predictedMs);
+    });
 
     // 3. 更新目标位置
     m_currentSoftwareCounts += counts;
     m_targetSoftwareCounts = m_currentSoftwareCounts;
 
     m_isMoving = true;
-    m_pollTimer->start();
+    if (m_resyncTimer->isActive()) m_resyncTimer->start(); // 运动期间不做空闲校正，重新计时
 
-    // 【修改点】启动超时定时器 (例如 20秒，根据电机转速调整)
+    // 【修改点】启动超时定时器（按速度曲线预测时间推算，见 moveTimeoutMs）
     // 防止电机实际动了但串口没收到反馈导致死锁
-    if(m_timeoutTimer) m_timeoutTimer->start(20000);
+    if(m_timeoutTimer) m_timeoutTimer->start(moveTimeoutMs(angle));
 
-    emit logMessage(QString("电机相对运动: %1度 (%2 counts)").arg(angle).arg(counts));
+    emit logMessage(QString("电机相对运动: %1度 (%2 counts)，预计 %3 ms").arg(angle).arg(counts).arg(predictedMs));
 }
 
-// 通过相对运动模拟绝对定位
+// 通过相对运动实现绝对定位：圈内目标角度，最短方向
 void ServoMotorController::moveToAbsolute(double targetAngle) {
-    // 1. 计算当前角度
-    double currAngle = currentAngle();
+    qint64 delta = plannedMoveCounts(m_currentSoftwareCounts, targetAngle);
 
-    // 2. 计算差值
-    double delta = targetAngle - currAngle;
-
-    // 3. 执行相对运动
-    if (qAbs(delta) > 0.01) {
-        moveRelative(delta);
+    if (qAbs(delta) > angleToCounts(0.01)) {
+        moveRelativeCounts(delta);
     } else {
         emit positionReached();
     }
 }
 
-// 回零：计算反向距离并回退
+// 回零：按最短方向回到 0 点
 void ServoMotorController::moveToZero() {
     moveToAbsolute(0.0);
 }
 
 void ServoMotorController::stop() {
+    clearCommandQueue();      // 急停优先于所有排队指令
     sendCommand("s r0x24 0"); // 去能/停止
     m_isMoving = false;
     m_pollTimer->stop();
+    m_arrivalTimer->stop();
     if(m_timeoutTimer) m_timeoutTimer->stop(); // 【新增】
+    // 中途急停时软件位置停在目标上，立即读回实际位置
+    resyncPosition();
 }
 
 void ServoMotorController::checkPositionStatus() {
-    // 查询实际位置 (0x32)
-    sendCommand("g r0x32");
+    // 查询实际位置 (0x32)；上一次查询未返回时不重复排队
+    if (m_positionQueryPending) return;
+    m_positionQueryPending = true;
+    sendCommand("g r0x32", [this](bool ok, qint64 counts) {
+        m_positionQueryPending = false;
+        if (ok) handlePosition(counts);
+    });
+}
+
+qint64 ServoMotorController::unwrapDriverCounts(qint64 raw) {
+    // r0x32 为 32 位有符号数：按与上次读数的差值（模 2^32）累加，跨越回绕点也连续
+    qint32 current = qint32(raw);
+    qint32 step = qint32(quint32(current) - quint32(m_lastDriverRaw));
+    m_lastDriverRaw = current;
+    m_driverCounts += step;
+    return m_driverCounts;
+}
+
+void ServoMotorController::resyncPosition() {
+    if (m_isMoving || !m_zeroEstablished || m_positionQueryPending || !isConnected()) return;
+    m_positionQueryPending = true;
+    sendCommand("g r0x32", [this](bool ok, qint64 raw) {
+        m_positionQueryPending = false;
+        if (!ok || m_isMoving) return;
+        qint64 actual = unwrapDriverCounts(raw);
+        qint64 drift = actual - m_currentSoftwareCounts;
+        if (drift == 0) return;
+        m_currentSoftwareCounts = actual;
+        m_targetSoftwareCounts = actual;
+        if (qAbs(drift) > POSITION_TOLERANCE) {
+            emit logMessage(QString("电机位置校正：软件位置偏差 %1 counts (%2°)")
+                                .arg(drift).arg(double(drift) / COUNTS_PER_REV * 360.0, 0, 'f', 3));
+        }
+        emit positionResynced(drift);
+    });
+}
+
+void ServoMotorController::handlePosition(qint64 raw) {
+    if (!m_isMoving) return;
+
+    // 计算误差（零点未确认时按原始读数比较）
+    qint64 driverCounts = m_zeroEstablished ? unwrapDriverCounts(raw) : raw;
+    qint64 diff = qAbs(driverCounts - m_targetSoftwareCounts);
+
+    // 判断是否到位
+    if (diff <= POSITION_TOLERANCE) {
+        m_isMoving = false;
+        m_pollTimer->stop();
+        m_arrivalTimer->stop();
+        if(m_timeoutTimer) m_timeoutTimer->stop(); // 停止超时计时
+
+        // 以驱动器实际位置为准，消除每次运动的残差累积
+        if (m_zeroEstablished) m_currentSoftwareCounts = m_targetSoftwareCounts = driverCounts;
+
+        emit logMessage(QString("电机到位 (误差: %1)").arg(diff));
+        emit positionReached();
+    }
 }
 
 void ServoMotorController::onDataReceived() {
     // 1. 将新数据追加到缓存
     m_buffer.append(m_serial->readAll());
 
+    // 超时后的静默期：收到的都是迟到应答，丢弃并顺延下一条指令
+    if (m_draining && !m_inFlight) {
+        qDebug() << "伺服驱动器迟到应答（已丢弃）:" << m_buffer.trimmed();
+        m_buffer.clear();
+        if (m_drainTimer.elapsed() < kDrainMaxMs) m_pacingTimer->start(kDrainQuietMs);
+        return;
+    }
+
     // 2. 按行处理数据 (以 \r 为结束符，Copley驱动器通常以 \r 结尾)
     while (m_buffer.contains('\r')) {
         int endIndex = m_buffer.indexOf('\r');
@@ -208,33 +451,31 @@ void ServoMotorController::onDataReceived() {
 
         // 去除可能的换行符 \n 和首尾空格
         QString response = QString::fromLatin1(lineData).trimmed();
+        if (response.isEmpty()) continue;
 
-        // 调试日志：看看实际上收到了什么（调试完成后可注释掉）
-        // qDebug() << "Servo Raw Line:" << response;
+        if (!m_inFlight) {
+            qDebug() << "伺服驱动器多余应答（已忽略）:" << response;
+            continue;
+        }
 
-        // 3. 解析位置数据
-        // 驱动器回复格式通常是 "v 123456"
-        if (m_isMoving && response.startsWith("v ")) {
+        // 3. 应答与在途指令一一对应："v <值>" 为查询结果，"ok" 为设置成功，"e <码>" 为错误。
+        //    应答类型与指令不符（查询收到 ok、设置收到 v）说明是更早指令的迟到应答，丢弃后继续等
+        const bool isQuery = m_current.text.startsWith("g ");
+        if ((response.startsWith("v ") && !isQuery) || (response == "ok" && isQuery)) {
+            qDebug() << "伺服驱动器应答与指令不符（已丢弃）:" << response << "指令:" << m_current.text;
+            continue;
+        }
+        if (response.startsWith("v ")) {
             bool ok;
-            // 提取 "v " 后面的数字
-            long long currentDriverCounts = response.mid(2).toLongLong(&ok);
-
-            if (ok) {
-                // 计算误差
-                long long diff = qAbs(currentDriverCounts - m_targetSoftwareCounts);
-
-                // qDebug() << "Target:" << m_targetSoftwareCounts << " Current:" << currentDriverCounts << " Diff:" << diff;
-
-                // 判断是否到位
-                if (diff <= POSITION_TOLERANCE) {
-                    m_isMoving = false;
-                    m_pollTimer->stop();
-                    if(m_timeoutTimer) m_timeoutTimer->stop(); // 停止超时计时
-
-                    emit logMessage(QString("电机到位 (误差: %1)").arg(diff));
-                    emit positionReached();
-                }
-            }
+            qint64 value = response.mid(2).trimmed().toLongLong(&ok);
+            finishCurrent(ok, value);
+        } else if (response == "ok") {
+            finishCurrent(true, 0);
+        } else if (response.startsWith("e")) {
+            emit errorOccurred(QString("伺服驱动器返回错误 %1（指令：%2）").arg(response, m_current.text));
+            finishCurrent(false, 0);
+        } else {
+            qDebug() << "伺服驱动器未知应答:" << response;
         }
     }
 }
@@ -4,45 +4,101 @@
 #include <QObject>
 #include <QSerialPort>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QSettings>
 #include <QDebug>
+#include <functional>
 
+// Copley 驱动器 ASCII 协议：每条指令都有一行应答（"ok"、"v <值>" 或 "e <错误码>"）。
+// 指令在本地排队，同一时刻只有一条在途，收到应答（或应答超时）后按节拍发送下一条，
+// 应答按先进先出与指令一一对应，不会阻塞调用线程
 class ServoMotorController : public QObject
 {
     Q_OBJECT
 public:
+    // ok 为 false 表示驱动器返回错误或应答超时；value 仅对 "g" 查询有效
+    using ReplyCallback = std::function<void(bool ok, qint64 value)>;
+
+    // 梯形速度曲线（驱动器单位：加/减速度 10 counts/s²，速度 0.1 counts/s），initDriverParameters 时下发
+    struct MotionProfile {
+        int acceleration = 20000;   // r0xcc
+        int deceleration = 20000;   // r0xcd
+        int maxVelocity = 1310720;  // r0xcb
+    };
+
     explicit ServoMotorController(QObject *parent = nullptr);
     ~ServoMotorController();
 
     // 连接设备
     bool connectDevice(const QString &portName, int baudRate = 9600);
     void disconnectDevice();
-    bool isConnected() const;
-
-    // 核心运动控制
-    void resetZeroPoint();             // 【关键】复位零点：发送r指令并重新初始化参数
-    void moveRelative(double angle);   // 相对转动（正数为顺时针）
-    void moveToAbsolute(double angle); // 模拟绝对定位（基于软件记录的0点计算相对差值）
-    void moveToZero();                 // 回零（反转回退到0点）
-    void stop();                       // 急停
-
-    double currentAngle() const;       // 获取当前软件记录的角度
+    virtual bool isConnected() const;
+
+    // 核心运动控制（虚函数，便于仿真转台替换实机通信）
+    virtual void resetZeroPoint();             // 【关键】复位零点：发送r指令并重新初始化参数
+    virtual void moveRelative(double angle);   // 相对转动（正数为顺时针）
+    virtual void moveToAbsolute(double angle); // 绝对定位：转到圈内 angle 度，按最短方向（受 max_turns 限制）
+    virtual void moveToZero();                 // 回零（按最短方向回到0点）
+    virtual void stop();                       // 急停
+
+    virtual double currentAngle() const;       // 获取当前软件记录的角度（多圈累计）
+    // moveToAbsolute(targetAngle) 实际要转动的角度（带符号）
+    double plannedMoveAngle(double targetAngle) const { return plannedMoveAngleFrom(currentAngle(), targetAngle); }
+    // 假定当前位于 fromAngle（多圈累计）时 moveToAbsolute(targetAngle) 要转动的角度，含 max_turns 反向，用于事先估算
+    virtual double plannedMoveAngleFrom(double fromAngle, double targetAngle) const;
+    // 从 fromAngle 转到 toAngle 的最短转角，范围 (-180, 180]
+    static double shortestRotation(double fromAngle, double toAngle);
 
     void initDriverParameters(); // 发送全套初始化参数(电流、增益、速度)
 
+    // 配置（config.ini）：
+    // [servo]
+    // acceleration=20000 / deceleration=20000 / max_velocity=1310720  ; 驱动器单位，同 MotionProfile
+    // timeout_factor=2.0        ; 运动超时 = 预测时间 × 系数 + 余量
+    // timeout_margin_ms=3000
+    // max_turns=2               ; 允许偏离零点的最大圈数（线缆缠绕保护），0 表示不限制
+    // resync_interval_ms=60000  ; 空闲时读回 r0x32 校正软件位置的周期，0 表示只在到位时校正
+    void loadSettings(QSettings &settings);
+    void setMotionProfile(const MotionProfile &profile) { m_profile = profile; } // 下次 initDriverParameters 生效
+    MotionProfile motionProfile() const { return m_profile; }
+
+    // 按梯形速度曲线预测转动 angle 度（取绝对值）所需的时间，毫秒，不含到位确认
+    virtual int predictedMoveMs(double angle) const;
+    // 转动 angle 度的超时时间：预测时间 × 系数 + 余量
+    int moveTimeoutMs(double angle) const;
+
+    // 排队中的指令数（含在途）
+    int pendingCommandCount() const { return m_commandQueue.size() + (m_inFlight ? 1 : 0); }
+
     QTimer *m_timeoutTimer;
 
 signals:
     void positionReached();            // 信号：已到达目标位置
+    void moveStarted(int predictedMs); // 驱动器已确认运动指令，预计 predictedMs 后到位
+    void positionResynced(qint64 driftCounts); // 按驱动器读回校正了软件位置
+    void zeroPointReset(bool ok);      // 复位零点指令序列执行完毕
+    void driverParametersInitialized(bool ok);
     void errorOccurred(const QString &msg);
     void logMessage(const QString &msg);
 
 private slots:
     void onDataReceived();
     void checkPositionStatus(); // 定时查询位置
+    void sendNextCommand();
+    void onReplyTimeout();
+    void resyncPosition();      // 空闲时读回实际位置，校正累计误差
 
 private:
     QSerialPort *m_serial;
-    QTimer *m_pollTimer;
+    QTimer *m_pollTimer;       // 预计到位附近的密集位置查询
+    QTimer *m_arrivalTimer;    // 运动开始后，到预计到位前不查询位置
+
+    MotionProfile m_profile;
+    double m_timeoutFactor = 2.0;
+    int m_timeoutMarginMs = 3000;
+    int m_maxTurns = 2;
+    QTimer *m_resyncTimer;
 
     // 电机参数配置
     const int COUNTS_PER_REV = 1310720; // 一圈脉冲数
@@ -51,16 +107,42 @@ private:
     // 【新增】串口数据缓存区，解决断包问题
     QByteArray m_buffer;
 
-    // 【核心】软件维护的“虚拟绝对位置”
-    // 因为驱动器内部计数器不能清零且容易溢出，我们在软件层记录当前应该在哪里
-    long long m_currentSoftwareCounts = 0;
-    long long m_targetSoftwareCounts = 0;
+    // 【核心】软件维护的“虚拟绝对位置”（64 位多圈累计，零点为 resetZeroPoint 时的位置）
+    // 驱动器 r0x32 是 32 位计数器，约 1638 圈后回绕，读回值经 unwrapDriverCounts 展开后再与软件位置比较
+    qint64 m_currentSoftwareCounts = 0;
+    qint64 m_targetSoftwareCounts = 0;
+    qint32 m_lastDriverRaw = 0;      // 上一次读回的 r0x32 原始值
+    qint64 m_driverCounts = 0;       // 展开后的驱动器位置
+    bool m_zeroEstablished = false;  // 零点复位成功后才用读回值校正软件位置
 
     bool m_isMoving = false;
 
-    void sendCommand(const QString &cmd);
-
-    int angleToCounts(double angle);
+    struct Command {
+        QString text;
+        ReplyCallback callback;
+        int delayAfterMs = 0;   // 应答后额外等待（如清零后给驱动器留生效时间）
+    };
+
+    QQueue<Command> m_commandQueue;
+    Command m_current;
+    bool m_inFlight = false;
+    QTimer *m_pacingTimer;      // 两条指令之间的最小间隔
+    QTimer *m_replyTimer;       // 应答超时
+    bool m_positionQueryPending = false;
+    bool m_draining = false;       // 应答超时后等待线路静默，期间到达的数据视为迟到应答
+    bool m_cancellingCommands = false; // clearCommandQueue 正在以失败结束被撤销的指令
+    QElapsedTimer m_drainTimer;
+    bool m_sequenceFailed = false; // 当前指令序列中是否有指令失败
+
+    void sendCommand(const QString &cmd, ReplyCallback callback = nullptr, int delayAfterMs = 0);
+    void finishCurrent(bool ok, qint64 value);
+    void clearCommandQueue();
+    void handlePosition(qint64 raw);
+    qint64 unwrapDriverCounts(qint64 raw);
+    void moveRelativeCounts(qint64 counts);
+    qint64 plannedMoveCounts(qint64 fromCounts, double targetAngle) const;
+
+    qint64 angleToCounts(double angle) const;
 };
 
 #endif // SERVOMOTORCONTROLLER_H
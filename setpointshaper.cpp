@@ -0,0 +1,249 @@
+#include "setpointshaper.h"
+#include "BlackbodyController.h"
+#include <QDebug>
+#include <cmath>
+#include <limits>
+
+namespace {
+const int kMinSamplesForFit = 20;      // 少于该采样数不做辨识
+const double kMinStepForFit = 1.0;     // 阶跃幅度太小时信噪比不够，不做辨识
+const int kModelAverageWindow = 5;     // 模型按最近若干次辨识滑动平均
+}
+
+SetpointShaper::SetpointShaper(BlackbodyController *blackbody, CalibrationClock *clock, QObject *parent)
+    : QObject(parent), m_blackbody(blackbody), m_clock(clock)
+{
+    qRegisterMetaType<SetpointShaper::SettleReport>();
+
+    m_holdTimer = m_clock->createTimer(this);
+    m_holdTimer->setSingleShot(true);
+    connect(m_holdTimer, &CalibrationTimer::timeout, this, &SetpointShaper::onHoldTimeout);
+
+    connect(m_blackbody, &BlackbodyController::currentTemperatureUpdated, this, &SetpointShaper::onTemperature);
+}
+
+void SetpointShaper::loadSettings(QSettings &settings)
+{
+    settings.beginGroup("setpoint_shaping");
+    m_enabled = settings.value("enabled", false).toBool();
+    m_maxOvershoot = qMax(0.0, settings.value("max_overshoot", 3.0).toDouble());
+    m_minSetpoint = settings.value("min_setpoint", -40.0).toDouble();
+    m_maxSetpoint = settings.value("max_setpoint", 150.0).toDouble();
+    m_band = qMax(0.01, settings.value("band", 0.1).toDouble());
+    m_settleHoldSec = qMax(0.0, settings.value("settle_hold_sec", 60.0).toDouble());
+    m_heating.tauSec = settings.value("heat_tau_sec", 0.0).toDouble();
+    m_heating.deadSec = settings.value("heat_dead_sec", 0.0).toDouble();
+    m_heating.fits = m_heating.isValid() ? 1 : 0;
+    m_cooling.tauSec = settings.value("cool_tau_sec", 0.0).toDouble();
+    m_cooling.deadSec = settings.value("cool_dead_sec", 0.0).toDouble();
+    m_cooling.fits = m_cooling.isValid() ? 1 : 0;
+    settings.endGroup();
+}
+
+void SetpointShaper::saveModels(QSettings &settings) const
+{
+    settings.beginGroup("setpoint_shaping");
+    if (m_heating.isValid()) {
+        settings.setValue("heat_tau_sec", QString::number(m_heating.tauSec, 'f', 1));
+        settings.setValue("heat_dead_sec", QString::number(m_heating.deadSec, 'f', 1));
+    }
+    if (m_cooling.isValid()) {
+        settings.setValue("cool_tau_sec", QString::number(m_cooling.tauSec, 'f', 1));
+        settings.setValue("cool_dead_sec", QString::number(m_cooling.deadSec, 'f', 1));
+    }
+    settings.endGroup();
+}
+
+double SetpointShaper::elapsedSec() const
+{
+    return m_step.start.msecsTo(m_clock->now()) / 1000.0;
+}
+
+double SetpointShaper::unshapedSettleSec(const Model &model, double y0, double target) const
+{
+    double delta = qAbs(target - y0);
+    if (delta <= m_band) return 0.0;
+    return model.deadSec + model.tauSec * std::log(delta / m_band);
+}
+
+void SetpointShaper::moveTo(float target, int pointIndex)
+{
+    // 同一温度点、同一目标重复下发（如流水线已预切换到下一点）时保持当前阶跃，不重写设定值，
+    // 否则会把正在进行的阶跃当作“未整定”报告，再从半途重新计时
+    if (pointIndex >= 0 && pointIndex == m_step.report.pointIndex && qAbs(m_step.target - target) < 1e-3
+        && (m_step.active || m_step.report.achievedSec >= 0.0)) {
+        return;
+    }
+    if (m_step.active) finishStep(-1.0); // 上一次阶跃未整定就被新设定值打断
+
+    m_holdTimer->stop();
+    m_step = Step();
+    m_step.active = true;
+    m_step.y0 = m_blackbody->getCurrentTemperature();
+    m_step.target = target;
+    m_step.start = m_clock->now();
+
+    const bool heating = target > m_step.y0;
+    const Model model = heating ? m_heating : m_cooling;
+
+    SettleReport &report = m_step.report;
+    report.pointIndex = pointIndex;
+    report.from = float(m_step.y0);
+    report.target = target;
+    report.unshapedSec = model.isValid() ? unshapedSettleSec(model, m_step.y0, target) : -1.0;
+    report.predictedSec = report.unshapedSec;
+
+    const double delta = target - m_step.y0;
+    if (m_enabled && model.isValid() && m_maxOvershoot > 0.0 && qAbs(delta) > 5 * m_band) {
+        // 过冲设定值 u：越过目标 max_overshoot，并受设备量程限制
+        double u = target + (delta > 0 ? m_maxOvershoot : -m_maxOvershoot);
+        u = qBound(m_minSetpoint, u, m_maxSetpoint);
+        double frac = (target - m_step.y0) / (u - m_step.y0);
+        if (frac > 0.0 && frac < 1.0) {
+            // 一阶响应 y = y0 + (u - y0)(1 - e^(-t/tau)) 到达目标的时刻；命令和响应都滞后 dead，
+            // 所以在 t* 时刻改回目标，温度恰好在 dead + t* 到达目标
+            double holdSec = -model.tauSec * std::log(1.0 - frac);
+            m_blackbody->setTargetTemperature(float(u));
+            m_step.commands.append({0.0, u});
+            m_holdTimer->start(qMax(1, int(holdSec * 1000.0)));
+            report.shaped = true;
+            report.predictedSec = model.deadSec + holdSec;
+            qDebug() << "设定值整形：目标" << target << "过冲设定" << u << "保持" << holdSec << "秒";
+            return;
+        }
+    }
+
+    m_blackbody->setTargetTemperature(target);
+    m_step.commands.append({0.0, double(target)});
+}
+
+void SetpointShaper::onHoldTimeout()
+{
+    if (!m_step.active) return;
+    m_blackbody->setTargetTemperature(float(m_step.target));
+    m_step.commands.append({elapsedSec(), m_step.target});
+}
+
+void SetpointShaper::finishShaping()
+{
+    if (!m_holdTimer->isActive()) return;
+    m_holdTimer->stop();
+    onHoldTimeout();
+}
+
+void SetpointShaper::abort()
+{
+    m_holdTimer->stop();
+    m_step = Step(); // 下次标校的同号温度点不能沿用本次的阶跃
+}
+
+void SetpointShaper::onTemperature(float temperature)
+{
+    if (!m_step.active) return;
+
+    const double t = elapsedSec();
+    m_step.samples.append({t, double(temperature)});
+
+    // 过冲保持期间即使经过目标也不算整定
+    if (!m_holdTimer->isActive() && qAbs(temperature - m_step.target) <= m_band) {
+        if (m_step.inBandSince < 0.0) m_step.inBandSince = t;
+        if (t - m_step.inBandSince >= m_settleHoldSec) {
+            finishStep(m_step.inBandSince);
+            return;
+        }
+    } else {
+        m_step.inBandSince = -1.0;
+    }
+
+    if (t > m_maxRecordSec) finishStep(-1.0);
+}
+
+void SetpointShaper::finishStep(double achievedSec)
+{
+    m_step.active = false;
+    m_step.report.achievedSec = achievedSec;
+    identify();
+    if (m_step.report.pointIndex >= 0) emit settleReported(m_step.report);
+}
+
+double SetpointShaper::simulationError(const Step &step, double tauSec, double deadSec)
+{
+    // 命令在 t + dead 时刻生效，之前模型处于 y0 稳态
+    double y = step.y0;
+    double input = step.y0;
+    double tCur = 0.0;
+    int next = 0;
+    double error = 0.0;
+
+    auto advance = [&](double to) {
+        if (to <= tCur) return;
+        y += (input - y) * (1.0 - std::exp(-(to - tCur) / tauSec));
+        tCur = to;
+    };
+
+    for (const auto &sample : step.samples) {
+        while (next < step.commands.size() && step.commands[next].t + deadSec <= sample.first) {
+            advance(step.commands[next].t + deadSec);
+            input = step.commands[next].value;
+            ++next;
+        }
+        advance(sample.first);
+        double diff = y - sample.second;
+        error += diff * diff;
+    }
+    return error;
+}
+
+void SetpointShaper::identify()
+{
+    if (m_step.samples.size() < kMinSamplesForFit) return;
+    if (qAbs(m_step.target - m_step.y0) < kMinStepForFit) return;
+
+    const double duration = m_step.samples.last().first;
+    const double maxDead = qMin(300.0, duration / 3.0);
+
+    // 粗网格：tau 对数均布，dead 每 5 秒
+    double bestTau = 0.0, bestDead = 0.0;
+    double bestError = std::numeric_limits<double>::max();
+    for (int i = 0; i < 40; ++i) {
+        double tau = 10.0 * std::pow(2400.0 / 10.0, i / 39.0);
+        for (double dead = 0.0; dead <= maxDead; dead += 5.0) {
+            double e = simulationError(m_step, tau, dead);
+            if (e < bestError) {
+                bestError = e;
+                bestTau = tau;
+                bestDead = dead;
+            }
+        }
+    }
+    // 在最优点附近细化
+    const double tauLow = bestTau * 0.85, tauHigh = bestTau * 1.15;
+    const double deadLow = qMax(0.0, bestDead - 5.0), deadHigh = qMin(maxDead, bestDead + 5.0);
+    for (int i = 0; i <= 20; ++i) {
+        double tau = tauLow + (tauHigh - tauLow) * i / 20.0;
+        for (double dead = deadLow; dead <= deadHigh; dead += 0.5) {
+            double e = simulationError(m_step, tau, dead);
+            if (e < bestError) {
+                bestError = e;
+                bestTau = tau;
+                bestDead = dead;
+            }
+        }
+    }
+
+    const bool heating = m_step.target > m_step.y0;
+    Model &model = heating ? m_heating : m_cooling;
+    int n = qMin(model.fits + 1, kModelAverageWindow);
+    if (model.isValid()) {
+        model.tauSec += (bestTau - model.tauSec) / n;
+        model.deadSec += (bestDead - model.deadSec) / n;
+    } else {
+        model.tauSec = bestTau;
+        model.deadSec = bestDead;
+    }
+    model.fits = n;
+
+    qDebug() << "黑体炉" << (heating ? "升温" : "降温") << "阶跃辨识：tau =" << bestTau << "s, 滞后 =" << bestDead
+             << "s, RMS =" << std::sqrt(bestError / m_step.samples.size());
+    emit modelUpdated(heating, model.tauSec, model.deadSec);
+}
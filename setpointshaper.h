@@ -0,0 +1,119 @@
+#ifndef SETPOINTSHAPER_H
+#define SETPOINTSHAPER_H
+
+#include <QObject>
+#include <QSettings>
+#include <QVector>
+#include "calibrationclock.h"
+
+class BlackbodyController;
+
+// 黑体炉设定值整形：
+// 1. 每次改设定值都记录温度响应，用网格搜索拟合一阶惯性加纯滞后（FOPDT）模型，升温、降温分开辨识，
+//    结果写回 config.ini，下次运行直接使用
+// 2. 有模型后，先向 0x000A 写入一个越过目标的过冲设定值（降温时为欠冲），按模型算出的时刻再改回目标，
+//    使温度更快进入 ±band 区间
+// 3. 每个温度点报告预测整定时间、不整形的预测时间和实际整定时间
+// 配置（config.ini）：
+// [setpoint_shaping]
+// enabled=true
+// max_overshoot=3.0        ; 过冲设定值偏离目标的最大幅度（℃）
+// min_setpoint=-40
+// max_setpoint=150
+// band=0.1                 ; 整定区间（±℃）
+// settle_hold_sec=60       ; 连续处于区间内多久算整定
+// heat_tau_sec / heat_dead_sec / cool_tau_sec / cool_dead_sec  ; 辨识结果（自动写回）
+class SetpointShaper : public QObject
+{
+    Q_OBJECT
+public:
+    struct Model {
+        double tauSec = 0.0;
+        double deadSec = 0.0;
+        int fits = 0;          // 已参与平均的辨识次数
+        bool isValid() const { return tauSec > 0.0; }
+    };
+
+    struct SettleReport {
+        int pointIndex = -1;
+        float from = 0.0f;
+        float target = 0.0f;
+        bool shaped = false;
+        double predictedSec = -1.0;   // 整形后的预测整定时间（无模型时为 -1）
+        double unshapedSec = -1.0;    // 直接写目标值时的预测整定时间
+        double achievedSec = -1.0;    // 实际整定时间（超时未整定为 -1）
+    };
+
+    SetpointShaper(BlackbodyController *blackbody, CalibrationClock *clock, QObject *parent = nullptr);
+
+    void loadSettings(QSettings &settings);
+    void saveModels(QSettings &settings) const;
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+    Model heatingModel() const { return m_heating; }
+    Model coolingModel() const { return m_cooling; }
+
+    // 代替 setTargetTemperature：按模型下发整形设定值序列，同时开始记录响应；
+    // 与进行中或已整定的阶跃同点同目标时不做任何事
+    void moveTo(float target, int pointIndex);
+    // 立即写入最终目标并结束过冲（暂停、取消时调用），响应记录继续
+    void finishShaping();
+    // 停止记录（取消标校时调用），不产生报告
+    void abort();
+
+    bool isShaping() const { return m_holdTimer->isActive(); }
+
+signals:
+    void settleReported(const SetpointShaper::SettleReport &report);
+    void modelUpdated(bool heating, double tauSec, double deadSec);
+
+private slots:
+    void onTemperature(float temperature);
+    void onHoldTimeout();
+
+private:
+    struct Command {
+        double t;      // 相对阶跃开始的秒数
+        double value;
+    };
+
+    struct Step {
+        bool active = false;
+        double y0 = 0.0;
+        double target = 0.0;
+        QDateTime start;
+        QVector<Command> commands;
+        QVector<QPair<double, double>> samples; // (秒, 温度)
+        double inBandSince = -1.0;
+        SettleReport report;
+    };
+
+    double elapsedSec() const;
+    void finishStep(double achievedSec);
+    void identify();
+    // 按 FOPDT 模型仿真命令序列，返回与采样的平方误差和
+    static double simulationError(const Step &step, double tauSec, double deadSec);
+    // 一阶模型从 y0 直接走到 target±band 的时间（含滞后）
+    double unshapedSettleSec(const Model &model, double y0, double target) const;
+
+    BlackbodyController *m_blackbody;
+    CalibrationClock *m_clock;
+    CalibrationTimer *m_holdTimer;
+
+    bool m_enabled = false;
+    double m_maxOvershoot = 3.0;
+    double m_minSetpoint = -40.0;
+    double m_maxSetpoint = 150.0;
+    double m_band = 0.1;
+    double m_settleHoldSec = 60.0;
+    double m_maxRecordSec = 3600.0;
+
+    Model m_heating;
+    Model m_cooling;
+    Step m_step;
+};
+
+Q_DECLARE_METATYPE(SetpointShaper::SettleReport)
+
+#endif // SETPOINTSHAPER_H
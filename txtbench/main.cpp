@@ -0,0 +1,154 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QDebug>
+#include "txtlogscanner.h"
+#include "txtminuteindex.h"
+
+// 用法：
+//   txtbench --dir ../Data模板 --repeat 5
+//   txtbench --dir D:/logs/多头 --format multi
+// 对目录下（递归）所有 .txt 依次测量：
+//   textstream  QTextStream::readLine + trimmed + startsWith/contains（原实现的读取方式）
+//   scan        TxtLogScanner 全文件扫描数据行（不解码）
+//   scan-minute TxtLogScanner 只取每个文件中的一分钟（其余行不解码直接跳过）
+//   index       TxtMinuteIndex::build 建立完整分钟索引（含候选行解码和字段解析），
+//               日志格式按文件所在目录判断（路径含“单头”“多头”，其余按标准），与处理时选用的格式一致
+// 结果按第一次之后的平均值计算，第一次用于预热文件缓存
+namespace {
+struct Result {
+    QString name;
+    double totalMs = 0.0;
+    qint64 matched = 0;
+};
+
+qint64 runTextStream(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+    QTextStream in(&file);
+    qint64 matched = 0;
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.startsWith("[R:") && line.contains(" ST,")) ++matched;
+    }
+    return matched;
+}
+
+qint64 runScan(const QString &path, const QSet<qint64> &minutes)
+{
+    TxtLogScanner scanner;
+    if (!scanner.open(path)) return 0;
+    scanner.setRequireDataLine(true);
+    scanner.setMinuteFilter(minutes);
+    qint64 matched = 0;
+    scanner.scan(0, [&matched](const TxtLogScanner::Line &) { ++matched; });
+    return matched;
+}
+
+// 取文件中间位置那一行的分钟，作为“只需要一分钟”的代表
+qint64 middleMinute(const QString &path)
+{
+    TxtLogScanner scanner;
+    if (!scanner.open(path) || scanner.size() == 0) return -1;
+    qint64 key = -1;
+    scanner.scan(scanner.size() / 2, [&key](const TxtLogScanner::Line &line) {
+        if (key < 0) key = line.firstMinute;
+    });
+    return key;
+}
+
+// 标准与多头日志行格式相同，无法从内容区分；数据按类型放在各自目录下，DataExcelProcessor 也是按所选类型解析
+TxtMinuteIndex::Format formatOf(const QString &path)
+{
+    const QString dir = QFileInfo(path).absolutePath();
+    if (dir.contains("单头")) return TxtMinuteIndex::SingleHeadLog;
+    if (dir.contains("多头")) return TxtMinuteIndex::MultiHeadLog;
+    return TxtMinuteIndex::StandardLog;
+}
+
+qint64 runIndex(const QString &path, TxtMinuteIndex::Format format)
+{
+    TxtMinuteIndex index;
+    if (!index.build(path, format)) return 0;
+    return index.minuteCount();
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("txtbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("原始 TXT 日志读取吞吐量基准");
+    parser.addHelpOption();
+    QCommandLineOption dirOption("dir", "日志目录（递归查找 .txt）", "path", "../Data模板");
+    QCommandLineOption repeatOption("repeat", "每项重复次数（不含预热）", "n", "3");
+    QCommandLineOption formatOption("format", "index 使用的日志格式：auto（按目录判断）、standard、single、multi", "format", "auto");
+    parser.addOptions({dirOption, repeatOption, formatOption});
+    parser.process(app);
+
+    const QString formatName = parser.value(formatOption);
+    if (!QStringList({"auto", "standard", "single", "multi"}).contains(formatName)) {
+        qCritical() << "未知的日志格式：" << formatName;
+        return 1;
+    }
+
+    const int repeat = qMax(1, parser.value(repeatOption).toInt());
+    QStringList files;
+    QDirIterator it(parser.value(dirOption), QStringList() << "*.txt", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) files.append(it.next());
+    files.sort();
+    if (files.isEmpty()) {
+        qCritical() << "目录中没有 .txt 文件：" << parser.value(dirOption);
+        return 1;
+    }
+
+    qint64 totalBytes = 0;
+    QHash<QString, QSet<qint64>> minuteOf;
+    QHash<QString, TxtMinuteIndex::Format> formatOfFile;
+    for (const QString &path : files) {
+        totalBytes += QFileInfo(path).size();
+        qint64 key = middleMinute(path);
+        if (key >= 0) minuteOf[path].insert(key);
+        if (formatName == "standard") formatOfFile.insert(path, TxtMinuteIndex::StandardLog);
+        else if (formatName == "single") formatOfFile.insert(path, TxtMinuteIndex::SingleHeadLog);
+        else if (formatName == "multi") formatOfFile.insert(path, TxtMinuteIndex::MultiHeadLog);
+        else formatOfFile.insert(path, formatOf(path));
+    }
+
+    QVector<Result> results = {{"textstream"}, {"scan"}, {"scan-minute"}, {"index"}};
+    for (int round = 0; round <= repeat; ++round) {
+        for (Result &result : results) {
+            QElapsedTimer timer;
+            timer.start();
+            qint64 matched = 0;
+            for (const QString &path : files) {
+                if (result.name == "textstream") matched += runTextStream(path);
+                else if (result.name == "scan") matched += runScan(path, QSet<qint64>());
+                else if (result.name == "scan-minute") matched += runScan(path, minuteOf.value(path));
+                else matched += runIndex(path, formatOfFile.value(path));
+            }
+            double ms = timer.nsecsElapsed() / 1e6;
+            if (round == 0) continue; // 预热
+            result.totalMs += ms;
+            result.matched = matched;
+        }
+    }
+
+    QTextStream out(stdout);
+    out << QString("文件 %1 个，共 %2 MB，SIMD：%3，重复 %4 次\n")
+               .arg(files.size()).arg(totalBytes / 1048576.0, 0, 'f', 1).arg(TxtLogScanner::simdLevel()).arg(repeat);
+    out << QString("%1 %2 %3 %4\n").arg("方式", -12).arg("平均 ms", 10).arg("MB/s", 10).arg("命中", 10);
+    for (const Result &result : results) {
+        double ms = result.totalMs / repeat;
+        double mbps = (ms > 0.0) ? totalBytes / 1048576.0 / (ms / 1000.0) : 0.0;
+        out << QString("%1 %2 %3 %4\n").arg(result.name, -12).arg(ms, 10, 'f', 1).arg(mbps, 10, 'f', 1).arg(result.matched, 10);
+    }
+    return 0;
+}
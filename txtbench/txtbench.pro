@@ -0,0 +1,22 @@
+# 原始 TXT 日志读取吞吐量基准（独立程序，不依赖主工程界面）
+# 对比 QTextStream 逐行读取与 TxtLogScanner 内存映射 + SIMD 扫描的 MB/s
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = txtbench
+
+# 需要 AVX2 版本时：qmake "QMAKE_CXXFLAGS+=-mavx2"
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../txtblocklog.cpp \
+    ../txtlogscanner.cpp \
+    ../txtminuteindex.cpp \
+    main.cpp
+
+HEADERS += \
+    ../txtblocklog.h \
+    ../txtlogscanner.h \
+    ../txtminuteindex.h
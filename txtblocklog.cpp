@@ -0,0 +1,246 @@
+#include "txtblocklog.h"
+#include "txtlogscanner.h"
+#include <QDataStream>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const char kSuffix[] = "txtz";
+
+// 块内所有 "[R:" 时间的分钟键，升序去重（与 TxtLogScanner 的分钟筛选同一口径：行内任意时间戳都算）
+QVector<qint64> blockMinutes(const char *begin, const char *end)
+{
+    QVector<qint64> minutes;
+    for (const char *p = TxtLogScanner::findMarker(begin, end, "[R:", 3); p < end;
+         p = TxtLogScanner::findMarker(p + 3, end, "[R:", 3)) {
+        const qint64 key = TxtLogScanner::parseMinuteKey(p + 3, end);
+        if (key >= 0 && (minutes.isEmpty() || minutes.last() != key)) minutes.append(key);
+    }
+    std::sort(minutes.begin(), minutes.end());
+    minutes.erase(std::unique(minutes.begin(), minutes.end()), minutes.end());
+    return minutes;
+}
+}
+
+bool TxtBlockLog::Block::covers(const QSet<qint64> &wanted) const
+{
+    if (wanted.isEmpty()) return true;
+    for (qint64 minute : minutes) {
+        if (wanted.contains(minute)) return true;
+    }
+    return false;
+}
+
+bool TxtBlockLog::isBlockLogPath(const QString &path)
+{
+    return QFileInfo(path).suffix().compare(kSuffix, Qt::CaseInsensitive) == 0;
+}
+
+QString TxtBlockLog::compressedPath(const QString &txtPath)
+{
+    const QFileInfo info(txtPath);
+    return info.path() + "/" + info.completeBaseName() + "." + kSuffix;
+}
+
+bool TxtBlockLog::compressFile(const QString &txtPath, const QString &outPath, QString *error,
+                               int blockSize, int level)
+{
+    QFile source(txtPath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        if (error) *error = source.errorString();
+        return false;
+    }
+
+    TxtBlockLogWriter writer(blockSize, level);
+    if (!writer.open(outPath, error)) return false;
+    while (!source.atEnd()) {
+        const QByteArray chunk = source.read(blockSize);
+        if (chunk.isEmpty() || !writer.write(chunk)) {
+            if (error) *error = chunk.isEmpty() ? source.errorString() : "写入失败：" + outPath;
+            writer.cancel();
+            return false;
+        }
+    }
+    return writer.finish(error);
+}
+
+bool TxtBlockLog::open(const QString &path, QString *error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    m_fileSize = m_file.size();
+
+    auto fail = [this, error](const QString &message) {
+        if (error) *error = message + "：" + m_file.fileName();
+        close();
+        return false;
+    };
+    if (m_fileSize < TrailerSize) return fail("不是分块压缩日志");
+
+    QDataStream in(&m_file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic;
+    quint16 version;
+    qint32 blockSize;
+    in >> magic >> version >> blockSize;
+    if (in.status() != QDataStream::Ok || magic != Magic || version != Version) return fail("不是分块压缩日志");
+
+    qint64 indexOffset;
+    m_file.seek(m_fileSize - TrailerSize);
+    in >> indexOffset >> magic;
+    if (in.status() != QDataStream::Ok || magic != Magic || indexOffset < 0 || indexOffset > m_fileSize - TrailerSize) {
+        return fail("压缩日志尾部损坏");
+    }
+
+    m_file.seek(indexOffset);
+    qint32 count;
+    in >> count;
+    if (in.status() != QDataStream::Ok || count < 0) return fail("压缩日志块索引损坏");
+    m_blocks.reserve(count);
+    for (qint32 i = 0; i < count; ++i) {
+        Block block;
+        in >> block.fileOffset >> block.compressedSize >> block.rawSize >> block.rawOffset >> block.lines >> block.minutes;
+        if (in.status() != QDataStream::Ok || block.fileOffset < 0 || block.compressedSize < 0
+            || block.fileOffset + block.compressedSize > indexOffset) {
+            return fail("压缩日志块索引损坏");
+        }
+        m_blocks.append(block);
+    }
+    in >> m_rawSize >> m_utf8Bom;
+    if (in.status() != QDataStream::Ok) return fail("压缩日志块索引损坏");
+    return true;
+}
+
+void TxtBlockLog::close()
+{
+    if (m_file.isOpen()) m_file.close();
+    m_fileSize = 0;
+    m_rawSize = 0;
+    m_utf8Bom = false;
+    m_blocks.clear();
+}
+
+QVector<int> TxtBlockLog::blocksFor(const QSet<qint64> &minutes) const
+{
+    QVector<int> result;
+    for (int i = 0; i < m_blocks.size(); ++i) {
+        if (m_blocks[i].covers(minutes)) result.append(i);
+    }
+    return result;
+}
+
+bool TxtBlockLog::readBlock(int index, QByteArray *raw, QString *error)
+{
+    const Block &block = m_blocks.at(index);
+    QByteArray compressed;
+    if (m_file.seek(block.fileOffset)) compressed = m_file.read(block.compressedSize);
+    if (compressed.size() != block.compressedSize) {
+        if (error) *error = "读取压缩块失败：" + m_file.fileName();
+        return false;
+    }
+    *raw = qUncompress(compressed);
+    if (raw->size() != block.rawSize) {
+        if (error) *error = QString("压缩块 %1 解压失败：%2").arg(index).arg(m_file.fileName());
+        return false;
+    }
+    return true;
+}
+
+TxtBlockLogWriter::TxtBlockLogWriter(int blockSize, int level)
+    : m_blockSize(qMax(blockSize, 4096))
+    , m_level(level)
+{}
+
+bool TxtBlockLogWriter::open(const QString &path, QString *error)
+{
+    m_file.setFileName(path);
+    m_pending.clear();
+    m_blocks.clear();
+    m_rawOffset = 0;
+    m_utf8Bom = false;
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    QDataStream out(&m_file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << TxtBlockLog::Magic << TxtBlockLog::Version << qint32(m_blockSize);
+    return out.status() == QDataStream::Ok;
+}
+
+bool TxtBlockLogWriter::write(const QByteArray &bytes)
+{
+    m_pending += bytes;
+    if (m_rawOffset == 0 && m_blocks.isEmpty() && m_pending.size() >= 3) {
+        m_utf8Bom = std::memcmp(m_pending.constData(), "\xEF\xBB\xBF", 3) == 0;
+    }
+
+    // 块在换行处结束；超长的行整行放进一块
+    while (m_pending.size() >= m_blockSize) {
+        int cut = m_pending.lastIndexOf('\n', m_blockSize - 1);
+        if (cut < 0) cut = m_pending.indexOf('\n', m_blockSize);
+        if (cut < 0) break;
+        if (!flushBlock(cut + 1)) return false;
+    }
+    return true;
+}
+
+bool TxtBlockLogWriter::flushBlock(int length)
+{
+    TxtBlockLog::Block block;
+    block.fileOffset = m_file.pos();
+    block.rawSize = length;
+    block.rawOffset = m_rawOffset;
+
+    const char *begin = m_pending.constData();
+    block.lines = int(std::count(begin, begin + length, '\n'));
+    block.minutes = blockMinutes(begin, begin + length);
+
+    const QByteArray compressed = qCompress(reinterpret_cast<const uchar *>(begin), length, m_level);
+    block.compressedSize = compressed.size();
+    if (m_file.write(compressed) != compressed.size()) return false;
+
+    m_blocks.append(block);
+    m_rawOffset += length;
+    m_pending.remove(0, length);
+    return true;
+}
+
+bool TxtBlockLogWriter::finish(QString *error)
+{
+    if (!m_pending.isEmpty() && !flushBlock(m_pending.size())) {
+        if (error) *error = m_file.errorString();
+        m_file.cancelWriting();
+        return false;
+    }
+
+    const qint64 indexOffset = m_file.pos();
+    QDataStream out(&m_file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << qint32(m_blocks.size());
+    for (const TxtBlockLog::Block &block : m_blocks) {
+        out << block.fileOffset << block.compressedSize << block.rawSize << block.rawOffset << block.lines << block.minutes;
+    }
+    out << m_rawOffset << m_utf8Bom;
+    out << indexOffset << TxtBlockLog::Magic;
+
+    if (out.status() != QDataStream::Ok || !m_file.commit()) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void TxtBlockLogWriter::cancel()
+{
+    m_file.cancelWriting();
+    m_file.commit(); // 取消后 commit 只丢弃临时文件
+    m_pending.clear();
+    m_blocks.clear();
+}
@@ -0,0 +1,99 @@
+#ifndef TXTBLOCKLOG_H
+#define TXTBLOCKLOG_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// 分块压缩的原始日志（.txtz）：轮转后的 TXT 按整行切成约 256KB 的块，每块用 qCompress（zlib）单独压缩，
+// 可以独立解压。文件尾部是块索引，记录每块在文件中的位置、原始偏移、行数，以及块内所有 "[R:" 时间的
+// 分钟键（yyyyMMddHHmm，与 TxtLogScanner::parseMinuteKey 一致），只需要几分钟的数据时直接定位到相关的块。
+//
+// 文件布局（QDataStream，Qt_5_12）：
+//   头部    magic "TXZB"、版本、块大小
+//   数据块  qCompress 输出，依次排列
+//   块索引  块数、每块 {文件偏移, 压缩长度, 原始长度, 原始偏移, 行数, 分钟键列表}、原始总长度、是否带 UTF-8 BOM
+//   尾部    块索引的文件偏移（qint64）+ magic，固定 12 字节
+class TxtBlockLog
+{
+public:
+    struct Block {
+        qint64 fileOffset = 0;
+        qint32 compressedSize = 0;
+        qint32 rawSize = 0;
+        qint64 rawOffset = 0;       // 在原始 TXT 中的偏移
+        qint32 lines = 0;           // 以换行结尾的行数
+        QVector<qint64> minutes;    // 升序、去重
+
+        // minutes 为空表示不限
+        bool covers(const QSet<qint64> &minutes) const;
+    };
+
+    static const int DefaultBlockSize = 256 * 1024;
+
+    // 按后缀判断（.txtz）
+    static bool isBlockLogPath(const QString &path);
+    // "x.txt" -> "x.txtz"
+    static QString compressedPath(const QString &txtPath);
+    // 把完整的 TXT 压缩成 outPath（写临时文件后原子替换），原文件不动
+    static bool compressFile(const QString &txtPath, const QString &outPath, QString *error = nullptr,
+                             int blockSize = DefaultBlockSize, int level = -1);
+
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+
+    QString path() const { return m_file.fileName(); }
+    qint64 fileSize() const { return m_fileSize; }
+    qint64 rawSize() const { return m_rawSize; }
+    bool hasUtf8Bom() const { return m_utf8Bom; }
+    int blockCount() const { return m_blocks.size(); }
+    const Block &block(int index) const { return m_blocks.at(index); }
+
+    // 含这些分钟的块号（升序），minutes 为空时返回全部块
+    QVector<int> blocksFor(const QSet<qint64> &minutes) const;
+    // 解压一块；失败返回 false
+    bool readBlock(int index, QByteArray *raw, QString *error = nullptr);
+
+private:
+    friend class TxtBlockLogWriter;
+    static const quint32 Magic = 0x545A5842; // "TXZB"
+    static const quint16 Version = 1;
+    static const int TrailerSize = 12;
+
+    QFile m_file;
+    qint64 m_fileSize = 0;
+    qint64 m_rawSize = 0;
+    bool m_utf8Bom = false;
+    QVector<Block> m_blocks;
+};
+
+// 顺序写入 .txtz：write() 接收任意切分的原始字节，攒满一块后在最后一个换行处切开压缩写出；
+// finish() 写出剩余数据（末尾可以不带换行）和块索引，然后原子替换目标文件。未 finish 的文件不会出现
+class TxtBlockLogWriter
+{
+public:
+    explicit TxtBlockLogWriter(int blockSize = TxtBlockLog::DefaultBlockSize, int level = -1);
+
+    bool open(const QString &path, QString *error = nullptr);
+    bool write(const QByteArray &bytes);
+    bool finish(QString *error = nullptr);
+    void cancel();
+
+    qint64 rawBytes() const { return m_rawOffset + m_pending.size(); }
+
+private:
+    bool flushBlock(int length);
+
+    QSaveFile m_file;
+    QByteArray m_pending;
+    QVector<TxtBlockLog::Block> m_blocks;
+    qint64 m_rawOffset = 0;
+    int m_blockSize;
+    int m_level;
+    bool m_utf8Bom = false;
+};
+
+#endif // TXTBLOCKLOG_H
@@ -0,0 +1,48 @@
+#include "txtdirectoryindex.h"
+#include <QDir>
+#include <QFileInfo>
+
+QString TxtDirectoryIndex::key(const QString &portNumber, const QString &dateString)
+{
+    return portNumber.trimmed() + '|' + dateString;
+}
+
+// 按名称排序列出：同一端口同一天的多个会话自然按 14 位前缀升序，同名的 .txt 排在 .txtz 之前
+QStringList TxtDirectoryIndex::listLogFiles() const
+{
+    return QDir(m_dirPath).entryList(QStringList() << "*.txt" << "*.txtz", QDir::Files, QDir::Name);
+}
+
+bool TxtDirectoryIndex::build(const QString &dirPath)
+{
+    QDir dir(dirPath);
+    m_dirPath = dir.absolutePath();
+    m_files.clear();
+    m_fileCount = 0;
+    m_entries.clear();
+    if (!dir.exists()) return false;
+
+    m_entries = listLogFiles();
+    QString previousBaseName;
+    for (const QString &fileName : qAsConst(m_entries)) {
+        const QString baseName = QFileInfo(fileName).completeBaseName();
+        if (baseName == previousBaseName) continue;
+        previousBaseName = baseName;
+
+        QStringList parts = baseName.split('_');
+        if (parts.size() < 3) continue;
+        m_files[key(parts[1], parts[2])].append(dir.filePath(fileName));
+        ++m_fileCount;
+    }
+    return true;
+}
+
+bool TxtDirectoryIndex::isStale() const
+{
+    return listLogFiles() != m_entries;
+}
+
+QStringList TxtDirectoryIndex::files(const QString &portNumber, const QDate &date) const
+{
+    return m_files.value(key(portNumber, date.toString("yyyyMMdd")));
+}
@@ -0,0 +1,36 @@
+#ifndef TXTDIRECTORYINDEX_H
+#define TXTDIRECTORYINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QDate>
+
+// 采集目录的 TXT 文件索引：文件名形如 "<14位会话时间>_<端口>_<yyyyMMdd>.txt"，
+// 列一次目录，建立 (端口, 日期) -> 文件 的映射。同一端口同一天可能有多次采集会话（前缀不同），
+// 全部保留并按会话时间排序，由调用方合并。isStale() 重新列一次 *.txt/*.txtz，文件名有增删改时为 true；
+// 不看目录修改时间，因为 .midx 旁路缓存和压缩时的临时文件也写在同一目录，会让目录时间随建索引而变化。
+// 轮转后压缩的 "<同名>.txtz" 同样收录；同一会话的 .txt 与 .txtz 同时存在时（压缩后尚未删除原文件）只取 .txt
+class TxtDirectoryIndex
+{
+public:
+    bool build(const QString &dirPath);
+    bool isStale() const;
+
+    QString dirPath() const { return m_dirPath; }
+    int fileCount() const { return m_fileCount; }
+
+    // 绝对路径，按会话前缀升序；没有时为空
+    QStringList files(const QString &portNumber, const QDate &date) const;
+
+private:
+    static QString key(const QString &portNumber, const QString &dateString);
+    QStringList listLogFiles() const;
+
+    QString m_dirPath;
+    QStringList m_entries;     // build 时列出的日志文件名（已排序），用于判断是否过期
+    int m_fileCount = 0;
+    QHash<QString, QStringList> m_files;
+};
+
+#endif // TXTDIRECTORYINDEX_H
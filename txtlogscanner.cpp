@@ -0,0 +1,232 @@
+#include "txtlogscanner.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TXTSCAN_AVX2
+#define TXTSCAN_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TXTSCAN_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+inline int countTrailingZeros(quint32 mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+inline int digit(char c)
+{
+    return (c >= '0' && c <= '9') ? c - '0' : -1;
+}
+}
+
+TxtLogScanner::~TxtLogScanner()
+{
+    close();
+}
+
+bool TxtLogScanner::open(const QString &path, QString *error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size == 0) return true;
+
+    uchar *mapped = m_file.map(0, m_size);
+    if (!mapped) {
+        if (error) *error = m_file.errorString();
+        m_file.close();
+        m_size = 0;
+        return false;
+    }
+    m_data = reinterpret_cast<const char *>(mapped);
+    return true;
+}
+
+void TxtLogScanner::openBuffer(const QByteArray &data)
+{
+    close();
+    m_buffer = data;
+    m_data = m_buffer.isEmpty() ? nullptr : m_buffer.constData();
+    m_size = m_buffer.size();
+}
+
+void TxtLogScanner::close()
+{
+    if (m_data && m_buffer.isEmpty()) m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_data)));
+    m_buffer = QByteArray();
+    m_data = nullptr;
+    m_size = 0;
+    if (m_file.isOpen()) m_file.close();
+}
+
+const char *TxtLogScanner::simdLevel()
+{
+#if defined(TXTSCAN_AVX2)
+    return "AVX2";
+#elif defined(TXTSCAN_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+const char *TxtLogScanner::findByte(const char *begin, const char *end, char c)
+{
+#if defined(TXTSCAN_AVX2)
+    const __m256i needle32 = _mm256_set1_epi8(c);
+    while (end - begin >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        quint32 mask = quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle32)));
+        if (mask) return begin + countTrailingZeros(mask);
+        begin += 32;
+    }
+#endif
+#if defined(TXTSCAN_SSE2)
+    const __m128i needle16 = _mm_set1_epi8(c);
+    while (end - begin >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle16)));
+        if (mask) return begin + countTrailingZeros(mask);
+        begin += 16;
+    }
+#endif
+    if (begin >= end) return end;
+    const void *hit = std::memchr(begin, c, size_t(end - begin));
+    return hit ? static_cast<const char *>(hit) : end;
+}
+
+const char *TxtLogScanner::findMarker(const char *begin, const char *end, const char *pattern, int len)
+{
+    if (len <= 0) return begin;
+    if (end - begin < len) return end;
+    const char *last = end - len;   // 最后一个可能的起点
+    const char first = pattern[0];
+    const char tail = pattern[len - 1];
+
+    // 同时比较首字节和尾字节，两者都命中的位置再逐字节确认
+#if defined(TXTSCAN_AVX2)
+    const __m256i first32 = _mm256_set1_epi8(first);
+    const __m256i tail32 = _mm256_set1_epi8(tail);
+    while (last - begin >= 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin + len - 1));
+        quint32 mask = quint32(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first32), _mm256_cmpeq_epi8(b, tail32))));
+        while (mask) {
+            int bit = countTrailingZeros(mask);
+            if (std::memcmp(begin + bit + 1, pattern + 1, size_t(len - 1)) == 0) return begin + bit;
+            mask &= mask - 1;
+        }
+        begin += 32;
+    }
+#endif
+#if defined(TXTSCAN_SSE2)
+    const __m128i first16 = _mm_set1_epi8(first);
+    const __m128i tail16 = _mm_set1_epi8(tail);
+    while (last - begin >= 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin + len - 1));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first16), _mm_cmpeq_epi8(b, tail16))));
+        while (mask) {
+            int bit = countTrailingZeros(mask);
+            if (std::memcmp(begin + bit + 1, pattern + 1, size_t(len - 1)) == 0) return begin + bit;
+            mask &= mask - 1;
+        }
+        begin += 16;
+    }
+#endif
+    for (const char *p = begin; p <= last; ++p) {
+        p = findByte(p, last + 1, first);
+        if (p > last) break;
+        if (std::memcmp(p + 1, pattern + 1, size_t(len - 1)) == 0) return p;
+    }
+    return end;
+}
+
+qint64 TxtLogScanner::parseMinuteKey(const char *p, const char *end)
+{
+    // "yyyy-MM-dd HH:mm"
+    if (end - p < 16) return -1;
+    if (p[4] != '-' || p[7] != '-' || p[10] != ' ' || p[13] != ':') return -1;
+    static const int digitPos[] = {0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15};
+    qint64 key = 0;
+    for (int offset : digitPos) {
+        int d = digit(p[offset]);
+        if (d < 0) return -1;
+        key = key * 10 + d;
+    }
+    return key;
+}
+
+bool TxtLogScanner::passesMinuteFilter(const char *begin, const char *end, qint64 firstMinute) const
+{
+    if (m_minuteFilter.isEmpty()) return true;
+    if (firstMinute >= 0 && m_minuteFilter.contains(firstMinute)) return true;
+    for (const char *p = findMarker(begin, end, "[R:", 3); p < end; p = findMarker(p + 3, end, "[R:", 3)) {
+        qint64 key = parseMinuteKey(p + 3, end);
+        if (key >= 0 && m_minuteFilter.contains(key)) return true;
+    }
+    return false;
+}
+
+qint64 TxtLogScanner::scan(qint64 offset, const LineCallback &callback, qint64 *lines) const
+{
+    if (lines) *lines = 0;
+    if (!m_data || offset >= m_size) return qMin(offset, m_size);
+
+    const char *end = m_data + m_size;
+    const char *pos = m_data + offset;
+    while (pos < end) {
+        const char *newline = findByte(pos, end, '\n');
+        if (newline == end) break;    // 末尾半行
+        if (lines) ++*lines;
+
+        const char *lineBegin = pos;
+        const char *lineEnd = newline;
+        pos = newline + 1;
+        while (lineBegin < lineEnd && isBlank(*lineBegin)) ++lineBegin;
+        while (lineEnd > lineBegin && isBlank(lineEnd[-1])) --lineEnd;
+
+        // 没有 "[R:" 的行（设备启动信息、乱码等）任何日志格式都用不到
+        const char *stamp = findMarker(lineBegin, lineEnd, "[R:", 3);
+        if (stamp == lineEnd) continue;
+
+        const bool startsWithStamp = (stamp == lineBegin);
+        const bool hasData = findMarker(lineBegin, lineEnd, " ST,", 4) != lineEnd;
+        if (m_requireDataLine && (!startsWithStamp || !hasData)) continue;
+
+        const qint64 firstMinute = startsWithStamp ? parseMinuteKey(lineBegin + 3, lineEnd) : -1;
+        if (!passesMinuteFilter(lineBegin, lineEnd, firstMinute)) continue;
+
+        callback({lineBegin, lineEnd, lineBegin - m_data, firstMinute, hasData});
+    }
+    return pos - m_data;
+}
+
+QByteArray TxtLogScanner::trailingBytes(qint64 offset) const
+{
+    if (!m_data || offset >= m_size) return QByteArray();
+    return QByteArray(m_data + offset, int(m_size - offset));
+}
@@ -0,0 +1,65 @@
+#ifndef TXTLOGSCANNER_H
+#define TXTLOGSCANNER_H
+
+#include <QFile>
+#include <QSet>
+#include <QString>
+#include <functional>
+
+// 原始日志的字节级扫描器：文件整体内存映射，用 SIMD 按字节查找换行和 "[R:"、" ST," 标记，
+// 时间前缀 "yyyy-MM-dd HH:mm" 直接按数字解析成 yyyyMMddHHmm，不做 UTF-16 转换。
+// 只有通过筛选的行才交给回调（由回调决定是否解码成 QString），其余行不解码直接跳过。
+// 指令集在编译期选择：定义了 __AVX2__ 用 AVX2，x86/x64 默认 SSE2，其他平台用 memchr
+class TxtLogScanner
+{
+public:
+    struct Line {
+        const char *begin;      // 行首（不含前导空白）
+        const char *end;        // 行尾（不含 \r\n）
+        qint64 offset;          // 行首在文件中的偏移
+        qint64 firstMinute;     // 行首 "[R:" 时间的分钟键，不是以 "[R:" 开头时为 -1
+        bool hasData;           // 行内含 " ST,"
+    };
+    using LineCallback = std::function<void(const Line &line)>;
+
+    ~TxtLogScanner();
+
+    bool open(const QString &path, QString *error = nullptr);
+    // 扫描内存中的数据（如解压后的压缩日志块），共享 data 不复制
+    void openBuffer(const QByteArray &data);
+    void close();
+    qint64 size() const { return m_size; }
+    const char *data() const { return m_data; }
+
+    // 只需要行首为 "[R:" 且含 " ST," 的数据行（单头、多头日志）
+    void setRequireDataLine(bool require) { m_requireDataLine = require; }
+    // 只需要这些分钟的行（行内任意 "[R:" 时间命中即可），为空表示不限
+    void setMinuteFilter(const QSet<qint64> &minutes) { m_minuteFilter = minutes; }
+
+    // 从 offset 开始逐行扫描，只回调以换行结尾、含 "[R:" 且通过筛选的行；lines 返回扫过的完整行数。
+    // 返回最后一个完整行之后的偏移（末尾不带换行的半行不回调，由调用方决定何时处理）
+    qint64 scan(qint64 offset, const LineCallback &callback, qint64 *lines = nullptr) const;
+    // 末尾不带换行的半行，[offset, size)；没有时返回空
+    QByteArray trailingBytes(qint64 offset) const;
+
+    // ---- 供其他模块复用的字节级工具 ----
+    static const char *findByte(const char *begin, const char *end, char c);
+    // 在 [begin, end) 中查找 len 字节的 pattern
+    static const char *findMarker(const char *begin, const char *end, const char *pattern, int len);
+    // 解析 p 处 "yyyy-MM-dd HH:mm"，失败返回 -1
+    static qint64 parseMinuteKey(const char *p, const char *end);
+    // 本次编译使用的指令集（"AVX2"/"SSE2"/"scalar"）
+    static const char *simdLevel();
+
+private:
+    bool passesMinuteFilter(const char *begin, const char *end, qint64 firstMinute) const;
+
+    QFile m_file;
+    QByteArray m_buffer;
+    const char *m_data = nullptr;
+    qint64 m_size = 0;
+    bool m_requireDataLine = false;
+    QSet<qint64> m_minuteFilter;
+};
+
+#endif // TXTLOGSCANNER_H
@@ -0,0 +1,424 @@
+#include "txtminuteindex.h"
+#include "txtblocklog.h"
+#include "txtlogscanner.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QStringList>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+const double kInvalid = 65535;
+const quint32 kSidecarMagic = 0x544D4958;   // "TMIX"
+const quint16 kSidecarVersion = 1;
+const qint64 kHashWindow = 64 * 1024;
+
+bool inRange(double value)
+{
+    return value >= -40.0 && value <= 150.0;
+}
+}
+
+void TxtChannelAggregate::add(double value)
+{
+    if (count == 0 || value < min) min = value;
+    if (count == 0 || value > max) max = value;
+    sum += value;
+    ++count;
+}
+
+void TxtChannelAggregate::merge(const TxtChannelAggregate &other)
+{
+    if (other.count == 0) return;
+    if (count == 0 || other.min < min) min = other.min;
+    if (count == 0 || other.max > max) max = other.max;
+    sum += other.sum;
+    count += other.count;
+}
+
+int TxtMinuteIndex::channelCount(Format format)
+{
+    switch (format) {
+    case StandardLog: return 16;
+    case SingleHeadLog: return 3;
+    case MultiHeadLog: return 9;
+    }
+    return 0;
+}
+
+qint64 TxtMinuteIndex::minuteKey(const QDateTime &dateTime)
+{
+    if (!dateTime.isValid()) return -1;
+    const QDate d = dateTime.date();
+    const QTime t = dateTime.time();
+    return qint64(d.year()) * 100000000 + d.month() * 1000000 + d.day() * 10000 + t.hour() * 100 + t.minute();
+}
+
+qint64 TxtMinuteIndex::parseMinuteKey(const QString &line, int pos)
+{
+    // "yyyy-MM-dd HH:mm"
+    if (pos < 0 || pos + 16 > line.size()) return -1;
+    static const int digitPos[] = {0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15};
+    qint64 key = 0;
+    for (int offset : digitPos) {
+        QChar c = line.at(pos + offset);
+        if (c < '0' || c > '9') return -1;
+        key = key * 10 + (c.unicode() - '0');
+    }
+    if (line.at(pos + 4) != '-' || line.at(pos + 7) != '-' || line.at(pos + 10) != ' ' || line.at(pos + 13) != ':') {
+        return -1;
+    }
+    return key;
+}
+
+void TxtMinuteIndex::reset(const QString &path, Format format)
+{
+    m_path = path;
+    m_format = format;
+    m_minutes.clear();
+    m_lines = 0;
+    m_parsedBytes = 0;
+    m_utf8 = false;
+    m_trailingLine.clear();
+    m_fromSidecar = false;
+}
+
+bool TxtMinuteIndex::build(const QString &path, Format format, QString *error)
+{
+    reset(path, format);
+    if (!update(error, true)) return false;
+    applyTrailingLine();
+    return true;
+}
+
+bool TxtMinuteIndex::load(const QString &path, Format format, QString *error)
+{
+    reset(path, format);
+    m_fromSidecar = loadSidecar();
+    if (!m_fromSidecar) reset(path, format);
+
+    if (!m_fromSidecar && !m_minuteFilter.isEmpty() && TxtBlockLog::isBlockLogPath(path)) {
+        return update(error, true);
+    }
+
+    const qint64 before = m_parsedBytes;
+    if (!update(error, false)) return false;
+    if (!m_fromSidecar || m_parsedBytes != before) {
+        if (!saveSidecar()) qDebug() << "分钟索引缓存写入失败：" << sidecarPath(path);
+    }
+    applyTrailingLine();
+    return true;
+}
+
+bool TxtMinuteIndex::update(QString *error, bool useMinuteFilter)
+{
+    if (TxtBlockLog::isBlockLogPath(m_path)) return updateBlockLog(error, useMinuteFilter);
+
+    TxtLogScanner scanner;
+    if (!scanner.open(m_path, error)) return false;
+    if (scanner.size() < m_parsedBytes) {
+        if (error) *error = "文件比已解析的部分短";
+        return false;
+    }
+
+    // 与 QTextStream 一致：带 BOM 按 UTF-8 解码并跳过 BOM，否则按本地编码
+    if (m_parsedBytes == 0 && scanner.size() >= 3 && std::memcmp(scanner.data(), "\xEF\xBB\xBF", 3) == 0) {
+        m_utf8 = true;
+        m_parsedBytes = 3;
+    }
+
+    scanner.setRequireDataLine(m_format != StandardLog);
+    if (useMinuteFilter) scanner.setMinuteFilter(m_minuteFilter);
+
+    qint64 lines = 0;
+    m_parsedBytes = scanner.scan(m_parsedBytes, [this](const TxtLogScanner::Line &line) {
+        addLine(decode(line.begin, int(line.end - line.begin)));
+    }, &lines);
+    m_lines += lines;
+    m_trailingLine = scanner.trailingBytes(m_parsedBytes); // 可能仍在写入
+    return true;
+}
+
+bool TxtMinuteIndex::updateBlockLog(QString *error, bool useMinuteFilter)
+{
+    TxtBlockLog log;
+    if (!log.open(m_path, error)) return false;
+    // 压缩日志写完后不再变化，缓存已覆盖整个文件时无需再读
+    if (m_parsedBytes == log.fileSize()) return true;
+    if (m_parsedBytes != 0) reset(m_path, m_format);
+
+    const QSet<qint64> minutes = useMinuteFilter ? m_minuteFilter : QSet<qint64>();
+    TxtLogScanner scanner;
+    scanner.setRequireDataLine(m_format != StandardLog);
+    scanner.setMinuteFilter(minutes);
+    m_utf8 = log.hasUtf8Bom();
+
+    QByteArray raw;
+    for (int blockIndex : log.blocksFor(minutes)) {
+        if (!log.readBlock(blockIndex, &raw, error)) return false;
+        scanner.openBuffer(raw);
+
+        const qint64 start = (m_utf8 && log.block(blockIndex).rawOffset == 0) ? 3 : 0;
+        qint64 lines = 0;
+        const qint64 end = scanner.scan(start, [this](const TxtLogScanner::Line &line) {
+            addLine(decode(line.begin, int(line.end - line.begin)));
+        }, &lines);
+        m_lines += lines;
+
+        // 只有最后一块可能以不带换行的半行结尾，文件已完整，直接计入
+        const QByteArray trailing = scanner.trailingBytes(end);
+        if (!trailing.isEmpty()) {
+            ++m_lines;
+            addLine(decode(trailing.constData(), trailing.size()));
+        }
+    }
+    m_parsedBytes = log.fileSize();
+    m_trailingLine.clear();
+    return true;
+}
+
+QString TxtMinuteIndex::decode(const char *data, int size) const
+{
+    return m_utf8 ? QString::fromUtf8(data, size) : QString::fromLocal8Bit(data, size);
+}
+
+void TxtMinuteIndex::applyTrailingLine()
+{
+    if (m_trailingLine.isEmpty()) return;
+    ++m_lines;
+    addLine(decode(m_trailingLine.constData(), m_trailingLine.size()));
+    m_trailingLine.clear();
+}
+
+QString TxtMinuteIndex::sidecarPath(const QString &path)
+{
+    return path + ".midx";
+}
+
+QByteArray TxtMinuteIndex::prefixHash(QFile &file, qint64 length)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArray::number(length));
+    file.seek(0);
+    hash.addData(file.read(qMin(length, kHashWindow)));
+    if (length > kHashWindow) {
+        qint64 tailStart = qMax(kHashWindow, length - kHashWindow);
+        file.seek(tailStart);
+        hash.addData(file.read(length - tailStart));
+    }
+    return hash.result();
+}
+
+bool TxtMinuteIndex::loadSidecar()
+{
+    QFile cache(sidecarPath(m_path));
+    if (!cache.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&cache);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic;
+    quint16 version;
+    qint32 format;
+    qint64 parsedBytes, sourceSize, sourceMtime, lines;
+    QByteArray contentHash;
+    bool utf8;
+    in >> magic >> version >> format;
+    if (in.status() != QDataStream::Ok || magic != kSidecarMagic || version != kSidecarVersion || format != m_format) {
+        return false;
+    }
+    in >> parsedBytes >> sourceSize >> sourceMtime >> contentHash >> utf8 >> lines;
+
+    // 已解析部分必须原样保留：文件只能变长，且首尾摘要一致（大小、修改时间都没变时不必再算摘要）
+    QFileInfo info(m_path);
+    if (in.status() != QDataStream::Ok || info.size() < parsedBytes) return false;
+    bool unchanged = info.size() == sourceSize && info.lastModified().toMSecsSinceEpoch() == sourceMtime;
+    if (!unchanged) {
+        QFile source(m_path);
+        if (!source.open(QIODevice::ReadOnly) || prefixHash(source, parsedBytes) != contentHash) return false;
+    }
+
+    const int channels = channelCount(m_format);
+    qint32 minuteCount;
+    in >> minuteCount;
+    if (in.status() != QDataStream::Ok || minuteCount < 0) return false;
+    m_minutes.reserve(minuteCount);
+    for (qint32 i = 0; i < minuteCount; ++i) {
+        qint64 key;
+        qint32 rows;
+        in >> key >> rows;
+        TxtMinuteAggregate &aggregate = slot(key);
+        aggregate.rows = rows;
+        for (int c = 0; c < channels; ++c) {
+            TxtChannelAggregate &channel = aggregate.channels[c];
+            qint32 count;
+            in >> channel.sum >> count >> channel.min >> channel.max;
+            channel.count = count;
+        }
+    }
+    if (in.status() != QDataStream::Ok) return false;
+
+    m_parsedBytes = parsedBytes;
+    m_utf8 = utf8;
+    m_lines = lines;
+    return true;
+}
+
+bool TxtMinuteIndex::saveSidecar() const
+{
+    QFile source(m_path);
+    if (!source.open(QIODevice::ReadOnly)) return false;
+    const QByteArray contentHash = prefixHash(source, m_parsedBytes);
+    const QFileInfo info(m_path);
+
+    QSaveFile cache(sidecarPath(m_path));
+    if (!cache.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&cache);
+    out.setVersion(QDataStream::Qt_5_12);
+
+    out << kSidecarMagic << kSidecarVersion << qint32(m_format)
+        << m_parsedBytes << info.size() << info.lastModified().toMSecsSinceEpoch()
+        << contentHash << m_utf8 << m_lines;
+    out << qint32(m_minutes.size());
+    for (auto it = m_minutes.constBegin(); it != m_minutes.constEnd(); ++it) {
+        out << it.key() << qint32(it.value().rows);
+        for (const TxtChannelAggregate &channel : it.value().channels) {
+            out << channel.sum << qint32(channel.count) << channel.min << channel.max;
+        }
+    }
+    return out.status() == QDataStream::Ok && cache.commit();
+}
+
+TxtMinuteAggregate &TxtMinuteIndex::slot(qint64 key)
+{
+    TxtMinuteAggregate &aggregate = m_minutes[key];
+    if (aggregate.channels.isEmpty()) aggregate.channels.resize(channelCount(m_format));
+    return aggregate;
+}
+
+void TxtMinuteIndex::addSamples(const QVector<qint64> &keys, const QVector<double> &values, bool countRow)
+{
+    for (qint64 key : keys) {
+        TxtMinuteAggregate &aggregate = slot(key);
+        if (countRow) ++aggregate.rows;
+        for (int i = 0; i < values.size(); ++i) {
+            if (values[i] != kInvalid) aggregate.channels[i].add(values[i]);
+        }
+    }
+}
+
+void TxtMinuteIndex::addLine(const QString &rawLine)
+{
+    const QString line = rawLine.trimmed();
+
+    if (m_format == SingleHeadLog) {
+        if (!line.startsWith("[R:") || !line.contains(" ST,")) return;
+        // 只看行首时间（原实现按 timePart.startsWith 匹配）
+        int endIndex = line.indexOf("] ST,");
+        if (endIndex <= 3) return;
+        qint64 key = parseMinuteKey(line, 3);
+        if (key < 0) return;
+
+        QStringList parts = line.split(',');
+        for (auto &part : parts) part = part.trimmed();
+
+        bool ok1 = false, ok2 = false, ok3 = false;
+        double temp1 = kInvalid, temp2 = kInvalid, temp3 = kInvalid;
+        if (parts.size() >= 4) {
+            temp1 = parts[2].toDouble(&ok1);
+        }
+        if (parts.size() >= 5) {
+            const QString &temp2Raw = parts[3];
+            if (temp2Raw.contains('|')) {
+                QStringList split = temp2Raw.split('|');
+                if (split.size() >= 2) {
+                    temp2 = split[0].toDouble(&ok2);
+                    temp3 = split[1].toDouble(&ok3);
+                }
+            } else if (parts.size() >= 6) {
+                temp2 = parts[3].toDouble(&ok2);
+                temp3 = parts[4].toDouble(&ok3);
+            }
+        }
+
+        QVector<double> values(3, kInvalid);
+        if (ok1 && inRange(temp1)) values[0] = temp1;
+        if (ok2 && inRange(temp2)) values[1] = temp2;
+        if (ok3 && inRange(temp3)) values[2] = temp3;
+        addSamples({key}, values, true);
+        return;
+    }
+
+    if (m_format == MultiHeadLog && (!line.startsWith("[R:") || !line.contains(" ST,"))) return;
+
+    // 标准、多头按 line.contains(目标分钟) 匹配：一行里所有 "[R:" 时间戳的分钟都算
+    QVector<qint64> keys;
+    for (int pos = line.indexOf("[R:"); pos >= 0; pos = line.indexOf("[R:", pos + 3)) {
+        qint64 key = parseMinuteKey(line, pos + 3);
+        if (key >= 0 && !keys.contains(key)) keys.append(key);
+    }
+    if (keys.isEmpty()) return;
+
+    if (m_format == MultiHeadLog) {
+        QStringList parts = line.split(',', Qt::SkipEmptyParts);
+        if (parts.size() < 19) return;
+
+        static const int indices[] = {6, 7, 8, 11, 12, 13, 16, 17, 18};
+        QVector<double> values(9, kInvalid);
+        int validCount = 0;
+        for (int i = 0; i < 9; ++i) {
+            bool ok;
+            double temp = parts.value(indices[i]).trimmed().toDouble(&ok) / 100.0; // 温度值需要除以100
+            if (ok && inRange(temp)) {
+                values[i] = temp;
+                ++validCount;
+            }
+        }
+        // 只有当至少7个通道有效时，才记录该行数据
+        if (validCount >= 7) addSamples(keys, values, true);
+        return;
+    }
+
+    // StandardLog
+    QStringList parts = line.split(',');
+    if (parts.size() < 19) return;
+    QVector<double> values(16, kInvalid);
+    for (int i = 3; i <= 18; ++i) {
+        bool ok;
+        double temp = parts[i].split(':').last().trimmed().toDouble(&ok);
+        if (ok && inRange(temp)) values[i - 3] = temp;
+    }
+    addSamples(keys, values, true);
+}
+
+void TxtMinuteIndex::merge(const TxtMinuteIndex &other)
+{
+    if (other.m_format != m_format) return;
+    for (auto it = other.m_minutes.constBegin(); it != other.m_minutes.constEnd(); ++it) {
+        TxtMinuteAggregate &aggregate = slot(it.key());
+        aggregate.rows += it.value().rows;
+        for (int i = 0; i < aggregate.channels.size() && i < it.value().channels.size(); ++i) {
+            aggregate.channels[i].merge(it.value().channels[i]);
+        }
+    }
+    m_lines += other.m_lines;
+}
+
+const TxtMinuteAggregate *TxtMinuteIndex::minute(qint64 minuteKey) const
+{
+    auto it = m_minutes.constFind(minuteKey);
+    return (it == m_minutes.constEnd()) ? nullptr : &it.value();
+}
+
+QVector<double> TxtMinuteIndex::averages(qint64 minuteKey) const
+{
+    QVector<double> result(channelCount(m_format), kInvalid);
+    const TxtMinuteAggregate *aggregate = minute(minuteKey);
+    if (!aggregate) return result;
+    for (int i = 0; i < result.size() && i < aggregate->channels.size(); ++i) {
+        result[i] = aggregate->channels[i].mean();
+    }
+    return result;
+}
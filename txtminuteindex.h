@@ -0,0 +1,127 @@
+#ifndef TXTMINUTEINDEX_H
+#define TXTMINUTEINDEX_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
+
+class QFile;
+
+// 单个通道一分钟内的有效采样汇总
+struct TxtChannelAggregate
+{
+    double sum = 0.0;
+    int count = 0;
+    double min = 0.0;
+    double max = 0.0;
+
+    void add(double value);
+    void merge(const TxtChannelAggregate &other);
+    double mean() const { return count > 0 ? sum / count : 65535; }
+};
+
+// 一分钟的汇总：rows 为该分钟内被采纳的数据行数
+struct TxtMinuteAggregate
+{
+    int rows = 0;
+    QVector<TxtChannelAggregate> channels;
+};
+
+// 原始 TXT 日志的分钟索引：整个文件只读一遍，按 "[R:yyyy-MM-dd HH:mm" 分钟汇总每个通道的
+// 和、个数、最小值、最大值，之后任意分钟的均值查询都是 O(1)。
+// 三种日志的行筛选、字段位置和有效性判断与 DataExcelProcessor 原来逐分钟扫描时完全一致：
+//   StandardLog   标准温度计，AAA1..AAA16 共 16 通道，只要行内时间匹配且字段数 ≥ 19 即计入
+//   SingleHeadLog 单头，3 通道，只看行首 "[R:" 的时间
+//   MultiHeadLog  多头，9 通道（原值 /100），同一行至少 7 个通道有效才计入
+//
+// 旁路缓存：load() 会在 TXT 旁边写一个 "<文件名>.midx"，记录已解析的字节数、文件大小、修改时间、
+// 已解析部分首尾各 64KB 的 MD5 以及全部分钟汇总。再次处理同一文件时：
+//   大小和修改时间都没变        直接使用缓存
+//   文件变长且已解析部分未改动  读入缓存后只解析新追加的行（采集过程中文件仍在写入）
+//   其他情况（被替换、被截短）  重新解析并覆盖缓存
+// 末尾不带换行的半行只计入内存结果，不写入缓存，追加完整后会被重新解析
+//
+// 读取通过 TxtLogScanner 内存映射并按字节预筛选，不含 "[R:"（单头、多头还要求行首 "[R:" 且含 " ST,"）
+// 或不在分钟筛选范围内的行不解码，只有候选行才转成 QString 交给 addLine 按原规则解析
+//
+// 分块压缩日志（.txtz，见 TxtBlockLog）同样支持，解压后的块按同样的规则扫描。压缩日志不再变化，
+// parsedBytes 记为压缩文件大小，旁路缓存照常使用；有分钟筛选时只解压块索引中含这些分钟的块
+class TxtMinuteIndex
+{
+public:
+    enum Format {
+        StandardLog,
+        SingleHeadLog,
+        MultiHeadLog
+    };
+
+    static int channelCount(Format format);
+
+    // yyyyMMddHHmm 形式的分钟键，无效时间返回 -1；Excel 时间行可用 ExcelTimeRow::txtMinuteKey 直接得到
+    static qint64 minuteKey(const QDateTime &dateTime);
+
+    // 只汇总这些分钟（minuteKey），为空表示全部；对 build 以及没有缓存的压缩日志的 load 生效
+    void setMinuteFilter(const QSet<qint64> &minutes) { m_minuteFilter = minutes; }
+
+    // 完整解析整个文件（不读写缓存）
+    bool build(const QString &path, Format format, QString *error = nullptr);
+    // 优先使用旁路缓存，必要时增量解析并更新缓存；缓存目录不可写时只是不保存。
+    // 缓存必须完整，因此 load 对 TXT 总是汇总全部分钟；没有缓存的压缩日志在设置了分钟筛选时
+    // 只解压相关的块，结果不完整，也不写缓存
+    bool load(const QString &path, Format format, QString *error = nullptr);
+
+    static QString sidecarPath(const QString &path);
+
+    QString path() const { return m_path; }
+    Format format() const { return m_format; }
+    bool isEmpty() const { return m_minutes.isEmpty(); }
+    int minuteCount() const { return m_minutes.size(); }
+    qint64 lineCount() const { return m_lines; }
+    qint64 parsedBytes() const { return m_parsedBytes; }
+    bool loadedFromSidecar() const { return m_fromSidecar; }
+
+    // 没有该分钟的数据时返回 nullptr
+    const TxtMinuteAggregate *minute(qint64 minuteKey) const;
+    const TxtMinuteAggregate *minute(const QDateTime &dateTime) const { return minute(minuteKey(dateTime)); }
+    // 各通道均值，无数据的通道为 65535
+    QVector<double> averages(qint64 minuteKey) const;
+    QVector<double> averages(const QDateTime &dateTime) const { return averages(minuteKey(dateTime)); }
+
+    // 逐行累加
+    void addLine(const QString &line);
+    // 并入另一个同格式文件的汇总（同一端口同一天的多次采集会话）
+    void merge(const TxtMinuteIndex &other);
+
+private:
+    void reset(const QString &path, Format format);
+    // 从 m_parsedBytes 继续解析新追加的完整行
+    bool update(QString *error, bool useMinuteFilter);
+    // 压缩日志：解压需要的块逐块扫描
+    bool updateBlockLog(QString *error, bool useMinuteFilter);
+    QString decode(const char *data, int size) const;
+    // 末尾半行计入内存结果（每次 update 之后调用，不影响 parsedBytes）
+    void applyTrailingLine();
+    bool loadSidecar();
+    bool saveSidecar() const;
+    // 源文件 [0, length) 的首尾各 64KB 摘要
+    static QByteArray prefixHash(QFile &file, qint64 length);
+
+    // 在 line 的 pos 处解析 "yyyy-MM-dd HH:mm"，失败返回 -1
+    static qint64 parseMinuteKey(const QString &line, int pos);
+    TxtMinuteAggregate &slot(qint64 key);
+    void addSamples(const QVector<qint64> &keys, const QVector<double> &values, bool countRow);
+
+    QString m_path;
+    Format m_format = StandardLog;
+    QHash<qint64, TxtMinuteAggregate> m_minutes;
+    qint64 m_lines = 0;
+    qint64 m_parsedBytes = 0;     // 已解析的完整行的字节数
+    bool m_utf8 = false;          // 文件带 UTF-8 BOM（否则按本地编码，与 QTextStream 默认一致）
+    QByteArray m_trailingLine;    // 末尾不带换行的半行
+    bool m_fromSidecar = false;
+    QSet<qint64> m_minuteFilter;
+};
+
+#endif // TXTMINUTEINDEX_H
@@ -0,0 +1,153 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QDate>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTextStream>
+#include "txtblocklog.h"
+
+// 用法：
+//   txtpack --dir D:/高低温数据 --remove
+//   txtpack 20240911083000_COM7_20240911.txt --level 9
+// 把轮转后的原始日志压缩成同名 .txtz（见 TxtBlockLog），数据处理会直接读取 .txtz。
+// --dir 递归查找 "<14位会话时间>_<端口>_<yyyyMMdd>.txt"，只处理日期早于今天、且至少 --idle 分钟
+// 未修改的文件（仍在采集中的当天日志不动）；直接列出的文件不做这项检查。
+// 压缩后总是解压校验一遍，--remove 时校验通过才删除原文件（连同它的 .midx 缓存）
+namespace {
+struct Totals {
+    int files = 0;
+    int failed = 0;
+    qint64 rawBytes = 0;
+    qint64 packedBytes = 0;
+    double packMs = 0.0;
+    double unpackMs = 0.0;
+};
+
+bool isRotated(const QFileInfo &info, int idleMinutes)
+{
+    static const QRegularExpression name(R"(^\d{14}_[^_]+_(\d{8})$)");
+    const QRegularExpressionMatch match = name.match(info.completeBaseName());
+    if (!match.hasMatch()) return false;
+    const QDate date = QDate::fromString(match.captured(1), "yyyyMMdd");
+    return date.isValid() && date < QDate::currentDate()
+           && info.lastModified().secsTo(QDateTime::currentDateTime()) >= idleMinutes * 60;
+}
+
+QByteArray fileHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    return hash.result();
+}
+
+// 逐块解压，与原文件逐字节一致
+bool verify(const QString &txtPath, const QString &packedPath, double *unpackMs, QString *error)
+{
+    QElapsedTimer timer;
+    timer.start();
+    TxtBlockLog log;
+    if (!log.open(packedPath, error)) return false;
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    QByteArray raw;
+    for (int i = 0; i < log.blockCount(); ++i) {
+        if (!log.readBlock(i, &raw, error)) return false;
+        hash.addData(raw);
+    }
+    *unpackMs = timer.nsecsElapsed() / 1e6;
+
+    if (hash.result() != fileHash(txtPath)) {
+        *error = "解压结果与原文件不一致";
+        return false;
+    }
+    return true;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("txtpack");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("把轮转后的原始 TXT 日志压缩为可按分钟定位的分块格式（.txtz）");
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", "要压缩的 .txt 文件", "[files...]");
+    QCommandLineOption dirOption("dir", "递归查找已轮转的日志", "path");
+    QCommandLineOption idleOption("idle", "至少这么多分钟未修改才视为已轮转", "minutes", "10");
+    QCommandLineOption blockOption("block-kb", "每块原始大小（KB）", "kb", QString::number(TxtBlockLog::DefaultBlockSize / 1024));
+    QCommandLineOption levelOption("level", "zlib 压缩级别 0-9，-1 为默认", "level", "-1");
+    QCommandLineOption removeOption("remove", "校验通过后删除原 TXT");
+    parser.addOptions({dirOption, idleOption, blockOption, levelOption, removeOption});
+    parser.process(app);
+
+    QStringList files = parser.positionalArguments();
+    if (parser.isSet(dirOption)) {
+        const int idle = parser.value(idleOption).toInt();
+        QDirIterator it(parser.value(dirOption), QStringList() << "*.txt", QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString path = it.next();
+            if (isRotated(QFileInfo(path), idle)) files.append(path);
+        }
+    }
+    files.sort();
+    if (files.isEmpty()) {
+        QTextStream(stderr) << "没有需要压缩的日志\n";
+        return 1;
+    }
+
+    const int blockSize = qMax(4, parser.value(blockOption).toInt()) * 1024;
+    const int level = qBound(-1, parser.value(levelOption).toInt(), 9);
+    QTextStream out(stdout);
+    Totals totals;
+
+    for (const QString &path : files) {
+        const QString packedPath = TxtBlockLog::compressedPath(path);
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        double unpackMs = 0.0;
+        if (!TxtBlockLog::compressFile(path, packedPath, &error, blockSize, level)) {
+            out << "失败：" << path << "（" << error << "）\n";
+            ++totals.failed;
+            continue;
+        }
+        if (!verify(path, packedPath, &unpackMs, &error)) {
+            out << "校验失败：" << path << "（" << error << "）\n";
+            QFile::remove(packedPath);
+            ++totals.failed;
+            continue;
+        }
+        const double ms = timer.nsecsElapsed() / 1e6 - unpackMs;
+        const qint64 rawBytes = QFileInfo(path).size();
+        const qint64 packedBytes = QFileInfo(packedPath).size();
+        out << QString("%1  %2 KB -> %3 KB（%4%）\n")
+                   .arg(QFileInfo(packedPath).fileName())
+                   .arg(rawBytes / 1024).arg(packedBytes / 1024)
+                   .arg(rawBytes > 0 ? 100.0 * packedBytes / rawBytes : 0.0, 0, 'f', 1);
+
+        if (parser.isSet(removeOption)) {
+            QFile::remove(path + ".midx");
+            if (!QFile::remove(path)) out << "原文件删除失败：" << path << "\n";
+        }
+        ++totals.files;
+        totals.rawBytes += rawBytes;
+        totals.packedBytes += packedBytes;
+        totals.packMs += ms;
+        totals.unpackMs += unpackMs;
+    }
+
+    auto mbps = [](qint64 bytes, double ms) { return ms > 0.0 ? bytes / 1048576.0 / (ms / 1000.0) : 0.0; };
+    out << QString("共 %1 个文件（失败 %2），%3 MB -> %4 MB，压缩 %5 MB/s，解压 %6 MB/s\n")
+               .arg(totals.files).arg(totals.failed)
+               .arg(totals.rawBytes / 1048576.0, 0, 'f', 1).arg(totals.packedBytes / 1048576.0, 0, 'f', 1)
+               .arg(mbps(totals.rawBytes, totals.packMs), 0, 'f', 1)
+               .arg(mbps(totals.rawBytes, totals.unpackMs), 0, 'f', 1);
+    return totals.failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,19 @@
+# 原始日志压缩工具（独立程序，不依赖主工程界面）
+# 把轮转后的 TXT 压缩为分块 .txtz（zlib，按块附分钟索引），数据处理可直接读取并只解压需要的分钟
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = txtpack
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../txtblocklog.cpp \
+    ../txtlogscanner.cpp \
+    main.cpp
+
+HEADERS += \
+    ../txtblocklog.h \
+    ../txtlogscanner.h